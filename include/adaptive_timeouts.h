@@ -0,0 +1,86 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "timing_config.h"
+
+namespace fuelflux {
+
+// Connect and total timeouts of backend requests derived from recently measured latencies,
+// so that a dead backend is given up on (and the offline path taken) sooner when the link
+// is fast.
+//
+// Connect times are kept per backend (they measure the link), total times per endpoint
+// (a card listing takes longer than an authorization); an endpoint is identified by its
+// path, so the pages of a listing share their samples. A timeout is kHttpTimeoutMultiplier
+// times the kHttpTimeoutPercentile of the last kHttpTimeoutWindow samples, clamped to
+// [floor, ceiling]; until kHttpTimeoutMinSamples were measured the ceiling applies.
+// A request that timed out is recorded with the time it took, so a few timeouts in a
+// row bring a degraded link back to the ceiling.
+class AdaptiveTimeouts {
+public:
+    using Duration = std::chrono::milliseconds;
+
+    struct Limits {
+        Duration floor;
+        Duration ceiling;
+    };
+
+    struct Timeouts {
+        Duration connect{0};
+        Duration total{0};
+
+        bool operator==(const Timeouts& other) const {
+            return connect == other.connect && total == other.total;
+        }
+        bool operator!=(const Timeouts& other) const { return !(*this == other); }
+    };
+
+    AdaptiveTimeouts(Limits connect, Limits total);
+
+    // Timeouts for the next request to 'endpoint'; a change is logged
+    Timeouts For(const std::string& endpoint);
+
+    // Timings of a finished request. 'connect' is the time to set up a new connection
+    // (zero if a pooled one was reused); 'total' the time of the whole request.
+    void Record(const std::string& endpoint, Duration connect, Duration total);
+
+private:
+    // The last kHttpTimeoutWindow samples
+    class Window {
+    public:
+        void Add(Duration sample);
+        std::size_t Size() const { return samples_.size(); }
+        // Nearest-rank q-quantile; zero if empty
+        Duration Percentile(double q) const;
+
+    private:
+        std::vector<Duration> samples_;
+        std::size_t next_ = 0;
+    };
+
+    struct Endpoint {
+        Window total;
+        Timeouts last;  // Returned by the previous For()
+    };
+
+    static Duration Derive(const Window& window, const Limits& limits);
+
+    const Limits connectLimits_;
+    const Limits totalLimits_;
+
+    std::mutex mutex_;
+    Window connect_;
+    std::map<std::string, Endpoint> endpoints_;
+};
+
+} // namespace fuelflux
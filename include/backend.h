@@ -7,17 +7,23 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <functional>
+#include <future>
 #include <mutex>
 #include <thread>
 #include <atomic>
 #include <nlohmann/json.hpp>
 #include "types.h"
+#include "card_records.h"
 #include "session.h"
 #include "bounded_executor.h"
+#include "circuit_breaker.h"
 
 namespace fuelflux {
 
 class MessageStorage;
+class TlsSessionStore;
 
 // Tank information structure for backend
 struct BackendTankInfo {
@@ -30,21 +36,6 @@ struct BackendTankInfo {
                                      // or a backend-configured per-tank limit, depending on backend semantics.
 };
 
-// User card structure for cache population
-struct UserCard {
-    std::string uid;
-    int roleId = 0;
-    double allowance = 0.0;
-};
-
-// Fuel tank structure for cache population
-struct FuelTank {
-    int idTank = 0;
-    int visualNumberTank = 0;
-    std::string nameTank;
-    Volume volume = 0.0;
-};
-
 // Interface for backend communication to enable mocking in tests
 class IBackend {
 public:
@@ -66,6 +57,23 @@ public:
     virtual std::vector<UserCard> FetchUserCards(int first, int number) = 0;
     virtual std::vector<FuelTank> FetchFuelTanks(int first, int number) = 0;
     virtual const std::string& GetControllerUid() const = 0;
+    // Fetch at most 'number' card changes made since the 'since' watermark.
+    // Returns std::nullopt when delta synchronization is not available; the caller
+    // then falls back to a full FetchUserCards population.
+    virtual std::optional<UserCardDelta> FetchUserCardChanges(const std::string& since [[maybe_unused]],
+                                                              int number [[maybe_unused]]) {
+        return std::nullopt;
+    }
+
+    // Non-blocking variants: the future becomes ready once the backend answered, after the
+    // state the blocking call would update (token, role, allowance, last error) is updated.
+    // They must not overlap with other calls that modify the same backend.
+    // The defaults run the blocking call on the calling thread and return a ready future.
+    virtual std::future<bool> AuthorizeAsync(const std::string& uid);
+    virtual std::future<bool> DeauthorizeAsync();
+    virtual std::future<bool> RefuelAsync(TankNumber tankNumber, Volume volume);
+    virtual std::future<bool> IntakeAsync(TankNumber tankNumber, Volume volume, IntakeDirection direction);
+    virtual std::future<std::vector<UserCard>> FetchUserCardsAsync(int first, int number);
 };
 
 // Base backend class with shared logic for request/response handling
@@ -83,6 +91,15 @@ public:
 // the method returns false to indicate that no state change occurred.
 // Applications should avoid concurrent calls to modifying methods and getters,
 // or use external synchronization if concurrent access is needed.
+//
+// All requests but deauthorization go through a circuit breaker: after repeated network
+// errors they fail at once (IsNetworkError() is true) until a probe finds the backend
+// reachable again, so an outage costs the controller a cache lookup instead of a timeout.
+//
+// The *Async variants send their request through HttpRequestAsync and finish on the thread
+// that delivers the response (the HTTP engine I/O thread for Backend); the future of
+// DeauthorizeAsync is true once the server confirmed the deauthorization. A backend that is
+// not managed by shared_ptr runs them synchronously.
 class BackendBase : public IBackend, public std::enable_shared_from_this<BackendBase> {
 public:
     ~BackendBase() override = default;
@@ -105,6 +122,13 @@ public:
     std::vector<UserCard> FetchUserCards(int first, int number) override;
     std::vector<FuelTank> FetchFuelTanks(int first, int number) override;
     const std::string& GetControllerUid() const override { return controllerUid_; }
+    std::optional<UserCardDelta> FetchUserCardChanges(const std::string& since, int number) override;
+
+    std::future<bool> AuthorizeAsync(const std::string& uid) override;
+    std::future<bool> DeauthorizeAsync() override;
+    std::future<bool> RefuelAsync(TankNumber tankNumber, Volume volume) override;
+    std::future<bool> IntakeAsync(TankNumber tankNumber, Volume volume, IntakeDirection direction) override;
+    std::future<std::vector<UserCard>> FetchUserCardsAsync(int first, int number) override;
 
 protected:
     BackendBase(std::string controllerUid, std::shared_ptr<MessageStorage> storage);
@@ -120,16 +144,105 @@ protected:
                                               const nlohmann::json& requestBody,
                                               const std::string& bearerToken) = 0;
     
+    // Same as HttpRequestWrapper with the request body already serialized
+    // The default parses the body and forwards it to HttpRequestWrapper
+    virtual nlohmann::json HttpRequestWithBody(const std::string& endpoint,
+                                               const std::string& method,
+                                               const std::string& body,
+                                               bool useBearerToken);
+
+    // HttpRequestWrapper plus a ConnectivitySignal report of the outcome;
+    // all foreground requests go through here
+    nlohmann::json SendRequest(const std::string& endpoint,
+                               const std::string& method,
+                               const nlohmann::json& requestBody,
+                               bool useBearerToken);
+    // SendRequest for a serialized body (backlog replay)
+    nlohmann::json SendRequestWithBody(const std::string& endpoint,
+                                       const std::string& method,
+                                       const std::string& body,
+                                       bool useBearerToken);
+
+    // Receives the items of an array response one at a time; false stops the request
+    using RecordCallback = std::function<bool(const nlohmann::json& record)>;
+
+    // Request for a listing: the items of an array response are handed to onRecord instead
+    // of being returned, and the response comes back with that array left empty (any other
+    // response, such as an error object, is returned whole).
+    // The default takes the complete response from HttpRequestWrapper.
+    virtual nlohmann::json HttpRequestRecords(const std::string& endpoint,
+                                              const std::string& method,
+                                              const nlohmann::json& requestBody,
+                                              bool useBearerToken,
+                                              const RecordCallback& onRecord);
+    // Whether a request may go out; false while the circuit is open (which starts a probe
+    // of the backend when one is due)
+    bool AdmitRequest();
+    // Send a foreground request through the circuit breaker: while it is open the request
+    // fails at once as a network error. Reports the outcome to the breaker and ConnectivitySignal.
+    nlohmann::json SendGuarded(const std::string& endpoint, const std::function<nlohmann::json()>& send);
+
+    // SendRequest counterpart of HttpRequestRecords
+    nlohmann::json SendRecordsRequest(const std::string& endpoint,
+                                      const std::string& method,
+                                      const nlohmann::json& requestBody,
+                                      bool useBearerToken,
+                                      const RecordCallback& onRecord);
+
+    // Receives the response of HttpRequestAsync as HttpRequestWrapper would have returned it
+    using ResponseCallback = std::function<void(const nlohmann::json& response, bool networkError)>;
+
+    // Send a request without waiting for the response; 'done' is called exactly once.
+    // The default performs it on the calling thread through HttpRequestWrapper.
+    virtual void HttpRequestAsync(const std::string& endpoint,
+                                  const std::string& method,
+                                  const nlohmann::json& requestBody,
+                                  const std::string& bearerToken,
+                                  ResponseCallback done);
+
+    // Check whether the backend can be reached again while the circuit is open, without
+    // waiting for it; 'done' is called exactly once, possibly on another thread.
+    // The default cannot tell without a request and lets the next request through as the trial.
+    virtual void ProbeBackend(std::function<void(bool reachable)> done);
+
     // Send async deauthorize request without mutex - overridden by concrete backend
     virtual void SendAsyncDeauthorizeRequest(const std::string& token) = 0;
 
+    // Start the deauthorize request of a session that is already cleared locally, without
+    // waiting for it. The default runs SendAsyncDeauthorizeRequest on the deauthorize executor.
+    virtual void StartDeauthorizeRequest(const std::string& token);
+
     // Get the bounded executor for async deauthorization requests
     // Uses Meyer's singleton pattern for thread-safe lazy initialization
     static BoundedExecutor& GetDeauthorizeExecutor();
 
-    // Map TankNumber in a payload from visualNumberTank to idTank.
-    // Returns true if a match was found and the mapping was applied.
-    bool ApplyVisualTankMapping(nlohmann::json& requestBody) const;
+    // idTank of the authorized tank with this visualNumberTank; nullopt if there is none
+    std::optional<std::int64_t> MapVisualTankNumber(std::int64_t visualNumber) const;
+
+    // Replay a stored backlog payload to the endpoint; 'report' names it in the log
+    bool SendPayload(const std::string& payload, const std::string& endpoint, const char* report);
+
+    // Validation and request body of an operation (false: refused, lastError_ is set) and
+    // the handling of its response, shared by the blocking and the async variants
+    bool BeginAuthorize(const std::string& uid, nlohmann::json& requestBody);
+    bool FinishAuthorize(const std::string& uid, const nlohmann::json& response);
+    bool BeginRefuel(TankNumber tankNumber, Volume volume, nlohmann::json& requestBody);
+    bool FinishRefuel(Volume volume, const nlohmann::json& requestBody, const nlohmann::json& response);
+    bool BeginIntake(TankNumber tankNumber, Volume volume, IntakeDirection direction, nlohmann::json& requestBody);
+    bool FinishIntake(const nlohmann::json& requestBody, const nlohmann::json& response);
+    // 'cards' were already streamed out of the response by HttpRequestRecords
+    std::vector<UserCard> FinishFetchUserCards(const nlohmann::json& response, std::vector<UserCard> cards = {});
+    // Clear the session locally; returns its token, or nullopt if there was no session
+    std::optional<std::string> EndSession();
+
+    // Send a request through HttpRequestAsync and resolve the future with finish(response,
+    // networkError); 'self' keeps the backend alive until then
+    template <typename T>
+    std::future<T> SendAsync(std::shared_ptr<BackendBase> self,
+                             const std::string& endpoint,
+                             const nlohmann::json& requestBody,
+                             const std::string& bearerToken,
+                             std::function<T(const nlohmann::json&, bool)> finish);
 
     std::string controllerUid_;
     std::string authorizedUid_;
@@ -141,6 +254,8 @@ protected:
     std::string lastError_;
     std::atomic<bool> networkError_{false};
     std::shared_ptr<MessageStorage> storage_;
+    // Shared with the callbacks of async requests and probes, which may outlive the backend
+    std::shared_ptr<CircuitBreaker> breaker_;
 };
 
 // Backend class for real REST API communication
@@ -150,17 +265,26 @@ public:
     // Parameters:
     //   baseAPI - base URL of backend REST API
     //   controllerUid - UID of controller
-    Backend(const std::string& baseAPI, const std::string& controllerUid, std::shared_ptr<MessageStorage> storage = nullptr);
+    //   tlsSessions - persisted TLS sessions to resume after a restart (optional, HTTPS only)
+    Backend(const std::string& baseAPI, const std::string& controllerUid, std::shared_ptr<MessageStorage> storage = nullptr,
+            std::shared_ptr<TlsSessionStore> tlsSessions = nullptr);
     
     ~Backend() override;
 
 private:
-    // Private method for common parsing of responses from the backend
+    // All the request overloads below end in PerformRequest (or the async path), which
+    // fills the endpoint's prepared template with the body and the token.
     // Returns: parsed JSON; on error returns object with CodeError/TextError
     nlohmann::json HttpRequestWrapper(const std::string& endpoint, 
                                        const std::string& method,
                                        const nlohmann::json& requestBody,
                                        bool useBearerToken = false) override;
+
+    // Request with a serialized body; the json overload above dumps its body and calls this
+    nlohmann::json HttpRequestWithBody(const std::string& endpoint,
+                                       const std::string& method,
+                                       const std::string& body,
+                                       bool useBearerToken) override;
     
     // Overload that accepts explicit token for async deauthorization
     nlohmann::json HttpRequestWrapper(const std::string& endpoint,
@@ -170,13 +294,62 @@ private:
     
     // Send async deauthorize request without mutex
     void SendAsyncDeauthorizeRequest(const std::string& token) override;
-    
-    // Static helper for async deauthorize - doesn't use mutex or modify state
-    static void SendAsyncDeauthorize(const std::string& baseAPI, const std::string& token);
+
+    // Non-blocking request on the shared HttpEngine with an easy handle of its own
+    void HttpRequestAsync(const std::string& endpoint,
+                          const std::string& method,
+                          const nlohmann::json& requestBody,
+                          const std::string& bearerToken,
+                          ResponseCallback done) override;
+
+    // Listing request whose array is parsed record by record as curl receives it
+    nlohmann::json HttpRequestRecords(const std::string& endpoint,
+                                      const std::string& method,
+                                      const nlohmann::json& requestBody,
+                                      bool useBearerToken,
+                                      const RecordCallback& onRecord) override;
+
+    // Deauthorize through HttpRequestAsync instead of the deauthorize executor thread
+    void StartDeauthorizeRequest(const std::string& token) override;
+
+    // Connect to the backend (TCP and TLS handshake) on the HTTP engine, without a request
+    void ProbeBackend(std::function<void(bool reachable)> done) override;
+
+    // libcurl state kept across requests (defined in backend.cpp)
+    struct CurlShare;
+    struct CurlConnection;
+    struct AsyncTransfer;
+    struct TlsResumption;
+    struct RequestTemplates;
+
+    // Send a request on the long-lived handle and wait for it; no Authorization header
+    // if bearerToken is empty. With onRecord the response is streamed as in HttpRequestRecords.
+    nlohmann::json PerformRequest(const std::string& endpoint,
+                                  const std::string& method,
+                                  const std::string& bodyStr,
+                                  const std::string& bearerToken,
+                                  const RecordCallback* onRecord = nullptr);
+
+    // Reset the long-lived handle for the next request, or build a new one if there is
+    // none yet or the network link changed since it was built; nullptr if curl fails.
+    // Must be called with requestMutex_ held.
+    CurlConnection* AcquireConnection();
+
+    // Share object for async requests (created if no foreground request was made yet)
+    std::shared_ptr<CurlShare> CurrentShare();
 
     // Base URL of backend REST API
     std::string baseAPI_;
+    // baseAPI_ parsed once, the static headers and per-endpoint request templates
+    std::shared_ptr<RequestTemplates> templates_;
     std::recursive_mutex requestMutex_;
+    // Guarded by requestMutex_
+    std::unique_ptr<CurlConnection> connection_;
+    // Share object of connection_, also used by async requests
+    std::shared_ptr<CurlShare> share_;
+    std::mutex shareMutex_;
+    // Offers and saves the TLS sessions of all requests (null if sessions are not persisted)
+    std::shared_ptr<TlsResumption> tls_;
 };
 
 } // namespace fuelflux
@@ -0,0 +1,37 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace fuelflux {
+
+// Encoding of report bodies queued in the message backlog
+//
+// A payload is a version byte followed by the body in MessagePack. Payloads written
+// before the binary encoding are the JSON text itself; they start with '{' (or
+// whitespace), which no version byte uses, so both forms are read back.
+constexpr std::uint8_t kBacklogPayloadMsgpackV1 = 0x01;
+
+std::string EncodeBacklogPayload(const nlohmann::json& body);
+
+// Returns the replacement for the top-level "TankNumber", or nullopt to keep it
+using TankNumberMapper = std::function<std::optional<std::int64_t>(std::int64_t tankNumber)>;
+
+// Request body text (as json::dump() would produce it) written straight from the stored
+// payload, without building a JSON document; nullopt if the payload is corrupt or of an
+// unknown version
+std::optional<std::string> BacklogPayloadToWireBody(const std::string& payload,
+                                                    const TankNumberMapper& mapTankNumber = nullptr);
+
+// Full decode, for inspection and tests
+std::optional<nlohmann::json> DecodeBacklogPayload(const std::string& payload);
+
+} // namespace fuelflux
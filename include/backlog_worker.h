@@ -7,20 +7,51 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <thread>
+#include <vector>
 
 #include "backend.h"
 #include "message_storage.h"
+#include "timing_config.h"
 
 namespace fuelflux {
 
+// Cumulative backlog drain counters
+struct BacklogDrainStats {
+    std::uint64_t sessions = 0;       // Authorize/Deauthorize cycles
+    std::uint64_t delivered = 0;      // Messages accepted by the backend
+    std::uint64_t deadLettered = 0;   // Messages moved to dead messages
+    std::chrono::milliseconds busyTime{0};  // Wall-clock time spent draining
+
+    double MessagesPerMinute() const {
+        const auto minutes = std::chrono::duration<double, std::ratio<60>>(busyTime).count();
+        return minutes > 0.0 ? static_cast<double>(delivered) / minutes : 0.0;
+    }
+};
+
+// Delivers stored reports to the backend
+// Each ProcessOnce() call takes the users with the oldest backlog messages, one per
+// backend, and sends up to kSessionMaxMessages of each user's messages, in order, inside
+// one authorized session. With several backends the sessions run in parallel; a user is
+// never handled by two sessions at once, so every user's reports keep their order.
+// A network error in any session stops all of them and the worker backs off as a whole:
+// every due message is rescheduled with exponential backoff and jitter (next_attempt_at)
+// and the worker sleeps until the earliest one, unless ConnectivitySignal reports that
+// the network is back, which cancels the backoff and wakes the worker immediately.
+// The link monitor coming up (ppp0 reconnected) counts as the network being back too.
 class BacklogWorker {
 public:
     BacklogWorker(std::shared_ptr<MessageStorage> storage,
                   std::shared_ptr<IBackend> backend,
                   std::chrono::milliseconds interval);
+    // Parallel drain: one session per backend (sessions hold per-backend tokens)
+    BacklogWorker(std::shared_ptr<MessageStorage> storage,
+                  std::vector<std::shared_ptr<IBackend>> backends,
+                  std::chrono::milliseconds interval);
     ~BacklogWorker();
 
     BacklogWorker(const BacklogWorker&) = delete;
@@ -34,18 +65,41 @@ public:
 
     bool ProcessOnce();
 
+    BacklogDrainStats GetDrainStats() const;
+
+    // Retry delay after 'attempts' consecutive network failures; jitter in [0, 1]
+    // picks the randomized half of the delay
+    static std::chrono::milliseconds BackoffDelay(int attempts, double jitter);
+
 private:
     void RunLoop();
-    bool ProcessMessage(const StoredMessage& message);
-    bool HandleFailure(const StoredMessage& message);
+    // How long to sleep when there was nothing to send
+    std::chrono::milliseconds IdleWait();
+    void OnConnectivityRestored();
+    // Returns false if the session stopped on a network error
+    bool ProcessSession(IBackend& backend, const std::string& uid, std::int64_t now,
+                        std::atomic<bool>& networkDown);
+    bool SendMessage(IBackend& backend, const StoredMessage& message);
+    bool HandleFailure(IBackend& backend, const StoredMessage& message);
 
     std::shared_ptr<MessageStorage> storage_;
-    std::shared_ptr<IBackend> backend_;
+    std::vector<std::shared_ptr<IBackend>> backends_;
     std::chrono::milliseconds interval_;
     std::atomic<bool> running_{false};
     std::thread workerThread_;
     mutable std::mutex mutex_;
     std::condition_variable cv_;
+    bool wakeRequested_ = false;  // Guarded by mutex_
+    int connectivityListener_ = 0;
+    int linkListener_ = 0;
+    std::mt19937 jitterRandom_{std::random_device{}()};  // Used by the draining thread only
+
+    mutable std::mutex statsMutex_;
+    BacklogDrainStats stats_;
+
+    static constexpr int kSessionMaxMessages = timing::kBacklogSessionMaxMessages;
+    static constexpr std::chrono::milliseconds kBackoffBase = timing::kBacklogBackoffBase;
+    static constexpr std::chrono::milliseconds kBackoffMax = timing::kBacklogBackoffMax;
 };
 
 } // namespace fuelflux
@@ -0,0 +1,52 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fuelflux {
+
+// Bloom filter over card UIDs
+// MightContain() == false is a definite miss; true may be a false positive.
+// Add() and MightContain() are lock-free and may run concurrently.
+// Hashes are FNV-1a based so that persisted filters stay valid across builds.
+class BloomFilter {
+public:
+    // Size the filter for expectedItems keys at the requested false-positive rate
+    BloomFilter(std::size_t expectedItems, double falsePositiveRate);
+
+    BloomFilter(const BloomFilter&) = delete;
+    BloomFilter& operator=(const BloomFilter&) = delete;
+
+    void Add(const std::string& key);
+    bool MightContain(const std::string& key) const;
+    // Raw key bytes; a string key hashes exactly like its bytes
+    void Add(const void* data, std::size_t size);
+    bool MightContain(const void* data, std::size_t size) const;
+
+    // False-positive rate predicted from the fraction of bits set
+    double EstimatedFalsePositiveRate() const;
+
+    std::size_t BitCount() const { return words_.size() * 64; }
+    std::size_t HashCount() const { return hashCount_; }
+
+    // Persist to / restore from a checksummed file tagged with the generation of the keys it covers;
+    // Load returns nullptr if the file is missing, corrupt or was written for another generation
+    bool Save(const std::string& path, std::uint64_t generation = 0) const;
+    static std::shared_ptr<BloomFilter> Load(const std::string& path, std::uint64_t generation = 0);
+
+private:
+    BloomFilter(std::size_t wordCount, std::size_t hashCount);
+
+    std::vector<std::atomic<std::uint64_t>> words_;
+    std::size_t hashCount_;
+};
+
+} // namespace fuelflux
@@ -13,6 +13,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <string>
+#include <vector>
 
 namespace fuelflux {
 
@@ -22,11 +24,16 @@ namespace fuelflux {
 // Session object that stores one JWT token. If the controller and cache_manager
 // shared the same backend, concurrent Authorize() calls would overwrite each other's
 // tokens, causing requests to fail or use incorrect authorization.
+//
+// Once a sync watermark is stored, each population first asks the backend for card
+// changes since the watermark and applies them in place to the active table. The full
+// flip/flop rebuild is used for the first sync and whenever the delta is unavailable
+// or larger than kDeltaMaxChanges.
 class CacheManager {
 public:
     // Constructor takes a dedicated backend for synchronization operations
     // and the user cache to populate
-    CacheManager(std::shared_ptr<UserCache> cache, std::shared_ptr<IBackend> backend);
+    CacheManager(std::shared_ptr<IUserCache> cache, std::shared_ptr<IBackend> backend);
     ~CacheManager();
 
     CacheManager(const CacheManager&) = delete;
@@ -56,9 +63,18 @@ public:
 private:
     void WorkerThread();
     bool PopulateCache();
+    // Rebuild the standby table from the full card listing and flip it in.
+    // Pages are fetched on the calling thread and inserted by a second thread,
+    // with at most kPipelineDepth fetched pages waiting to be written.
+    bool FullPopulation(const std::string& syncWatermark);
+    // Apply card changes since the stored watermark in place; false means fall back to FullPopulation
+    bool DeltaSync(const std::string& since, const std::string& syncWatermark);
+    bool FetchAllTanks(std::vector<FuelTank>& tanks);
+    // UTC ISO-8601 timestamp of the sync start, moved back by kDeltaWatermarkOverlap
+    std::string MakeSyncWatermark() const;
     std::chrono::system_clock::time_point CalculateNextDailyUpdate(int hour = 2) const;
     
-    std::shared_ptr<UserCache> cache_;
+    std::shared_ptr<IUserCache> cache_;
     std::shared_ptr<IBackend> backend_;
     
     std::thread workerThread_;
@@ -76,6 +92,9 @@ private:
     static constexpr int kDailyUpdateHour = timing::kCacheDailyUpdateHour;
     static constexpr int kRetryIntervalMinutes = timing::kCacheRetryIntervalMinutes;
     static constexpr int kFetchBatchSize = timing::kCacheFetchBatchSize;
+    static constexpr std::size_t kPipelineDepth = timing::kCachePipelineDepth;
+    static constexpr int kDeltaMaxChanges = timing::kCacheDeltaMaxChanges;
+    static constexpr auto kDeltaWatermarkOverlap = timing::kCacheDeltaWatermarkOverlap;
 };
 
 } // namespace fuelflux
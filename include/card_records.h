@@ -0,0 +1,38 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "types.h"
+
+// Card and tank records fetched from the backend to populate the user cache
+
+namespace fuelflux {
+
+// User card structure for cache population
+struct UserCard {
+    std::string uid;
+    int roleId = 0;
+    double allowance = 0.0;
+};
+
+// Changes to user cards since a sync watermark (delta synchronization)
+struct UserCardDelta {
+    std::vector<UserCard> upserts;          // Cards added or modified since the watermark
+    std::vector<std::string> deletedUids;   // Cards removed since the watermark
+    std::string watermark;                  // Server sync point to pass as 'since' next time (may be empty)
+    bool truncated = false;                 // Server had more changes than requested
+};
+
+// Fuel tank structure for cache population
+struct FuelTank {
+    int idTank = 0;
+    int visualNumberTank = 0;
+    std::string nameTank;
+    Volume volume = 0.0;
+};
+
+} // namespace fuelflux
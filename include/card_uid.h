@@ -0,0 +1,67 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace fuelflux {
+
+// ISO 14443A card UID (4, 7 or 10 bytes) stored inline, without heap allocation
+//
+// The card reader and the backend identify cards by the "reader string": every UID byte
+// as three decimal digits ("004161178090" for 04 A1 B2 5A). Parse() and ToString()
+// convert between the two forms losslessly, so any UserId that parses can be stored and
+// indexed as its binary bytes. Identifiers that do not parse (keypad input, test data)
+// simply stay strings.
+class CardUid {
+public:
+    static constexpr std::size_t kMaxSize = 10;
+
+    CardUid() = default;
+
+    // Returns nullopt unless size is 4, 7 or 10
+    static std::optional<CardUid> FromBytes(const std::uint8_t* data, std::size_t size);
+    // Parse the reader string; returns nullopt if uid is not a valid 4/7/10-byte UID in that form
+    static std::optional<CardUid> Parse(std::string_view uid);
+
+    const std::uint8_t* data() const { return bytes_.data(); }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Reader string (the form used as UserId and by the backend)
+    std::string ToString() const;
+    // Uppercase hex, e.g. "04A1B25A" (for logs)
+    std::string ToHex() const;
+
+    // FNV-1a over the UID bytes
+    std::size_t Hash() const;
+
+    bool operator==(const CardUid& other) const {
+        return size_ == other.size_ && bytes_ == other.bytes_;
+    }
+    bool operator!=(const CardUid& other) const { return !(*this == other); }
+    bool operator<(const CardUid& other) const;
+
+private:
+    std::array<std::uint8_t, kMaxSize> bytes_{};  // Unused tail bytes stay zero
+    std::uint8_t size_ = 0;
+};
+
+} // namespace fuelflux
+
+namespace std {
+    template<>
+    struct hash<fuelflux::CardUid> {
+        size_t operator()(const fuelflux::CardUid& uid) const {
+            return uid.Hash();
+        }
+    };
+}
@@ -7,10 +7,13 @@
 #ifdef USE_CARES
 
 #include <string>
+#include <atomic>
 #include <mutex>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <optional>
+#include <thread>
 #include "timing_config.h"
 
 namespace fuelflux {
@@ -33,6 +36,12 @@ void CleanupCaresLibrary();
 // Uses Yandex DNS servers for reliable resolution over PPP interface
 // Thread-safe: concurrent calls to Resolve() are serialized via internal mutex
 // NOTE: InitializeCaresLibrary() must be called successfully before using this class
+//
+// The address of the backend API hostname is cached for kBackendApiDnsCacheTtl and
+// refreshed on a background thread once less than kBackendApiDnsRefreshAhead is left.
+// An expired address keeps being served (with a warning) while refreshes fail, for up
+// to kBackendApiDnsMaxStale. With a cache file the address survives restarts, so a
+// cold start does not wait for DNS either.
 class CaresResolver {
 public:
     using Clock = std::chrono::steady_clock;
@@ -40,9 +49,14 @@ public:
     using TimeProvider = std::function<TimePoint()>;
 
     CaresResolver();
-    explicit CaresResolver(const std::string& cachedHostname, TimeProvider timeProvider = Clock::now);
+    // cachePath - file the backend API address is persisted to (empty: not persisted)
+    explicit CaresResolver(const std::string& cachedHostname, TimeProvider timeProvider = Clock::now,
+                           std::string cachePath = "");
     ~CaresResolver();
 
+    CaresResolver(const CaresResolver&) = delete;
+    CaresResolver& operator=(const CaresResolver&) = delete;
+
     // Resolve hostname to IP address using Yandex DNS
     // Returns empty string on failure
     // Parameters:
@@ -52,9 +66,17 @@ public:
     // Thread-safe: multiple threads can call this method concurrently
     std::string Resolve(const std::string& hostname, const std::string& interface = "");
 
+    // Never waits for DNS: returns an IP literal as is, or the cached backend API address
+    // (even a stale one, within kBackendApiDnsMaxStale). Otherwise nullopt, after starting
+    // a background refresh of the backend API address, so that a later call hits the cache.
+    // For threads that must not block; the caller leaves a miss to libcurl's resolver.
+    std::optional<std::string> ResolveCached(const std::string& hostname, const std::string& interface = "");
+
     // Test helpers for validating targeted cache behavior
     bool HasValidTargetedCacheForTesting() const;
     std::string GetTargetedCachedIpForTesting() const;
+    // Wait until a running background refresh finished
+    void WaitForRefreshForTesting();
 
 private:
     struct CacheEntry {
@@ -65,15 +87,39 @@ private:
     bool IsBackendApiHostname(const std::string& hostname) const;
     bool HasValidBackendCacheEntry() const;
 
+    // c-ares lookup without the cache; empty string on failure.
+    // Gives up early once 'cancel' is set.
+    static std::string Lookup(const std::string& hostname, const std::string& interface,
+                              const std::atomic<bool>& cancel);
+
+    // Store a resolved backend API address (and persist it). Requires resolve_mutex_.
+    void UpdateBackendCacheEntry(const std::string& ip);
+    // Start a background refresh of the backend API address unless one is running or a
+    // failed one was too recent. Requires resolve_mutex_.
+    void StartRefresh(const std::string& interface);
+    void RefreshThread(std::string interface);
+
+    void LoadCacheFile();
+    void SaveCacheFile(const std::string& ip) const;
+
     static constexpr auto kBackendApiCacheTtl = timing::kBackendApiDnsCacheTtl;
 
     std::string cached_hostname_;
     TimeProvider time_provider_;
+    std::string cache_path_;
     std::optional<CacheEntry> backend_api_cache_entry_;
 
     // Mutex for thread-safe DNS resolution
-    // Protects concurrent channel operations
+    // Protects concurrent channel operations and the fields below
     mutable std::mutex resolve_mutex_;
+    std::condition_variable refresh_done_;
+    std::thread refresh_thread_;
+    bool refreshing_ = false;
+    std::optional<TimePoint> next_refresh_attempt_;
+    std::atomic<bool> stopping_{false};
+    // Set by the link monitor when ppp0 comes up: the next refresh skips the retry delay
+    std::atomic<bool> link_restored_{false};
+    int link_listener_ = 0;
 };
 
 } // namespace fuelflux
@@ -0,0 +1,58 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+namespace fuelflux {
+
+// Circuit breaker of a backend: after failureThreshold consecutive network errors it opens
+// and requests fail at once instead of waiting for their timeouts. Once probeInterval has
+// passed, the owner runs a probe (TryStartProbe/ProbeFinished); a probe that reaches the
+// backend makes the breaker half-open and lets a single trial request through; the others
+// are rejected until it finishes. A success closes the breaker, a failure opens it again.
+// Thread-safe.
+class CircuitBreaker {
+public:
+    enum class State { Closed, Open, HalfOpen };
+    using Clock = std::chrono::steady_clock;
+    using TimeProvider = std::function<Clock::time_point()>;
+
+    CircuitBreaker(int failureThreshold, Clock::duration probeInterval, TimeProvider now = Clock::now);
+
+    // Admit a request: always while closed, the one trial request while half-open, none
+    // while open. Every admitted request is reported with RecordResult() or Cancel().
+    bool Allow();
+    // An admitted request that was not sent after all; frees the half-open trial
+    void Cancel();
+
+    // True if the breaker is open, the probe interval has passed and no probe is running;
+    // the caller must then probe and report the outcome with ProbeFinished()
+    bool TryStartProbe();
+    void ProbeFinished(bool reachable);
+
+    // Outcome of a request that was sent; only network errors count as failures
+    void RecordResult(bool success);
+
+    State GetState() const;
+
+private:
+    void Open(const char* reason);
+
+    const int failureThreshold_;
+    const Clock::duration probeInterval_;
+    const TimeProvider now_;
+
+    mutable std::mutex mutex_;
+    State state_ = State::Closed;
+    int failures_ = 0;              // Consecutive network errors while closed
+    Clock::time_point nextProbe_{};
+    bool probing_ = false;
+    bool trialInFlight_ = false;    // Half-open: the trial request was admitted
+};
+
+} // namespace fuelflux
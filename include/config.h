@@ -17,9 +17,15 @@ constexpr std::size_t INPUT_MAX_LENGTH = 1024;
 #ifdef FUELFLUX_UNIX_FOLDER_CONVENTION
 const std::string STORAGE_DB_PATH = "/var/fuelflux/db/fuelflux_storage.db";
 const std::string CACHE_DB_PATH = "/var/fuelflux/db/fuelflux_cache.db";
+const std::string CACHE_SNAPSHOT_PATH = "/var/fuelflux/db/fuelflux_cache.snap";
+const std::string TLS_SESSION_PATH = "/var/fuelflux/db/fuelflux_tls_sessions.bin";
+const std::string DNS_CACHE_PATH = "/var/fuelflux/db/fuelflux_dns_cache.txt";
 const std::string LOG_DIR = "/var/fuelflux/logs";
 #else
 const std::string STORAGE_DB_PATH = "fuelflux/db/fuelflux_storage.db";
 const std::string CACHE_DB_PATH = "fuelflux/db/fuelflux_cache.db";
+const std::string CACHE_SNAPSHOT_PATH = "fuelflux/db/fuelflux_cache.snap";
+const std::string TLS_SESSION_PATH = "fuelflux/db/fuelflux_tls_sessions.bin";
+const std::string DNS_CACHE_PATH = "fuelflux/db/fuelflux_dns_cache.txt";
 const std::string LOG_DIR = "fuelflux/logs";
 #endif
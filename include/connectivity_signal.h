@@ -0,0 +1,43 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace fuelflux {
+
+// Process-wide network reachability signal
+// Backends report the outcome of every request. When a request succeeds after a
+// network error, every subscriber is called on the reporting thread. Listeners run
+// with the subscriber list locked: they must be quick and must not (un)subscribe.
+// Unsubscribe() therefore also guarantees the listener is not running any more.
+class ConnectivitySignal {
+public:
+    using Listener = std::function<void()>;
+
+    static ConnectivitySignal& Instance();
+
+    // Returns an id for Unsubscribe()
+    int Subscribe(Listener listener);
+    void Unsubscribe(int id);
+
+    void ReportSuccess();
+    void ReportNetworkError();
+
+    bool IsDown() const { return down_.load(); }
+
+private:
+    ConnectivitySignal() = default;
+
+    std::mutex mutex_;
+    std::map<int, Listener> listeners_;
+    int nextId_ = 1;
+    std::atomic<bool> down_{false};
+};
+
+} // namespace fuelflux
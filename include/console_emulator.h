@@ -22,7 +22,7 @@ namespace fuelflux {
 
 // Forward declarations
 class CacheManager;
-class UserCache;
+class IUserCache;
 
 // Forward declaration - ConsoleDisplay is now defined in display/console_display.h
 namespace display {
@@ -130,7 +130,7 @@ public:
     
     // Set cache manager and user cache for cache commands
     void setCacheManager(std::shared_ptr<CacheManager> cacheManager);
-    void setUserCache(std::shared_ptr<UserCache> userCache);
+    void setUserCache(std::shared_ptr<IUserCache> userCache);
     void setFlowMeterSimulationHandler(std::function<bool(bool)> handler);
 
     // Dispatcher helper: forward a raw character to the keyboard (if available)
@@ -156,7 +156,7 @@ private:
     
     // Cache manager for cache commands
     std::shared_ptr<CacheManager> cacheManager_;
-    std::shared_ptr<UserCache> userCache_;
+    std::shared_ptr<IUserCache> userCache_;
     std::function<bool(bool)> flowMeterSimulationHandler_;
 
     // command assembly in command mode
@@ -7,8 +7,11 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
 #include <thread>
@@ -19,20 +22,22 @@
 #include "state_machine.h"
 #include "timing_config.h"
 #include "types.h"
+#include "user_cache.h"
 #include "peripherals/peripheral_interface.h"
 
 namespace fuelflux {
 
 // Forward declarations
 class CacheManager;
-class UserCache;
 
 // Main controller class that orchestrates the entire system
 class Controller {
   public:
     Controller(ControllerId controllerId,
                std::shared_ptr<IBackend> backend = nullptr,
-               std::chrono::seconds noFlowCancelTimeout = timing::kNoFlowCancelTimeout);
+               std::chrono::seconds noFlowCancelTimeout = timing::kNoFlowCancelTimeout,
+               std::chrono::milliseconds authHedgeDelay = timing::kAuthHedgeDelay,
+               UserCacheEngine cacheEngine = UserCacheEngine::Sqlite);
     ~Controller();
 
     // System lifecycle
@@ -70,6 +75,9 @@ class Controller {
     void setCardReader(std::unique_ptr<peripherals::ICardReader> cardReader);
     void setPump(std::unique_ptr<peripherals::IPump> pump);
     void setFlowMeter(std::unique_ptr<peripherals::IFlowMeter> flowMeter);
+    // Creates the backend that takes over when a hedged authorization is abandoned
+    using BackendFactory = std::function<std::shared_ptr<IBackend>()>;
+    void setBackendFactory(BackendFactory factory);
     // Allow external threads to post events to the controller's event loop
     void postEvent(Event event);
 
@@ -87,13 +95,16 @@ class Controller {
     TankNumber getSelectedTank() const { return selectedTank_; }
     Volume getEnteredVolume() const { return enteredVolume_; }
     const std::string& getCurrentInput() const { return currentInput_; }
+    // Parsed UID of the card that filled the current input, if any
+    const std::optional<CardUid>& getPresentedCard() const { return presentedCard_; }
     IntakeDirection getSelectedIntakeDirection() const { return selectedIntakeDirection_; }
     Volume getCurrentRefuelVolume() const { return currentRefuelVolume_; }
     const std::string& getLastErrorMessage() const { return lastErrorMessage_; }
 
     // Input handling
     void handleKeyPress(KeyCode key);
-    void handleCardPresented(const UserId& userId);
+    // cardUid is set when userId came from the card reader as a parsed card UID
+    void handleCardPresented(const UserId& userId, const std::optional<CardUid>& cardUid = std::nullopt);
     void handlePumpStateChanged(bool isRunning);
     void handleFlowUpdate(Volume currentVolume);
 
@@ -115,8 +126,10 @@ class Controller {
     void removeLastDigit();
     void setMaxValue();
 
-    // Authorization
-    void requestAuthorization(const UserId& userId);
+    // Authorization. With a hedge delay, a customer found in the user cache is let through
+    // on the cached decision once the backend has not answered within it; the backend
+    // answer is applied to the session when it arrives (see reconcilePendingAuthorization).
+    void requestAuthorization(const UserId& userId, const std::optional<CardUid>& cardUid = std::nullopt);
 
     // Tank operations
     void selectTank(TankNumber tankNumber);
@@ -146,8 +159,10 @@ class Controller {
     
     // Cache management
     std::shared_ptr<CacheManager> getCacheManager() const { return cacheManager_; }
-    std::shared_ptr<UserCache> getUserCache() const { return userCache_; }
+    std::shared_ptr<IUserCache> getUserCache() const { return userCache_; }
     bool isSessionAuthorizedFromCache() const { return sessionAuthorizedFromCache_; }
+    // The current session was started from the cache and the backend has not answered yet
+    bool isAuthorizationPending() const { return sessionAwaitsBackend_; }
 
     // Utility functions
     std::string formatVolume(Volume volume) const;
@@ -174,7 +189,7 @@ class Controller {
     std::shared_ptr<MessageStorage> messageStorage_;
     
     // Cache components
-    std::shared_ptr<UserCache> userCache_;
+    std::shared_ptr<IUserCache> userCache_;
     std::shared_ptr<CacheManager> cacheManager_;
     
     // Current session state
@@ -184,6 +199,7 @@ class Controller {
     TankNumber selectedTank_;
     Volume enteredVolume_;
     std::string currentInput_;
+    std::optional<CardUid> presentedCard_;
     IntakeDirection selectedIntakeDirection_;
     
     // Refueling state
@@ -197,6 +213,24 @@ class Controller {
     std::string lastErrorMessage_;
     bool sessionAuthorizedFromCache_ = false;
 
+    // Hedged authorization: backend answer for a session started from the cache. The
+    // session may end before it arrives; sessionAwaitsBackend_ tells whether it is still on.
+    // While the answer is in flight backend_ belongs to it and is left alone.
+    std::chrono::milliseconds authHedgeDelay_;
+    std::future<bool> pendingAuthorization_;
+    UserId pendingAuthorizationUser_;
+    bool sessionAwaitsBackend_ = false;
+
+    // Hedged requests still in flight when the next user came: each keeps the backend it
+    // was sent on and is closed there when it lands
+    struct AbandonedAuthorization {
+        std::future<bool> authorized;
+        std::shared_ptr<IBackend> backend;
+        UserId userId;
+    };
+    std::vector<AbandonedAuthorization> abandonedAuthorizations_;
+    BackendFactory backendFactory_;
+
     // Event queue for cross-thread event posting
     std::queue<Event> eventQueue_;
     std::mutex eventQueueMutex_;
@@ -221,6 +255,19 @@ class Controller {
     Volume parseVolumeFromInput() const;
     TankNumber parseTankFromInput() const;
     void resetSessionData();
+    void finishAuthorization(const UserId& userId, const std::optional<CardUid>& cardUid, bool authorized);
+    // Binary-keyed cache lookup for presented cards, string lookup for keypad input
+    std::optional<UserCacheEntry> lookupCachedEntry(const UserId& userId, const std::optional<CardUid>& cardUid) const;
+    void applyBackendAuthorization(const UserId& userId);
+    void applyCachedAuthorization(const UserCacheEntry& entry);
+    // Apply the backend answer of a hedged authorization once it is there
+    void reconcilePendingAuthorization();
+    // Hand a hedged request still in flight over to abandonedAuthorizations_
+    void abandonPendingAuthorization();
+    void reapAbandonedAuthorizations();
+    void cancelHedgedSession();
+    // Deauthorize the backend session of a session authorized online
+    void closeBackendSession(bool sessionFromCache);
     void selectIntakeDirection(IntakeDirection direction);
     /**
      * Initializes all configured peripherals (display, keyboard, card reader, pump, flow meter, backend).
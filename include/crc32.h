@@ -0,0 +1,16 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fuelflux {
+
+// CRC-32 (IEEE 802.3, as used by zlib). Pass the previous result as 'crc'
+// to checksum data that arrives in several chunks.
+std::uint32_t Crc32(const void* data, std::size_t size, std::uint32_t crc = 0);
+
+} // namespace fuelflux
@@ -0,0 +1,75 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fuelflux {
+
+// Runs libcurl transfers on a single I/O thread through one curl_multi handle.
+// Transfers submitted by different threads overlap on that thread and share its
+// connection pool, so requests to the same server are multiplexed over one HTTP/2
+// connection (or reuse a keep-alive one) instead of blocking a thread each.
+//
+// Completion callbacks run on the I/O thread: they must be quick and must not wait
+// for other transfers. Perform() called from a callback runs the transfer inline.
+class HttpEngine {
+public:
+    using Completion = std::function<void(CURLcode result)>;
+
+    HttpEngine();
+    ~HttpEngine();
+
+    HttpEngine(const HttpEngine&) = delete;
+    HttpEngine& operator=(const HttpEngine&) = delete;
+
+    // Start the transfer of a configured easy handle; 'done' runs on the I/O thread when it
+    // finished. The handle and everything its options point to must stay valid until then.
+    // Returns false (and does not call 'done') after Shutdown().
+    bool Submit(CURL* easy, Completion done);
+
+    // Submit and wait for the result. Runs curl_easy_perform() on the calling thread when
+    // called from the I/O thread or after Shutdown().
+    CURLcode Perform(CURL* easy);
+
+    // Close the pooled connections (e.g. the network link changed) as soon as no transfer
+    // is running; transfers started meanwhile may still reuse them
+    void ResetConnections();
+
+    std::size_t ActiveTransfers() const { return active_.load(); }
+    bool IsIoThread() const { return std::this_thread::get_id() == ioThread_.get_id(); }
+
+    // Stop the I/O thread; unfinished transfers complete with CURLE_ABORTED_BY_CALLBACK
+    void Shutdown();
+
+    // Engine shared by every backend of the process
+    static HttpEngine& Shared();
+
+private:
+    void IoThread();
+    // Must be called with mutex_ held
+    void CreateMultiUnlocked();
+
+    CURLM* multi_ = nullptr;
+    std::thread ioThread_;
+    mutable std::mutex mutex_;
+    // Guarded by mutex_: transfers waiting to be added to multi_ by the I/O thread
+    std::vector<std::pair<CURL*, Completion>> pending_;
+    bool resetConnections_ = false;
+    bool shutdown_ = false;
+    // Owned by the I/O thread
+    std::map<CURL*, Completion> running_;
+    std::atomic<std::size_t> active_{0};
+};
+
+} // namespace fuelflux
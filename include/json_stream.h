@@ -0,0 +1,129 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace fuelflux {
+
+// Push parser for JSON that arrives in chunks (curl write callbacks).
+// Bytes are fed as they are received and turned into SAX events right away, so a
+// value may be split anywhere, even inside a string or a number. Keys and string
+// values are reported whole; numbers follow nlohmann's typing (non-negative integers
+// are unsigned, integers out of range are floats).
+class JsonStreamParser {
+public:
+    // Deeper documents are rejected; bounds the container stack
+    static constexpr std::size_t kMaxDepth = 64;
+
+    explicit JsonStreamParser(nlohmann::json::json_sax_t& handler);
+
+    // Parse the next chunk; false on a syntax error or when the handler returned false
+    // (all later calls fail as well)
+    bool Feed(const char* data, std::size_t size);
+
+    // End of input; true if exactly one complete value was parsed
+    bool Finish();
+
+    bool Failed() const { return failed_; }
+    // Description of the failure (empty if none)
+    const std::string& Error() const { return error_; }
+    // Number of bytes consumed so far
+    std::size_t Position() const { return position_; }
+
+private:
+    // What the grammar accepts next (outside of a token)
+    enum class Expect {
+        Value,          // after ':' or ',' in an array, or at the start
+        ValueOrEnd,     // right after '['
+        Key,            // after ',' in an object
+        KeyOrEnd,       // right after '{'
+        Colon,          // after a key
+        CommaOrEnd,     // after a value inside a container
+        Done            // a complete top-level value was parsed
+    };
+
+    // Token being scanned across chunk boundaries
+    enum class Token { None, String, Number, Literal };
+
+    bool Consume(char c);
+    bool ConsumeString(char c);
+    bool StartValue(char c);
+    bool FinishString();
+    bool FinishNumber();
+    bool FinishLiteral();
+    bool ValueDone();
+    void AppendCodePoint(std::uint32_t codePoint);
+    bool Fail(const std::string& message);
+
+    nlohmann::json::json_sax_t& handler_;
+    std::vector<char> containers_;  // '{' or '[' per open container
+    Expect expect_ = Expect::Value;
+    Token token_ = Token::None;
+    bool tokenIsKey_ = false;
+    std::string text_;              // string contents / number characters
+    const char* literal_ = nullptr; // "true", "false" or "null" while scanning one
+    std::size_t literalPos_ = 0;
+    int escape_ = 0;                // 0: none, 1: after '\', 2..5: hex digits of \uXXXX
+    std::uint32_t unicode_ = 0;
+    std::uint32_t highSurrogate_ = 0;
+    std::size_t position_ = 0;
+    bool failed_ = false;
+    std::string error_;
+};
+
+// SAX handler for responses that are an array of records (card and tank listings).
+// Each array item is built on its own and handed to the callback, so only one record
+// is held in memory whatever the page size. Any other response (an error object,
+// null) is kept whole. Result() returns the response with a streamed array left empty.
+class JsonRecordReader : public nlohmann::json::json_sax_t {
+public:
+    // Receives each item of the top-level array; false stops parsing
+    using RecordCallback = std::function<bool(const nlohmann::json& record)>;
+
+    explicit JsonRecordReader(RecordCallback onRecord);
+
+    nlohmann::json Result() const { return root_; }
+    std::size_t RecordCount() const { return records_; }
+    // The callback returned false
+    bool Stopped() const { return stopped_; }
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool string(string_t& val) override;
+    bool binary(binary_t& val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& last_token,
+                     const nlohmann::detail::exception& ex) override;
+
+private:
+    // Store a value at the current position of the record (or response) being built
+    nlohmann::json* Put(nlohmann::json value);
+    // Called after a value or a container was completed
+    bool Completed();
+
+    RecordCallback onRecord_;
+    nlohmann::json root_;               // the response, or an empty array when streamed
+    nlohmann::json record_;             // array item being built
+    std::vector<nlohmann::json*> open_; // open containers of root_ or record_
+    std::string key_;
+    bool streaming_ = false;            // the top-level array is open
+    bool stopped_ = false;
+    std::size_t records_ = 0;
+};
+
+} // namespace fuelflux
@@ -0,0 +1,46 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace fuelflux {
+
+// Lock-free latency histogram with power-of-two microsecond buckets
+// Bucket 0 counts samples below 1 us, bucket i samples in [2^(i-1), 2^i) us;
+// the last bucket also takes everything slower.
+class LatencyHistogram {
+public:
+    static constexpr std::size_t kBucketCount = 26;  // Up to ~16.8 s
+
+    struct Snapshot {
+        std::array<std::uint64_t, kBucketCount> buckets{};
+        std::uint64_t count = 0;
+        std::chrono::microseconds total{0};
+        std::chrono::microseconds max{0};
+
+        // Upper bound of the bucket holding the q-quantile (0 <= q <= 1); zero if empty
+        std::chrono::microseconds Percentile(double q) const;
+        std::chrono::microseconds Mean() const;
+    };
+
+    // Exclusive upper bound of bucket i
+    static std::chrono::microseconds BucketUpperBound(std::size_t bucket);
+
+    void Record(std::chrono::microseconds latency);
+    Snapshot GetSnapshot() const;
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::int64_t> totalMicros_{0};
+    std::atomic<std::int64_t> maxMicros_{0};
+};
+
+} // namespace fuelflux
@@ -0,0 +1,96 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace fuelflux {
+
+// Interface of the SIM800C GPRS link brought up by pppd
+constexpr const char kPppInterface[] = "ppp0";
+
+// State of one network interface, kept current from rtnetlink link and address events
+// (Linux only) instead of walking getifaddrs() on every request.
+//
+// The interface is Up when it exists, is administratively up and has an IPv4 address;
+// pppd assigns a new address on every reconnect, so each reconnect is a transition too.
+// Absent means it was never seen since Start(), which callers treat like "no monitor"
+// (e.g. a development build with no modem). Once seen, losing it makes it Down.
+//
+// Listeners are called on the watcher thread with the listener list locked: they must be
+// quick and must not (un)subscribe. Unsubscribe() guarantees the listener is not running.
+class LinkMonitor {
+public:
+    enum class State { Absent, Down, Up };
+    using Listener = std::function<void(State state, const std::string& address)>;
+
+    explicit LinkMonitor(std::string interface);
+    ~LinkMonitor();
+
+    LinkMonitor(const LinkMonitor&) = delete;
+    LinkMonitor& operator=(const LinkMonitor&) = delete;
+
+    // Monitor of kPppInterface shared by the backends, the resolver and the backlog worker
+    static LinkMonitor& Instance();
+
+    // Read the current state and start watching; false if rtnetlink is not available
+    // (the state then stays Absent and IsRunning() false)
+    bool Start();
+    void Stop();
+    bool IsRunning() const { return running_.load(std::memory_order_acquire); }
+
+    State GetState() const { return state_.load(std::memory_order_acquire); }
+    bool IsUp() const { return GetState() == State::Up; }
+    // IPv4 address of the interface, empty unless Up
+    std::string Address() const;
+    // Incremented on every transition (including a new address)
+    std::uint64_t Generation() const { return generation_.load(std::memory_order_acquire); }
+
+    int Subscribe(Listener listener);
+    void Unsubscribe(int id);
+
+    // Apply a buffer of rtnetlink messages (RTM_NEWLINK/DELLINK/NEWADDR/DELADDR) as read
+    // from the socket; used by the watcher thread and by tests
+    void ProcessMessages(const void* data, std::size_t size);
+
+private:
+    void WatchLoop();
+    // Re-read the interface with getifaddrs (at start and after a socket overrun)
+    void Resync();
+    // Recompute the state from the fields below and announce a transition.
+    // Requires mutex_; releases it before calling the listeners.
+    void Publish(std::unique_lock<std::mutex>& lock);
+
+    const std::string interface_;
+
+    mutable std::mutex mutex_;
+    int index_ = 0;             // ifindex of the interface, 0 if unknown
+    bool present_ = false;
+    bool seen_ = false;
+    bool adminUp_ = false;
+    std::string address_;
+    std::string publishedAddress_;  // address_ as of the last transition
+
+    std::atomic<State> state_{State::Absent};
+    std::atomic<std::uint64_t> generation_{0};
+
+    std::mutex listenersMutex_;
+    std::map<int, Listener> listeners_;
+    int nextId_ = 1;
+
+    std::atomic<bool> running_{false};
+    int socket_ = -1;
+    int wakePipe_[2] = {-1, -1};
+    std::thread thread_;
+};
+
+} // namespace fuelflux
@@ -4,15 +4,28 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <mutex>
 #include <string>
 #include <vector>
 
+#include "latency_histogram.h"
+#include "sqlite_statement_cache.h"
+#include "sqlite_utils.h"
+
 struct sqlite3;
 
 namespace fuelflux {
 
+class SegmentBacklog;
+
 enum class MessageMethod {
     Refuel,
     Intake
@@ -25,33 +38,110 @@ struct StoredMessage {
     std::string data;
 };
 
+// Where the backlog queue lives; dead messages always stay in SQLite
+enum class BacklogEngine {
+    Sqlite,     // 'backlog' table in the message database
+    SegmentLog  // Append-only CRC-framed segment files in <dbPath>.backlog/
+};
+
+// Persistent backlog of reports that could not be delivered
+// AddBacklog uses group commit: inserts from concurrent callers are collected into one
+// transaction by whichever caller finds no commit running, and every caller returns once
+// the transaction holding its entry is durable.
+// With BacklogEngine::SegmentLog the same interface is served by a SegmentBacklog: a
+// group commit becomes one sequential append and GetNextBacklog a pointer read. Its fsync
+// policy follows durability.synchronous (Full: every commit, Normal: periodic, Off: never).
 class MessageStorage {
 public:
-    explicit MessageStorage(const std::string& dbPath);
+    // Backlog entries must survive power loss: WAL turns each commit into one sequential
+    // append + fsync, and synchronous=FULL keeps that fsync before AddBacklog returns
+    static constexpr SqliteDurability kDefaultDurability{SqliteJournalMode::Wal, SqliteSynchronous::Full};
+
+    // Throws std::runtime_error if the database (or the segment log) cannot be opened;
+    // the segment log engine needs an on-disk dbPath
+    explicit MessageStorage(const std::string& dbPath, const SqliteDurability& durability = kDefaultDurability,
+                            BacklogEngine engine = BacklogEngine::Sqlite);
     ~MessageStorage();
 
     MessageStorage(const MessageStorage&) = delete;
     MessageStorage& operator=(const MessageStorage&) = delete;
 
     bool IsOpen() const;
+    BacklogEngine GetBacklogEngine() const;
 
     bool AddBacklog(const std::string& uid, MessageMethod method, const std::string& data);
     bool AddDeadMessage(const std::string& uid, MessageMethod method, const std::string& data);
 
     std::optional<StoredMessage> GetNextBacklog();
+    // Retry scheduling: each backlog message has an attempt counter and a next_attempt_at
+    // time in milliseconds since the Unix epoch (0 = due immediately). The 'dueAt' filters
+    // below skip messages scheduled later than dueAt; the default returns everything.
+    static constexpr std::int64_t kAllMessages = std::numeric_limits<std::int64_t>::max();
+
+    // Users whose oldest backlog message is due, ordered by that message
+    std::vector<std::string> GetBacklogUids(int limit, std::int64_t dueAt = kAllMessages);
+    // Oldest backlog messages of one user, in insertion order, up to the first one not yet due
+    std::vector<StoredMessage> GetBacklogForUid(const std::string& uid, int limit,
+                                                std::int64_t dueAt = kAllMessages);
+    // Reschedule every message due at 'now': attempts is incremented and next_attempt_at
+    // becomes now + delay(attempts)
+    bool DeferBacklog(std::int64_t now, const std::function<std::chrono::milliseconds(int attempts)>& delay);
+    // Make every message due immediately and reset the attempt counters
+    bool ResetBacklogBackoff();
+    // Earliest next_attempt_at over the backlog; nullopt if the backlog is empty
+    std::optional<std::int64_t> GetNextBacklogAttemptAt() const;
     bool RemoveBacklog(long long id);
 
     int BacklogCount() const;
     int DeadMessageCount() const;
 
+    // Time from the AddBacklog call until its entry was committed
+    LatencyHistogram::Snapshot GetBacklogEnqueueLatency() const;
+    // Transactions used for AddBacklog inserts (lower than the call count when batched)
+    std::uint64_t GetBacklogCommitCount() const;
+
 private:
+    struct PendingBacklog {
+        std::string uid;
+        MessageMethod method = MessageMethod::Refuel;
+        std::string data;
+        bool done = false;
+        bool ok = false;
+    };
+
     bool Execute(const std::string& sql) const;
+    // Switching engines keeps undelivered reports: on open the backlog left in the other
+    // engine's store is moved into the active one (a crash midway may duplicate a batch)
+    void MoveSqliteBacklogToSegments();
+    void MoveSegmentBacklogToSqlite();
+    // Read a (rowid, uid, method, data) row; nullopt if the method is missing or unknown
+    std::optional<StoredMessage> ReadMessage(sqlite3_stmt* stmt) const;
+    // Must be called with dbMutex_ held
+    bool ExecuteUnlocked(const std::string& sql) const;
+    // Insert the batch in a single transaction; takes dbMutex_
+    bool CommitBacklogBatch(const std::vector<std::shared_ptr<PendingBacklog>>& batch);
     std::string MethodToString(MessageMethod method) const;
     std::optional<MessageMethod> MethodFromString(const std::string& value) const;
 
     sqlite3* db_;
     std::string dbPath_;
+    // Set when the backlog uses the segment log engine
+    std::unique_ptr<SegmentBacklog> segmentBacklog_;
     mutable std::mutex dbMutex_;
+    // Prepared statements, guarded by dbMutex_
+    mutable SqliteStatementCache statements_;
+
+    // Group commit queue; a caller that sets commitInProgress_ commits for everyone queued
+    std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    std::deque<std::shared_ptr<PendingBacklog>> pendingBacklog_;
+    bool commitInProgress_ = false;
+
+    LatencyHistogram backlogLatency_;
+    std::atomic<std::uint64_t> backlogCommits_{0};
+
+    // Upper bound on inserts per group commit transaction
+    static constexpr std::size_t kMaxGroupCommitBatch = 64;
 };
 
 } // namespace fuelflux
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include "../card_uid.h"
 #include "../types.h"
 #include <functional>
+#include <optional>
 
 namespace fuelflux::peripherals {
 
@@ -38,7 +40,9 @@ public:
 // Card reader interface
 class ICardReader : public IPeripheral {
 public:
-    using CardPresentedCallback = std::function<void(const UserId&)>;
+    // cardUid carries the parsed UID bytes when userId is a card UID, so that consumers
+    // need not parse the reader string again
+    using CardPresentedCallback = std::function<void(const UserId& userId, const std::optional<CardUid>& cardUid)>;
     
     virtual void setCardPresentedCallback(CardPresentedCallback callback) = 0;
     virtual void enableReading(bool enabled) = 0;
@@ -0,0 +1,84 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "message_storage.h"
+#include "segment_log.h"
+
+namespace fuelflux {
+
+// Backlog queue on an append-only SegmentLog (MessageStorage with BacklogEngine::SegmentLog)
+//
+// The log holds two record types: an appended message and the acknowledgement of its id.
+// Only the message metadata (uid, retry schedule, log position) is kept in memory; the
+// payload is read back from the log when the message is fetched. A segment is removed
+// once every message in it and in all older segments has been acknowledged.
+// Retry scheduling is not journaled: after a restart every message is due immediately.
+// With SegmentFsync::Periodic a background thread flushes the log every fsyncInterval, so
+// the last appends before an idle period are synced without waiting for the next Append.
+class SegmentBacklog {
+public:
+    // Throws std::runtime_error if the log cannot be opened
+    explicit SegmentBacklog(const std::string& directory, SegmentLogOptions options = {});
+    ~SegmentBacklog();
+
+    SegmentBacklog(const SegmentBacklog&) = delete;
+    SegmentBacklog& operator=(const SegmentBacklog&) = delete;
+
+    // Append the messages (their ids are ignored) as one write
+    bool Append(const std::vector<StoredMessage>& messages);
+
+    // Same semantics as the MessageStorage backlog methods
+    std::optional<StoredMessage> GetNext();
+    std::vector<std::string> GetUids(int limit, std::int64_t dueAt);
+    std::vector<StoredMessage> GetForUid(const std::string& uid, int limit, std::int64_t dueAt);
+    bool Defer(std::int64_t now, const std::function<std::chrono::milliseconds(int attempts)>& delay);
+    bool ResetBackoff();
+    std::optional<std::int64_t> GetNextAttemptAt() const;
+    bool Remove(long long id);
+    int Count() const;
+
+    std::size_t SegmentCount() const;
+
+private:
+    struct IndexEntry {
+        std::string uid;
+        SegmentLog::Position position;
+        int attempts = 0;
+        std::int64_t nextAttemptAt = 0;
+    };
+
+    // Must be called with mutex_ held
+    std::optional<StoredMessage> ReadUnlocked(long long id, const IndexEntry& entry) const;
+    void Replay();
+    // Remove the segments that precede the oldest unacknowledged message
+    void Recycle();
+    void FlushLoop(std::chrono::milliseconds interval);
+
+    mutable std::mutex mutex_;
+    SegmentLog log_;
+    std::map<long long, IndexEntry> index_;
+    // Unacknowledged messages per segment
+    std::map<std::uint64_t, std::size_t> liveMessages_;
+    long long nextId_ = 1;
+
+    // Periodic fsync timer; stopping_ is guarded by mutex_
+    std::condition_variable flushCv_;
+    bool stopping_ = false;
+    std::thread flusher_;
+};
+
+} // namespace fuelflux
@@ -0,0 +1,102 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "timing_config.h"
+
+namespace fuelflux {
+
+// When appended records are forced to the storage device
+enum class SegmentFsync {
+    EveryCommit,  // fdatasync before Append() returns
+    Periodic,     // fdatasync at most once per fsyncInterval, and by Flush() once appends stop;
+                  // a crash may lose the last interval
+    Never         // Leave it to the OS
+};
+
+struct SegmentLogOptions {
+    // A new segment is started once the active one reaches this size
+    std::size_t maxSegmentBytes = 4 * 1024 * 1024;
+    SegmentFsync fsync = SegmentFsync::EveryCommit;
+    std::chrono::milliseconds fsyncInterval = timing::kSegmentLogFsyncInterval;
+};
+
+// Append-only log of opaque records kept in numbered segment files
+//
+// Every record is framed as [length][CRC-32 of length and payload][payload]. On open the
+// segments are scanned and the active (last) one is truncated after its last intact frame,
+// which discards a torn write left by power loss. Whole segments are removed with
+// ReleaseBefore() once the consumer no longer needs any record in them.
+// Not thread-safe: callers serialize access.
+class SegmentLog {
+public:
+    struct Position {
+        std::uint64_t segment = 0;
+        std::uint64_t offset = 0;
+    };
+    using RecordVisitor = std::function<void(const Position& position, const std::string& record)>;
+
+    // Opens the log in 'directory' (created if missing) and recovers it;
+    // throws std::runtime_error if the directory or the active segment cannot be used
+    explicit SegmentLog(std::string directory, SegmentLogOptions options = {});
+    ~SegmentLog();
+
+    SegmentLog(const SegmentLog&) = delete;
+    SegmentLog& operator=(const SegmentLog&) = delete;
+
+    // Visit every intact record in append order
+    void ForEach(const RecordVisitor& visitor) const;
+
+    // Append the records with a single write and sync them according to the fsync policy;
+    // returns their positions, or nullopt if nothing was appended
+    std::optional<std::vector<Position>> Append(const std::vector<std::string>& records);
+
+    // Sync records appended since the last fdatasync, ignoring the Periodic interval
+    bool Flush() { return SyncActive(true); }
+
+    // Pointer read of one record; nullopt if the position does not hold an intact record
+    std::optional<std::string> Read(const Position& position) const;
+
+    // Remove every segment older than 'segment' (never the active one); returns the number removed
+    std::size_t ReleaseBefore(std::uint64_t segment);
+
+    std::uint64_t ActiveSegment() const { return activeSegment_; }
+    std::size_t SegmentCount() const { return segments_.size(); }
+    // Bytes cut from the active segment during recovery
+    std::uint64_t TruncatedBytes() const { return truncatedBytes_; }
+
+private:
+    struct Segment {
+        int fd = -1;
+        std::uint64_t size = 0;  // End of the last intact frame
+    };
+
+    std::string SegmentPath(std::uint64_t segment) const;
+    bool CreateSegment(std::uint64_t segment);
+    void Recover();
+    // Scan frames from the segment header on; returns the end of the last intact frame
+    std::uint64_t ScanSegment(std::uint64_t segment, const Segment& file, std::uint64_t fileSize,
+                              const RecordVisitor& visitor) const;
+    bool SyncActive(bool force);
+
+    std::string directory_;
+    SegmentLogOptions options_;
+    std::map<std::uint64_t, Segment> segments_;
+    std::uint64_t activeSegment_ = 0;
+    std::uint64_t truncatedBytes_ = 0;
+    std::chrono::steady_clock::time_point lastSync_;
+    bool unsynced_ = false;
+};
+
+} // namespace fuelflux
@@ -0,0 +1,60 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace fuelflux {
+
+// Cache of prepared SQLite statements keyed by SQL text
+// Statements are prepared on first use and reused afterwards; the owner resets them
+// after each use (see ScopedStatementReset). Clear() finalizes everything, which the
+// owner calls when the statements become stale (e.g. after a flip/flop table swap)
+// and before closing the database.
+// Not thread-safe: callers are expected to hold the same mutex that guards the database.
+class SqliteStatementCache {
+public:
+    SqliteStatementCache() = default;
+    ~SqliteStatementCache();
+
+    SqliteStatementCache(const SqliteStatementCache&) = delete;
+    SqliteStatementCache& operator=(const SqliteStatementCache&) = delete;
+
+    // Bind the cache to a database connection (finalizes statements of the previous one)
+    void Attach(sqlite3* db);
+
+    // Get a ready-to-bind statement for sql, preparing it on first use
+    // Returns nullptr if the statement cannot be prepared
+    sqlite3_stmt* Get(const std::string& sql);
+
+    // Finalize all cached statements
+    void Clear();
+
+    std::size_t Size() const { return statements_.size(); }
+
+private:
+    sqlite3* db_ = nullptr;
+    std::unordered_map<std::string, sqlite3_stmt*> statements_;
+};
+
+// Resets a cached statement and clears its bindings when leaving scope,
+// so that read statements release their locks and the next user starts clean
+class ScopedStatementReset {
+public:
+    explicit ScopedStatementReset(sqlite3_stmt* stmt) : stmt_(stmt) {}
+    ~ScopedStatementReset();
+
+    ScopedStatementReset(const ScopedStatementReset&) = delete;
+    ScopedStatementReset& operator=(const ScopedStatementReset&) = delete;
+
+private:
+    sqlite3_stmt* stmt_;
+};
+
+} // namespace fuelflux
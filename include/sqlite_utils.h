@@ -0,0 +1,45 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <string>
+
+struct sqlite3;
+
+namespace fuelflux {
+
+// SQLite journal_mode values
+enum class SqliteJournalMode {
+    Delete,
+    Truncate,
+    Persist,
+    Memory,
+    Wal
+};
+
+// SQLite synchronous levels
+enum class SqliteSynchronous {
+    Off,
+    Normal,
+    Full
+};
+
+// Durability settings applied to a database connection right after it is opened
+// SQLite defaults are DELETE/FULL; WAL/NORMAL trades durability of the last
+// commits on power loss for far fewer fsyncs on SD card storage.
+struct SqliteDurability {
+    SqliteJournalMode journalMode = SqliteJournalMode::Delete;
+    SqliteSynchronous synchronous = SqliteSynchronous::Full;
+};
+
+std::string ToString(SqliteJournalMode mode);
+std::string ToString(SqliteSynchronous level);
+
+// Apply journal_mode and synchronous pragmas
+// Returns false if SQLite did not accept the requested journal mode
+// (e.g. WAL on an in-memory database) or the synchronous pragma failed
+bool ApplySqliteDurability(sqlite3* db, const SqliteDurability& durability);
+
+} // namespace fuelflux
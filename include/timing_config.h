@@ -13,6 +13,7 @@
  */
 
 #include <chrono>
+#include <cstddef>
 
 namespace fuelflux::timing {
 
@@ -50,6 +51,31 @@ constexpr std::chrono::milliseconds kNoFlowMonitorInterval{200};
 // How often the backlog worker retries failed messages (seconds).
 constexpr std::chrono::seconds kBacklogWorkerInterval{30};
 
+// Maximum number of one user's messages sent inside a single authorized session.
+constexpr int kBacklogSessionMaxMessages{50};
+
+// Backlog sessions run in parallel (one backend each). 1 suits GPRS links;
+// Ethernet stations can raise it with FUELFLUX_BACKLOG_SESSIONS up to the maximum.
+constexpr int kBacklogParallelSessions{1};
+constexpr int kBacklogMaxParallelSessions{8};
+
+// Backlog retry backoff while the network stays down: the delay doubles per failed
+// attempt from the base up to the cap, and half of it is randomized (jitter).
+// A connectivity-restored signal from any backend request cancels the backoff.
+constexpr std::chrono::seconds kBacklogBackoffBase{5};
+constexpr std::chrono::minutes kBacklogBackoffMax{10};
+
+// Segment log backlog with a relaxed fsync policy: longest time appended records may
+// stay in the page cache before fdatasync.
+constexpr std::chrono::milliseconds kSegmentLogFsyncInterval{200};
+
+// Persisted TLS sessions of the backend connection older than this are not offered
+// for resumption after a restart (servers rarely honour tickets for longer).
+constexpr std::chrono::hours kTlsSessionMaxAge{24};
+// Sessions staged by the TLS handshake callbacks are written this long after the first
+// one arrives, so that the tickets of one handshake cost a single file write.
+constexpr std::chrono::milliseconds kTlsSessionFlushDelay{2000};
+
 // ─── Main application loop ────────────────────────────────────────────────────
 
 // Main thread: sleep interval while waiting for shutdown signal.
@@ -79,6 +105,34 @@ constexpr long kHttpConnectTimeoutSim800cSec{30};
 // Total HTTP request timeout for SIM800C networks (seconds).
 constexpr long kHttpTotalTimeoutSim800cSec{90};
 
+// The timeouts above are ceilings: once enough requests were measured, the backend
+// uses kHttpTimeoutMultiplier times the kHttpTimeoutPercentile of the recent
+// latencies, but never less than these floors.
+constexpr std::chrono::milliseconds kHttpConnectTimeoutFloor{1000};
+constexpr std::chrono::milliseconds kHttpTotalTimeoutFloor{3000};
+constexpr std::chrono::milliseconds kHttpConnectTimeoutFloorSim800c{8000};
+constexpr std::chrono::milliseconds kHttpTotalTimeoutFloorSim800c{20000};
+
+// Latency samples kept per endpoint (connect times: per backend) for the estimate.
+constexpr std::size_t kHttpTimeoutWindow{32};
+
+// Samples needed before the timeouts drop below their ceilings.
+constexpr std::size_t kHttpTimeoutMinSamples{8};
+
+constexpr double kHttpTimeoutPercentile{0.95};
+constexpr int kHttpTimeoutMultiplier{3};
+
+// Backend circuit breaker: consecutive network errors that open it (requests then fail
+// at once and authorization falls back to the user cache).
+constexpr int kBackendCircuitFailureThreshold{3};
+
+// Backend circuit breaker: time between probes of the backend while it is open.
+constexpr std::chrono::seconds kBackendCircuitProbeInterval{15};
+
+// HTTP engine I/O thread: longest wait for socket activity when no transfer timer is
+// due sooner (new transfers and shutdown wake it immediately).
+constexpr std::chrono::milliseconds kHttpEnginePollInterval{1000};
+
 // ─── DNS / c-ares ─────────────────────────────────────────────────────────────
 
 // c-ares channel: per-attempt timeout in milliseconds (passed to ares_options).
@@ -97,6 +151,18 @@ constexpr int kDnsSelectTimeoutSec{2};
 // TTL for the cached resolved IP of the backend API hostname.
 constexpr std::chrono::hours kBackendApiDnsCacheTtl{24};
 
+// The backend API address is re-resolved in the background once less than this is left
+// of its TTL, so no request waits for the lookup.
+constexpr std::chrono::hours kBackendApiDnsRefreshAhead{2};
+
+// Delay between background refresh attempts after a failed one (the cached address
+// keeps being served meanwhile).
+constexpr std::chrono::minutes kBackendApiDnsRefreshRetry{5};
+
+// How long past its TTL the last known backend API address is still served while
+// refreshes fail; after that a request waits for a lookup again.
+constexpr std::chrono::hours kBackendApiDnsMaxStale{7 * 24};
+
 // ─── Cache manager ────────────────────────────────────────────────────────────
 
 // Hour of day (local time) at which the daily cache population is scheduled.
@@ -108,11 +174,35 @@ constexpr int kCacheRetryIntervalMinutes{60};  // 1 hour
 // Number of user records fetched per API request during cache population.
 constexpr int kCacheFetchBatchSize{100};
 
-// ─── Authorisation (debug/test) ───────────────────────────────────────────────
+// Number of fetched pages that may wait for the insert stage during a full population.
+// Bounds memory use while letting the next page download during the current insert.
+constexpr std::size_t kCachePipelineDepth{2};
+
+// Maximum number of card changes accepted by a delta synchronization. Larger change
+// sets (or a server-side truncation) fall back to a full flip/flop rebuild.
+constexpr int kCacheDeltaMaxChanges{1000};
+
+// The stored sync watermark is moved back by this amount to tolerate clock skew between
+// the controller and the server; re-applying an unchanged card is harmless.
+constexpr std::chrono::minutes kCacheDeltaWatermarkOverlap{10};
+
+// Folded allowance ledger entries older than this are pruned when the ledger is next folded.
+constexpr std::chrono::hours kCacheLedgerRetention{24 * 90};  // 90 days
+
+// ─── Authorisation ────────────────────────────────────────────────────────────
 
 // Extra delay injected during authorisation when ENABLE_AUTH_DELAY is defined.
 constexpr std::chrono::seconds kAuthDelay{3};
 
+// Hedged authorisation: a customer found in the user cache is let through on the cached
+// decision if the backend has not answered a card tap within this delay; the backend answer
+// then confirms, limits or cancels the session. Off by default: a stale cache entry could
+// dispense; a deployment opts in with FUELFLUX_AUTH_HEDGE_MS (e.g. 2000).
+constexpr std::chrono::milliseconds kAuthHedgeDelay{0};
+
+// Largest allowance (litres) a hedged session gets before the backend confirms it.
+constexpr double kAuthHedgeMaxAllowance{100.0};
+
 // ─── Console emulator ─────────────────────────────────────────────────────────
 
 // Console input dispatcher: sleep interval between keyboard input checks.
@@ -0,0 +1,99 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "timing_config.h"
+
+namespace fuelflux {
+
+// Small file of serialized TLS sessions (session IDs and tickets), one per peer, so that
+// the first request after a restart resumes the session instead of paying for a full
+// handshake
+//
+// File layout (host byte order):
+//   header   16 bytes: magic "FFTS", format version, entry count and CRC-32 of the entries
+//   entries  saved-at (unix seconds), peer length, session length, peer, session
+//
+// The whole file is rewritten (temporary file and rename) on every Save. Stage, used
+// from the TLS callbacks on the HTTP I/O thread, only updates memory: a background thread
+// writes the file flushDelay later, and the destructor writes whatever is still staged.
+// A missing, corrupt or unknown-version file starts the store empty. Sessions older than
+// maxAge are never returned and are dropped on the next write. Thread-safe.
+class TlsSessionStore {
+public:
+    explicit TlsSessionStore(std::string path, std::chrono::seconds maxAge = timing::kTlsSessionMaxAge,
+                             std::chrono::milliseconds flushDelay = timing::kTlsSessionFlushDelay);
+    ~TlsSessionStore();
+
+    TlsSessionStore(const TlsSessionStore&) = delete;
+    TlsSessionStore& operator=(const TlsSessionStore&) = delete;
+
+    // Serialized session for peer saved at most maxAge before 'now'
+    std::optional<std::string> Load(const std::string& peer, std::int64_t now) const;
+
+    // Replace the session of peer and persist the store; false on I/O errors or if the
+    // session is larger than kMaxSessionBytes
+    bool Save(const std::string& peer, const std::string& session, std::int64_t now);
+
+    // Replace the session of peer without touching the file; the store is written in the
+    // background. false if the session is larger than kMaxSessionBytes
+    bool Stage(const std::string& peer, const std::string& session, std::int64_t now);
+
+    // Write staged sessions now; true if there was nothing to write
+    bool Flush();
+
+    // Drop the session of peer (e.g. the server rejected it) and persist the store
+    bool Forget(const std::string& peer);
+
+    std::size_t Count() const;
+    const std::string& Path() const { return path_; }
+
+    static constexpr std::size_t kMaxSessionBytes = 16 * 1024;
+    static constexpr std::size_t kMaxPeers = 8;
+
+    // Seconds since the epoch, the clock Load and Save expect
+    static std::int64_t Now();
+
+private:
+    struct Entry {
+        std::int64_t savedAt = 0;
+        std::string session;
+    };
+
+    void ReadFile();
+    // Must be called with mutex_ held
+    void PutUnlocked(const std::string& peer, const std::string& session, std::int64_t now);
+    // Drop expired sessions and return the file image; must be called with mutex_ held
+    std::string SerializeUnlocked(std::int64_t now);
+    // Must be called with fileMutex_ held
+    bool WriteFile(const std::string& image) const;
+    void WriterLoop();
+
+    const std::string path_;
+    const std::int64_t maxAge_;
+    const std::chrono::milliseconds flushDelay_;
+    // Serializes file writes; taken before mutex_ so that images reach the file in order
+    std::mutex fileMutex_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+
+    // Background writer, started by the first Stage; guarded by mutex_
+    std::condition_variable writerCv_;
+    std::thread writer_;
+    bool dirty_ = false;
+    bool stopping_ = false;
+    std::int64_t stagedAt_ = 0;
+};
+
+} // namespace fuelflux
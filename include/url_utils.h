@@ -15,4 +15,9 @@ namespace fuelflux {
 // - optional port and path
 std::string ExtractHostFromUrl(const std::string& url);
 
+// Split a backend endpoint such as "/api/pump/cards?first=0&number=50" at its query:
+// the path ("/api/pump/cards") and the query with its '?' ("" if there is none)
+std::string EndpointPath(const std::string& endpoint);
+std::string EndpointQuery(const std::string& endpoint);
+
 } // namespace fuelflux
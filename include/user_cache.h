@@ -4,15 +4,29 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "bloom_filter.h"
+#include "card_uid.h"
+#include "sqlite_statement_cache.h"
+#include "sqlite_utils.h"
+#include "timing_config.h"
+
 struct sqlite3;
 
 namespace fuelflux {
 
+struct UserCard;
+struct FuelTank;
+
 // User cache entry structure
 struct UserCacheEntry {
     std::string uid;
@@ -27,11 +41,82 @@ struct TankCacheEntry {
     double volume = 0.0;
 };
 
+// Offline deduction recorded in the allowance ledger
+struct AllowanceLedgerEntry {
+    std::int64_t id = 0;
+    std::string uid;
+    double amount = 0.0;
+    std::int64_t createdAt = 0;             // Unix time of the deduction
+    std::optional<std::int64_t> foldedAt;   // Unix time it was folded into a table; empty while pending
+};
+
+// Bloom filter counters for GetEntry lookups
+struct BloomFilterStats {
+    std::uint64_t lookups = 0;          // Lookups checked against the filter
+    std::uint64_t rejected = 0;         // Definite misses answered by the filter alone
+    std::uint64_t falsePositives = 0;   // Filter said "maybe" but the UID was not cached
+    double estimatedFalsePositiveRate = 0.0;  // Predicted from the filter fill ratio
+
+    // Fraction of unknown UIDs that got past the filter
+    double ObservedFalsePositiveRate() const {
+        const std::uint64_t misses = rejected + falsePositives;
+        return misses == 0 ? 0.0 : static_cast<double>(falsePositives) / static_cast<double>(misses);
+    }
+};
+
+// User cache operations used by the cache manager and the controller
+// UserCache (SQLite flip/flop tables) is the default implementation; MappedUserCache
+// (user_cache_snapshot.h) serves lookups from a memory-mapped snapshot file.
+class IUserCache {
+public:
+    virtual ~IUserCache() = default;
+
+    virtual std::optional<UserCacheEntry> GetEntry(const std::string& uid) const = 0;
+    virtual std::optional<UserCacheEntry> GetEntry(const CardUid& uid) const = 0;
+    virtual bool UpdateEntry(const std::string& uid, double allowance, int roleId) = 0;
+    virtual bool DeductAllowance(const std::string& uid, double amount) = 0;
+    virtual int GetCount() const = 0;
+    virtual std::vector<TankCacheEntry> GetTanks() const = 0;
+    virtual int GetTankCount() const = 0;
+    // Only caches with a Bloom filter in front of the lookups report anything here
+    virtual BloomFilterStats GetBloomFilterStats() const { return BloomFilterStats{}; }
+
+    virtual bool BeginPopulation() = 0;
+    virtual bool AddPopulationEntry(const std::string& uid, double allowance, int roleId) = 0;
+    virtual bool AddPopulationTank(int idTank, int visualNumberTank, const std::string& nameTank, double volume) = 0;
+    virtual bool AddPopulationEntries(const std::vector<UserCard>& cards) = 0;
+    virtual bool AddPopulationTanks(const std::vector<FuelTank>& tanks) = 0;
+    virtual bool CommitPopulation(const std::string& syncWatermark = std::string()) = 0;
+    virtual void AbortPopulation() = 0;
+
+    virtual std::optional<std::string> GetSyncWatermark() const = 0;
+    virtual bool ApplyDelta(const std::vector<UserCard>& upserts,
+                            const std::vector<std::string>& deletedUids,
+                            const std::vector<FuelTank>& tanks,
+                            const std::string& syncWatermark) = 0;
+};
+
+// Which IUserCache implementation the controller opens
+enum class UserCacheEngine {
+    Sqlite,     // UserCache at CACHE_DB_PATH
+    Snapshot,   // MappedUserCache at CACHE_SNAPSHOT_PATH
+};
+
 // User cache class with flip/flop table mechanism for atomic updates
-class UserCache {
+// Lookups are served from an in-memory index of the active table. The index is published
+// as an immutable snapshot (base map + small delta map) that readers load without taking
+// dbMutex_; writers rebuild it under dbMutex_ and swap it in atomically.
+// A Bloom filter over the active table UIDs (persisted as <dbPath>.bloom) rejects
+// unknown cards before any lookup. It is rebuilt on every commit or delta, and the
+// persisted copy is removed whenever a UID is added that it does not cover yet.
+class UserCache : public IUserCache {
 public:
-    explicit UserCache(const std::string& dbPath);
-    ~UserCache();
+    // The cache can always be rebuilt from the backend, so by default it trades
+    // durability of the last commits for fewer fsyncs (WAL journal, synchronous=NORMAL)
+    static constexpr SqliteDurability kDefaultDurability{SqliteJournalMode::Wal, SqliteSynchronous::Normal};
+
+    explicit UserCache(const std::string& dbPath, const SqliteDurability& durability = kDefaultDurability);
+    ~UserCache() override;
 
     UserCache(const UserCache&) = delete;
     UserCache& operator=(const UserCache&) = delete;
@@ -39,30 +124,131 @@ public:
     bool IsOpen() const;
 
     // Cache operations
-    std::optional<UserCacheEntry> GetEntry(const std::string& uid) const;
-    bool UpdateEntry(const std::string& uid, double allowance, int roleId);
-    bool DeductAllowance(const std::string& uid, double amount);
-    int GetCount() const;
-    std::vector<TankCacheEntry> GetTanks() const;
-    int GetTankCount() const;
+    std::optional<UserCacheEntry> GetEntry(const std::string& uid) const override;
+    // Card-tap lookup straight from the reader bytes; same result as GetEntry(uid.ToString())
+    std::optional<UserCacheEntry> GetEntry(const CardUid& uid) const override;
+    bool UpdateEntry(const std::string& uid, double allowance, int roleId) override;
+    // Appends to the allowance ledger; GetEntry reports the table value minus pending deductions
+    bool DeductAllowance(const std::string& uid, double amount) override;
+    // Ledger entries for uid (all UIDs if empty), oldest first
+    std::vector<AllowanceLedgerEntry> GetLedger(const std::string& uid = std::string()) const;
+    int GetCount() const override;
+    std::vector<TankCacheEntry> GetTanks() const override;
+    int GetTankCount() const override;
+    BloomFilterStats GetBloomFilterStats() const override;
 
     // Population operations with flip/flop mechanism
-    bool BeginPopulation();
-    bool AddPopulationEntry(const std::string& uid, double allowance, int roleId);
-    bool AddPopulationTank(int idTank, int visualNumberTank, const std::string& nameTank, double volume);
-    bool CommitPopulation();
-    void AbortPopulation();
+    bool BeginPopulation() override;
+    bool AddPopulationEntry(const std::string& uid, double allowance, int roleId) override;
+    bool AddPopulationTank(int idTank, int visualNumberTank, const std::string& nameTank, double volume) override;
+    // Batched variants: the whole page is inserted in a single transaction
+    bool AddPopulationEntries(const std::vector<UserCard>& cards) override;
+    bool AddPopulationTanks(const std::vector<FuelTank>& tanks) override;
+    // Flip the tables; a non-empty syncWatermark is stored in the same transaction
+    bool CommitPopulation(const std::string& syncWatermark = std::string()) override;
+    void AbortPopulation() override;
+
+    // Delta synchronization: upserts and deletes are applied in place to the active
+    // table, the active tank table is replaced with 'tanks' and the watermark is
+    // advanced, all in one transaction. Not allowed while a population is in progress.
+    std::optional<std::string> GetSyncWatermark() const override;
+    bool ApplyDelta(const std::vector<UserCard>& upserts,
+                    const std::vector<std::string>& deletedUids,
+                    const std::vector<FuelTank>& tanks,
+                    const std::string& syncWatermark) override;
 
 private:
+    // Lookup map: card UIDs are keyed by their inline binary form, any other
+    // identifier (keypad input, test data) by its string
+    class UserIndexMap {
+    public:
+        std::optional<UserCacheEntry> Find(const std::string& uid) const;
+        std::optional<UserCacheEntry> Find(const CardUid& uid) const;
+        void Put(const std::string& uid, double allowance, int roleId);
+        void Put(const CardUid& uid, double allowance, int roleId);
+        // Entries of other replace the ones in this map
+        void Merge(const UserIndexMap& other);
+        std::size_t Size() const { return cards_.size() + others_.size(); }
+        void AddKeysTo(BloomFilter& filter) const;
+
+    private:
+        struct Value {
+            double allowance;
+            int roleId;
+        };
+        std::unordered_map<CardUid, Value> cards_;
+        std::unordered_map<std::string, Value> others_;
+    };
+
+    // Immutable lookup snapshot. Base is loaded from the active table on open/commit,
+    // delta collects UpdateEntry/DeductAllowance results (copy-on-write, base is shared).
+    struct IndexSnapshot {
+        std::shared_ptr<const UserIndexMap> base;
+        std::shared_ptr<const UserIndexMap> delta;
+    };
+
     bool Execute(const std::string& sql) const;
+    // Must be called with dbMutex_ held
+    bool ExecuteUnlocked(const std::string& sql) const;
     std::string GetActiveTableName() const;
     std::string GetStandbyTableName() const;
+    // Must be called with dbMutex_ held
+    bool StoreSyncWatermark(const std::string& syncWatermark);
+
+    // Index/SQLite lookup behind the Bloom filter check
+    std::optional<UserCacheEntry> LookupEntry(const std::string& uid) const;
+    // Must be called with dbMutex_ held
+    bool MigrateUidKeysUnlocked();
+
+    // Must be called with dbMutex_ held
+    std::optional<UserCacheEntry> SelectEntryUnlocked(const std::string& uid) const;
+    // Apply all pending ledger entries to tableName and mark them folded
+    bool FoldLedgerUnlocked(const std::string& tableName);
+    // Mark pending entries of uid folded without applying them (a backend value replaced the row)
+    bool SupersedeLedgerUnlocked(const std::string& uid);
+
+    // Must be called with dbMutex_ held
+    std::shared_ptr<const UserIndexMap> LoadActiveTable() const;
+    // Reload the active table and publish it together with its Bloom filter; a filter
+    // built here is persisted when persistBloom is set, a loaded one is used as is
+    void RebuildIndex(bool persistBloom, std::shared_ptr<BloomFilter> filter = nullptr);
+    void ApplyIndexDelta(const UserCacheEntry& entry);
+    static std::shared_ptr<BloomFilter> BuildBloomFilter(const IndexSnapshot& snapshot);
+    // Table generation, bumped with every commit that replaces or reloads the active table
+    std::uint64_t LoadGenerationUnlocked() const;
+    bool StoreGenerationUnlocked(std::uint64_t generation);
+    // Make sure uid passes the filter; drops the persisted copy first if it does not
+    void AddToBloomFilter(const std::string& uid);
+    std::string GetBloomFilterPath() const;
 
     sqlite3* db_;
     std::string dbPath_;
     mutable std::mutex dbMutex_;
+    // Prepared statements, guarded by dbMutex_
+    mutable SqliteStatementCache statements_;
     bool activeTableIsA_; // true = table A is active, false = table B is active
     bool populationInProgress_;
+    // Generation the persisted Bloom filter must carry, guarded by dbMutex_
+    std::uint64_t generation_ = 0;
+
+    // Accessed only through std::atomic_load/std::atomic_store
+    std::shared_ptr<const IndexSnapshot> index_;
+
+    // Accessed only through std::atomic_load/std::atomic_store
+    std::shared_ptr<BloomFilter> bloom_;
+    mutable std::atomic<std::uint64_t> bloomLookups_{0};
+    mutable std::atomic<std::uint64_t> bloomRejected_{0};
+    mutable std::atomic<std::uint64_t> bloomFalsePositives_{0};
+
+    // Delta size at which it is folded into a fresh base map
+    static constexpr std::size_t kMaxIndexDeltaSize = 256;
+
+    // Bloom filter sizing: headroom for cards added online between populations
+    static constexpr double kBloomFalsePositiveRate = 0.01;
+    static constexpr std::size_t kBloomMinCapacity = 1024;
+
+    // How long folded ledger entries are kept for auditing
+    static constexpr std::chrono::seconds kLedgerRetention = timing::kCacheLedgerRetention;
 };
 
 } // namespace fuelflux
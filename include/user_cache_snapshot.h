@@ -0,0 +1,160 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "user_cache.h"
+
+namespace fuelflux {
+
+// Immutable, memory-mapped snapshot of a committed user cache population
+//
+// File layout (little-endian, host byte order):
+//   header      32 bytes: magic "FFUS", format version, generation, entry count,
+//               key width and CRC-32 of everything after the header
+//   keys        count * keyWidth bytes, UIDs sorted and zero-padded to keyWidth
+//   (padding to 8 bytes)
+//   allowances  count * double
+//   roles       count * int32
+//
+// Lookups binary-search the key column directly in the mapping, so opening a
+// snapshot costs one mmap plus a checksum pass and needs no locking afterwards.
+class UserCacheSnapshot {
+public:
+    ~UserCacheSnapshot();
+
+    UserCacheSnapshot(const UserCacheSnapshot&) = delete;
+    UserCacheSnapshot& operator=(const UserCacheSnapshot&) = delete;
+
+    // Write entries to path (via a temporary file and rename, so readers never see a partial file)
+    // Duplicate UIDs keep the last entry. Returns false on I/O errors.
+    static bool Write(const std::string& path, std::vector<UserCacheEntry> entries, std::uint64_t generation);
+
+    // Map and validate a snapshot file; returns nullptr if it is missing, truncated or corrupt
+    static std::shared_ptr<const UserCacheSnapshot> Open(const std::string& path);
+
+    std::optional<UserCacheEntry> Find(const std::string& uid) const;
+    // All entries in key order
+    std::vector<UserCacheEntry> Entries() const;
+
+    std::size_t Count() const { return count_; }
+    std::uint64_t Generation() const { return generation_; }
+    std::size_t MappedSize() const { return size_; }
+
+private:
+    UserCacheSnapshot() = default;
+
+    const unsigned char* KeyAt(std::size_t index) const { return keys_ + index * keyWidth_; }
+
+    void* mapping_ = nullptr;
+    std::size_t size_ = 0;
+    std::uint64_t generation_ = 0;
+    std::size_t count_ = 0;
+    std::size_t keyWidth_ = 0;
+    const unsigned char* keys_ = nullptr;
+    const double* allowances_ = nullptr;
+    const std::int32_t* roles_ = nullptr;
+};
+
+// Alternative user cache backend built on UserCacheSnapshot
+// Each committed population (and each applied delta) becomes a new snapshot generation.
+// Runtime changes (UpdateEntry/DeductAllowance) go to a small in-memory overlay that is
+// journaled to <snapshot>.overlay and replayed on start; the journal also carries the
+// tanks and sync watermark of the generation. Like the ledger of UserCache, offline
+// deductions are carried over once onto the next population, while backend values from
+// UpdateEntry are superseded by it. GetEntry loads the current snapshot/overlay pair
+// atomically and never takes a mutex; writers serialize on writeMutex_ and publish
+// copy-on-write state.
+class MappedUserCache : public IUserCache {
+public:
+    // Maps the existing snapshot at snapshotPath, if there is a valid one
+    explicit MappedUserCache(std::string snapshotPath);
+
+    MappedUserCache(const MappedUserCache&) = delete;
+    MappedUserCache& operator=(const MappedUserCache&) = delete;
+
+    bool IsLoaded() const;
+    std::uint64_t GetGeneration() const;
+
+    std::optional<UserCacheEntry> GetEntry(const std::string& uid) const override;
+    std::optional<UserCacheEntry> GetEntry(const CardUid& uid) const override;
+    bool UpdateEntry(const std::string& uid, double allowance, int roleId) override;
+    bool DeductAllowance(const std::string& uid, double amount) override;
+    int GetCount() const override;
+    std::vector<TankCacheEntry> GetTanks() const override;
+    int GetTankCount() const override;
+
+    // Entries and tanks are collected in memory and written as one generation on commit
+    bool BeginPopulation() override;
+    bool AddPopulationEntry(const std::string& uid, double allowance, int roleId) override;
+    bool AddPopulationTank(int idTank, int visualNumberTank, const std::string& nameTank, double volume) override;
+    bool AddPopulationEntries(const std::vector<UserCard>& cards) override;
+    bool AddPopulationTanks(const std::vector<FuelTank>& tanks) override;
+    bool CommitPopulation(const std::string& syncWatermark = std::string()) override;
+    void AbortPopulation() override;
+
+    std::optional<std::string> GetSyncWatermark() const override;
+    // Writes the changed population as the next generation; overlay entries and pending
+    // deductions of the changed UIDs are superseded, the others are kept
+    bool ApplyDelta(const std::vector<UserCard>& upserts,
+                    const std::vector<std::string>& deletedUids,
+                    const std::vector<FuelTank>& tanks,
+                    const std::string& syncWatermark) override;
+
+    // Write entries as the next generation (keeping the tanks, dropping the watermark),
+    // map it and re-apply the pending deductions
+    bool Publish(const std::vector<UserCacheEntry>& entries);
+
+private:
+    using OverlayMap = std::unordered_map<std::string, UserCacheEntry>;
+
+    // Describes a generation together with its snapshot
+    struct Metadata {
+        std::vector<TankCacheEntry> tanks;
+        std::optional<std::string> syncWatermark;
+    };
+
+    struct State {
+        std::shared_ptr<const UserCacheSnapshot> snapshot;
+        std::shared_ptr<const OverlayMap> overlay;
+        std::shared_ptr<const Metadata> metadata;
+    };
+
+    // Must be called with writeMutex_ held (or from the constructor)
+    void StoreOverlayEntry(const std::shared_ptr<const State>& current, const UserCacheEntry& entry);
+    std::shared_ptr<const State> LoadJournal(const std::shared_ptr<const UserCacheSnapshot>& snapshot);
+    // Overlay for a new snapshot: pending deductions applied to its values; consumes them
+    std::shared_ptr<const OverlayMap> CarryOver(const std::shared_ptr<const UserCacheSnapshot>& snapshot,
+                                                const OverlayMap& previous);
+    // Write, map and publish the next generation; a null overlay carries the current one over
+    bool PublishUnlocked(std::vector<UserCacheEntry> entries, std::shared_ptr<const Metadata> metadata,
+                         std::shared_ptr<const OverlayMap> overlay);
+    bool AppendJournal(const std::string& record);
+    bool RewriteJournal(std::uint64_t generation, const OverlayMap& overlay, const Metadata& metadata);
+    std::string JournalPath() const { return snapshotPath_ + ".overlay"; }
+
+    std::string snapshotPath_;
+    std::mutex writeMutex_;
+    // Offline deductions since the last population, per UID
+    std::unordered_map<std::string, double> pendingDeductions_;
+
+    // Population being collected, guarded by writeMutex_
+    bool populationInProgress_ = false;
+    std::vector<UserCacheEntry> populationEntries_;
+    std::vector<TankCacheEntry> populationTanks_;
+
+    // Accessed only through std::atomic_load/std::atomic_store
+    std::shared_ptr<const State> state_;
+};
+
+} // namespace fuelflux
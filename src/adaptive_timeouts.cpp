@@ -0,0 +1,78 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "adaptive_timeouts.h"
+
+#include "logger.h"
+#include "url_utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace fuelflux {
+
+void AdaptiveTimeouts::Window::Add(Duration sample) {
+    if (samples_.size() < timing::kHttpTimeoutWindow) {
+        samples_.push_back(sample);
+        return;
+    }
+    samples_[next_] = sample;
+    next_ = (next_ + 1) % samples_.size();
+}
+
+AdaptiveTimeouts::Duration AdaptiveTimeouts::Window::Percentile(double q) const {
+    if (samples_.empty()) {
+        return Duration(0);
+    }
+    std::vector<Duration> sorted(samples_);
+    const auto rank = static_cast<std::size_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(sorted.size())));
+    const std::size_t index = std::max<std::size_t>(rank, 1) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(index), sorted.end());
+    return sorted[index];
+}
+
+AdaptiveTimeouts::AdaptiveTimeouts(Limits connect, Limits total)
+    : connectLimits_(connect)
+    , totalLimits_(total) {
+}
+
+AdaptiveTimeouts::Duration AdaptiveTimeouts::Derive(const Window& window, const Limits& limits) {
+    if (window.Size() < timing::kHttpTimeoutMinSamples) {
+        return limits.ceiling;
+    }
+    const Duration estimate = window.Percentile(timing::kHttpTimeoutPercentile) * timing::kHttpTimeoutMultiplier;
+    return std::clamp(estimate, limits.floor, limits.ceiling);
+}
+
+AdaptiveTimeouts::Timeouts AdaptiveTimeouts::For(const std::string& endpoint) {
+    const std::string path = EndpointPath(endpoint);
+    Timeouts timeouts;
+    std::size_t connectSamples = 0;
+    std::size_t totalSamples = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Endpoint& state = endpoints_[path];
+        timeouts.connect = Derive(connect_, connectLimits_);
+        timeouts.total = Derive(state.total, totalLimits_);
+        if (timeouts == state.last) {
+            return timeouts;
+        }
+        state.last = timeouts;
+        connectSamples = connect_.Size();
+        totalSamples = state.total.Size();
+    }
+    LOG_BCK_INFO("HTTP timeouts for {}: connect {} ms, total {} ms ({} connect / {} request samples)", path,
+                 timeouts.connect.count(), timeouts.total.count(), connectSamples, totalSamples);
+    return timeouts;
+}
+
+void AdaptiveTimeouts::Record(const std::string& endpoint, Duration connect, Duration total) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connect > Duration(0)) {
+        connect_.Add(connect);
+    }
+    endpoints_[EndpointPath(endpoint)].total.Add(total);
+}
+
+} // namespace fuelflux
@@ -5,10 +5,21 @@
 #include "backend.h"
 #include "url_utils.h"
 #include "backend_utils.h"
+#include "adaptive_timeouts.h"
 #include "logger.h"
 #include "timing_config.h"
 #include "version.h"
+#include "tls_session_store.h"
+#include "http_engine.h"
+#include "json_stream.h"
+#include "link_monitor.h"
 #include <curl/curl.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <stdexcept>
@@ -19,10 +30,15 @@
 #include <cctype>
 #include <vector>
 #include <cerrno>
+#include <arpa/inet.h>
+#include <netinet/in.h>
 #endif
 #ifdef USE_CARES
 #include "cares_resolver.h"
 #endif
+#ifdef USE_OPENSSL_TLS_SESSIONS
+#include <openssl/ssl.h>
+#endif
 
 namespace fuelflux {
 
@@ -100,8 +116,6 @@ size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
 }
 
 #ifdef TARGET_SIM800C
-constexpr const char kPppInterface[] = "ppp0";
-
 bool IsPppInterfaceAvailable() {
     struct ifaddrs* ifaddr = nullptr;
     if (getifaddrs(&ifaddr) != 0) {
@@ -220,13 +234,50 @@ bool IsLocalhost(const std::string& host) {
     return false;
 }
 
-bool ShouldBindToPppInterface(const std::string& host) {
-    if (IsLocalhost(host)) {
+// Local IPv4 address of the PPP link, empty if the link is down. pppd gets a new address
+// on every reconnect, so a change means that cached connections point to a dead link.
+std::string PppLinkSignature() {
+    struct ifaddrs* ifaddr = nullptr;
+    if (getifaddrs(&ifaddr) != 0) {
+        return {};
+    }
+
+    std::string signature;
+    for (struct ifaddrs* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+        if (ifa->ifa_name && std::strcmp(ifa->ifa_name, kPppInterface) == 0 &&
+            ifa->ifa_addr && ifa->ifa_addr->sa_family == AF_INET) {
+            char address[INET_ADDRSTRLEN] = {};
+            const auto* in = reinterpret_cast<const struct sockaddr_in*>(ifa->ifa_addr);
+            if (inet_ntop(AF_INET, &in->sin_addr, address, sizeof(address))) {
+                signature = address;
+            }
+            break;
+        }
+    }
+    freeifaddrs(ifaddr);
+    return signature;
+}
+
+bool ShouldBindToPppInterface(bool localHost) {
+    if (localHost) {
         return false;
     }
+    // Without the link monitor the interfaces are listed on every request
+    const LinkMonitor& link = LinkMonitor::Instance();
+    if (link.IsRunning()) {
+        return link.IsUp();
+    }
     return IsPppInterfaceAvailable();
 }
 
+// ppp0 existed and went away (or lost its address): a request cannot get through, so it
+// fails at once and the caller takes its offline path instead of waiting for the connect
+// timeout. Only known with the link monitor.
+bool IsPppLinkDown() {
+    const LinkMonitor& link = LinkMonitor::Instance();
+    return link.IsRunning() && link.GetState() == LinkMonitor::State::Down;
+}
+
 
 #ifdef USE_CARES
 // Helper function to extract port from URL (returns 443 for https, 80 for http by default)
@@ -282,11 +333,30 @@ CaresResolver& GetCaresResolver() {
 //   curl - CURL handle to configure
 //   resolveList - CurlSlist to append the resolve entry to
 //   host - hostname to resolve
-//   url - full URL (needed to extract port)
+//   port - port of the backend URL
 //   logPrefix - prefix for log messages (e.g., "" or "Async deauthorize: ")
+//   cacheOnly - never wait for a lookup; a cache miss is left to libcurl's resolver
 void SetupDnsResolution(CURL* curl, CurlSlist& resolveList, 
-                        const std::string& host, const std::string& url,
-                        const std::string& logPrefix = "") {
+                        const std::string& host, int port,
+                        const std::string& logPrefix = "", bool cacheOnly = false) {
+    if (cacheOnly) {
+        const auto cachedIp = GetCaresResolver().ResolveCached(host, kPppInterface);
+        if (!cachedIp) {
+            // Resolved by libcurl when the engine starts the transfer, still via the PPP link
+            LOG_BCK_DEBUG("{}No cached address for {}; leaving DNS to libcurl via interface {}",
+                          logPrefix, host, kPppInterface);
+            curl_easy_setopt(curl, CURLOPT_DNS_INTERFACE, kPppInterface);
+            return;
+        }
+        if (*cachedIp != host) {
+            std::string resolveEntry = host + ":" + std::to_string(port) + ":" + *cachedIp;
+            resolveList.append(resolveEntry.c_str());
+            curl_easy_setopt(curl, CURLOPT_RESOLVE, resolveList.get());
+            LOG_BCK_DEBUG("{}Using CURLOPT_RESOLVE: {}", logPrefix, resolveEntry);
+        }
+        return;
+    }
+
     std::string resolvedIp  = GetCaresResolver().Resolve(host, kPppInterface);
     if (resolvedIp.empty()) {
         // c-ares failed; fall back to letting libcurl do DNS, but force it to use
@@ -296,7 +366,6 @@ void SetupDnsResolution(CURL* curl, CurlSlist& resolveList,
         curl_easy_setopt(curl, CURLOPT_DNS_INTERFACE, kPppInterface);
     } else if (resolvedIp != host) {
         // Hostname was successfully resolved to a different IP
-        int port = ExtractPortFromUrl(url);
         // Format: "hostname:port:address"
         std::string resolveEntry = host + ":" + std::to_string(port) + ":" + resolvedIp;
         resolveList.append(resolveEntry.c_str());
@@ -309,178 +378,637 @@ void SetupDnsResolution(CURL* curl, CurlSlist& resolveList,
 
 #endif
 
-} // namespace
+// Base URL of a backend parsed once, with the headers every request sends
+struct ApiTarget {
+    std::string baseAPI;
+    std::string host;
+    bool localHost = false;     // Loopback host, never bound to the PPP link
+#if defined(TARGET_SIM800C) && defined(USE_CARES)
+    int port = 0;
+#endif
+    CurlSlist headers;          // Accept and Content-Type
+};
 
-Backend::Backend(const std::string& baseAPI, const std::string& controllerUid, std::shared_ptr<MessageStorage> storage)
-    : BackendBase(controllerUid, std::move(storage))
-    , baseAPI_(baseAPI)
-{
-    // Initialize libcurl globally exactly once (thread-safe)
-    std::call_once(curl_init_flag, InitCurlGlobally);
-    LOG_BCK_INFO("Backend initialized (v{}) with base API: {} and controller UID: {}", FUELFLUX_VERSION, baseAPI_, controllerUid_);
-}
+// A request to one endpoint with everything but the body and the token prepared
+struct EndpointTemplate {
+    std::string endpoint;       // Path, without the query string
+    std::string method;
+    std::string url;            // baseAPI + endpoint
+    bool post = false;
+    bool supported = false;     // POST or GET
+};
 
-Backend::~Backend() {
-    // Do not call curl_global_cleanup() here - it's process-global and may affect other users
-    // Cleanup should happen at process shutdown, not per Backend instance
-}
+// Request data the curl options point to; must live until the transfer finished
+struct TransferData {
+    std::string body;
+    // Query string of the endpoint ("?..." or empty), appended to the template URL
+    std::string query;
+    std::string response;
+    // Authorization line, linked in front of ApiTarget::headers
+    std::string authorization;
+    struct curl_slist authorizationHeader {};
+#ifdef USE_CARES
+    // DNS resolution list for CURLOPT_RESOLVE
+    CurlSlist resolveList;
+#endif
+};
 
-nlohmann::json Backend::HttpRequestWrapper(const std::string& endpoint,
-                                           const std::string& method,
-                                           const nlohmann::json& requestBody,
-                                           bool useBearerToken) {
-    std::lock_guard<std::recursive_mutex> lock(requestMutex_);
+// Set the options of a request from its template (transfer.body must be filled in);
+// false if the method is not supported or the PPP link is down.
+// 'target' must outlive the transfer: the static headers are not copied by curl.
+// With dnsCacheOnly (transfers handed to the HttpEngine) the calling thread never waits
+// for a c-ares lookup.
+bool ConfigureTransfer(CURL* curl, TransferData& transfer, const ApiTarget& target, const EndpointTemplate& request,
+                       const AdaptiveTimeouts::Timeouts& timeouts, const std::string& bearerToken,
+                       const std::string& logPrefix, bool dnsCacheOnly = false) {
+    if (!request.supported) {
+        LOG_BCK_ERROR("{}Unsupported HTTP method: {}", logPrefix, request.method);
+        return false;
+    }
 
-    networkError_ = false;
+    // Set URL (curl copies it)
+    if (transfer.query.empty()) {
+        curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    } else {
+        curl_easy_setopt(curl, CURLOPT_URL, (request.url + transfer.query).c_str());
+    }
 
-    // Use RAII wrapper for CURL handle
-    CurlHandle curl;
-    if (!curl) {
-        LOG_BCK_ERROR("Failed to initialize curl");
-        networkError_ = true;
-        return BuildWrapperErrorResponse();
+    // Set user agent
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, kUserAgent.c_str());
+
+    // Set callback for response
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer.response);
+
+    // Set timeouts (derived from the measured latencies)
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(timeouts.connect.count()));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, static_cast<long>(timeouts.total.count()));
+
+    // Enable TCP keepalive
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    // Overlapping requests wait for the multiplexed connection instead of opening another
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+
+#ifdef TARGET_SIM800C
+    if (!target.localHost && IsPppLinkDown()) {
+        LOG_BCK_WARN("{}Link {} is down; failing the request without connecting", logPrefix, kPppInterface);
+        return false;
     }
 
-    try {
-        std::string url = baseAPI_ + endpoint;
-        std::string responseBody;
-        
-        // Compute body string once and reuse for both logging and POST
-        std::string bodyStr = requestBody.dump();
-        LOG_BCK_DEBUG("Request: {} {} with body: {}", method, endpoint, bodyStr);
+    // Bind to PPP interface if available and not localhost
+    if (ShouldBindToPppInterface(target.localHost)) {
+        LOG_BCK_DEBUG("{}Binding to {} for host {}", logPrefix, kPppInterface, target.host);
+        curl_easy_setopt(curl, CURLOPT_INTERFACE, kPppInterface);
 
-        // Set URL
-        curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-        
-        // Set user agent
-        curl_easy_setopt(curl.get(), CURLOPT_USERAGENT, kUserAgent.c_str());
-        
-        // Set callback for response
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &responseBody);
-        
-        // Set timeouts
+#ifdef USE_CARES
+        // Use c-ares with Yandex DNS for hostname resolution
+        // Bind DNS queries to ppp0 interface via ares_set_local_dev()
+        // Then use CURLOPT_RESOLVE to provide the resolved IP to curl
+        // This preserves the hostname in the URL for Host header and SNI
+        SetupDnsResolution(curl, transfer.resolveList, target.host, target.port, logPrefix, dnsCacheOnly);
+#endif
+    } else {
+        if (target.localHost) {
+            LOG_BCK_DEBUG("{}Skipping {} binding for localhost: {}", logPrefix, kPppInterface, target.host);
+        } else {
+            LOG_BCK_DEBUG("{}Skipping {} binding for host {} (interface unavailable)", logPrefix, kPppInterface,
+                          target.host);
+        }
+    }
+#endif
+
+    // Static headers, with the Authorization line (if any) linked in front of them
+    struct curl_slist* headers = target.headers.get();
+    if (!bearerToken.empty()) {
+        transfer.authorization = "Authorization: Bearer " + bearerToken;
+        transfer.authorizationHeader.data = transfer.authorization.data();
+        transfer.authorizationHeader.next = headers;
+        headers = &transfer.authorizationHeader;
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    // Set method and body
+    if (request.post) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, transfer.body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(transfer.body.size()));
+    } else {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    }
+    return true;
+}
+
+// Feed the timings of a finished transfer to the timeout estimate. Only answered and
+// timed out requests say something about the latency; for a timeout the time it took
+// is a lower bound, which widens the next timeouts.
+void RecordTimings(AdaptiveTimeouts& timeouts, const std::string& endpoint, CURL* curl, CURLcode res) {
+    if (res != CURLE_OK && res != CURLE_OPERATION_TIMEDOUT) {
+        return;
+    }
+    curl_off_t total = 0;
+    curl_off_t connect = 0;
+    curl_off_t appConnect = 0;
+    curl_off_t preTransfer = 0;
+    long newConnections = 0;
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &preTransfer);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &newConnections);
+
+    // The connect timeout covers the TLS handshake as well
+    curl_off_t connectPhase = 0;
+    if (res == CURLE_OPERATION_TIMEDOUT && preTransfer == 0) {
+        connectPhase = total;  // Timed out while connecting
+    } else if (newConnections > 0) {
+        connectPhase = appConnect > 0 ? appConnect : connect;
+    }
+    // Rounded up: a sub-millisecond connect on a LAN is still a connect
+    using std::chrono::microseconds;
+    timeouts.Record(endpoint, std::chrono::ceil<AdaptiveTimeouts::Duration>(microseconds(connectPhase)),
+                    std::chrono::ceil<AdaptiveTimeouts::Duration>(microseconds(total)));
+}
+
+// Identifies the network link that cached connections were opened on
+std::string CurrentLinkSignature() {
 #ifdef TARGET_SIM800C
-        // GPRS/2G connections via SIM800C have very high latency (1-3 seconds per round trip)
-        // Increase timeouts significantly to accommodate slow mobile networks
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, timing::kHttpConnectTimeoutSim800cSec);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timing::kHttpTotalTimeoutSim800cSec);
+    const LinkMonitor& link = LinkMonitor::Instance();
+    if (link.IsRunning()) {
+        return link.Address();
+    }
+    return PppLinkSignature();
 #else
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, timing::kHttpConnectTimeoutSec);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timing::kHttpTotalTimeoutSec);
+    return {};
 #endif
+}
 
-        // Enable TCP keepalive
-        curl_easy_setopt(curl.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+} // namespace
 
-#ifdef TARGET_SIM800C
-        // Bind to PPP interface if available and not localhost
-        std::string host = ExtractHostFromUrl(baseAPI_);
-#ifdef USE_CARES
-        // DNS resolution list for CURLOPT_RESOLVE (must stay in scope until curl_easy_perform)
-        CurlSlist resolveList;
+
+// DNS cache and TLS session cache shared between the foreground handle and the async
+// requests of a backend, which use handles of their own
+struct Backend::CurlShare {
+    CurlShare() : handle(curl_share_init()) {
+        if (handle) {
+            curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, Lock);
+            curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, Unlock);
+            curl_share_setopt(handle, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+    }
+    ~CurlShare() {
+        if (handle) {
+            curl_share_cleanup(handle);
+        }
+    }
+
+    CurlShare(const CurlShare&) = delete;
+    CurlShare& operator=(const CurlShare&) = delete;
+
+    static void Lock(CURL* /*curl*/, curl_lock_data data, curl_lock_access /*access*/, void* userptr) {
+        static_cast<CurlShare*>(userptr)->locks[static_cast<std::size_t>(data) % CURL_LOCK_DATA_LAST].lock();
+    }
+    static void Unlock(CURL* /*curl*/, curl_lock_data data, void* userptr) {
+        static_cast<CurlShare*>(userptr)->locks[static_cast<std::size_t>(data) % CURL_LOCK_DATA_LAST].unlock();
+    }
+
+    // Apply a pending fresh-connect request to the next transfer
+    void TakeFreshConnect(CURL* curl) {
+        if (freshConnect.exchange(false)) {
+            curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+        }
+    }
+
+    CURLSH* handle;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> locks;
+    // A transfer failed: the pooled connection may be dead, open a new one next time
+    std::atomic<bool> freshConnect{false};
+};
+
+#ifdef USE_OPENSSL_TLS_SESSIONS
+namespace {
+
+// Each SSL_CTX holds a reference (std::shared_ptr<void>) to its Backend::TlsResumption:
+// curl's connections and their contexts live in the HTTP engine pool and may outlive the
+// backend that opened them
+void FreeTlsResumptionRef(void* /*parent*/, void* ptr, CRYPTO_EX_DATA* /*ad*/, int /*idx*/,
+                          long /*argl*/, void* /*argp*/) {
+    delete static_cast<std::shared_ptr<void>*>(ptr);
+}
+
+// SSL_CTX slot that leads the OpenSSL callbacks back to their Backend::TlsResumption
+int TlsResumptionIndex() {
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, FreeTlsResumptionRef);
+    return index;
+}
+
+} // namespace
 #endif
-        if (ShouldBindToPppInterface(host)) {
-            LOG_BCK_DEBUG("Binding to {} for host {}", kPppInterface, host);
-            curl_easy_setopt(curl.get(), CURLOPT_INTERFACE, kPppInterface);
-            
-#ifdef USE_CARES
-            // Use c-ares with Yandex DNS for hostname resolution
-            // Bind DNS queries to ppp0 interface via ares_set_local_dev()
-            // Then use CURLOPT_RESOLVE to provide the resolved IP to curl
-            // This preserves the hostname in the URL for Host header and SNI
-            SetupDnsResolution(curl.get(), resolveList, host, url);
+
+// Offers the persisted session of the backend in the first handshake of a connection and
+// persists every new session the server issues. It hooks the OpenSSL context curl builds for
+// each connection, so it needs a libcurl that uses OpenSSL; elsewhere TLS sessions are only
+// kept in memory by the CurlShare.
+struct Backend::TlsResumption : std::enable_shared_from_this<Backend::TlsResumption> {
+    TlsResumption(std::shared_ptr<TlsSessionStore> sessionStore, std::string peerKey)
+        : store(std::move(sessionStore))
+        , peer(std::move(peerKey)) {
+    }
+
+    static bool Available() {
+#ifdef USE_OPENSSL_TLS_SESSIONS
+        // Multi-backend builds put the backends that are not in use in parentheses
+        const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+        return info && info->ssl_version && std::strncmp(info->ssl_version, "OpenSSL/", 8) == 0;
+#else
+        return false;
 #endif
-        } else {
-            if (IsLocalhost(host)) {
-                LOG_BCK_DEBUG("Skipping {} binding for localhost: {}", kPppInterface, host);
-            } else {
-                LOG_BCK_DEBUG("Skipping {} binding for host {} (interface unavailable)", kPppInterface, host);
-            }
-        }
+    }
+
+    // Must be called after each curl_easy_reset()
+    void Attach(CURL* curl) {
+#ifdef USE_OPENSSL_TLS_SESSIONS
+        curl_easy_setopt(curl, CURLOPT_SSL_CTX_FUNCTION, OnSslContext);
+        curl_easy_setopt(curl, CURLOPT_SSL_CTX_DATA, this);
+#else
+        (void)curl;
 #endif
+    }
 
-        // Prepare headers using RAII wrapper
-        CurlSlist headers;
-        headers.append("Accept: */*");
-        headers.append("Content-Type: application/json");
-        
-        if (useBearerToken) {
-            std::string token = GetToken();
-            if (!token.empty()) {
-                std::string authHeader = "Authorization: Bearer " + token;
-                headers.append(authHeader.c_str());
+    std::shared_ptr<TlsSessionStore> store;
+    std::string peer;
+
+#ifdef USE_OPENSSL_TLS_SESSIONS
+    // Callbacks curl installed itself (its in-memory session cache); ours chain to them
+    std::atomic<int (*)(SSL*, SSL_SESSION*)> curlNewSession{nullptr};
+    std::atomic<void (*)(const SSL*, int, int)> curlInfo{nullptr};
+
+    static CURLcode OnSslContext(CURL* /*curl*/, void* sslctx, void* userptr) {
+        auto* self = static_cast<TlsResumption*>(userptr);
+        auto* ctx = static_cast<SSL_CTX*>(sslctx);
+        if (SSL_CTX_get_ex_data(ctx, TlsResumptionIndex()) == nullptr) {
+            SSL_CTX_set_ex_data(ctx, TlsResumptionIndex(), new std::shared_ptr<void>(self->shared_from_this()));
+        }
+        if (SSL_CTX_sess_get_new_cb(ctx) != OnNewSession) {
+            self->curlNewSession = SSL_CTX_sess_get_new_cb(ctx);
+            SSL_CTX_sess_set_new_cb(ctx, OnNewSession);
+        }
+        if (SSL_CTX_get_info_callback(ctx) != OnInfo) {
+            self->curlInfo = SSL_CTX_get_info_callback(ctx);
+            SSL_CTX_set_info_callback(ctx, OnInfo);
+        }
+        // The new-session callback only runs with client-side caching enabled
+        SSL_CTX_set_session_cache_mode(ctx, SSL_CTX_get_session_cache_mode(ctx) |
+                                            SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        return CURLE_OK;
+    }
+
+    static TlsResumption* From(const SSL* ssl) {
+        const auto* ref = static_cast<std::shared_ptr<void>*>(
+            SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), TlsResumptionIndex()));
+        return ref ? static_cast<TlsResumption*>(ref->get()) : nullptr;
+    }
+
+    // Session IDs arrive with the handshake, TLS 1.3 tickets after it
+    static int OnNewSession(SSL* ssl, SSL_SESSION* session) {
+        TlsResumption* self = From(ssl);
+        if (!self) {
+            return 0;
+        }
+        const int size = i2d_SSL_SESSION(session, nullptr);
+        if (size > 0) {
+            std::string serialized(static_cast<std::size_t>(size), '\0');
+            auto* out = reinterpret_cast<unsigned char*>(&serialized[0]);
+            // Runs on the HTTP I/O thread: only stage it, the store writes the file later
+            if (i2d_SSL_SESSION(session, &out) == size &&
+                !self->store->Stage(self->peer, serialized, TlsSessionStore::Now())) {
+                LOG_BCK_WARN("Failed to persist TLS session for {}", self->peer);
             }
         }
-        
-        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers.get());
-
-        // Set method and body
-        if (method == "POST") {
-            curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-            curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, bodyStr.c_str());
-            curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDSIZE, static_cast<long>(bodyStr.size()));
-        } else if (method == "GET") {
-            curl_easy_setopt(curl.get(), CURLOPT_HTTPGET, 1L);
-        } else {
-            LOG_BCK_ERROR("Unsupported HTTP method: {}", method);
-            networkError_ = true;
-            return BuildWrapperErrorResponse();
+        // curl's callback decides whether OpenSSL keeps the reference it hands over
+        const auto curlCallback = self->curlNewSession.load();
+        return curlCallback ? curlCallback(ssl, session) : 0;
+    }
+
+    static void OnInfo(const SSL* ssl, int where, int ret) {
+        TlsResumption* self = From(ssl);
+        if (!self) {
+            return;
+        }
+        if (const auto curlCallback = self->curlInfo.load()) {
+            curlCallback(ssl, where, ret);
+        }
+        // curl has already set the session from its own cache if it had one; the stored
+        // session only stands in when it had none (the first connection after startup)
+        if ((where & SSL_CB_HANDSHAKE_START) && SSL_get_session(ssl) == nullptr) {
+            self->Offer(const_cast<SSL*>(ssl));
         }
+    }
 
-        // Perform request
-        CURLcode res = curl_easy_perform(curl.get());
+    void Offer(SSL* ssl) {
+        const std::int64_t now = TlsSessionStore::Now();
+        const auto serialized = store->Load(peer, now);
+        if (!serialized) {
+            return;
+        }
+        const auto* in = reinterpret_cast<const unsigned char*>(serialized->data());
+        SSL_SESSION* session = d2i_SSL_SESSION(nullptr, &in, static_cast<long>(serialized->size()));
+        if (!session) {
+            LOG_BCK_WARN("Discarding unreadable persisted TLS session for {}", peer);
+            store->Forget(peer);
+            return;
+        }
+        if (SSL_SESSION_is_resumable(session) &&
+            SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) > now &&
+            SSL_set_session(ssl, session) == 1) {
+            LOG_BCK_DEBUG("Offering persisted TLS session for {}", peer);
+        }
+        SSL_SESSION_free(session);
+    }
+#endif
+};
 
-        if (res != CURLE_OK) {
-            std::string errorMsg = "HTTP request failed: ";
-            errorMsg += curl_easy_strerror(res);
-            LOG_BCK_ERROR("{}", errorMsg);
-            networkError_ = true;
-            return BuildWrapperErrorResponse();
+// Easy handle reused by every foreground request of a Backend. curl_easy_reset() between
+// requests clears the options but keeps the handle's DNS and TLS session caches; live
+// (keep-alive) connections are pooled by the HTTP engine.
+struct Backend::CurlConnection {
+    explicit CurlConnection(std::shared_ptr<CurlShare> sharedCache)
+        : share(std::move(sharedCache))
+        , curl(curl_easy_init()) {
+    }
+    ~CurlConnection() {
+        // The easy handle must let go of the share before the share can be cleaned up
+        if (curl) {
+            curl_easy_cleanup(curl);
         }
+    }
 
-        // Get HTTP status code
-        long httpCode = 0;
-        curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &httpCode);
-        
-        LOG_BCK_DEBUG("Response status: {} body: {}", httpCode, responseBody);
+    CurlConnection(const CurlConnection&) = delete;
+    CurlConnection& operator=(const CurlConnection&) = delete;
 
-        // Check HTTP status code
-        if (httpCode >= 200 && httpCode < 300) {
-            // Success response
-            nlohmann::json responseJson;
+    std::shared_ptr<CurlShare> share;
+    CURL* curl;
+    std::string link;            // CurrentLinkSignature() when the handle was built
+};
 
-            // Handle empty or "null" response
-            if (responseBody.empty() || responseBody == "null") {
-                responseJson = nlohmann::json(nullptr);
-            }
-            else {
-                try {
-                    responseJson = nlohmann::json::parse(responseBody);
-                }
-                catch (const std::exception& e) {
-                    LOG_BCK_ERROR("Failed to parse response JSON: {}", e.what());
-                    networkError_ = true;
-                    return BuildWrapperErrorResponse();
-                }
-            }
+// Parsed base URL and the endpoint templates of a backend, built on first use of each
+// endpoint. Shared with async transfers, which may outlive the backend.
+struct Backend::RequestTemplates {
+    explicit RequestTemplates(const std::string& baseAPI)
+#ifdef TARGET_SIM800C
+        // GPRS/2G connections via SIM800C have very high latency (1-3 seconds per round trip),
+        // so both the floors and the ceilings are much higher
+        : timeouts({timing::kHttpConnectTimeoutFloorSim800c, std::chrono::seconds(timing::kHttpConnectTimeoutSim800cSec)},
+                   {timing::kHttpTotalTimeoutFloorSim800c, std::chrono::seconds(timing::kHttpTotalTimeoutSim800cSec)})
+#else
+        : timeouts({timing::kHttpConnectTimeoutFloor, std::chrono::seconds(timing::kHttpConnectTimeoutSec)},
+                   {timing::kHttpTotalTimeoutFloor, std::chrono::seconds(timing::kHttpTotalTimeoutSec)})
+#endif
+    {
+        target.baseAPI = baseAPI;
+        target.host = ExtractHostFromUrl(baseAPI);
+#ifdef TARGET_SIM800C
+        target.localHost = IsLocalhost(target.host);
+#ifdef USE_CARES
+        target.port = ExtractPortFromUrl(baseAPI);
+#endif
+#endif
+        target.headers.append("Accept: */*");
+        target.headers.append("Content-Type: application/json");
+    }
 
-            return responseJson;
+    RequestTemplates(const RequestTemplates&) = delete;
+    RequestTemplates& operator=(const RequestTemplates&) = delete;
+
+    // Template of 'method path' for an endpoint; its query string is not part of the template
+    // (see TransferData::query), so paged listings share one. The reference stays valid
+    // for the lifetime of this object.
+    const EndpointTemplate& Get(const std::string& endpoint, const std::string& method) {
+        std::string path = EndpointPath(endpoint);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& forMethod = endpoints[method];
+        auto it = forMethod.find(path);
+        if (it == forMethod.end()) {
+            EndpointTemplate request;
+            request.endpoint = path;
+            request.method = method;
+            request.url = target.baseAPI + path;
+            request.post = method == "POST";
+            request.supported = request.post || method == "GET";
+            it = forMethod.emplace(std::move(path), std::move(request)).first;
         }
-        else {
-            // HTTP error response
-            std::ostringstream oss;
-            oss << "System error, code " << httpCode;
-            LOG_BCK_ERROR("{}", oss.str());
-            networkError_ = true;
+        return it->second;
+    }
+
+    ApiTarget target;
+    AdaptiveTimeouts timeouts;
+    std::mutex mutex;
+    // method -> path -> template (node-based: references are stable)
+    std::map<std::string, std::map<std::string, EndpointTemplate>> endpoints;
+};
+
+// Transfer of an async request with an easy handle of its own
+struct Backend::AsyncTransfer {
+    AsyncTransfer(std::shared_ptr<CurlShare> sharedCache, std::shared_ptr<RequestTemplates> requestTemplates)
+        : templates(std::move(requestTemplates))
+        , share(std::move(sharedCache)) {
+    }
+
+    // Declared before the handle so that the handle is cleaned up first
+    std::shared_ptr<RequestTemplates> templates;
+    std::shared_ptr<CurlShare> share;
+    CurlHandle curl;
+    TransferData data;
+};
+
+namespace {
+
+// Turn the outcome of a finished transfer into the HttpRequestWrapper response
+nlohmann::json ParseResponse(CURL* curl, CURLcode res, const std::string& responseBody, bool& networkError) {
+    networkError = true;
+    if (res != CURLE_OK) {
+        LOG_BCK_ERROR("HTTP request failed: {}", curl_easy_strerror(res));
+        return BuildWrapperErrorResponse();
+    }
+
+    // Get HTTP status code
+    long httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    long newConnections = 0;
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &newConnections);
+
+    LOG_BCK_DEBUG("Response status: {} body: {} (new connections: {})", httpCode, responseBody, newConnections);
+
+    if (httpCode < 200 || httpCode >= 300) {
+        LOG_BCK_ERROR("System error, code {}", httpCode);
+        return BuildWrapperErrorResponse();
+    }
+
+    // Handle empty or "null" response
+    nlohmann::json responseJson(nullptr);
+    if (!responseBody.empty() && responseBody != "null") {
+        try {
+            responseJson = nlohmann::json::parse(responseBody);
+        }
+        catch (const std::exception& e) {
+            LOG_BCK_ERROR("Failed to parse response JSON: {}", e.what());
             return BuildWrapperErrorResponse();
         }
     }
-    catch (const std::exception& e) {
-        LOG_BCK_ERROR("HTTP request exception: {}", e.what());
-        networkError_ = true;
+    networkError = false;
+    return responseJson;
+}
+
+// Response of a listing request: a 2xx body goes to the stream parser as it arrives,
+// so records are built while the page downloads; any other body is kept for ParseResponse
+struct RecordStream {
+    RecordStream(CURL* handle, const std::function<bool(const nlohmann::json&)>& onRecord, std::string& body)
+        : curl(handle)
+        , reader(onRecord)
+        , parser(reader)
+        , response(body) {
+    }
+
+    CURL* curl;
+    JsonRecordReader reader;
+    JsonStreamParser parser;
+    std::string& response;
+    std::size_t streamed = 0;
+    int status = 0;  // 0: no data yet, 1: streaming a 2xx body, -1: buffering an error body
+};
+
+size_t RecordStreamCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    const size_t totalSize = size * nmemb;
+    auto* stream = static_cast<RecordStream*>(userp);
+    if (stream->status == 0) {
+        long httpCode = 0;
+        curl_easy_getinfo(stream->curl, CURLINFO_RESPONSE_CODE, &httpCode);
+        stream->status = (httpCode >= 200 && httpCode < 300) ? 1 : -1;
+    }
+    if (stream->status < 0) {
+        stream->response.append(static_cast<char*>(contents), totalSize);
+        return totalSize;
+    }
+    stream->streamed += totalSize;
+    try {
+        // Returning less than totalSize aborts the transfer
+        return stream->parser.Feed(static_cast<const char*>(contents), totalSize) ? totalSize : 0;
+    } catch (const std::exception& e) {
+        LOG_BCK_ERROR("Failed to process response record: {}", e.what());
+        return 0;
+    }
+}
+
+// ParseResponse for a streamed listing; returns RecordStream::reader's result
+nlohmann::json ParseRecordStream(CURL* curl, CURLcode res, RecordStream& stream, bool& networkError) {
+    if (stream.reader.Stopped()) {
+        // A record was rejected by the caller; the server did answer
+        networkError = false;
+        return nlohmann::json::array();
+    }
+    if (stream.parser.Failed()) {
+        LOG_BCK_ERROR("Failed to parse response JSON: {}", stream.parser.Error());
+        networkError = true;
         return BuildWrapperErrorResponse();
     }
+    if (res != CURLE_OK || stream.status <= 0) {
+        // Transport errors, error statuses and empty bodies are handled as for other requests
+        return ParseResponse(curl, res, stream.response, networkError);
+    }
+
+    long httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    LOG_BCK_DEBUG("Response status: {} ({} bytes, {} records streamed)", httpCode, stream.streamed,
+                  stream.reader.RecordCount());
+
+    if (!stream.parser.Finish()) {
+        LOG_BCK_ERROR("Failed to parse response JSON: {}", stream.parser.Error());
+        networkError = true;
+        return BuildWrapperErrorResponse();
+    }
+    networkError = false;
+    return stream.reader.Result();
+}
+
+} // namespace
+
+Backend::CurlConnection* Backend::AcquireConnection() {
+    const std::string link = CurrentLinkSignature();
+    if (connection_ && connection_->link != link) {
+        LOG_BCK_INFO("Network link changed; dropping cached connections, DNS answers and TLS sessions");
+        connection_.reset();
+        HttpEngine::Shared().ResetConnections();
+    }
+
+    if (connection_) {
+        curl_easy_reset(connection_->curl);
+    } else {
+        auto share = std::make_shared<CurlShare>();
+        auto connection = std::make_unique<CurlConnection>(share);
+        if (!connection->curl) {
+            return nullptr;
+        }
+        connection->link = link;
+        connection_ = std::move(connection);
+        std::lock_guard<std::mutex> lock(shareMutex_);
+        share_ = std::move(share);
+    }
+
+    if (connection_->share->handle) {
+        curl_easy_setopt(connection_->curl, CURLOPT_SHARE, connection_->share->handle);
+    }
+    if (tls_) {
+        tls_->Attach(connection_->curl);
+    }
+    connection_->share->TakeFreshConnect(connection_->curl);
+    return connection_.get();
+}
+
+std::shared_ptr<Backend::CurlShare> Backend::CurrentShare() {
+    std::lock_guard<std::mutex> lock(shareMutex_);
+    if (!share_) {
+        share_ = std::make_shared<CurlShare>();
+    }
+    return share_;
+}
+
+Backend::Backend(const std::string& baseAPI, const std::string& controllerUid, std::shared_ptr<MessageStorage> storage,
+                 std::shared_ptr<TlsSessionStore> tlsSessions)
+    : BackendBase(controllerUid, std::move(storage))
+    , baseAPI_(baseAPI)
+    , templates_(std::make_shared<RequestTemplates>(baseAPI))
+{
+    // Initialize libcurl globally exactly once (thread-safe)
+    std::call_once(curl_init_flag, InitCurlGlobally);
+    LOG_BCK_INFO("Backend initialized (v{}) with base API: {} and controller UID: {}", FUELFLUX_VERSION, baseAPI_, controllerUid_);
+    if (tlsSessions) {
+        if (TlsResumption::Available()) {
+            tls_ = std::make_shared<TlsResumption>(std::move(tlsSessions), baseAPI_);
+        } else {
+            LOG_BCK_INFO("TLS sessions are not persisted: libcurl does not use OpenSSL or the build lacks it");
+        }
+    }
+}
+
+Backend::~Backend() {
+    // Do not call curl_global_cleanup() here - it's process-global and may affect other users
+    // Cleanup should happen at process shutdown, not per Backend instance
+}
+
+nlohmann::json Backend::HttpRequestWrapper(const std::string& endpoint,
+                                           const std::string& method,
+                                           const nlohmann::json& requestBody,
+                                           bool useBearerToken) {
+    return PerformRequest(endpoint, method, requestBody.dump(), useBearerToken ? GetToken() : std::string());
+}
+
+nlohmann::json Backend::HttpRequestWithBody(const std::string& endpoint,
+                                            const std::string& method,
+                                            const std::string& bodyStr,
+                                            bool useBearerToken) {
+    return PerformRequest(endpoint, method, bodyStr, useBearerToken ? GetToken() : std::string());
 }
 
 // Overload that accepts explicit token for async deauthorization
@@ -488,149 +1016,71 @@ nlohmann::json Backend::HttpRequestWrapper(const std::string& endpoint,
                                            const std::string& method,
                                            const nlohmann::json& requestBody,
                                            const std::string& bearerToken) {
+    return PerformRequest(endpoint, method, requestBody.dump(), bearerToken);
+}
+
+nlohmann::json Backend::HttpRequestRecords(const std::string& endpoint,
+                                           const std::string& method,
+                                           const nlohmann::json& requestBody,
+                                           bool useBearerToken,
+                                           const RecordCallback& onRecord) {
+    return PerformRequest(endpoint, method, requestBody.dump(), useBearerToken ? GetToken() : std::string(),
+                          &onRecord);
+}
+
+nlohmann::json Backend::PerformRequest(const std::string& endpoint,
+                                       const std::string& method,
+                                       const std::string& bodyStr,
+                                       const std::string& bearerToken,
+                                       const RecordCallback* onRecord) {
     std::lock_guard<std::recursive_mutex> lock(requestMutex_);
 
     networkError_ = false;
 
-    // Use RAII wrapper for CURL handle
-    CurlHandle curl;
-    if (!curl) {
+    // Long-lived handle: DNS answers and TLS sessions survive between requests
+    CurlConnection* connection = AcquireConnection();
+    if (!connection) {
         LOG_BCK_ERROR("Failed to initialize curl");
         networkError_ = true;
         return BuildWrapperErrorResponse();
     }
+    CURL* curl = connection->curl;
 
     try {
-        std::string url = baseAPI_ + endpoint;
-        std::string responseBody;
-        
-        // Compute body string once and reuse for both logging and POST
-        std::string bodyStr = requestBody.dump();
-        LOG_BCK_DEBUG("Request: {} {} with body: {}", method, endpoint, bodyStr);
+        const EndpointTemplate& request = templates_->Get(endpoint, method);
+        TransferData transfer;
+        transfer.body = bodyStr;
+        transfer.query = EndpointQuery(endpoint);
 
-        // Set URL
-        curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-        
-        // Set user agent
-        curl_easy_setopt(curl.get(), CURLOPT_USERAGENT, kUserAgent.c_str());
-        
-        // Set callback for response
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &responseBody);
-        
-        // Set timeouts
-#ifdef TARGET_SIM800C
-        // GPRS/2G connections via SIM800C have very high latency (1-3 seconds per round trip)
-        // Increase timeouts significantly to accommodate slow mobile networks
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, timing::kHttpConnectTimeoutSim800cSec);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timing::kHttpTotalTimeoutSim800cSec);
-#else
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, timing::kHttpConnectTimeoutSec);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timing::kHttpTotalTimeoutSec);
-#endif
-
-        // Enable TCP keepalive
-        curl_easy_setopt(curl.get(), CURLOPT_TCP_KEEPALIVE, 1L);
-
-#ifdef TARGET_SIM800C
-        // Bind to PPP interface if available and not localhost
-        std::string host = ExtractHostFromUrl(baseAPI_);
-#ifdef USE_CARES
-        // DNS resolution list for CURLOPT_RESOLVE (must stay in scope until curl_easy_perform)
-        CurlSlist resolveList;
-#endif
-        if (ShouldBindToPppInterface(host)) {
-            LOG_BCK_DEBUG("Binding to {} for host {}", kPppInterface, host);
-            curl_easy_setopt(curl.get(), CURLOPT_INTERFACE, kPppInterface);
-            
-#ifdef USE_CARES
-            // Use c-ares with Yandex DNS for hostname resolution
-            // Bind DNS queries to ppp0 interface via ares_set_local_dev()
-            // Then use CURLOPT_RESOLVE to provide the resolved IP to curl
-            // This preserves the hostname in the URL for Host header and SNI
-            SetupDnsResolution(curl.get(), resolveList, host, url);
-#endif
-        } else {
-            if (IsLocalhost(host)) {
-                LOG_BCK_DEBUG("Skipping {} binding for localhost: {}", kPppInterface, host);
-            } else {
-                LOG_BCK_DEBUG("Skipping {} binding for host {} (interface unavailable)", kPppInterface, host);
-            }
-        }
-#endif
+        LOG_BCK_DEBUG("Request: {} {} with body: {}", method, endpoint, bodyStr);
 
-        // Prepare headers using RAII wrapper with explicit token
-        CurlSlist headers;
-        headers.append("Accept: */*");
-        headers.append("Content-Type: application/json");
-        
-        if (!bearerToken.empty()) {
-            std::string authHeader = "Authorization: Bearer " + bearerToken;
-            headers.append(authHeader.c_str());
-        }
-        
-        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers.get());
-
-        // Set method and body
-        if (method == "POST") {
-            curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-            curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, bodyStr.c_str());
-            curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDSIZE, static_cast<long>(bodyStr.size()));
-        } else if (method == "GET") {
-            curl_easy_setopt(curl.get(), CURLOPT_HTTPGET, 1L);
-        } else {
-            LOG_BCK_ERROR("Unsupported HTTP method: {}", method);
+        if (!ConfigureTransfer(curl, transfer, templates_->target, request, templates_->timeouts.For(endpoint),
+                               bearerToken, "")) {
             networkError_ = true;
             return BuildWrapperErrorResponse();
         }
 
-        // Perform request
-        CURLcode res = curl_easy_perform(curl.get());
+        // Listings are parsed chunk by chunk instead of being buffered whole
+        std::unique_ptr<RecordStream> stream;
+        if (onRecord) {
+            stream = std::make_unique<RecordStream>(curl, *onRecord, transfer.response);
+            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, RecordStreamCallback);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, stream.get());
+        }
 
+        // Runs on the shared HTTP engine thread, overlapping with other backends' requests
+        const CURLcode res = HttpEngine::Shared().Perform(curl);
+        RecordTimings(templates_->timeouts, endpoint, curl, res);
         if (res != CURLE_OK) {
-            std::string errorMsg = "HTTP request failed: ";
-            errorMsg += curl_easy_strerror(res);
-            LOG_BCK_ERROR("{}", errorMsg);
-            networkError_ = true;
-            return BuildWrapperErrorResponse();
+            // The pooled connection may be dead; open a new one next time (TLS sessions stay)
+            connection->share->freshConnect = true;
         }
 
-        // Get HTTP status code
-        long httpCode = 0;
-        curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &httpCode);
-        
-        LOG_BCK_DEBUG("Response status: {} body: {}", httpCode, responseBody);
-
-        // Check HTTP status code
-        if (httpCode >= 200 && httpCode < 300) {
-            // Success response
-            nlohmann::json responseJson;
-
-            // Handle empty or "null" response
-            if (responseBody.empty() || responseBody == "null") {
-                responseJson = nlohmann::json(nullptr);
-            }
-            else {
-                try {
-                    responseJson = nlohmann::json::parse(responseBody);
-                }
-                catch (const std::exception& e) {
-                    LOG_BCK_ERROR("Failed to parse response JSON: {}", e.what());
-                    networkError_ = true;
-                    return BuildWrapperErrorResponse();
-                }
-            }
-
-            return responseJson;
-        }
-        else {
-            // HTTP error response
-            std::ostringstream oss;
-            oss << "System error, code " << httpCode;
-            LOG_BCK_ERROR("{}", oss.str());
-            networkError_ = true;
-            return BuildWrapperErrorResponse();
-        }
+        bool networkError = false;
+        nlohmann::json response = stream ? ParseRecordStream(curl, res, *stream, networkError)
+                                         : ParseResponse(curl, res, transfer.response, networkError);
+        networkError_ = networkError;
+        return response;
     }
     catch (const std::exception& e) {
         LOG_BCK_ERROR("HTTP request exception: {}", e.what());
@@ -639,103 +1089,123 @@ nlohmann::json Backend::HttpRequestWrapper(const std::string& endpoint,
     }
 }
 
-// Static helper for async deauthorize - doesn't use mutex or modify state
-void Backend::SendAsyncDeauthorize(const std::string& baseAPI, const std::string& token) {
-    // Use RAII wrapper for CURL handle
-    CurlHandle curl;
+void Backend::HttpRequestAsync(const std::string& endpoint,
+                               const std::string& method,
+                               const nlohmann::json& requestBody,
+                               const std::string& bearerToken,
+                               ResponseCallback done) {
+    // A handle of its own, so it can overlap with the foreground handle; the engine's
+    // connection pool and the share still spare it the connect and the TLS handshake.
+    // DNS (SIM800C) comes from the c-ares cache only, so the calling thread never waits.
+    auto transfer = std::make_shared<AsyncTransfer>(CurrentShare(), templates_);
+    CURL* curl = transfer->curl.get();
     if (!curl) {
-        LOG_BCK_WARN("Async deauthorize: Failed to initialize curl");
+        LOG_BCK_ERROR("Failed to initialize curl");
+        done(BuildWrapperErrorResponse(), true);
         return;
     }
 
     try {
-        std::string url = baseAPI + "/api/pump/deauthorize";
-        std::string responseBody;
-        std::string bodyStr = "{}";
-        
-        LOG_BCK_DEBUG("Async deauthorize: POST /api/pump/deauthorize");
-
-        // Set URL
-        curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-        
-        // Set user agent
-        curl_easy_setopt(curl.get(), CURLOPT_USERAGENT, kUserAgent.c_str());
-        
-        // Set callback for response
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &responseBody);
-        
-        // Set timeouts
-#ifdef TARGET_SIM800C
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, timing::kHttpConnectTimeoutSim800cSec);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timing::kHttpTotalTimeoutSim800cSec);
-#else
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, timing::kHttpConnectTimeoutSec);
-        curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timing::kHttpTotalTimeoutSec);
-#endif
+        if (transfer->share->handle) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, transfer->share->handle);
+        }
+        if (tls_) {
+            tls_->Attach(curl);
+        }
+        transfer->share->TakeFreshConnect(curl);
 
-        // Enable TCP keepalive
-        curl_easy_setopt(curl.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+        const EndpointTemplate& request = templates_->Get(endpoint, method);
+        transfer->data.body = requestBody.dump();
+        transfer->data.query = EndpointQuery(endpoint);
+        LOG_BCK_DEBUG("Async request: {} {} with body: {}", method, endpoint, transfer->data.body);
 
-#ifdef TARGET_SIM800C
-        // Bind to PPP interface if available and not localhost
-        std::string host = ExtractHostFromUrl(baseAPI);
-#ifdef USE_CARES
-        // DNS resolution list for CURLOPT_RESOLVE (must stay in scope until curl_easy_perform)
-        CurlSlist resolveList;
-#endif
-        if (ShouldBindToPppInterface(host)) {
-            LOG_BCK_DEBUG("Async deauthorize: Binding to {} for host {}", kPppInterface, host);
-            curl_easy_setopt(curl.get(), CURLOPT_INTERFACE, kPppInterface);
-            
-#ifdef USE_CARES
-            // Use c-ares with Yandex DNS for hostname resolution via ppp0
-            SetupDnsResolution(curl.get(), resolveList, host, url, "Async deauthorize: ");
-#endif
+        if (!ConfigureTransfer(curl, transfer->data, templates_->target, request, templates_->timeouts.For(endpoint),
+                               bearerToken, "Async request: ", true)) {
+            done(BuildWrapperErrorResponse(), true);
+            return;
         }
-#endif
+    }
+    catch (const std::exception& e) {
+        LOG_BCK_ERROR("HTTP request exception: {}", e.what());
+        done(BuildWrapperErrorResponse(), true);
+        return;
+    }
 
-        // Prepare headers with token
-        CurlSlist headers;
-        headers.append("Accept: */*");
-        headers.append("Content-Type: application/json");
-        
-        if (!token.empty()) {
-            std::string authHeader = "Authorization: Bearer " + token;
-            headers.append(authHeader.c_str());
+    const bool submitted = HttpEngine::Shared().Submit(curl, [transfer, endpoint, done](CURLcode res) {
+        RecordTimings(transfer->templates->timeouts, endpoint, transfer->curl.get(), res);
+        if (res != CURLE_OK) {
+            transfer->share->freshConnect = true;
         }
-        
-        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, headers.get());
-
-        // Set POST method and body
-        curl_easy_setopt(curl.get(), CURLOPT_POST, 1L);
-        curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, bodyStr.c_str());
-        curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDSIZE, static_cast<long>(bodyStr.size()));
+        bool networkError = false;
+        const nlohmann::json response = ParseResponse(transfer->curl.get(), res, transfer->data.response, networkError);
+        done(response, networkError);
+    });
+    if (!submitted) {
+        LOG_BCK_ERROR("HTTP engine is shut down; request {} {} not sent", method, endpoint);
+        done(BuildWrapperErrorResponse(), true);
+    }
+}
 
-        // Perform request
-        CURLcode res = curl_easy_perform(curl.get());
+void Backend::ProbeBackend(std::function<void(bool reachable)> done) {
+    auto transfer = std::make_shared<AsyncTransfer>(CurrentShare(), templates_);
+    CURL* curl = transfer->curl.get();
+    if (!curl) {
+        LOG_BCK_ERROR("Failed to initialize curl");
+        done(false);
+        return;
+    }
 
-        if (res != CURLE_OK) {
-            LOG_BCK_WARN("Async deauthorize request failed (ignored): {}", curl_easy_strerror(res));
-        } else {
-            long httpCode = 0;
-            curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, &httpCode);
-            LOG_BCK_DEBUG("Async deauthorize response status: {}", httpCode);
-            if (httpCode >= 200 && httpCode < 300) {
-                LOG_BCK_INFO("Async deauthorization completed successfully");
-            } else {
-                LOG_BCK_WARN("Async deauthorize returned HTTP {}", httpCode);
-            }
+    try {
+        if (transfer->share->handle) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, transfer->share->handle);
         }
+        if (tls_) {
+            tls_->Attach(curl);
+        }
+        const EndpointTemplate& request = templates_->Get("/", "GET");
+        if (!ConfigureTransfer(curl, transfer->data, templates_->target, request, templates_->timeouts.For("/"),
+                               std::string(), "Probe: ", true)) {
+            done(false);
+            return;
+        }
+        // Only the connection is set up; a pooled one proves nothing, the backend may
+        // have gone away since it was opened
+        curl_easy_setopt(curl, CURLOPT_CONNECT_ONLY, 1L);
+        curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
     }
     catch (const std::exception& e) {
-        LOG_BCK_WARN("Async deauthorize exception (ignored): {}", e.what());
+        LOG_BCK_ERROR("Backend probe exception: {}", e.what());
+        done(false);
+        return;
     }
+
+    const bool submitted = HttpEngine::Shared().Submit(curl, [transfer, done](CURLcode res) {
+        if (res != CURLE_OK) {
+            LOG_BCK_DEBUG("Backend probe failed: {}", curl_easy_strerror(res));
+        }
+        done(res == CURLE_OK);
+    });
+    if (!submitted) {
+        done(false);
+    }
+}
+
+void Backend::StartDeauthorizeRequest(const std::string& token) {
+    // Sent on the HTTP engine thread; the executor thread is not needed
+    HttpRequestAsync("/api/pump/deauthorize", "POST", nlohmann::json::object(), token,
+                     [](const nlohmann::json& response, bool /*networkError*/) {
+        std::string responseError;
+        if (IsErrorResponse(response, &responseError)) {
+            LOG_BCK_WARN("Async deauthorize failed (ignored): {}", responseError);
+        } else {
+            LOG_BCK_INFO("Async deauthorization completed successfully");
+        }
+    });
 }
 
 // Send async deauthorize request without mutex
 void Backend::SendAsyncDeauthorizeRequest(const std::string& token) {
-    SendAsyncDeauthorize(baseAPI_, token);
+    StartDeauthorizeRequest(token);
 }
 
 } // namespace fuelflux
@@ -6,16 +6,128 @@
 
 #include <algorithm>
 #include <chrono>
+#include <future>
 #include <stdexcept>
 #include <thread>
 
 #include "backend_utils.h"
+#include "backlog_payload.h"
+#include "connectivity_signal.h"
 #include "logger.h"
 #include "message_storage.h"
 #include "timing_config.h"
 
 namespace fuelflux {
 
+namespace {
+
+// Parse a card object shared by the full and delta card listings.
+// Leaves card.uid empty when the item has no UID; returns false on a malformed Allowance.
+bool ParseUserCard(const nlohmann::json& item, UserCard& card) {
+    if (!item.contains("Uid") || !item["Uid"].is_string()) {
+        return true;
+    }
+    card.uid = item["Uid"].get<std::string>();
+    if (item.contains("RoleId") && item["RoleId"].is_number_integer()) {
+        card.roleId = item["RoleId"].get<int>();
+    }
+    if (item.contains("Allowance") && !item["Allowance"].is_null()) {
+        if (!item["Allowance"].is_number()) {
+            return false;
+        }
+        card.allowance = item["Allowance"].get<double>();
+    }
+    return true;
+}
+
+// Append an item of a card listing; items that are not objects or have no UID are skipped.
+// Returns false on a malformed card.
+bool AddUserCard(const nlohmann::json& item, std::vector<UserCard>& cards) {
+    if (!item.is_object()) {
+        return true;
+    }
+    UserCard card;
+    if (!ParseUserCard(item, card)) {
+        return false;
+    }
+    if (!card.uid.empty()) {
+        cards.push_back(std::move(card));
+    }
+    return true;
+}
+
+// Append an item of a tank listing; items without an integer VisualNumberTank are skipped.
+// Returns false on a malformed Volume.
+bool AddFuelTank(const nlohmann::json& item, std::vector<FuelTank>& tanks) {
+    if (!item.is_object()) {
+        return true;
+    }
+    if (!item.contains("VisualNumberTank") || !item["VisualNumberTank"].is_number_integer()) {
+        return true;
+    }
+
+    FuelTank tank;
+    tank.visualNumberTank = item["VisualNumberTank"].get<int>();
+
+    if (item.contains("IdTank") && item["IdTank"].is_number_integer()) {
+        tank.idTank = item["IdTank"].get<int>();
+    }
+    if (item.contains("NameTank") && item["NameTank"].is_string()) {
+        tank.nameTank = item["NameTank"].get<std::string>();
+    }
+    if (item.contains("Volume") && !item["Volume"].is_null()) {
+        if (!item["Volume"].is_number()) {
+            return false;
+        }
+        tank.volume = item["Volume"].get<double>();
+    }
+
+    tanks.push_back(std::move(tank));
+    return true;
+}
+
+std::string UserCardsEndpoint(int first, int number) {
+    return "/api/pump/cards?first=" + std::to_string(first) + "&number=" + std::to_string(number);
+}
+
+template <typename T>
+std::future<T> ReadyFuture(T value) {
+    std::promise<T> promise;
+    promise.set_value(std::move(value));
+    return promise.get_future();
+}
+
+// Connectivity report of every foreground request
+void ReportConnectivity(bool networkError) {
+    if (networkError) {
+        ConnectivitySignal::Instance().ReportNetworkError();
+    } else {
+        ConnectivitySignal::Instance().ReportSuccess();
+    }
+}
+
+} // namespace
+
+std::future<bool> IBackend::AuthorizeAsync(const std::string& uid) {
+    return ReadyFuture(Authorize(uid));
+}
+
+std::future<bool> IBackend::DeauthorizeAsync() {
+    return ReadyFuture(Deauthorize());
+}
+
+std::future<bool> IBackend::RefuelAsync(TankNumber tankNumber, Volume volume) {
+    return ReadyFuture(Refuel(tankNumber, volume));
+}
+
+std::future<bool> IBackend::IntakeAsync(TankNumber tankNumber, Volume volume, IntakeDirection direction) {
+    return ReadyFuture(Intake(tankNumber, volume, direction));
+}
+
+std::future<std::vector<UserCard>> IBackend::FetchUserCardsAsync(int first, int number) {
+    return ReadyFuture(FetchUserCards(first, number));
+}
+
 // Meyer's singleton for bounded executor - thread-safe lazy initialization
 // Initialized on first use, avoiding static initialization order issues
 // and allowing exception handling at runtime instead of during startup
@@ -27,31 +139,51 @@ BoundedExecutor& BackendBase::GetDeauthorizeExecutor() {
 BackendBase::BackendBase(std::string controllerUid, std::shared_ptr<MessageStorage> storage)
     : controllerUid_(std::move(controllerUid))
     , storage_(std::move(storage))
+    , breaker_(std::make_shared<CircuitBreaker>(timing::kBackendCircuitFailureThreshold,
+                                                timing::kBackendCircuitProbeInterval))
 {
 }
 
 bool BackendBase::Authorize(const std::string& uid) {
+    nlohmann::json requestBody;
+    if (!BeginAuthorize(uid, requestBody)) {
+        return false;
+    }
+
+    nlohmann::json response;
     try {
-        if (session_.IsAuthorized()) {
-            LOG_BCK_ERROR("{}", "Already authorized. Call Deauthorize first.");
-            lastError_ = StdControllerError;
-            return false;
-        }
+        response = SendRequest("/api/pump/authorize", "POST", requestBody, false);
+    } catch (const std::exception& e) {
+        LOG_BCK_ERROR("Authorization failed: {}", e.what());
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        LOG_BCK_INFO("Authorizing card UID: {}", uid);
+#ifdef ENABLE_AUTH_DELAY
+    // Add delay for testing/simulation purposes
+    LOG_BCK_INFO("ENABLE_AUTH_DELAY is set, adding {}-second authorization delay", timing::kAuthDelay.count());
+    std::this_thread::sleep_for(timing::kAuthDelay);
+#endif
 
-        nlohmann::json requestBody;
-        requestBody["CardUid"] = uid;
-        requestBody["PumpControllerUid"] = controllerUid_;
+    return FinishAuthorize(uid, response);
+}
 
-        nlohmann::json response = HttpRequestWrapper("/api/pump/authorize", "POST", requestBody, false);
+bool BackendBase::BeginAuthorize(const std::string& uid, nlohmann::json& requestBody) {
+    if (session_.IsAuthorized()) {
+        LOG_BCK_ERROR("{}", "Already authorized. Call Deauthorize first.");
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-#ifdef ENABLE_AUTH_DELAY
-        // Add delay for testing/simulation purposes
-        LOG_BCK_INFO("ENABLE_AUTH_DELAY is set, adding {}-second authorization delay", timing::kAuthDelay.count());
-        std::this_thread::sleep_for(timing::kAuthDelay);
-#endif
+    LOG_BCK_INFO("Authorizing card UID: {}", uid);
 
+    requestBody["CardUid"] = uid;
+    requestBody["PumpControllerUid"] = controllerUid_;
+    return true;
+}
+
+bool BackendBase::FinishAuthorize(const std::string& uid, const nlohmann::json& response) {
+    try {
         std::string responseError;
         if (IsErrorResponse(response, &responseError)) {
             LOG_BCK_ERROR("Authorization failed: {}", responseError);
@@ -146,58 +278,127 @@ bool BackendBase::Authorize(const std::string& uid) {
     }
 }
 
-bool BackendBase::Deauthorize() {
+bool BackendBase::AdmitRequest() {
+    if (breaker_->Allow()) {
+        return true;
+    }
+    if (breaker_->TryStartProbe()) {
+        LOG_BCK_INFO("Probing the backend");
+        ProbeBackend([breaker = breaker_](bool reachable) {
+            breaker->ProbeFinished(reachable);
+            if (reachable) {
+                // Wakes the backlog worker, whose next request is the trial
+                ConnectivitySignal::Instance().ReportSuccess();
+            }
+        });
+        // A probe that finished right away may have let this request through
+        return breaker_->Allow();
+    }
+    return false;
+}
+
+void BackendBase::ProbeBackend(std::function<void(bool reachable)> done) {
+    done(true);
+}
+
+nlohmann::json BackendBase::SendGuarded(const std::string& endpoint, const std::function<nlohmann::json()>& send) {
+    if (!AdmitRequest()) {
+        LOG_BCK_DEBUG("Backend circuit is open; {} fails without a request", endpoint);
+        networkError_ = true;
+        return BuildWrapperErrorResponse();
+    }
+    nlohmann::json response;
     try {
-        if (!session_.IsAuthorized()) {
-            LOG_BCK_ERROR("{}", "Not authorized. Call Authorize first.");
-            lastError_ = StdControllerError;
-            return false;
+        response = send();
+    } catch (...) {
+        breaker_->Cancel();
+        throw;
+    }
+    breaker_->RecordResult(!networkError_);
+    ReportConnectivity(networkError_);
+    return response;
+}
+
+nlohmann::json BackendBase::SendRequest(const std::string& endpoint,
+                                        const std::string& method,
+                                        const nlohmann::json& requestBody,
+                                        bool useBearerToken) {
+    return SendGuarded(endpoint, [&]() { return HttpRequestWrapper(endpoint, method, requestBody, useBearerToken); });
+}
+
+nlohmann::json BackendBase::SendRequestWithBody(const std::string& endpoint,
+                                                const std::string& method,
+                                                const std::string& body,
+                                                bool useBearerToken) {
+    return SendGuarded(endpoint, [&]() { return HttpRequestWithBody(endpoint, method, body, useBearerToken); });
+}
+
+nlohmann::json BackendBase::SendRecordsRequest(const std::string& endpoint,
+                                               const std::string& method,
+                                               const nlohmann::json& requestBody,
+                                               bool useBearerToken,
+                                               const RecordCallback& onRecord) {
+    return SendGuarded(endpoint, [&]() {
+        return HttpRequestRecords(endpoint, method, requestBody, useBearerToken, onRecord);
+    });
+}
+
+nlohmann::json BackendBase::HttpRequestRecords(const std::string& endpoint,
+                                               const std::string& method,
+                                               const nlohmann::json& requestBody,
+                                               bool useBearerToken,
+                                               const RecordCallback& onRecord) {
+    nlohmann::json response = HttpRequestWrapper(endpoint, method, requestBody, useBearerToken);
+    if (!response.is_array()) {
+        return response;
+    }
+    for (const auto& item : response) {
+        if (!onRecord(item)) {
+            break;
         }
+    }
+    return nlohmann::json::array();
+}
 
-        LOG_BCK_INFO("Deauthorizing (async)");
+nlohmann::json BackendBase::HttpRequestWithBody(const std::string& endpoint,
+                                                const std::string& method,
+                                                const std::string& body,
+                                                bool useBearerToken) {
+    return HttpRequestWrapper(endpoint, method, nlohmann::json::parse(body), useBearerToken);
+}
 
-        // Capture token for async HTTP request
-        std::string token = session_.GetToken();
-        
-        // Clear state immediately (fire-and-forget pattern)
-        // Backend drops sessions on timeout, so we don't wait for HTTP response
-        session_.Clear();
-        roleId_ = 0;
-        allowance_ = 0.0;
-        price_ = 0.0;
-        fuelTanks_.clear();
-        authorizedUid_.clear();
-        lastError_.clear();
+std::optional<std::string> BackendBase::EndSession() {
+    if (!session_.IsAuthorized()) {
+        LOG_BCK_ERROR("{}", "Not authorized. Call Authorize first.");
+        lastError_ = StdControllerError;
+        return std::nullopt;
+    }
 
-        // Try to submit async HTTP request to bounded executor if backend is managed by shared_ptr
-        // Uses a dedicated async method that doesn't hold requestMutex_ or modify networkError_
-        try {
-            std::weak_ptr<BackendBase> weakSelf = shared_from_this();
-            bool submitted = GetDeauthorizeExecutor().Submit([weakSelf, token]() {
-                // Check if backend still exists
-                if (auto self = weakSelf.lock()) {
-                    try {
-                        // Call virtual method that sends request without mutex
-                        self->SendAsyncDeauthorizeRequest(token);
-                    } catch (const std::exception& e) {
-                        LOG_BCK_WARN("Async deauthorization failed (ignored): {}", e.what());
-                    }
-                }
-            });
-            
-            if (!submitted) {
-                LOG_BCK_WARN("Deauthorize executor queue full, dropping async request (state cleared)");
-            }
-        } catch (const std::bad_weak_ptr&) {
-            // Backend is not managed by shared_ptr (likely in test environment)
-            // Send synchronous request but still return immediately after clearing state
-            try {
-                SendAsyncDeauthorizeRequest(token);
-            } catch (const std::exception& e) {
-                LOG_BCK_WARN("Deauthorization request failed (ignored): {}", e.what());
-            }
+    // Capture token for async HTTP request
+    std::string token = session_.GetToken();
+
+    // Clear state immediately (fire-and-forget pattern)
+    // Backend drops sessions on timeout, so we don't wait for HTTP response
+    session_.Clear();
+    roleId_ = 0;
+    allowance_ = 0.0;
+    price_ = 0.0;
+    fuelTanks_.clear();
+    authorizedUid_.clear();
+    lastError_.clear();
+    return token;
+}
+
+bool BackendBase::Deauthorize() {
+    try {
+        const auto token = EndSession();
+        if (!token) {
+            return false;
         }
 
+        LOG_BCK_INFO("Deauthorizing (async)");
+        StartDeauthorizeRequest(*token);
+
         LOG_BCK_INFO("Deauthorization initiated (state cleared immediately)");
         return true;
     } catch (const std::exception& e) {
@@ -215,62 +416,112 @@ bool BackendBase::Deauthorize() {
     }
 }
 
-bool BackendBase::Refuel(TankNumber tankNumber, Volume volume) {
+void BackendBase::StartDeauthorizeRequest(const std::string& token) {
+    // Try to submit async HTTP request to bounded executor if backend is managed by shared_ptr
+    // Uses a dedicated async method that doesn't hold requestMutex_ or modify networkError_
     try {
-        if (!session_.IsAuthorized()) {
-            LOG_BCK_ERROR("Invalid refueling report: backend is not authorized");
-            lastError_ = StdControllerError;
-            return false;
-        }
+        std::weak_ptr<BackendBase> weakSelf = shared_from_this();
+        bool submitted = GetDeauthorizeExecutor().Submit([weakSelf, token]() {
+            // Check if backend still exists
+            if (auto self = weakSelf.lock()) {
+                try {
+                    // Call virtual method that sends request without mutex
+                    self->SendAsyncDeauthorizeRequest(token);
+                } catch (const std::exception& e) {
+                    LOG_BCK_WARN("Async deauthorization failed (ignored): {}", e.what());
+                }
+            }
+        });
 
-        if (roleId_ != static_cast<int>(UserRole::Customer)) {
-            LOG_BCK_ERROR("Invalid refueling report: role {} is not allowed (expected Customer)", roleId_);
-            lastError_ = StdControllerError;
-            return false;
+        if (!submitted) {
+            LOG_BCK_WARN("Deauthorize executor queue full, dropping async request (state cleared)");
         }
-
-        const auto tankIt = std::find_if(
-            fuelTanks_.begin(),
-            fuelTanks_.end(),
-            [tankNumber](const BackendTankInfo& tank) { return tank.visualNumberTank == tankNumber; });
-        if (tankIt == fuelTanks_.end()) {
-            LOG_BCK_ERROR("Invalid refueling report: tank {} not found in authorized tanks", tankNumber);
-            lastError_ = StdControllerError;
-            return false;
+    } catch (const std::bad_weak_ptr&) {
+        // Backend is not managed by shared_ptr (likely in test environment)
+        // Send synchronous request but still return immediately after clearing state
+        try {
+            SendAsyncDeauthorizeRequest(token);
+        } catch (const std::exception& e) {
+            LOG_BCK_WARN("Deauthorization request failed (ignored): {}", e.what());
         }
+    }
+}
 
-        if (volume < 0.0) {
-            LOG_BCK_ERROR("Invalid refueling report: volume {} must be non-negative", volume);
-            lastError_ = StdControllerError;
-            return false;
+bool BackendBase::Refuel(TankNumber tankNumber, Volume volume) {
+    nlohmann::json requestBody;
+    if (!BeginRefuel(tankNumber, volume, requestBody)) {
+        return false;
+    }
+    nlohmann::json response;
+    try {
+        response = SendRequest("/api/pump/refuel", "POST", requestBody, true);
+    } catch (const std::exception& e) {
+        LOG_BCK_ERROR("Failed to send refueling report: {}", e.what());
+        if (lastError_.empty()) {
+            lastError_ = StdBackendError;
         }
+        return false;
+    }
+    return FinishRefuel(volume, requestBody, response);
+}
 
-        if (volume > allowance_) {
-            LOG_BCK_ERROR("Invalid refueling report: volume {} exceeds allowance {}", volume, allowance_);
-            lastError_ = StdControllerError;
-            return false;
-        }
+bool BackendBase::BeginRefuel(TankNumber tankNumber, Volume volume, nlohmann::json& requestBody) {
+    if (!session_.IsAuthorized()) {
+        LOG_BCK_ERROR("Invalid refueling report: backend is not authorized");
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        const auto now = std::chrono::system_clock::now();
-        const auto timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                     now.time_since_epoch())
-                                     .count();
+    if (roleId_ != static_cast<int>(UserRole::Customer)) {
+        LOG_BCK_ERROR("Invalid refueling report: role {} is not allowed (expected Customer)", roleId_);
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        nlohmann::json requestBody;
-        requestBody["TankNumber"] = tankIt->idTank;
-        requestBody["FuelVolume"] = volume;
-        requestBody["TimeAt"] = timestampMs;
+    const auto tankIt = std::find_if(
+        fuelTanks_.begin(),
+        fuelTanks_.end(),
+        [tankNumber](const BackendTankInfo& tank) { return tank.visualNumberTank == tankNumber; });
+    if (tankIt == fuelTanks_.end()) {
+        LOG_BCK_ERROR("Invalid refueling report: tank {} not found in authorized tanks", tankNumber);
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        LOG_BCK_INFO("Refueling report: tank={}, volume={}, timestamp_ms={}", tankNumber, volume, timestampMs);
+    if (volume < 0.0) {
+        LOG_BCK_ERROR("Invalid refueling report: volume {} must be non-negative", volume);
+        lastError_ = StdControllerError;
+        return false;
+    }
+
+    if (volume > allowance_) {
+        LOG_BCK_ERROR("Invalid refueling report: volume {} exceeds allowance {}", volume, allowance_);
+        lastError_ = StdControllerError;
+        return false;
+    }
+
+    const auto now = std::chrono::system_clock::now();
+    const auto timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 now.time_since_epoch())
+                                 .count();
+
+    requestBody["TankNumber"] = tankIt->idTank;
+    requestBody["FuelVolume"] = volume;
+    requestBody["TimeAt"] = timestampMs;
+
+    LOG_BCK_INFO("Refueling report: tank={}, volume={}, timestamp_ms={}", tankNumber, volume, timestampMs);
+    return true;
+}
 
-        nlohmann::json response = HttpRequestWrapper("/api/pump/refuel", "POST", requestBody, true);
+bool BackendBase::FinishRefuel(Volume volume, const nlohmann::json& requestBody, const nlohmann::json& response) {
+    try {
         std::string responseError;
         if (IsErrorResponse(response, &responseError)) {
             LOG_BCK_ERROR("Failed to send refueling report: {}", responseError);
             if (storage_ && !authorizedUid_.empty()) {
                 const int errorCode = response.value("CodeError", 0);
                 if (errorCode == HttpRequestWrapperErrorCode) {
-                    storage_->AddBacklog(authorizedUid_, MessageMethod::Refuel, requestBody.dump());
+                    storage_->AddBacklog(authorizedUid_, MessageMethod::Refuel, EncodeBacklogPayload(requestBody));
                 } else {
                     storage_->AddDeadMessage(authorizedUid_, MessageMethod::Refuel, requestBody.dump());
                 }
@@ -296,66 +547,86 @@ bool BackendBase::Refuel(TankNumber tankNumber, Volume volume) {
 }
 
 bool BackendBase::Intake(TankNumber tankNumber, Volume volume, IntakeDirection direction) {
+    nlohmann::json requestBody;
+    if (!BeginIntake(tankNumber, volume, direction, requestBody)) {
+        return false;
+    }
+    nlohmann::json response;
     try {
-        if (!session_.IsAuthorized()) {
-            LOG_BCK_ERROR("Invalid intake report: backend is not authorized");
-            lastError_ = StdControllerError;
-            return false;
+        response = SendRequest("/api/pump/fuel-intake", "POST", requestBody, true);
+    } catch (const std::exception& e) {
+        LOG_BCK_ERROR("Failed to send fuel intake report: {}", e.what());
+        if (lastError_.empty()) {
+            lastError_ = StdBackendError;
         }
+        return false;
+    }
+    return FinishIntake(requestBody, response);
+}
 
-        if (roleId_ != static_cast<int>(UserRole::Operator)) {
-            LOG_BCK_ERROR("Invalid intake report: role {} is not allowed (expected Operator)", roleId_);
-            lastError_ = StdControllerError;
-            return false;
-        }
+bool BackendBase::BeginIntake(TankNumber tankNumber, Volume volume, IntakeDirection direction,
+                              nlohmann::json& requestBody) {
+    if (!session_.IsAuthorized()) {
+        LOG_BCK_ERROR("Invalid intake report: backend is not authorized");
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        const auto tankIt = std::find_if(
-            fuelTanks_.begin(),
-            fuelTanks_.end(),
-            [tankNumber](const BackendTankInfo& tank) { return tank.visualNumberTank == tankNumber; });
-        if (tankIt == fuelTanks_.end()) {
-            LOG_BCK_ERROR("Invalid intake report: tank {} not found in authorized tanks", tankNumber);
-            lastError_ = StdControllerError;
-            return false;
-        }
+    if (roleId_ != static_cast<int>(UserRole::Operator)) {
+        LOG_BCK_ERROR("Invalid intake report: role {} is not allowed (expected Operator)", roleId_);
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        if (volume < 0.0) {
-            LOG_BCK_ERROR("Invalid intake report: volume {} must be non-negative", volume);
-            lastError_ = StdControllerError;
-            return false;
-        }
+    const auto tankIt = std::find_if(
+        fuelTanks_.begin(),
+        fuelTanks_.end(),
+        [tankNumber](const BackendTankInfo& tank) { return tank.visualNumberTank == tankNumber; });
+    if (tankIt == fuelTanks_.end()) {
+        LOG_BCK_ERROR("Invalid intake report: tank {} not found in authorized tanks", tankNumber);
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        if (direction != IntakeDirection::In && direction != IntakeDirection::Out) {
-            LOG_BCK_ERROR("Invalid intake report: direction {} is not supported", static_cast<int>(direction));
-            lastError_ = StdControllerError;
-            return false;
-        }
+    if (volume < 0.0) {
+        LOG_BCK_ERROR("Invalid intake report: volume {} must be non-negative", volume);
+        lastError_ = StdControllerError;
+        return false;
+    }
+
+    if (direction != IntakeDirection::In && direction != IntakeDirection::Out) {
+        LOG_BCK_ERROR("Invalid intake report: direction {} is not supported", static_cast<int>(direction));
+        lastError_ = StdControllerError;
+        return false;
+    }
 
-        const auto now = std::chrono::system_clock::now();
-        const auto timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                     now.time_since_epoch())
-                                     .count();
+    const auto now = std::chrono::system_clock::now();
+    const auto timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 now.time_since_epoch())
+                                 .count();
 
-        nlohmann::json requestBody;
-        requestBody["TankNumber"] = tankIt->idTank;
-        requestBody["IntakeVolume"] = volume;
-        requestBody["Direction"] = static_cast<int>(direction);
-        requestBody["TimeAt"] = timestampMs;
-
-        LOG_BCK_INFO("Fuel intake report: tank={}, volume={}, direction={}, timestamp_ms={}",
-                 tankNumber,
-                 volume,
-                 static_cast<int>(direction),
-                 timestampMs);
-
-        nlohmann::json response = HttpRequestWrapper("/api/pump/fuel-intake", "POST", requestBody, true);
+    requestBody["TankNumber"] = tankIt->idTank;
+    requestBody["IntakeVolume"] = volume;
+    requestBody["Direction"] = static_cast<int>(direction);
+    requestBody["TimeAt"] = timestampMs;
+
+    LOG_BCK_INFO("Fuel intake report: tank={}, volume={}, direction={}, timestamp_ms={}",
+             tankNumber,
+             volume,
+             static_cast<int>(direction),
+             timestampMs);
+    return true;
+}
+
+bool BackendBase::FinishIntake(const nlohmann::json& requestBody, const nlohmann::json& response) {
+    try {
         std::string responseError;
         if (IsErrorResponse(response, &responseError)) {
             LOG_BCK_ERROR("Failed to send fuel intake report: {}", responseError);
             if (storage_ && !authorizedUid_.empty()) {
                 const int errorCode = response.value("CodeError", 0);
                 if (errorCode == HttpRequestWrapperErrorCode) {
-                    storage_->AddBacklog(authorizedUid_, MessageMethod::Intake, requestBody.dump());
+                    storage_->AddBacklog(authorizedUid_, MessageMethod::Intake, EncodeBacklogPayload(requestBody));
                 } else {
                     storage_->AddDeadMessage(authorizedUid_, MessageMethod::Intake, requestBody.dump());
                 }
@@ -376,11 +647,7 @@ bool BackendBase::Intake(TankNumber tankNumber, Volume volume, IntakeDirection d
     }
 }
 
-bool BackendBase::ApplyVisualTankMapping(nlohmann::json& requestBody) const {
-    if (!requestBody.contains("TankNumber") || !requestBody["TankNumber"].is_number_integer()) {
-        return false;
-    }
-    const int visualNumber = requestBody["TankNumber"].get<int>();
+std::optional<std::int64_t> BackendBase::MapVisualTankNumber(std::int64_t visualNumber) const {
     const auto tankIt = std::find_if(
         fuelTanks_.begin(),
         fuelTanks_.end(),
@@ -388,33 +655,33 @@ bool BackendBase::ApplyVisualTankMapping(nlohmann::json& requestBody) const {
     if (tankIt == fuelTanks_.end()) {
         LOG_BCK_WARN("Tank with visualNumber {} not found in authorized tanks; sending payload without id mapping",
                      visualNumber);
-        return false;
+        return std::nullopt;
     }
-    requestBody["TankNumber"] = tankIt->idTank;
-    return true;
+    return tankIt->idTank;
 }
 
-bool BackendBase::RefuelPayload(const std::string& payload) {
+bool BackendBase::SendPayload(const std::string& payload, const std::string& endpoint, const char* report) {
     try {
         if (!session_.IsAuthorized()) {
-            LOG_BCK_ERROR("Invalid refueling report: backend is not authorized");
+            LOG_BCK_ERROR("Invalid {} report: backend is not authorized", report);
             lastError_ = StdControllerError;
             return false;
         }
 
-        auto requestBody = nlohmann::json::parse(payload, nullptr, false);
-        if (requestBody.is_discarded()) {
-            LOG_BCK_ERROR("Invalid refueling payload");
+        // Stored payloads carry visual tank numbers; map them while writing the body
+        auto body = BacklogPayloadToWireBody(payload, [this](std::int64_t tankNumber) {
+            return MapVisualTankNumber(tankNumber);
+        });
+        if (!body) {
+            LOG_BCK_ERROR("Invalid {} payload", report);
             lastError_ = StdControllerError;
             return false;
         }
 
-        ApplyVisualTankMapping(requestBody);
-
-        nlohmann::json response = HttpRequestWrapper("/api/pump/refuel", "POST", requestBody, true);
+        nlohmann::json response = SendRequestWithBody(endpoint, "POST", *body, true);
         std::string responseError;
         if (IsErrorResponse(response, &responseError)) {
-            LOG_BCK_ERROR("Failed to send refueling report: {}", responseError);
+            LOG_BCK_ERROR("Failed to send {} report: {}", report, responseError);
             lastError_ = responseError;
             return false;
         }
@@ -422,7 +689,7 @@ bool BackendBase::RefuelPayload(const std::string& payload) {
         lastError_.clear();
         return true;
     } catch (const std::exception& e) {
-        LOG_BCK_ERROR("Failed to send refueling payload: {}", e.what());
+        LOG_BCK_ERROR("Failed to send {} payload: {}", report, e.what());
         if (lastError_.empty()) {
             lastError_ = StdBackendError;
         }
@@ -430,59 +697,50 @@ bool BackendBase::RefuelPayload(const std::string& payload) {
     }
 }
 
-bool BackendBase::IntakePayload(const std::string& payload) {
-    try {
-        if (!session_.IsAuthorized()) {
-            LOG_BCK_ERROR("Invalid intake report: backend is not authorized");
-            lastError_ = StdControllerError;
-            return false;
-        }
-
-        auto requestBody = nlohmann::json::parse(payload, nullptr, false);
-        if (requestBody.is_discarded()) {
-            LOG_BCK_ERROR("Invalid intake payload");
-            lastError_ = StdControllerError;
-            return false;
-        }
+bool BackendBase::RefuelPayload(const std::string& payload) {
+    return SendPayload(payload, "/api/pump/refuel", "refueling");
+}
 
-        ApplyVisualTankMapping(requestBody);
+bool BackendBase::IntakePayload(const std::string& payload) {
+    return SendPayload(payload, "/api/pump/fuel-intake", "intake");
+}
 
-        nlohmann::json response = HttpRequestWrapper("/api/pump/fuel-intake", "POST", requestBody, true);
-        std::string responseError;
-        if (IsErrorResponse(response, &responseError)) {
-            LOG_BCK_ERROR("Failed to send fuel intake report: {}", responseError);
-            lastError_ = responseError;
-            return false;
+std::vector<UserCard> BackendBase::FetchUserCards(int first, int number) {
+    try {
+        LOG_BCK_INFO("Fetching user cards: first={}, number={}", first, number);
+        
+        // Create an empty request body (GET-like request but using POST for consistency)
+        nlohmann::json requestBody;
+        requestBody["PumpControllerUid"] = controllerUid_;
+        
+        // Make the request with bearer token (will use controller's session);
+        // the cards are parsed as the page arrives
+        std::vector<UserCard> cards;
+        bool malformed = false;
+        nlohmann::json response = SendRecordsRequest(UserCardsEndpoint(first, number), "POST", requestBody, true,
+            [&cards, &malformed](const nlohmann::json& item) {
+                malformed = !AddUserCard(item, cards);
+                return !malformed;
+            });
+        if (malformed) {
+            LOG_BCK_ERROR("Invalid response format: field 'Allowance' must be a number");
+            lastError_ = StdBackendError;
+            return {};
         }
-
-        lastError_.clear();
-        return true;
+        return FinishFetchUserCards(response, std::move(cards));
     } catch (const std::exception& e) {
-        LOG_BCK_ERROR("Failed to send intake payload: {}", e.what());
+        LOG_BCK_ERROR("Failed to fetch user cards: {}", e.what());
         if (lastError_.empty()) {
             lastError_ = StdBackendError;
         }
-        return false;
     }
+    return {};
 }
 
-std::vector<UserCard> BackendBase::FetchUserCards(int first, int number) {
+std::vector<UserCard> BackendBase::FinishFetchUserCards(const nlohmann::json& response, std::vector<UserCard> cards) {
     std::vector<UserCard> result;
     
     try {
-        // Build the endpoint with query parameters
-        std::string endpoint = "/api/pump/cards?first=" + std::to_string(first) + 
-                               "&number=" + std::to_string(number);
-        
-        LOG_BCK_INFO("Fetching user cards: first={}, number={}", first, number);
-        
-        // Create an empty request body (GET-like request but using POST for consistency)
-        nlohmann::json requestBody;
-        requestBody["PumpControllerUid"] = controllerUid_;
-        
-        // Make the request with bearer token (will use controller's session)
-        nlohmann::json response = HttpRequestWrapper(endpoint, "POST", requestBody, true);
-        
         std::string responseError;
         if (IsErrorResponse(response, &responseError)) {
             LOG_BCK_ERROR("Failed to fetch user cards: {}", responseError);
@@ -497,46 +755,97 @@ std::vector<UserCard> BackendBase::FetchUserCards(int first, int number) {
             return result;
         }
         
+        result = std::move(cards);
         for (const auto& item : response) {
+            if (!AddUserCard(item, result)) {
+                LOG_BCK_ERROR("Invalid response format: field 'Allowance' must be a number");
+                lastError_ = StdBackendError;
+                return {};
+            }
+        }
+        
+        LOG_BCK_INFO("Fetched {} user cards", result.size());
+        lastError_.clear();
+        
+    } catch (const std::exception& e) {
+        LOG_BCK_ERROR("Failed to fetch user cards: {}", e.what());
+        if (lastError_.empty()) {
+            lastError_ = StdBackendError;
+        }
+    }
+    
+    return result;
+}
+
+std::optional<UserCardDelta> BackendBase::FetchUserCardChanges(const std::string& since, int number) {
+    try {
+        std::string endpoint = "/api/pump/cards/changes?number=" + std::to_string(number);
+
+        LOG_BCK_INFO("Fetching user card changes: since={}, number={}", since, number);
+
+        // The watermark is opaque to the controller, so it travels in the body rather than the query
+        nlohmann::json requestBody;
+        requestBody["PumpControllerUid"] = controllerUid_;
+        requestBody["Since"] = since;
+
+        nlohmann::json response = SendRequest(endpoint, "POST", requestBody, true);
+
+        std::string responseError;
+        if (IsErrorResponse(response, &responseError)) {
+            LOG_BCK_WARN("Card changes are not available: {}", responseError);
+            lastError_ = responseError;
+            return std::nullopt;
+        }
+
+        if (!response.is_object() || !response.contains("Cards") || !response["Cards"].is_array()) {
+            LOG_BCK_ERROR("Invalid response format: expected object with 'Cards' array");
+            lastError_ = StdBackendError;
+            return std::nullopt;
+        }
+
+        UserCardDelta delta;
+        for (const auto& item : response["Cards"]) {
             if (!item.is_object()) {
                 continue;
             }
-            
             UserCard card;
-            if (item.contains("Uid") && item["Uid"].is_string()) {
-                card.uid = item["Uid"].get<std::string>();
-            } else {
-                continue; // Skip entries without UID
+            if (!ParseUserCard(item, card)) {
+                LOG_BCK_ERROR("Invalid response format: field 'Allowance' must be a number");
+                lastError_ = StdBackendError;
+                return std::nullopt;
             }
-            
-            if (item.contains("RoleId") && item["RoleId"].is_number_integer()) {
-                card.roleId = item["RoleId"].get<int>();
+            if (!card.uid.empty()) {
+                delta.upserts.push_back(card);
             }
-            
-            if (item.contains("Allowance") && !item["Allowance"].is_null()) {
-                if (item["Allowance"].is_number()) {
-                    card.allowance = item["Allowance"].get<double>();
-                } else {
-                    LOG_BCK_ERROR("Invalid response format: expected array");
-                    lastError_ = StdBackendError;
-                    return result;
+        }
+
+        if (response.contains("Deleted") && response["Deleted"].is_array()) {
+            for (const auto& uid : response["Deleted"]) {
+                if (uid.is_string()) {
+                    delta.deletedUids.push_back(uid.get<std::string>());
                 }
             }
-            
-            result.push_back(card);
         }
-        
-        LOG_BCK_INFO("Fetched {} user cards", result.size());
+
+        if (response.contains("Watermark") && response["Watermark"].is_string()) {
+            delta.watermark = response["Watermark"].get<std::string>();
+        }
+        if (response.contains("Truncated") && response["Truncated"].is_boolean()) {
+            delta.truncated = response["Truncated"].get<bool>();
+        }
+
+        LOG_BCK_INFO("Fetched {} changed and {} deleted user cards", delta.upserts.size(), delta.deletedUids.size());
         lastError_.clear();
-        
+        return delta;
+
     } catch (const std::exception& e) {
-        LOG_BCK_ERROR("Failed to fetch user cards: {}", e.what());
+        LOG_BCK_ERROR("Failed to fetch user card changes: {}", e.what());
         if (lastError_.empty()) {
             lastError_ = StdBackendError;
         }
     }
-    
-    return result;
+
+    return std::nullopt;
 }
 
 std::vector<FuelTank> BackendBase::FetchFuelTanks(int first, int number) {
@@ -551,7 +860,18 @@ std::vector<FuelTank> BackendBase::FetchFuelTanks(int first, int number) {
         nlohmann::json requestBody;
         requestBody["PumpControllerUid"] = controllerUid_;
 
-        nlohmann::json response = HttpRequestWrapper(endpoint, "POST", requestBody, true);
+        std::vector<FuelTank> tanks;
+        bool malformed = false;
+        nlohmann::json response = SendRecordsRequest(endpoint, "POST", requestBody, true,
+            [&tanks, &malformed](const nlohmann::json& item) {
+                malformed = !AddFuelTank(item, tanks);
+                return !malformed;
+            });
+        if (malformed) {
+            LOG_BCK_ERROR("Invalid response format: field 'Volume' must be a number");
+            lastError_ = StdBackendError;
+            return result;
+        }
 
         std::string responseError;
         if (IsErrorResponse(response, &responseError)) {
@@ -566,37 +886,7 @@ std::vector<FuelTank> BackendBase::FetchFuelTanks(int first, int number) {
             return result;
         }
 
-        for (const auto& item : response) {
-            if (!item.is_object()) {
-                continue;
-            }
-
-            if (!item.contains("VisualNumberTank") || !item["VisualNumberTank"].is_number_integer()) {
-                continue;
-            }
-
-            FuelTank tank;
-            tank.visualNumberTank = item["VisualNumberTank"].get<int>();
-
-            if (item.contains("IdTank") && item["IdTank"].is_number_integer()) {
-                tank.idTank = item["IdTank"].get<int>();
-            }
-            if (item.contains("NameTank") && item["NameTank"].is_string()) {
-                tank.nameTank = item["NameTank"].get<std::string>();
-            }
-            if (item.contains("Volume") && !item["Volume"].is_null()) {
-                if (item["Volume"].is_number()) {
-                    tank.volume = item["Volume"].get<double>();
-                } else {
-                    LOG_BCK_ERROR("Invalid response format: field 'Volume' must be a number");
-                    lastError_ = StdBackendError;
-                    return std::vector<FuelTank>{};
-                }
-            }
-
-            result.push_back(tank);
-        }
-
+        result = std::move(tanks);
         LOG_BCK_INFO("Fetched {} fuel tanks", result.size());
         lastError_.clear();
     } catch (const std::exception& e) {
@@ -609,4 +899,136 @@ std::vector<FuelTank> BackendBase::FetchFuelTanks(int first, int number) {
     return result;
 }
 
+template <typename T>
+std::future<T> BackendBase::SendAsync(std::shared_ptr<BackendBase> self,
+                                      const std::string& endpoint,
+                                      const nlohmann::json& requestBody,
+                                      const std::string& bearerToken,
+                                      std::function<T(const nlohmann::json&, bool)> finish) {
+    auto promise = std::make_shared<std::promise<T>>();
+    std::future<T> future = promise->get_future();
+    if (!AdmitRequest()) {
+        LOG_BCK_DEBUG("Backend circuit is open; {} fails without a request", endpoint);
+        promise->set_value(finish(BuildWrapperErrorResponse(), true));
+        return future;
+    }
+    auto done = [self, promise, finish, breaker = breaker_](const nlohmann::json& response, bool networkError) {
+        breaker->RecordResult(!networkError);
+        ReportConnectivity(networkError);
+        promise->set_value(finish(response, networkError));
+    };
+    try {
+        HttpRequestAsync(endpoint, "POST", requestBody, bearerToken, std::move(done));
+    } catch (const std::exception& e) {
+        // The default HttpRequestAsync reports exceptions of HttpRequestWrapper here
+        LOG_BCK_ERROR("Request {} failed: {}", endpoint, e.what());
+        if (lastError_.empty()) {
+            lastError_ = StdBackendError;
+        }
+        try {
+            promise->set_value(T{});
+            // Never sent, so it must not hold the half-open trial
+            breaker_->Cancel();
+        } catch (const std::future_error&) {
+            // 'done' had already run
+        }
+    }
+    return future;
+}
+
+void BackendBase::HttpRequestAsync(const std::string& endpoint,
+                                   const std::string& method,
+                                   const nlohmann::json& requestBody,
+                                   const std::string& bearerToken,
+                                   ResponseCallback done) {
+    nlohmann::json response = HttpRequestWrapper(endpoint, method, requestBody, bearerToken);
+    done(response, networkError_);
+}
+
+std::future<bool> BackendBase::AuthorizeAsync(const std::string& uid) {
+    const auto self = weak_from_this().lock();
+    if (!self) {
+        return ReadyFuture(Authorize(uid));
+    }
+    nlohmann::json requestBody;
+    if (!BeginAuthorize(uid, requestBody)) {
+        return ReadyFuture(false);
+    }
+    return SendAsync<bool>(self, "/api/pump/authorize", requestBody, std::string(),
+                           [this, uid](const nlohmann::json& response, bool networkError) {
+        networkError_ = networkError;
+        return FinishAuthorize(uid, response);
+    });
+}
+
+std::future<bool> BackendBase::DeauthorizeAsync() {
+    const auto self = weak_from_this().lock();
+    if (!self) {
+        return ReadyFuture(Deauthorize());
+    }
+    const auto token = EndSession();
+    if (!token) {
+        return ReadyFuture(false);
+    }
+    LOG_BCK_INFO("Deauthorizing (async)");
+    // Like Deauthorize, leaves networkError_ alone: the session is over either way
+    return SendAsync<bool>(self, "/api/pump/deauthorize", nlohmann::json::object(), *token,
+                           [](const nlohmann::json& response, bool /*networkError*/) {
+        std::string responseError;
+        if (IsErrorResponse(response, &responseError)) {
+            LOG_BCK_WARN("Async deauthorize failed (ignored): {}", responseError);
+            return false;
+        }
+        LOG_BCK_INFO("Async deauthorization completed successfully");
+        return true;
+    });
+}
+
+std::future<bool> BackendBase::RefuelAsync(TankNumber tankNumber, Volume volume) {
+    const auto self = weak_from_this().lock();
+    if (!self) {
+        return ReadyFuture(Refuel(tankNumber, volume));
+    }
+    nlohmann::json requestBody;
+    if (!BeginRefuel(tankNumber, volume, requestBody)) {
+        return ReadyFuture(false);
+    }
+    return SendAsync<bool>(self, "/api/pump/refuel", requestBody, session_.GetToken(),
+                           [this, volume, requestBody](const nlohmann::json& response, bool networkError) {
+        networkError_ = networkError;
+        return FinishRefuel(volume, requestBody, response);
+    });
+}
+
+std::future<bool> BackendBase::IntakeAsync(TankNumber tankNumber, Volume volume, IntakeDirection direction) {
+    const auto self = weak_from_this().lock();
+    if (!self) {
+        return ReadyFuture(Intake(tankNumber, volume, direction));
+    }
+    nlohmann::json requestBody;
+    if (!BeginIntake(tankNumber, volume, direction, requestBody)) {
+        return ReadyFuture(false);
+    }
+    return SendAsync<bool>(self, "/api/pump/fuel-intake", requestBody, session_.GetToken(),
+                           [this, requestBody](const nlohmann::json& response, bool networkError) {
+        networkError_ = networkError;
+        return FinishIntake(requestBody, response);
+    });
+}
+
+std::future<std::vector<UserCard>> BackendBase::FetchUserCardsAsync(int first, int number) {
+    const auto self = weak_from_this().lock();
+    if (!self) {
+        return ReadyFuture(FetchUserCards(first, number));
+    }
+    LOG_BCK_INFO("Fetching user cards: first={}, number={}", first, number);
+    nlohmann::json requestBody;
+    requestBody["PumpControllerUid"] = controllerUid_;
+    return SendAsync<std::vector<UserCard>>(self, UserCardsEndpoint(first, number), requestBody, session_.GetToken(),
+                                            [this](const nlohmann::json& response, bool networkError) {
+        networkError_ = networkError;
+        return FinishFetchUserCards(response);
+    });
+}
+
 } // namespace fuelflux
@@ -0,0 +1,198 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "backlog_payload.h"
+
+#include <limits>
+#include <vector>
+
+namespace fuelflux {
+
+namespace {
+
+using json = nlohmann::json;
+
+enum class PayloadFormat {
+    JsonText,
+    MsgpackV1,
+    Unknown
+};
+
+PayloadFormat DetectFormat(const std::string& payload) {
+    if (payload.empty()) {
+        return PayloadFormat::Unknown;
+    }
+    const auto first = static_cast<unsigned char>(payload[0]);
+    if (first == kBacklogPayloadMsgpackV1) {
+        return PayloadFormat::MsgpackV1;
+    }
+    // Control characters other than JSON whitespace are reserved for version bytes
+    if (first < 0x20 && first != ' ' && first != '\t' && first != '\n' && first != '\r') {
+        return PayloadFormat::Unknown;
+    }
+    return PayloadFormat::JsonText;
+}
+
+// SAX consumer that writes compact JSON text as the events arrive
+class WireBodyWriter {
+public:
+    explicit WireBodyWriter(const TankNumberMapper& mapTankNumber)
+        : mapTankNumber_(mapTankNumber) {
+    }
+
+    std::string& Output() { return out_; }
+
+    bool null() {
+        return Scalar("null");
+    }
+    bool boolean(bool value) {
+        return Scalar(value ? "true" : "false");
+    }
+    bool number_integer(json::number_integer_t value) {
+        return Integer(value);
+    }
+    bool number_unsigned(json::number_unsigned_t value) {
+        if (value <= static_cast<json::number_unsigned_t>(std::numeric_limits<json::number_integer_t>::max())) {
+            return Integer(static_cast<json::number_integer_t>(value));
+        }
+        return Scalar(std::to_string(value));
+    }
+    bool number_float(json::number_float_t value, const json::string_t& /*text*/) {
+        // Same formatting as dumping a parsed document
+        return Scalar(json(value).dump());
+    }
+    bool string(json::string_t& value) {
+        return Scalar(json(value).dump());
+    }
+    bool binary(json::binary_t& /*value*/) {
+        // Never produced by EncodeBacklogPayload and not representable in the request
+        return false;
+    }
+    bool start_object(std::size_t /*size*/) {
+        BeginValue();
+        out_ += '{';
+        containers_.push_back(Container{true, true});
+        return true;
+    }
+    bool key(json::string_t& name) {
+        Container& container = containers_.back();
+        if (!container.first) {
+            out_ += ',';
+        }
+        container.first = false;
+        out_ += json(name).dump();
+        out_ += ':';
+        tankNumberNext_ = (containers_.size() == 1 && name == "TankNumber");
+        return true;
+    }
+    bool end_object() {
+        out_ += '}';
+        containers_.pop_back();
+        return true;
+    }
+    bool start_array(std::size_t /*size*/) {
+        BeginValue();
+        out_ += '[';
+        containers_.push_back(Container{false, true});
+        return true;
+    }
+    bool end_array() {
+        out_ += ']';
+        containers_.pop_back();
+        return true;
+    }
+    bool parse_error(std::size_t /*position*/, const std::string& /*token*/, const json::exception& /*error*/) {
+        return false;
+    }
+
+private:
+    struct Container {
+        bool isObject;
+        bool first;
+    };
+
+    void BeginValue() {
+        if (!containers_.empty() && !containers_.back().isObject) {
+            if (!containers_.back().first) {
+                out_ += ',';
+            }
+            containers_.back().first = false;
+        }
+        tankNumberNext_ = false;
+    }
+
+    bool Scalar(const std::string& text) {
+        BeginValue();
+        out_ += text;
+        return true;
+    }
+
+    bool Integer(json::number_integer_t value) {
+        if (tankNumberNext_ && mapTankNumber_) {
+            if (auto mapped = mapTankNumber_(value)) {
+                value = *mapped;
+            }
+        }
+        return Scalar(std::to_string(value));
+    }
+
+    const TankNumberMapper& mapTankNumber_;
+    std::string out_;
+    std::vector<Container> containers_;
+    bool tankNumberNext_ = false;
+};
+
+} // namespace
+
+std::string EncodeBacklogPayload(const nlohmann::json& body) {
+    const std::vector<std::uint8_t> packed = json::to_msgpack(body);
+    std::string payload;
+    payload.reserve(packed.size() + 1);
+    payload += static_cast<char>(kBacklogPayloadMsgpackV1);
+    payload.append(packed.begin(), packed.end());
+    return payload;
+}
+
+std::optional<std::string> BacklogPayloadToWireBody(const std::string& payload, const TankNumberMapper& mapTankNumber) {
+    WireBodyWriter writer(mapTankNumber);
+    try {
+        bool ok = false;
+        switch (DetectFormat(payload)) {
+            case PayloadFormat::MsgpackV1:
+                ok = json::sax_parse(payload.begin() + 1, payload.end(), &writer, json::input_format_t::msgpack);
+                break;
+            case PayloadFormat::JsonText:
+                ok = json::sax_parse(payload, &writer);
+                break;
+            case PayloadFormat::Unknown:
+                break;
+        }
+        if (!ok) {
+            return std::nullopt;
+        }
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    return std::move(writer.Output());
+}
+
+std::optional<nlohmann::json> DecodeBacklogPayload(const std::string& payload) {
+    json body;
+    switch (DetectFormat(payload)) {
+        case PayloadFormat::MsgpackV1:
+            body = json::from_msgpack(payload.begin() + 1, payload.end(), true, false);
+            break;
+        case PayloadFormat::JsonText:
+            body = json::parse(payload, nullptr, false);
+            break;
+        case PayloadFormat::Unknown:
+            return std::nullopt;
+    }
+    if (body.is_discarded()) {
+        return std::nullopt;
+    }
+    return body;
+}
+
+} // namespace fuelflux
@@ -4,22 +4,89 @@
 
 #include "backlog_worker.h"
 
+#include "connectivity_signal.h"
+#include "link_monitor.h"
 #include "logger.h"
 
+#include <algorithm>
+
 namespace fuelflux {
 
+namespace {
+
+std::int64_t NowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
 BacklogWorker::BacklogWorker(std::shared_ptr<MessageStorage> storage,
                              std::shared_ptr<IBackend> backend,
                              std::chrono::milliseconds interval)
+    : BacklogWorker(std::move(storage), std::vector<std::shared_ptr<IBackend>>{std::move(backend)}, interval) {
+}
+
+BacklogWorker::BacklogWorker(std::shared_ptr<MessageStorage> storage,
+                             std::vector<std::shared_ptr<IBackend>> backends,
+                             std::chrono::milliseconds interval)
     : storage_(std::move(storage))
-    , backend_(std::move(backend))
     , interval_(interval) {
+    for (auto& backend : backends) {
+        if (backend) {
+            backends_.push_back(std::move(backend));
+        }
+    }
+    connectivityListener_ = ConnectivitySignal::Instance().Subscribe([this]() { OnConnectivityRestored(); });
+    linkListener_ = LinkMonitor::Instance().Subscribe([this](LinkMonitor::State state, const std::string&) {
+        if (state == LinkMonitor::State::Up) {
+            OnConnectivityRestored();
+        }
+    });
 }
 
 BacklogWorker::~BacklogWorker() {
+    LinkMonitor::Instance().Unsubscribe(linkListener_);
+    ConnectivitySignal::Instance().Unsubscribe(connectivityListener_);
     Stop();
 }
 
+void BacklogWorker::OnConnectivityRestored() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakeRequested_ = true;
+    }
+    cv_.notify_all();
+}
+
+std::chrono::milliseconds BacklogWorker::BackoffDelay(int attempts, double jitter) {
+    auto delay = kBackoffMax;
+    if (attempts <= 1) {
+        delay = kBackoffBase;
+    } else if (attempts < 31 && kBackoffBase * (std::int64_t{1} << (attempts - 1)) < kBackoffMax) {
+        delay = kBackoffBase * (std::int64_t{1} << (attempts - 1));
+    }
+    // "Equal jitter": keep half of the delay, randomize the other half
+    const auto half = delay / 2;
+    return half + std::chrono::milliseconds(static_cast<std::int64_t>(
+        std::clamp(jitter, 0.0, 1.0) * static_cast<double>((delay - half).count())));
+}
+
+std::chrono::milliseconds BacklogWorker::IdleWait() {
+    std::chrono::milliseconds interval;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interval = interval_;
+    }
+    const auto nextAttempt = storage_ ? storage_->GetNextBacklogAttemptAt() : std::nullopt;
+    const std::int64_t now = NowMillis();
+    if (nextAttempt && *nextAttempt > now) {
+        // Backing off: sleep until the earliest rescheduled message is due
+        return std::chrono::milliseconds(*nextAttempt - now);
+    }
+    return interval;
+}
+
 void BacklogWorker::Start() {
     if (running_.exchange(true)) {
         return;
@@ -52,31 +119,80 @@ void BacklogWorker::SetInterval(std::chrono::milliseconds interval) {
 void BacklogWorker::RunLoop() {
     while (running_.load()) {
         const bool processed = ProcessOnce();
+        const auto wait = processed ? std::chrono::milliseconds(0) : IdleWait();
         std::unique_lock<std::mutex> lock(mutex_);
         if (!running_.load()) {
             break;
         }
         if (!processed) {
-            cv_.wait_for(lock, interval_, [this] { return !running_.load(); });
+            cv_.wait_for(lock, wait, [this] { return !running_.load() || wakeRequested_; });
+        }
+        if (wakeRequested_) {
+            wakeRequested_ = false;
+            lock.unlock();
+            LOG_BCK_INFO("Connectivity restored, retrying backlog now");
+            if (storage_) {
+                storage_->ResetBacklogBackoff();
+            }
         }
     }
 }
 
 bool BacklogWorker::ProcessOnce() {
-    if (!storage_ || !backend_) {
+    if (!storage_ || backends_.empty()) {
         return false;
     }
 
-    const auto message = storage_->GetNextBacklog();
-    if (!message) {
+    const std::int64_t now = NowMillis();
+    const auto uids = storage_->GetBacklogUids(static_cast<int>(backends_.size()), now);
+    if (uids.empty()) {
         return false;
     }
 
-    return ProcessMessage(*message);
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<bool> networkDown{false};
+    // Distinct users only, so no user's messages can be sent by two sessions at once
+    std::vector<std::thread> sessions;
+    sessions.reserve(uids.size() - 1);
+    for (std::size_t i = 1; i < uids.size(); ++i) {
+        sessions.emplace_back([this, i, now, &uids, &networkDown]() {
+            ProcessSession(*backends_[i], uids[i], now, networkDown);
+        });
+    }
+    ProcessSession(*backends_.front(), uids.front(), now, networkDown);
+    for (auto& session : sessions) {
+        session.join();
+    }
+
+    // Wall-clock time, so that the rate reflects parallel sessions
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    double rate = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.busyTime += elapsed;
+        rate = stats_.MessagesPerMinute();
+    }
+    LOG_BCK_INFO("Backlog drain rate {:.1f} msgs/min, {} messages left", rate, storage_->BacklogCount());
+
+    if (networkDown.load()) {
+        // Back off as a whole: reschedule everything that is due, not only the failed messages
+        std::uniform_real_distribution<double> jitter(0.0, 1.0);
+        storage_->DeferBacklog(now, [this, &jitter](int attempts) {
+            return BackoffDelay(attempts, jitter(jitterRandom_));
+        });
+    }
+
+    return !networkDown.load();
+}
+
+BacklogDrainStats BacklogWorker::GetDrainStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
 }
 
-bool BacklogWorker::HandleFailure(const StoredMessage& message) {
-    if (backend_->IsNetworkError()) {
+bool BacklogWorker::HandleFailure(IBackend& backend, const StoredMessage& message) {
+    if (backend.IsNetworkError()) {
         LOG_BCK_WARN("Backlog processing paused due to network error");
         return false;
     }
@@ -84,31 +200,69 @@ bool BacklogWorker::HandleFailure(const StoredMessage& message) {
     LOG_BCK_WARN("Moving backlog message {} to dead messages", message.id);
     storage_->AddDeadMessage(message.uid, message.method, message.data);
     storage_->RemoveBacklog(message.id);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        ++stats_.deadLettered;
+    }
     return true;
 }
 
-bool BacklogWorker::ProcessMessage(const StoredMessage& message) {
-    if (!backend_->Authorize(message.uid)) {
-        return HandleFailure(message);
+bool BacklogWorker::SendMessage(IBackend& backend, const StoredMessage& message) {
+    if (message.method == MessageMethod::Refuel) {
+        return backend.RefuelPayload(message.data);
+    }
+    return backend.IntakePayload(message.data);
+}
+
+bool BacklogWorker::ProcessSession(IBackend& backend, const std::string& uid, std::int64_t now,
+                                   std::atomic<bool>& networkDown) {
+    const auto messages = storage_->GetBacklogForUid(uid, kSessionMaxMessages, now);
+    if (messages.empty()) {
+        return true;
     }
 
-    bool sendOk = false;
-    if (message.method == MessageMethod::Refuel) {
-        sendOk = backend_->RefuelPayload(message.data);
-    } else {
-        sendOk = backend_->IntakePayload(message.data);
+    const auto start = std::chrono::steady_clock::now();
+    if (!backend.Authorize(uid)) {
+        if (!HandleFailure(backend, messages.front())) {
+            networkDown = true;
+            return false;
+        }
+        return true;
+    }
+
+    std::size_t delivered = 0;
+    for (const auto& message : messages) {
+        // Another session hit a network error: leave the rest for the next attempt
+        if (networkDown.load()) {
+            break;
+        }
+        if (SendMessage(backend, message)) {
+            storage_->RemoveBacklog(message.id);
+            ++delivered;
+            continue;
+        }
+        if (!HandleFailure(backend, message)) {
+            // Network is down: keep this and the remaining messages for the next attempt
+            networkDown = true;
+            break;
+        }
     }
 
     // Deauthorize is treated as fire-and-forget at this call site.
     // Return value and potential errors are intentionally ignored.
-    backend_->Deauthorize();
+    backend.Deauthorize();
 
-    if (!sendOk) {
-        return HandleFailure(message);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        ++stats_.sessions;
+        stats_.delivered += delivered;
     }
+    LOG_BCK_INFO("Backlog session for {}: {} of {} messages delivered in {} ms",
+                 uid, delivered, messages.size(), elapsed.count());
 
-    storage_->RemoveBacklog(message.id);
-    return true;
+    return !networkDown.load();
 }
 
 } // namespace fuelflux
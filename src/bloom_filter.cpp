@@ -0,0 +1,184 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "crc32.h"
+
+namespace fuelflux {
+
+namespace {
+
+constexpr char kBloomMagic[4] = {'F', 'F', 'B', 'F'};
+// Version 2: UserCache keys card UIDs by their binary bytes
+// Version 3: header carries the generation of the data the filter was built from
+constexpr std::uint32_t kBloomVersion = 3;
+constexpr std::size_t kMaxHashCount = 16;
+// 32 MiB of filter bits; anything larger in a file header is treated as corruption
+constexpr std::uint64_t kMaxWordCount = 1ULL << 22;
+
+struct BloomHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t wordCount;
+    std::uint32_t hashCount;
+    std::uint32_t checksum;
+    std::uint64_t generation;
+};
+static_assert(sizeof(BloomHeader) == 32, "Bloom filter header must stay 32 bytes");
+
+std::uint64_t Fnv1a(const unsigned char* data, std::size_t size, std::uint64_t basis) {
+    std::uint64_t hash = basis;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Optimal m = -n ln p / (ln 2)^2 bits, rounded up to whole 64-bit words
+std::size_t OptimalWordCount(std::size_t expectedItems, double falsePositiveRate) {
+    const double items = static_cast<double>(std::max<std::size_t>(expectedItems, 1));
+    const double rate = std::clamp(falsePositiveRate, 1e-6, 0.5);
+    const double ln2 = std::log(2.0);
+    const double bits = std::ceil(-items * std::log(rate) / (ln2 * ln2));
+    return std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(bits / 64.0)));
+}
+
+// Optimal k = m/n ln 2
+std::size_t OptimalHashCount(std::size_t expectedItems, double falsePositiveRate) {
+    const double items = static_cast<double>(std::max<std::size_t>(expectedItems, 1));
+    const double bits = static_cast<double>(OptimalWordCount(expectedItems, falsePositiveRate) * 64);
+    const double hashes = std::round(bits / items * std::log(2.0));
+    return std::clamp<std::size_t>(static_cast<std::size_t>(hashes), 1, kMaxHashCount);
+}
+
+} // namespace
+
+BloomFilter::BloomFilter(std::size_t expectedItems, double falsePositiveRate)
+    : BloomFilter(OptimalWordCount(expectedItems, falsePositiveRate),
+                  OptimalHashCount(expectedItems, falsePositiveRate)) {
+}
+
+BloomFilter::BloomFilter(std::size_t wordCount, std::size_t hashCount)
+    : words_(wordCount)
+    , hashCount_(hashCount) {
+    for (auto& word : words_) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+void BloomFilter::Add(const std::string& key) {
+    Add(key.data(), key.size());
+}
+
+void BloomFilter::Add(const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    const std::uint64_t h1 = Fnv1a(bytes, size, 0xCBF29CE484222325ULL);
+    const std::uint64_t h2 = Fnv1a(bytes, size, 0x84222325CBF29CE4ULL) | 1ULL;
+    const std::uint64_t bitCount = BitCount();
+    for (std::size_t i = 0; i < hashCount_; ++i) {
+        const std::uint64_t bit = (h1 + i * h2) % bitCount;
+        words_[bit / 64].fetch_or(1ULL << (bit % 64), std::memory_order_relaxed);
+    }
+}
+
+bool BloomFilter::MightContain(const std::string& key) const {
+    return MightContain(key.data(), key.size());
+}
+
+bool BloomFilter::MightContain(const void* data, std::size_t size) const {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    const std::uint64_t h1 = Fnv1a(bytes, size, 0xCBF29CE484222325ULL);
+    const std::uint64_t h2 = Fnv1a(bytes, size, 0x84222325CBF29CE4ULL) | 1ULL;
+    const std::uint64_t bitCount = BitCount();
+    for (std::size_t i = 0; i < hashCount_; ++i) {
+        const std::uint64_t bit = (h1 + i * h2) % bitCount;
+        if ((words_[bit / 64].load(std::memory_order_relaxed) & (1ULL << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double BloomFilter::EstimatedFalsePositiveRate() const {
+    std::size_t setBits = 0;
+    for (const auto& word : words_) {
+        setBits += static_cast<std::size_t>(__builtin_popcountll(word.load(std::memory_order_relaxed)));
+    }
+    const double fill = static_cast<double>(setBits) / static_cast<double>(BitCount());
+    return std::pow(fill, static_cast<double>(hashCount_));
+}
+
+bool BloomFilter::Save(const std::string& path, std::uint64_t generation) const {
+    std::vector<std::uint64_t> words(words_.size());
+    for (std::size_t i = 0; i < words_.size(); ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+    }
+
+    BloomHeader header{};
+    std::memcpy(header.magic, kBloomMagic, sizeof(header.magic));
+    header.version = kBloomVersion;
+    header.wordCount = words.size();
+    header.hashCount = static_cast<std::uint32_t>(hashCount_);
+    header.checksum = Crc32(words.data(), words.size() * sizeof(std::uint64_t));
+    header.generation = generation;
+
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(words.data()),
+                   static_cast<std::streamsize>(words.size() * sizeof(std::uint64_t)));
+        if (!file) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<BloomFilter> BloomFilter::Load(const std::string& path, std::uint64_t generation) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+
+    BloomHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kBloomMagic, sizeof(header.magic)) != 0 ||
+        header.version != kBloomVersion || header.wordCount == 0 || header.wordCount > kMaxWordCount ||
+        header.hashCount == 0 || header.hashCount > kMaxHashCount || header.generation != generation) {
+        return nullptr;
+    }
+
+    std::vector<std::uint64_t> words(header.wordCount);
+    if (!file.read(reinterpret_cast<char*>(words.data()),
+                   static_cast<std::streamsize>(words.size() * sizeof(std::uint64_t))) ||
+        file.peek() != std::ifstream::traits_type::eof() ||
+        Crc32(words.data(), words.size() * sizeof(std::uint64_t)) != header.checksum) {
+        return nullptr;
+    }
+
+    std::shared_ptr<BloomFilter> filter(new BloomFilter(words.size(), static_cast<std::size_t>(header.hashCount)));
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        filter->words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    return filter;
+}
+
+} // namespace fuelflux
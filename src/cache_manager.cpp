@@ -3,12 +3,14 @@
 // This file is a part of fuelflux application
 
 #include "cache_manager.h"
+#include "bounded_queue.h"
 #include "logger.h"
 #include <algorithm>
+#include <ctime>
 
 namespace fuelflux {
 
-CacheManager::CacheManager(std::shared_ptr<UserCache> cache, std::shared_ptr<IBackend> backend)
+CacheManager::CacheManager(std::shared_ptr<IUserCache> cache, std::shared_ptr<IBackend> backend)
     : cache_(std::move(cache))
     , backend_(std::move(backend))
     , running_(false)
@@ -76,7 +78,7 @@ bool CacheManager::DeductAllowance(const std::string& uid, double amount) {
         return false;
     }
     
-    // Use atomic deduct operation in UserCache
+    // Use atomic deduct operation in the user cache
     return cache_->DeductAllowance(uid, amount);
 }
 
@@ -204,101 +206,30 @@ bool CacheManager::PopulateCache() {
         }
         
         LOG_INFO("Synchronization session authorized with RoleId=3, token obtained");
-        
-        // Begin population (prepares standby table)
-        if (!cache_->BeginPopulation()) {
-            LOG_ERROR("Failed to begin cache population");
-            backend_->Deauthorize();
-            return false;
-        }
-        
-        int totalFetched = 0;
-        int totalTanksFetched = 0;
-        int first = 0;
-        bool moreData = true;
-        
-        while (moreData && running_) {
-            // Fetch batch of user cards
-            LOG_DEBUG("Fetching user cards: first={}, number={}", first, kFetchBatchSize);
-            std::vector<UserCard> cards = backend_->FetchUserCards(first, kFetchBatchSize);
-            
-            if (cards.empty()) {
-                // No more data
-                moreData = false;
-                break;
-            }
-            
-            // Add entries to standby table
-            for (const auto& card : cards) {
-                if (!cache_->AddPopulationEntry(card.uid, card.allowance, card.roleId)) {
-                    LOG_ERROR("Failed to add cache entry for UID: {}", card.uid);
-                    cache_->AbortPopulation();
-                    backend_->Deauthorize();
-                    return false;
-                }
-            }
-            
-            totalFetched += static_cast<int>(cards.size());
-            
-            // Check if we got fewer entries than requested (indicates end of data)
-            if (static_cast<int>(cards.size()) < kFetchBatchSize) {
-                moreData = false;
-            }
-            
-            first += kFetchBatchSize;
-        }
 
-        first = 0;
-        moreData = true;
-        while (moreData && running_) {
-            LOG_DEBUG("Fetching fuel tanks: first={}, number={}", first, kFetchBatchSize);
-            std::vector<FuelTank> tanks = backend_->FetchFuelTanks(first, kFetchBatchSize);
-
-            if (tanks.empty()) {
-                const std::string lastError = backend_->GetLastError();
-                if (!lastError.empty()) {
-                    LOG_ERROR("Failed to fetch fuel tanks: {}", lastError);
-                    cache_->AbortPopulation();
-                    backend_->Deauthorize();
-                    return false;
-                }
-                moreData = false;
-                break;
-            }
+        // Taken before the first request so that changes made during the sync are fetched again next time
+        const std::string syncWatermark = MakeSyncWatermark();
 
-            for (const auto& tank : tanks) {
-                if (!cache_->AddPopulationTank(tank.idTank, tank.visualNumberTank, tank.nameTank, tank.volume)) {
-                    LOG_ERROR("Failed to add tank cache entry for visual tank: {}", tank.visualNumberTank);
-                    cache_->AbortPopulation();
-                    backend_->Deauthorize();
-                    return false;
-                }
+        bool synced = false;
+        if (const auto watermark = cache_->GetSyncWatermark()) {
+            synced = DeltaSync(*watermark, syncWatermark);
+            if (!synced && running_) {
+                LOG_INFO("Delta synchronization not possible, falling back to full population");
             }
-
-            totalTanksFetched += static_cast<int>(tanks.size());
-            if (static_cast<int>(tanks.size()) < kFetchBatchSize) {
-                moreData = false;
-            }
-
-            first += kFetchBatchSize;
         }
-        
-        if (!running_) {
-            LOG_WARN("Cache population interrupted by shutdown");
-            cache_->AbortPopulation();
-            backend_->Deauthorize();
-            return false;
+        if (!synced) {
+            synced = FullPopulation(syncWatermark);
         }
         
-        // Commit population (swap tables)
-        if (!cache_->CommitPopulation()) {
-            LOG_ERROR("Failed to commit cache population");
+        if (!synced) {
             backend_->Deauthorize();
             return false;
         }
-        
-        LOG_INFO("Cache population completed: {} card entries loaded, {} tank entries loaded",
-                 totalFetched, totalTanksFetched);
+
+        const BloomFilterStats bloomStats = cache_->GetBloomFilterStats();
+        LOG_INFO("Bloom filter: {} lookups, {} rejected, observed FP rate {:.4f}, estimated FP rate {:.4f}",
+                 bloomStats.lookups, bloomStats.rejected, bloomStats.ObservedFalsePositiveRate(),
+                 bloomStats.estimatedFalsePositiveRate);
         
         // Close synchronization session - this is critical for cleanup
         // If deauthorization fails, we still return true because the data was successfully loaded
@@ -322,4 +253,170 @@ bool CacheManager::PopulateCache() {
     }
 }
 
+bool CacheManager::FullPopulation(const std::string& syncWatermark) {
+    // Begin population (prepares standby table)
+    if (!cache_->BeginPopulation()) {
+        LOG_ERROR("Failed to begin cache population");
+        return false;
+    }
+    
+    // Two-stage pipeline: this thread downloads pages while the insert stage writes
+    // the previous ones, so the GPRS round trip and the SQLite commit overlap
+    BoundedQueue<std::vector<UserCard>> pages(kPipelineDepth);
+    std::atomic<bool> insertFailed{false};
+    int totalFetched = 0;
+
+    std::thread inserter([this, &pages, &insertFailed, &totalFetched]() {
+        while (auto cards = pages.Pop()) {
+            // Add the page to standby table in a single transaction
+            if (!cache_->AddPopulationEntries(*cards)) {
+                LOG_ERROR("Failed to add {} cache entries at offset {}", cards->size(), totalFetched);
+                insertFailed = true;
+                pages.Close();
+                return;
+            }
+            totalFetched += static_cast<int>(cards->size());
+        }
+    });
+
+    // Stop the insert stage and wait for the pages already queued
+    auto finishInserts = [&pages, &inserter]() {
+        pages.Close();
+        if (inserter.joinable()) {
+            inserter.join();
+        }
+    };
+
+    try {
+        int first = 0;
+        bool moreData = true;
+
+        while (moreData && running_) {
+            // Fetch batch of user cards
+            LOG_DEBUG("Fetching user cards: first={}, number={}", first, kFetchBatchSize);
+            std::vector<UserCard> cards = backend_->FetchUserCards(first, kFetchBatchSize);
+
+            if (cards.empty()) {
+                // No more data
+                break;
+            }
+
+            // Check if we got fewer entries than requested (indicates end of data)
+            if (static_cast<int>(cards.size()) < kFetchBatchSize) {
+                moreData = false;
+            }
+
+            if (!pages.Push(std::move(cards))) {
+                // Insert stage failed and closed the queue
+                break;
+            }
+
+            first += kFetchBatchSize;
+        }
+    } catch (...) {
+        finishInserts();
+        throw;
+    }
+    finishInserts();
+
+    if (insertFailed) {
+        cache_->AbortPopulation();
+        return false;
+    }
+
+    std::vector<FuelTank> tanks;
+    if (running_ && !FetchAllTanks(tanks)) {
+        cache_->AbortPopulation();
+        return false;
+    }
+    
+    if (!running_) {
+        LOG_WARN("Cache population interrupted by shutdown");
+        cache_->AbortPopulation();
+        return false;
+    }
+
+    if (!cache_->AddPopulationTanks(tanks)) {
+        LOG_ERROR("Failed to add {} tank cache entries", tanks.size());
+        cache_->AbortPopulation();
+        return false;
+    }
+    
+    // Commit population (swap tables)
+    if (!cache_->CommitPopulation(syncWatermark)) {
+        LOG_ERROR("Failed to commit cache population");
+        return false;
+    }
+    
+    LOG_INFO("Cache population completed: {} card entries loaded, {} tank entries loaded",
+             totalFetched, tanks.size());
+    return true;
+}
+
+bool CacheManager::DeltaSync(const std::string& since, const std::string& syncWatermark) {
+    LOG_INFO("Starting delta synchronization since {}", since);
+
+    const auto delta = backend_->FetchUserCardChanges(since, kDeltaMaxChanges);
+    if (!delta) {
+        return false;
+    }
+
+    const std::size_t changes = delta->upserts.size() + delta->deletedUids.size();
+    if (delta->truncated || changes > static_cast<std::size_t>(kDeltaMaxChanges)) {
+        LOG_INFO("Card changes exceed delta limit of {}", kDeltaMaxChanges);
+        return false;
+    }
+
+    std::vector<FuelTank> tanks;
+    if (!running_ || !FetchAllTanks(tanks)) {
+        return false;
+    }
+
+    // Prefer the server's own sync point when it provides one
+    const std::string& nextWatermark = delta->watermark.empty() ? syncWatermark : delta->watermark;
+    if (!cache_->ApplyDelta(delta->upserts, delta->deletedUids, tanks, nextWatermark)) {
+        LOG_ERROR("Failed to apply card changes to cache");
+        return false;
+    }
+
+    LOG_INFO("Delta synchronization completed: {} cards updated, {} removed, {} tank entries loaded",
+             delta->upserts.size(), delta->deletedUids.size(), tanks.size());
+    return true;
+}
+
+bool CacheManager::FetchAllTanks(std::vector<FuelTank>& tanks) {
+    int first = 0;
+    bool moreData = true;
+    while (moreData && running_) {
+        LOG_DEBUG("Fetching fuel tanks: first={}, number={}", first, kFetchBatchSize);
+        std::vector<FuelTank> batch = backend_->FetchFuelTanks(first, kFetchBatchSize);
+
+        if (batch.empty()) {
+            const std::string lastError = backend_->GetLastError();
+            if (!lastError.empty()) {
+                LOG_ERROR("Failed to fetch fuel tanks: {}", lastError);
+                return false;
+            }
+            break;
+        }
+
+        if (static_cast<int>(batch.size()) < kFetchBatchSize) {
+            moreData = false;
+        }
+        tanks.insert(tanks.end(), batch.begin(), batch.end());
+        first += kFetchBatchSize;
+    }
+    return true;
+}
+
+std::string CacheManager::MakeSyncWatermark() const {
+    const auto point = std::chrono::system_clock::now() - kDeltaWatermarkOverlap;
+    const std::time_t time = std::chrono::system_clock::to_time_t(point);
+    std::tm utc{};
+    gmtime_r(&time, &utc);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buffer;
+}
+
 } // namespace fuelflux
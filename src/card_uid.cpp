@@ -0,0 +1,91 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "card_uid.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace fuelflux {
+
+namespace {
+
+constexpr std::size_t kDigitsPerByte = 3;
+
+bool IsValidSize(std::size_t size) {
+    return size == 4 || size == 7 || size == 10;
+}
+
+} // namespace
+
+std::optional<CardUid> CardUid::FromBytes(const std::uint8_t* data, std::size_t size) {
+    if (!data || !IsValidSize(size)) {
+        return std::nullopt;
+    }
+    CardUid uid;
+    std::memcpy(uid.bytes_.data(), data, size);
+    uid.size_ = static_cast<std::uint8_t>(size);
+    return uid;
+}
+
+std::optional<CardUid> CardUid::Parse(std::string_view uid) {
+    if (uid.size() % kDigitsPerByte != 0 || !IsValidSize(uid.size() / kDigitsPerByte)) {
+        return std::nullopt;
+    }
+
+    CardUid result;
+    result.size_ = static_cast<std::uint8_t>(uid.size() / kDigitsPerByte);
+    for (std::size_t i = 0; i < result.size_; ++i) {
+        int value = 0;
+        for (std::size_t j = 0; j < kDigitsPerByte; ++j) {
+            const char c = uid[i * kDigitsPerByte + j];
+            if (c < '0' || c > '9') {
+                return std::nullopt;
+            }
+            value = value * 10 + (c - '0');
+        }
+        if (value > 0xFF) {
+            return std::nullopt;
+        }
+        result.bytes_[i] = static_cast<std::uint8_t>(value);
+    }
+    return result;
+}
+
+std::string CardUid::ToString() const {
+    std::string result(size_ * kDigitsPerByte, '0');
+    for (std::size_t i = 0; i < size_; ++i) {
+        const std::uint8_t value = bytes_[i];
+        result[i * kDigitsPerByte] = static_cast<char>('0' + value / 100);
+        result[i * kDigitsPerByte + 1] = static_cast<char>('0' + value / 10 % 10);
+        result[i * kDigitsPerByte + 2] = static_cast<char>('0' + value % 10);
+    }
+    return result;
+}
+
+std::string CardUid::ToHex() const {
+    static constexpr char kHexDigits[] = "0123456789ABCDEF";
+    std::string result(size_ * 2, '0');
+    for (std::size_t i = 0; i < size_; ++i) {
+        result[i * 2] = kHexDigits[bytes_[i] >> 4];
+        result[i * 2 + 1] = kHexDigits[bytes_[i] & 0x0F];
+    }
+    return result;
+}
+
+std::size_t CardUid::Hash() const {
+    std::uint64_t hash = 0xCBF29CE484222325ULL;
+    for (std::size_t i = 0; i < size_; ++i) {
+        hash ^= bytes_[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+bool CardUid::operator<(const CardUid& other) const {
+    return std::lexicographical_compare(bytes_.begin(), bytes_.begin() + size_,
+                                        other.bytes_.begin(), other.bytes_.begin() + other.size_);
+}
+
+} // namespace fuelflux
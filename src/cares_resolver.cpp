@@ -4,6 +4,7 @@
 
 #include "cares_resolver.h"
 #include "config.h"
+#include "link_monitor.h"
 #include "url_utils.h"
 #include "logger.h"
 #include <ares.h>
@@ -12,11 +13,16 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <cstring>
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
 #include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <sys/select.h>
 #include <sys/time.h>
 
@@ -143,6 +149,18 @@ void HostCallback(void* arg, int status, int timeouts, struct hostent* host) {
     }
 }
 
+bool IsIpAddress(const std::string& text) {
+    struct in_addr addr4;
+    struct in6_addr addr6;
+    return inet_pton(AF_INET, text.c_str(), &addr4) == 1 ||
+           inet_pton(AF_INET6, text.c_str(), &addr6) == 1;
+}
+
+// Seconds since the epoch; the cache file outlives the steady clock of the process
+std::int64_t WallClockSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
 
 } // namespace
 
@@ -208,13 +226,28 @@ void CleanupCaresLibrary() {
 }
 
 CaresResolver::CaresResolver()
-    : CaresResolver(ExtractHostFromUrl(BACKEND_API_URL), Clock::now) {}
+    : CaresResolver(ExtractHostFromUrl(BACKEND_API_URL), Clock::now, DNS_CACHE_PATH) {}
 
-CaresResolver::CaresResolver(const std::string& cachedHostname, TimeProvider timeProvider)
+CaresResolver::CaresResolver(const std::string& cachedHostname, TimeProvider timeProvider, std::string cachePath)
     : cached_hostname_(cachedHostname),
-      time_provider_(std::move(timeProvider)) {}
+      time_provider_(std::move(timeProvider)),
+      cache_path_(std::move(cachePath)) {
+    LoadCacheFile();
+    // Called on the monitor thread: only flags the event, resolve_mutex_ may be held long
+    link_listener_ = LinkMonitor::Instance().Subscribe([this](LinkMonitor::State state, const std::string&) {
+        if (state == LinkMonitor::State::Up) {
+            link_restored_ = true;
+        }
+    });
+}
 
 CaresResolver::~CaresResolver() {
+    LinkMonitor::Instance().Unsubscribe(link_listener_);
+    // A refresh in progress gives up within one select() iteration
+    stopping_ = true;
+    if (refresh_thread_.joinable()) {
+        refresh_thread_.join();
+    }
 }
 
 bool CaresResolver::HasValidTargetedCacheForTesting() const {
@@ -230,6 +263,11 @@ std::string CaresResolver::GetTargetedCachedIpForTesting() const {
     return backend_api_cache_entry_->ip;
 }
 
+void CaresResolver::WaitForRefreshForTesting() {
+    std::unique_lock<std::mutex> lock(resolve_mutex_);
+    refresh_done_.wait(lock, [this]() { return !refreshing_; });
+}
+
 bool CaresResolver::IsBackendApiHostname(const std::string& hostname) const {
     return !cached_hostname_.empty() && hostname == cached_hostname_;
 }
@@ -257,19 +295,79 @@ std::string CaresResolver::Resolve(const std::string& hostname, const std::strin
                   interface.empty() ? "" : " via " + interface);
     
     // Check if hostname is already an IP address
-    struct in_addr addr4;
-    struct in6_addr addr6;
-    if (inet_pton(AF_INET, hostname.c_str(), &addr4) == 1 ||
-        inet_pton(AF_INET6, hostname.c_str(), &addr6) == 1) {
+    if (IsIpAddress(hostname)) {
         LOG_BCK_DEBUG("Hostname {} is already an IP address", hostname);
         return hostname;
     }
 
-    if (IsBackendApiHostname(hostname) && HasValidBackendCacheEntry()) {
+    const bool backendApi = IsBackendApiHostname(hostname);
+    if (backendApi && backend_api_cache_entry_.has_value()) {
+        const CacheEntry& entry = *backend_api_cache_entry_;
+        const TimePoint now = time_provider_();
+        if (now < entry.expiresAt - timing::kBackendApiDnsRefreshAhead) {
+            LOG_BCK_DEBUG("Using cached DNS entry for {} -> {}", hostname, entry.ip);
+            return entry.ip;
+        }
+        if (now < entry.expiresAt + timing::kBackendApiDnsMaxStale) {
+            if (now >= entry.expiresAt) {
+                LOG_BCK_WARN("DNS entry for {} expired; serving last known address {} until it is refreshed",
+                             hostname, entry.ip);
+            } else {
+                LOG_BCK_DEBUG("Using cached DNS entry for {} -> {} (refreshing ahead of expiry)", hostname, entry.ip);
+            }
+            StartRefresh(interface);
+            return entry.ip;
+        }
+        LOG_BCK_WARN("Last known address of {} is too old to be served; resolving again", hostname);
+    }
+
+    const std::string ip = Lookup(hostname, interface, stopping_);
+    if (ip.empty()) {
+        if (backendApi && backend_api_cache_entry_.has_value()) {
+            // Still better than libcurl's own lookup, which would fail the same way
+            LOG_BCK_WARN("Serving last known address {} of {} after a failed lookup", backend_api_cache_entry_->ip,
+                         hostname);
+            return backend_api_cache_entry_->ip;
+        }
+        return "";
+    }
+
+    LOG_BCK_DEBUG("Resolved {} -> {} via Yandex DNS{}", 
+                  hostname, ip,
+                  interface.empty() ? "" : " on " + interface);
+
+    if (backendApi) {
+        UpdateBackendCacheEntry(ip);
+    }
+
+    return ip;
+}
+
+std::optional<std::string> CaresResolver::ResolveCached(const std::string& hostname, const std::string& interface) {
+    if (IsIpAddress(hostname)) {
+        return hostname;
+    }
+    // Resolve() holds the mutex for the whole lookup; do not queue up behind it
+    std::unique_lock<std::mutex> lock(resolve_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || g_cares_init_state.load(std::memory_order_acquire) != InitState::Initialized ||
+        !IsBackendApiHostname(hostname)) {
+        return std::nullopt;
+    }
+
+    const TimePoint now = time_provider_();
+    if (backend_api_cache_entry_.has_value() && now < backend_api_cache_entry_->expiresAt + timing::kBackendApiDnsMaxStale) {
+        if (now >= backend_api_cache_entry_->expiresAt - timing::kBackendApiDnsRefreshAhead) {
+            StartRefresh(interface);
+        }
         LOG_BCK_DEBUG("Using cached DNS entry for {} -> {}", hostname, backend_api_cache_entry_->ip);
         return backend_api_cache_entry_->ip;
     }
-    
+    StartRefresh(interface);
+    return std::nullopt;
+}
+
+std::string CaresResolver::Lookup(const std::string& hostname, const std::string& interface,
+                                  const std::atomic<bool>& cancel) {
     AresChannel channel(interface);
     if (!channel.isInitialized()) {
         LOG_BCK_ERROR("Failed to initialize c-ares channel");
@@ -292,6 +390,11 @@ std::string CaresResolver::Resolve(const std::string& hostname, const std::strin
     int loopCount = 0;
     
     while (!ctx.done) {
+        if (cancel.load(std::memory_order_acquire)) {
+            LOG_BCK_DEBUG("DNS resolution of {} cancelled", hostname);
+            break;
+        }
+
         // Check overall timeout to prevent infinite hangs
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::steady_clock::now() - startTime);
@@ -346,17 +449,111 @@ std::string CaresResolver::Resolve(const std::string& hostname, const std::strin
         LOG_BCK_ERROR("DNS resolution failed for {}: {}", hostname, ares_strerror(ctx.status));
         return "";
     }
-    
-    LOG_BCK_DEBUG("Resolved {} -> {} via Yandex DNS{}", 
-                  hostname, ctx.result,
-                  interface.empty() ? "" : " on " + interface);
 
-    if (IsBackendApiHostname(hostname)) {
-        backend_api_cache_entry_ = CacheEntry{ctx.result, time_provider_() + kBackendApiCacheTtl};
-        LOG_BCK_DEBUG("Updated targeted DNS cache for {} (valid for 24h)", hostname);
+    return ctx.result;
+}
+
+void CaresResolver::UpdateBackendCacheEntry(const std::string& ip) {
+    backend_api_cache_entry_ = CacheEntry{ip, time_provider_() + kBackendApiCacheTtl};
+    next_refresh_attempt_.reset();
+    LOG_BCK_DEBUG("Updated targeted DNS cache for {} (valid for 24h)", cached_hostname_);
+    SaveCacheFile(ip);
+}
+
+void CaresResolver::StartRefresh(const std::string& interface) {
+    if (refreshing_ || stopping_.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (link_restored_.exchange(false)) {
+        // A failed refresh most likely failed because the link was down
+        next_refresh_attempt_.reset();
+    }
+    if (interface == kPppInterface && LinkMonitor::Instance().GetState() == LinkMonitor::State::Down) {
+        return;  // Cannot reach the DNS servers; the cached entry keeps being served
+    }
+    if (next_refresh_attempt_.has_value() && time_provider_() < *next_refresh_attempt_) {
+        return;
     }
+    // The previous refresh has finished (refreshing_ is false); reap its thread
+    if (refresh_thread_.joinable()) {
+        refresh_thread_.join();
+    }
+    refreshing_ = true;
+    refresh_thread_ = std::thread(&CaresResolver::RefreshThread, this, interface);
+}
 
-    return ctx.result;
+void CaresResolver::RefreshThread(std::string interface) {
+    LOG_BCK_INFO("Refreshing DNS entry for {} in the background", cached_hostname_);
+    const std::string ip = Lookup(cached_hostname_, interface, stopping_);
+
+    std::lock_guard<std::mutex> lock(resolve_mutex_);
+    if (!ip.empty()) {
+        LOG_BCK_INFO("Refreshed DNS entry for {} -> {}", cached_hostname_, ip);
+        UpdateBackendCacheEntry(ip);
+    } else {
+        next_refresh_attempt_ = time_provider_() + timing::kBackendApiDnsRefreshRetry;
+        if (backend_api_cache_entry_.has_value()) {
+            LOG_BCK_WARN("Background DNS refresh of {} failed; keeping last known address {}", cached_hostname_,
+                         backend_api_cache_entry_->ip);
+        }
+    }
+    refreshing_ = false;
+    refresh_done_.notify_all();
+}
+
+void CaresResolver::LoadCacheFile() {
+    if (cache_path_.empty() || cached_hostname_.empty()) {
+        return;
+    }
+    std::ifstream file(cache_path_);
+    if (!file) {
+        return;
+    }
+
+    // One line: hostname, address and the time it was resolved (seconds since the epoch)
+    std::string hostname;
+    std::string ip;
+    std::int64_t resolvedAt = 0;
+    if (!(file >> hostname >> ip >> resolvedAt) || !IsIpAddress(ip)) {
+        LOG_BCK_WARN("Ignoring malformed DNS cache file: {}", cache_path_);
+        return;
+    }
+    if (hostname != cached_hostname_) {
+        LOG_BCK_INFO("Ignoring DNS cache file for another host ({}): {}", hostname, cache_path_);
+        return;
+    }
+
+    // A clock that went backwards makes the entry look fresh rather than from the future
+    const std::chrono::seconds age(std::max<std::int64_t>(0, WallClockSeconds() - resolvedAt));
+    backend_api_cache_entry_ = CacheEntry{ip, time_provider_() - age + kBackendApiCacheTtl};
+    LOG_BCK_INFO("Loaded cached address of {} -> {} (resolved {}s ago)", hostname, ip, age.count());
+}
+
+void CaresResolver::SaveCacheFile(const std::string& ip) const {
+    if (cache_path_.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    const auto directory = std::filesystem::path(cache_path_).parent_path();
+    if (!directory.empty()) {
+        std::filesystem::create_directories(directory, error);
+    }
+
+    // Write a temporary file and rename it, so a crash never leaves a partial line behind
+    const std::string tempPath = cache_path_ + ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (file) {
+            file << cached_hostname_ << ' ' << ip << ' ' << WallClockSeconds() << '\n';
+            written = static_cast<bool>(file.flush());
+        }
+    }
+    if (!written || std::rename(tempPath.c_str(), cache_path_.c_str()) != 0) {
+        LOG_BCK_WARN("Failed to write DNS cache file: {}", cache_path_);
+        std::remove(tempPath.c_str());
+    }
 }
 
 } // namespace fuelflux
@@ -0,0 +1,101 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "circuit_breaker.h"
+
+#include "logger.h"
+
+namespace fuelflux {
+
+CircuitBreaker::CircuitBreaker(int failureThreshold, Clock::duration probeInterval, TimeProvider now)
+    : failureThreshold_(failureThreshold)
+    , probeInterval_(probeInterval)
+    , now_(std::move(now)) {
+}
+
+bool CircuitBreaker::Allow() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (state_) {
+    case State::Closed:
+        return true;
+    case State::HalfOpen:
+        if (trialInFlight_) {
+            return false;
+        }
+        trialInFlight_ = true;
+        return true;
+    case State::Open:
+        break;
+    }
+    return false;
+}
+
+void CircuitBreaker::Cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trialInFlight_ = false;
+}
+
+bool CircuitBreaker::TryStartProbe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::Open || probing_ || now_() < nextProbe_) {
+        return false;
+    }
+    probing_ = true;
+    return true;
+}
+
+void CircuitBreaker::ProbeFinished(bool reachable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    probing_ = false;
+    if (state_ != State::Open) {
+        return;  // A request closed it meanwhile
+    }
+    if (reachable) {
+        state_ = State::HalfOpen;
+        trialInFlight_ = false;
+        LOG_BCK_INFO("Backend is reachable again; the next request decides whether the circuit closes");
+    } else {
+        nextProbe_ = now_() + probeInterval_;
+        LOG_BCK_DEBUG("Backend probe failed; circuit stays open");
+    }
+}
+
+void CircuitBreaker::RecordResult(bool success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trialInFlight_ = false;
+    if (success) {
+        if (state_ != State::Closed) {
+            LOG_BCK_INFO("Backend request succeeded; circuit closed");
+        }
+        state_ = State::Closed;
+        failures_ = 0;
+        return;
+    }
+    switch (state_) {
+    case State::Closed:
+        if (++failures_ >= failureThreshold_) {
+            Open("consecutive network errors");
+        }
+        break;
+    case State::HalfOpen:
+        Open("the trial request failed");
+        break;
+    case State::Open:
+        break;  // A request that was already in flight when it opened
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::GetState() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+void CircuitBreaker::Open(const char* reason) {
+    state_ = State::Open;
+    failures_ = 0;
+    nextProbe_ = now_() + probeInterval_;
+    LOG_BCK_WARN("Backend circuit opened ({}); requests fail at once until a probe reaches the backend", reason);
+}
+
+} // namespace fuelflux
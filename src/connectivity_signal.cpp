@@ -0,0 +1,44 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "connectivity_signal.h"
+
+#include "logger.h"
+
+namespace fuelflux {
+
+ConnectivitySignal& ConnectivitySignal::Instance() {
+    static ConnectivitySignal instance;
+    return instance;
+}
+
+int ConnectivitySignal::Subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int id = nextId_++;
+    listeners_.emplace(id, std::move(listener));
+    return id;
+}
+
+void ConnectivitySignal::Unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.erase(id);
+}
+
+void ConnectivitySignal::ReportSuccess() {
+    if (!down_.exchange(false)) {
+        return;
+    }
+
+    LOG_BCK_INFO("Network connectivity restored");
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [id, listener] : listeners_) {
+        listener();
+    }
+}
+
+void ConnectivitySignal::ReportNetworkError() {
+    down_ = true;
+}
+
+} // namespace fuelflux
@@ -313,7 +313,7 @@ void ConsoleCardReader::simulateCardPresented(const UserId& userId) {
 
     std::lock_guard<std::mutex> lock(callbackMutex_);
     if (cardPresentedCallback_) {
-        cardPresentedCallback_(userId);
+        cardPresentedCallback_(userId, CardUid::Parse(userId));
     }
 }
 
@@ -728,7 +728,7 @@ void ConsoleEmulator::setCacheManager(std::shared_ptr<CacheManager> cacheManager
     cacheManager_ = std::move(cacheManager);
 }
 
-void ConsoleEmulator::setUserCache(std::shared_ptr<UserCache> userCache) {
+void ConsoleEmulator::setUserCache(std::shared_ptr<IUserCache> userCache) {
     userCache_ = std::move(userCache);
 }
 
@@ -4,11 +4,14 @@
 
 #include "controller.h"
 #include "backend.h"
+#include "backlog_payload.h"
 #include "config.h"
 #include "console_emulator.h"
 #include "user_cache.h"
+#include "user_cache_snapshot.h"
 #include "cache_manager.h"
 #include "message_storage.h"
+#include "tls_session_store.h"
 #include "logger.h"
 #include "peripherals/flow_meter.h"
 #include <sstream>
@@ -17,22 +20,35 @@
 #include <thread>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
 
 
 namespace fuelflux {
 
+namespace {
+
+// One store for all backends of the process: they talk to the same server
+std::shared_ptr<TlsSessionStore> DefaultTlsSessionStore() {
+    static const auto store = std::make_shared<TlsSessionStore>(TLS_SESSION_PATH);
+    return store;
+}
+
+} // namespace
+
 std::shared_ptr<IBackend> Controller::CreateDefaultBackend(std::shared_ptr<MessageStorage> storage) {
-    return std::make_shared<Backend>(BACKEND_API_URL, CONTROLLER_UID, storage);
+    return std::make_shared<Backend>(BACKEND_API_URL, CONTROLLER_UID, storage, DefaultTlsSessionStore());
 }
 
 std::shared_ptr<IBackend> Controller::CreateDefaultBackendShared(const std::string& controllerUid, 
                                                                   std::shared_ptr<MessageStorage> storage) {
-    return std::make_shared<Backend>(BACKEND_API_URL, controllerUid, storage);
+    return std::make_shared<Backend>(BACKEND_API_URL, controllerUid, storage, DefaultTlsSessionStore());
 }
 
 Controller::Controller(ControllerId controllerId,
                        std::shared_ptr<IBackend> backend,
-                       std::chrono::seconds noFlowCancelTimeout)
+                       std::chrono::seconds noFlowCancelTimeout,
+                       std::chrono::milliseconds authHedgeDelay,
+                       UserCacheEngine cacheEngine)
     : controllerId_(std::move(controllerId))
     , stateMachine_(this)
     , backend_(backend ? std::move(backend) : CreateDefaultBackend())
@@ -42,19 +58,25 @@ Controller::Controller(ControllerId controllerId,
     , currentRefuelVolume_(0.0)
     , targetRefuelVolume_(0.0)
     , isRunning_(false)
+    , authHedgeDelay_(authHedgeDelay)
     , noFlowCancelTimeout_(noFlowCancelTimeout)
 {
     resetSessionData();
     
     // Initialize user cache and cache manager
     try {
-        userCache_ = std::make_shared<UserCache>(CACHE_DB_PATH);
+        const std::string& cachePath = cacheEngine == UserCacheEngine::Snapshot ? CACHE_SNAPSHOT_PATH : CACHE_DB_PATH;
+        if (cacheEngine == UserCacheEngine::Snapshot) {
+            userCache_ = std::make_shared<MappedUserCache>(cachePath);
+        } else {
+            userCache_ = std::make_shared<UserCache>(cachePath);
+        }
         // Create a separate backend instance for cache manager synchronization to avoid JWT token conflicts
         // The cache manager needs its own backend with independent session state so that synchronization
         // operations don't interfere with concurrent user authorization sessions in the main backend
         auto syncBackend = CreateDefaultBackendShared(backend_->GetControllerUid(), nullptr);
         cacheManager_ = std::make_shared<CacheManager>(userCache_, syncBackend);
-        LOG_CTRL_INFO("User cache initialized at: {}", CACHE_DB_PATH);
+        LOG_CTRL_INFO("User cache initialized at: {}", cachePath);
     } catch (const std::exception& e) {
         LOG_CTRL_ERROR("Failed to initialize user cache: {}", e.what());
         // Continue without cache - non-blocking
@@ -163,6 +185,7 @@ bool Controller::reinitializeDevice() {
     resetSessionData();
     // Clear input without triggering display update
     currentInput_.clear();
+    presentedCard_.reset();
 
     if (ok) {
         LOG_CTRL_INFO("Device reinitialization complete");
@@ -179,6 +202,9 @@ void Controller::run() {
     threadExited_ = false;
     
     while (isRunning_) {
+        reconcilePendingAuthorization();
+        reapAbandonedAuthorizations();
+
         bool haveEvent = false;
         Event event = Event::Timeout; // initialize but treat as invalid until popped
         {
@@ -256,6 +282,10 @@ void Controller::setFlowMeter(std::unique_ptr<peripherals::IFlowMeter> flowMeter
     flowMeter_ = std::move(flowMeter);
 }
 
+void Controller::setBackendFactory(BackendFactory factory) {
+    backendFactory_ = std::move(factory);
+}
+
 // Input handling
 void Controller::handleKeyPress(KeyCode key) {
     LOG_CTRL_DEBUG("Key pressed: {}", static_cast<char>(key));
@@ -312,10 +342,11 @@ void Controller::handleKeyPress(KeyCode key) {
 
 }
 
-void Controller::handleCardPresented(const UserId& userId) {
+void Controller::handleCardPresented(const UserId& userId, const std::optional<CardUid>& cardUid) {
     LOG_CTRL_INFO("Card presented: {}", userId);
     // Store the user ID and let state machine handle authorization
     currentInput_ = userId;
+    presentedCard_ = cardUid;
     postEvent(Event::CardPresented);
 }
 
@@ -436,6 +467,7 @@ void Controller::startNewSession() {
 }
 
 void Controller::endCurrentSession() {
+    const bool sessionFromCache = sessionAuthorizedFromCache_;
     resetSessionData();
     clearInputSilent();
     if (pump_ && pump_->isRunning()) {
@@ -444,18 +476,26 @@ void Controller::endCurrentSession() {
     if (flowMeter_) {
         flowMeter_->stopMeasurement();
     }
-    if (!sessionAuthorizedFromCache_ && backend_ && backend_->IsAuthorized()) {
-        (void)backend_->Deauthorize();
+    closeBackendSession(sessionFromCache);
+}
+
+void Controller::closeBackendSession(bool sessionFromCache) {
+    // A hedged request still in flight is closed by reconcilePendingAuthorization when it lands
+    if (sessionFromCache || pendingAuthorization_.valid() || !backend_ || !backend_->IsAuthorized()) {
+        return;
     }
+    (void)backend_->Deauthorize();
 }
 
 void Controller::clearInput() {
     currentInput_.clear();
+    presentedCard_.reset();
     postEvent(Event::InputUpdated);
 }
 
 void Controller::clearInputSilent() {
     currentInput_.clear();
+    presentedCard_.reset();
     // No updateDisplay() call - avoid overwriting error messages
 }
 
@@ -464,6 +504,7 @@ void Controller::addDigitToInput(char digit) {
     // against abnormal or chained conditions that could grow the buffer indefinitely.
     if (currentInput_.length() < INPUT_MAX_LENGTH) { 
         currentInput_ += digit;
+        presentedCard_.reset();
         postEvent(Event::InputUpdated);
     }
 }
@@ -471,90 +512,246 @@ void Controller::addDigitToInput(char digit) {
 void Controller::removeLastDigit() {
     if (!currentInput_.empty()) {
         currentInput_.pop_back();
+        presentedCard_.reset();
         postEvent(Event::InputUpdated);
     }
 }
 
 void Controller::setMaxValue() {
     currentInput_ = std::to_string(static_cast<int>(currentUser_.allowance));
+    presentedCard_.reset();
     postEvent(Event::InputUpdated);
 }
 
 // Authorization
-void Controller::requestAuthorization(const UserId& userId) {
+void Controller::requestAuthorization(const UserId& userId, const std::optional<CardUid>& cardUid) {
     if (!backend_) {
         showError("Backend unavailable");
         postEvent(Event::AuthorizationFailed);
         return;
     }
 
+    // A new user never waits for the previous hedged request: an answer that is there is
+    // applied, one still in flight keeps its backend and the session moves to a fresh one
+    reconcilePendingAuthorization();
+    abandonPendingAuthorization();
+
     // This method handles the actual authorization for both card and PIN
-    if (backend_->Authorize(userId)) {
-        sessionAuthorizedFromCache_ = false;
-        currentUser_.uid = userId;
-        currentUser_.role = static_cast<UserRole>(backend_->GetRoleId());
-        currentUser_.allowance = backend_->GetAllowance();
-        currentUser_.price = backend_->GetPrice();
-
-        availableTanks_.clear();
-        cachedFuelTanks_.clear();
-        for (const auto& tank : backend_->GetFuelTanks()) {
-            TankInfo info;
-            info.number = tank.visualNumberTank;
-            availableTanks_.push_back(info);
-            cachedFuelTanks_.push_back(tank);
-        }
-        
-        // Update cache with authorization data
-        if (cacheManager_) {
-            cacheManager_->UpdateCacheEntry(userId, currentUser_.allowance, 
-                                           static_cast<int>(currentUser_.role));
-        }
-        
+    if (authHedgeDelay_.count() <= 0 || !userCache_ || !messageStorage_) {
+        finishAuthorization(userId, cardUid, backend_->Authorize(userId));
+        return;
+    }
+
+    auto authorized = backend_->AuthorizeAsync(userId);
+    // Looked up while the request is in flight
+    const auto cached = lookupCachedEntry(userId, cardUid);
+    // Only customers are hedged: an allowance bounds what a stale cache entry can dispense
+    const bool hedgeable = cached.has_value() && static_cast<UserRole>(cached->roleId) == UserRole::Customer &&
+                           cached->allowance > 0.0;
+    if (hedgeable && authorized.wait_for(authHedgeDelay_) == std::future_status::timeout) {
+        applyCachedAuthorization(*cached);
+        currentUser_.allowance = std::min(currentUser_.allowance, timing::kAuthHedgeMaxAllowance);
+        pendingAuthorization_ = std::move(authorized);
+        pendingAuthorizationUser_ = userId;
+        sessionAwaitsBackend_ = true;
+        LOG_CTRL_WARN("Backend did not answer within {} ms; authorized user {} from cache until it does",
+                      authHedgeDelay_.count(), userId);
+        postEvent(Event::AuthorizationSuccess);
+        return;
+    }
+    finishAuthorization(userId, cardUid, authorized.get());
+}
+
+std::optional<UserCacheEntry> Controller::lookupCachedEntry(const UserId& userId,
+                                                            const std::optional<CardUid>& cardUid) const {
+    return cardUid ? userCache_->GetEntry(*cardUid) : userCache_->GetEntry(userId);
+}
+
+void Controller::finishAuthorization(const UserId& userId, const std::optional<CardUid>& cardUid, bool authorized) {
+    if (authorized) {
+        applyBackendAuthorization(userId);
         // Post event instead of processing it directly to maintain sequential event processing
         postEvent(Event::AuthorizationSuccess);
+        return;
+    }
+
+    // Check if it's a network error
+    bool isNetworkError = backend_->IsNetworkError();
+
+    // Try cache fallback if network error and cache is available
+    if (isNetworkError && userCache_ && messageStorage_) {
+        auto cached = lookupCachedEntry(userId, cardUid);
+        if (cached.has_value()) {
+            applyCachedAuthorization(*cached);
+            LOG_CTRL_WARN("Authorized user {} from cache due to backend network error", userId);
+            postEvent(Event::AuthorizationSuccess);
+            return;
+        }
+    }
+
+    // Post appropriate failure event
+    if (isNetworkError) {
+        // Network error (with or without cache) - cannot authorize
+        postEvent(Event::AuthorizationFailed);
     } else {
-        // Check if it's a network error
-        bool isNetworkError = backend_->IsNetworkError();
-        
-        // Try cache fallback if network error and cache is available
-        if (isNetworkError && userCache_ && messageStorage_) {
-            auto cached = userCache_->GetEntry(userId);
-            if (cached.has_value()) {
-                sessionAuthorizedFromCache_ = true;
-                currentUser_.uid = cached->uid;
-                currentUser_.role = static_cast<UserRole>(cached->roleId);
-                currentUser_.allowance = cached->allowance;
-                currentUser_.price = 0.0;
-                availableTanks_.clear();
-                cachedFuelTanks_.clear();
-                const auto cachedTanks = userCache_->GetTanks();
-                for (const auto& tank : cachedTanks) {
-                    TankInfo info;
-                    info.number = tank.visualNumberTank;
-                    availableTanks_.push_back(info);
-
-                    BackendTankInfo cachedInfo;
-                    cachedInfo.idTank = tank.idTank;
-                    cachedInfo.visualNumberTank = tank.visualNumberTank;
-                    cachedInfo.nameTank = tank.nameTank;
-                    cachedInfo.volume = tank.volume;
-                    cachedFuelTanks_.push_back(cachedInfo);
-                }
-                LOG_CTRL_WARN("Authorized user {} from cache due to backend network error", userId);
-                postEvent(Event::AuthorizationSuccess);
-                return;
-            }
+        // Not a network error - authorization denied
+        postEvent(Event::AuthorizationDenied);
+    }
+}
+
+void Controller::applyBackendAuthorization(const UserId& userId) {
+    sessionAuthorizedFromCache_ = false;
+    currentUser_.uid = userId;
+    currentUser_.role = static_cast<UserRole>(backend_->GetRoleId());
+    currentUser_.allowance = backend_->GetAllowance();
+    currentUser_.price = backend_->GetPrice();
+
+    availableTanks_.clear();
+    cachedFuelTanks_.clear();
+    for (const auto& tank : backend_->GetFuelTanks()) {
+        TankInfo info;
+        info.number = tank.visualNumberTank;
+        availableTanks_.push_back(info);
+        cachedFuelTanks_.push_back(tank);
+    }
+
+    // Update cache with authorization data
+    if (cacheManager_) {
+        cacheManager_->UpdateCacheEntry(userId, currentUser_.allowance,
+                                       static_cast<int>(currentUser_.role));
+    }
+}
+
+void Controller::applyCachedAuthorization(const UserCacheEntry& entry) {
+    sessionAuthorizedFromCache_ = true;
+    currentUser_.uid = entry.uid;
+    currentUser_.role = static_cast<UserRole>(entry.roleId);
+    currentUser_.allowance = entry.allowance;
+    currentUser_.price = 0.0;
+    availableTanks_.clear();
+    cachedFuelTanks_.clear();
+    const auto cachedTanks = userCache_->GetTanks();
+    for (const auto& tank : cachedTanks) {
+        TankInfo info;
+        info.number = tank.visualNumberTank;
+        availableTanks_.push_back(info);
+
+        BackendTankInfo cachedInfo;
+        cachedInfo.idTank = tank.idTank;
+        cachedInfo.visualNumberTank = tank.visualNumberTank;
+        cachedInfo.nameTank = tank.nameTank;
+        cachedInfo.volume = tank.volume;
+        cachedFuelTanks_.push_back(cachedInfo);
+    }
+}
+
+void Controller::reconcilePendingAuthorization() {
+    if (!pendingAuthorization_.valid() ||
+        pendingAuthorization_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    const bool authorized = pendingAuthorization_.get();
+    const UserId userId = std::move(pendingAuthorizationUser_);
+    pendingAuthorizationUser_.clear();
+    const bool sessionActive = sessionAwaitsBackend_;
+    sessionAwaitsBackend_ = false;
+
+    if (!sessionActive) {
+        // The session ran on the cached decision and its reports went to the backlog
+        LOG_CTRL_INFO("Backend answered hedged authorization of user {} after the session ended", userId);
+        if (authorized) {
+            // Not waited for: the next tap must not sit out a round trip for a finished session
+            (void)backend_->DeauthorizeAsync();
         }
-        
-        // Post appropriate failure event
-        if (isNetworkError) {
-            // Network error (with or without cache) - cannot authorize
-            postEvent(Event::AuthorizationFailed);
+        return;
+    }
+
+    if (!authorized) {
+        if (backend_->IsNetworkError()) {
+            LOG_CTRL_WARN("Backend unreachable for user {}; the session continues from cache", userId);
         } else {
-            // Not a network error - authorization denied
-            postEvent(Event::AuthorizationDenied);
+            LOG_CTRL_WARN("Backend denied user {} after a hedged authorization; cancelling the session", userId);
+            cancelHedgedSession();
         }
+        return;
+    }
+
+    const auto role = static_cast<UserRole>(backend_->GetRoleId());
+    if (role != currentUser_.role) {
+        LOG_CTRL_WARN("Backend role of user {} differs from the cache; cancelling the session", userId);
+        // The only close of this backend session: the cancelled session still counts as cached
+        (void)backend_->DeauthorizeAsync();
+        cancelHedgedSession();
+        return;
+    }
+
+    const TankNumber selectedTank = selectedTank_;
+    applyBackendAuthorization(userId);
+    LOG_CTRL_INFO("Backend confirmed hedged authorization of user {} (allowance {})", userId,
+                  currentUser_.allowance);
+    if (selectedTank != 0 && !isTankValid(selectedTank)) {
+        LOG_CTRL_WARN("Tank {} is not available to user {}; cancelling the session", selectedTank, userId);
+        cancelHedgedSession();
+        return;
+    }
+    // A refuel running on the cached allowance stops at the confirmed one
+    if (targetRefuelVolume_ > currentUser_.allowance) {
+        targetRefuelVolume_ = currentUser_.allowance;
+        if (pump_ && pump_->isRunning() && currentRefuelVolume_ >= targetRefuelVolume_) {
+            pump_->stop();
+        }
+    }
+    postEvent(Event::InputUpdated);
+}
+
+void Controller::abandonPendingAuthorization() {
+    if (!pendingAuthorization_.valid()) {
+        return;
+    }
+    LOG_CTRL_INFO("Backend has not answered hedged authorization of user {} yet; closing it when it does",
+                  pendingAuthorizationUser_);
+    abandonedAuthorizations_.push_back({std::move(pendingAuthorization_), backend_,
+                                        std::move(pendingAuthorizationUser_)});
+    pendingAuthorizationUser_.clear();
+    sessionAwaitsBackend_ = false;
+    // The abandoned request may still write the session state of its backend
+    backend_ = backendFactory_ ? backendFactory_()
+                               : CreateDefaultBackendShared(backend_->GetControllerUid(), messageStorage_);
+}
+
+void Controller::reapAbandonedAuthorizations() {
+    auto it = abandonedAuthorizations_.begin();
+    while (it != abandonedAuthorizations_.end()) {
+        if (it->authorized.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+        if (it->authorized.get()) {
+            LOG_CTRL_INFO("Backend answered abandoned hedged authorization of user {}; closing it", it->userId);
+            // The request keeps its backend alive until it is sent
+            (void)it->backend->DeauthorizeAsync();
+        }
+        it = abandonedAuthorizations_.erase(it);
+    }
+}
+
+void Controller::cancelHedgedSession() {
+    switch (stateMachine_.getCurrentState()) {
+        case SystemState::TankSelection:
+        case SystemState::VolumeEntry:
+            endCurrentSession();
+            // Processed right away so that a queued selection cannot start the pump first
+            stateMachine_.processEvent(Event::AuthorizationDenied);
+            break;
+        case SystemState::Refueling:
+            // What was dispensed is still reported when the pump stops
+            if (pump_) {
+                pump_->stop();
+            }
+            break;
+        default:
+            // The session is already finishing
+            break;
     }
 }
 
@@ -657,12 +854,12 @@ void Controller::completeRefueling() {
     transaction.timestamp = std::chrono::system_clock::now();
     
     logRefuelTransaction(transaction);
+    // A hedged session is reported from the cache by now; a late backend answer only closes it
+    sessionAwaitsBackend_ = false;
     
     // After completing refuel, deauthorize the user to close the session
     // Do not reset session data here so the final pumped volume remains visible
-    if (!sessionAuthorizedFromCache_ && backend_ && backend_->IsAuthorized()) {
-        (void)backend_->Deauthorize();
-    }
+    closeBackendSession(sessionAuthorizedFromCache_);
 }
 
 // Fuel intake operations
@@ -697,6 +894,7 @@ void Controller::completeIntakeOperation() {
     transaction.timestamp = std::chrono::system_clock::now();
     
     logIntakeTransaction(transaction);
+    sessionAwaitsBackend_ = false;
     // Event posting is now handled by state machine after data transmission
 }
 
@@ -711,7 +909,7 @@ void Controller::logRefuelTransaction(const RefuelTransaction& transaction) {
         payload["FuelVolume"] = transaction.volume;
         payload["TimeAt"] = timestampMs;
 
-        const bool stored = messageStorage_->AddBacklog(transaction.userId, MessageMethod::Refuel, payload.dump());
+        const bool stored = messageStorage_->AddBacklog(transaction.userId, MessageMethod::Refuel, EncodeBacklogPayload(payload));
         if (!stored) {
             LOG_CTRL_ERROR("Failed to save offline refuel report to backlog for user {}", transaction.userId);
         }
@@ -744,7 +942,7 @@ void Controller::logIntakeTransaction(const IntakeTransaction& transaction) {
         payload["Direction"] = static_cast<int>(transaction.direction);
         payload["TimeAt"] = timestampMs;
 
-        const bool stored = messageStorage_->AddBacklog(transaction.operatorId, MessageMethod::Intake, payload.dump());
+        const bool stored = messageStorage_->AddBacklog(transaction.operatorId, MessageMethod::Intake, EncodeBacklogPayload(payload));
         if (!stored) {
             LOG_CTRL_ERROR("Failed to save offline intake report to backlog for user {}", transaction.operatorId);
         }
@@ -809,8 +1007,8 @@ void Controller::setupPeripheralCallbacks() {
     }
     
     if (cardReader_) {
-        cardReader_->setCardPresentedCallback([this](const UserId& userId) {
-            handleCardPresented(userId);
+        cardReader_->setCardPresentedCallback([this](const UserId& userId, const std::optional<CardUid>& cardUid) {
+            handleCardPresented(userId, cardUid);
         });
         // Card reading is disabled by default - state machine will enable it
         // only when in Waiting or PinEntry states
@@ -915,6 +1113,7 @@ void Controller::resetSessionData() {
     currentRefuelVolume_ = 0.0;
     targetRefuelVolume_ = 0.0;
     sessionAuthorizedFromCache_ = false;
+    sessionAwaitsBackend_ = false;
 }
 
 bool Controller::initializePeripherals() {
@@ -0,0 +1,38 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "crc32.h"
+
+#include <array>
+
+namespace fuelflux {
+
+namespace {
+
+std::array<std::uint32_t, 256> MakeCrc32Table() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < table.size(); ++i) {
+        std::uint32_t value = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1U) ? (0xEDB88320U ^ (value >> 1)) : (value >> 1);
+        }
+        table[i] = value;
+    }
+    return table;
+}
+
+} // namespace
+
+std::uint32_t Crc32(const void* data, std::size_t size, std::uint32_t crc) {
+    static const std::array<std::uint32_t, 256> table = MakeCrc32Table();
+
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ bytes[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace fuelflux
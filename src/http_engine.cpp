@@ -0,0 +1,181 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "http_engine.h"
+
+#include <future>
+#include <stdexcept>
+
+#include "logger.h"
+#include "timing_config.h"
+
+namespace fuelflux {
+
+namespace {
+
+void RunCompletion(const HttpEngine::Completion& done, CURLcode result) {
+    try {
+        done(result);
+    } catch (const std::exception& e) {
+        LOG_BCK_ERROR("HTTP completion callback failed: {}", e.what());
+    }
+}
+
+} // namespace
+
+HttpEngine::HttpEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CreateMultiUnlocked();
+    }
+    if (!multi_) {
+        throw std::runtime_error("Failed to initialize curl multi handle");
+    }
+    ioThread_ = std::thread(&HttpEngine::IoThread, this);
+}
+
+HttpEngine::~HttpEngine() {
+    Shutdown();
+    if (multi_) {
+        curl_multi_cleanup(multi_);
+    }
+}
+
+HttpEngine& HttpEngine::Shared() {
+    static HttpEngine engine;
+    return engine;
+}
+
+void HttpEngine::CreateMultiUnlocked() {
+    if (multi_) {
+        curl_multi_cleanup(multi_);
+    }
+    multi_ = curl_multi_init();
+    if (multi_) {
+        // Overlapping requests to one server share a single HTTP/2 connection
+        curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+}
+
+bool HttpEngine::Submit(CURL* easy, Completion done) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shutdown_) {
+        return false;
+    }
+    pending_.emplace_back(easy, std::move(done));
+    ++active_;
+    curl_multi_wakeup(multi_);
+    return true;
+}
+
+CURLcode HttpEngine::Perform(CURL* easy) {
+    if (IsIoThread()) {
+        return curl_easy_perform(easy);
+    }
+    auto result = std::make_shared<std::promise<CURLcode>>();
+    auto future = result->get_future();
+    if (!Submit(easy, [result](CURLcode code) { result->set_value(code); })) {
+        return curl_easy_perform(easy);
+    }
+    return future.get();
+}
+
+void HttpEngine::ResetConnections() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    resetConnections_ = true;
+    curl_multi_wakeup(multi_);
+}
+
+void HttpEngine::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (shutdown_) {
+            return;
+        }
+        shutdown_ = true;
+        curl_multi_wakeup(multi_);
+    }
+    if (ioThread_.joinable()) {
+        ioThread_.join();
+    }
+}
+
+void HttpEngine::IoThread() {
+    LOG_BCK_DEBUG("HTTP engine I/O thread started");
+    for (;;) {
+        std::vector<std::pair<CURL*, Completion>> added;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (shutdown_) {
+                break;
+            }
+            // The pool goes with the multi handle, which may only be replaced while idle
+            if (resetConnections_ && running_.empty()) {
+                LOG_BCK_INFO("Closing pooled HTTP connections");
+                CreateMultiUnlocked();
+                resetConnections_ = false;
+                if (!multi_) {
+                    LOG_BCK_ERROR("Failed to recreate curl multi handle; stopping HTTP engine");
+                    shutdown_ = true;
+                    break;
+                }
+            }
+            added.swap(pending_);
+        }
+
+        for (auto& [easy, done] : added) {
+            const CURLMcode code = curl_multi_add_handle(multi_, easy);
+            if (code != CURLM_OK) {
+                LOG_BCK_ERROR("Failed to start HTTP transfer: {}", curl_multi_strerror(code));
+                --active_;
+                RunCompletion(done, CURLE_FAILED_INIT);
+                continue;
+            }
+            running_.emplace(easy, std::move(done));
+        }
+
+        int stillRunning = 0;
+        curl_multi_perform(multi_, &stillRunning);
+
+        int queued = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi_, &queued)) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+            CURL* easy = message->easy_handle;
+            const CURLcode result = message->data.result;
+            curl_multi_remove_handle(multi_, easy);
+            auto it = running_.find(easy);
+            if (it == running_.end()) {
+                continue;
+            }
+            Completion done = std::move(it->second);
+            running_.erase(it);
+            --active_;
+            RunCompletion(done, result);
+        }
+
+        curl_multi_poll(multi_, nullptr, 0,
+                        static_cast<int>(timing::kHttpEnginePollInterval.count()), nullptr);
+    }
+
+    // Whatever has not finished is reported as aborted
+    std::vector<std::pair<CURL*, Completion>> aborted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        aborted.swap(pending_);
+    }
+    for (auto& [easy, done] : running_) {
+        curl_multi_remove_handle(multi_, easy);
+        aborted.emplace_back(easy, std::move(done));
+    }
+    running_.clear();
+    for (auto& entry : aborted) {
+        --active_;
+        RunCompletion(entry.second, CURLE_ABORTED_BY_CALLBACK);
+    }
+    LOG_BCK_DEBUG("HTTP engine I/O thread stopped");
+}
+
+} // namespace fuelflux
@@ -0,0 +1,481 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "json_stream.h"
+
+#include <charconv>
+#include <utility>
+
+namespace fuelflux {
+
+namespace {
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+// Sets 'integer' if there is neither a fraction nor an exponent
+bool IsValidNumber(const std::string& text, bool& integer) {
+    const std::size_t n = text.size();
+    std::size_t i = 0;
+    if (i < n && text[i] == '-') {
+        ++i;
+    }
+    if (i < n && text[i] == '0') {
+        ++i;
+    } else if (i < n && IsDigit(text[i])) {
+        while (i < n && IsDigit(text[i])) ++i;
+    } else {
+        return false;
+    }
+    integer = true;
+    if (i < n && text[i] == '.') {
+        integer = false;
+        ++i;
+        if (i >= n || !IsDigit(text[i])) return false;
+        while (i < n && IsDigit(text[i])) ++i;
+    }
+    if (i < n && (text[i] == 'e' || text[i] == 'E')) {
+        integer = false;
+        ++i;
+        if (i < n && (text[i] == '+' || text[i] == '-')) ++i;
+        if (i >= n || !IsDigit(text[i])) return false;
+        while (i < n && IsDigit(text[i])) ++i;
+    }
+    return i == n;
+}
+
+} // namespace
+
+JsonStreamParser::JsonStreamParser(nlohmann::json::json_sax_t& handler)
+    : handler_(handler) {
+}
+
+bool JsonStreamParser::Feed(const char* data, std::size_t size) {
+    if (failed_) {
+        return false;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        if (!Consume(data[i])) {
+            return false;
+        }
+        ++position_;
+    }
+    return true;
+}
+
+bool JsonStreamParser::Finish() {
+    if (failed_) {
+        return false;
+    }
+    // A top-level number has no delimiter after it
+    if (token_ == Token::Number && !FinishNumber()) {
+        return false;
+    }
+    if (token_ != Token::None || expect_ != Expect::Done) {
+        return Fail("unexpected end of input");
+    }
+    return true;
+}
+
+bool JsonStreamParser::Consume(char c) {
+    switch (token_) {
+    case Token::String:
+        return ConsumeString(c);
+    case Token::Literal:
+        if (c != literal_[literalPos_]) {
+            return Fail("invalid literal");
+        }
+        if (literal_[++literalPos_] == '\0') {
+            return FinishLiteral();
+        }
+        return true;
+    case Token::Number:
+        if (IsDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            text_.push_back(c);
+            return true;
+        }
+        if (!FinishNumber()) {
+            return false;
+        }
+        break;  // 'c' starts the next token
+    case Token::None:
+        break;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        return true;
+    }
+
+    const bool inObject = !containers_.empty() && containers_.back() == '{';
+    switch (expect_) {
+    case Expect::Done:
+        return Fail("unexpected data after the value");
+    case Expect::Colon:
+        if (c == ':') {
+            expect_ = Expect::Value;
+            return true;
+        }
+        return Fail("expected ':'");
+    case Expect::KeyOrEnd:
+    case Expect::Key:
+        if (c == '"') {
+            token_ = Token::String;
+            tokenIsKey_ = true;
+            text_.clear();
+            return true;
+        }
+        if (c == '}' && expect_ == Expect::KeyOrEnd) {
+            break;
+        }
+        return Fail("expected a key");
+    case Expect::CommaOrEnd:
+        if (c == ',') {
+            expect_ = inObject ? Expect::Key : Expect::Value;
+            return true;
+        }
+        if (c == (inObject ? '}' : ']')) {
+            break;
+        }
+        return Fail("expected ',' or the end of the container");
+    case Expect::ValueOrEnd:
+        if (c == ']') {
+            break;
+        }
+        return StartValue(c);
+    case Expect::Value:
+        return StartValue(c);
+    }
+
+    // Close the innermost container
+    containers_.pop_back();
+    if (!(inObject ? handler_.end_object() : handler_.end_array())) {
+        return Fail("stopped by the handler");
+    }
+    return ValueDone();
+}
+
+bool JsonStreamParser::StartValue(char c) {
+    switch (c) {
+    case '{':
+    case '[':
+        if (containers_.size() >= kMaxDepth) {
+            return Fail("nesting too deep");
+        }
+        if (!(c == '{' ? handler_.start_object(static_cast<std::size_t>(-1))
+                       : handler_.start_array(static_cast<std::size_t>(-1)))) {
+            return Fail("stopped by the handler");
+        }
+        containers_.push_back(c);
+        expect_ = c == '{' ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+        return true;
+    case '"':
+        token_ = Token::String;
+        tokenIsKey_ = false;
+        text_.clear();
+        return true;
+    case 't':
+        literal_ = "true";
+        break;
+    case 'f':
+        literal_ = "false";
+        break;
+    case 'n':
+        literal_ = "null";
+        break;
+    default:
+        if (c == '-' || IsDigit(c)) {
+            token_ = Token::Number;
+            text_.assign(1, c);
+            return true;
+        }
+        return Fail("unexpected character");
+    }
+    token_ = Token::Literal;
+    literalPos_ = 1;
+    return true;
+}
+
+bool JsonStreamParser::ConsumeString(char c) {
+    if (escape_ >= 2) {
+        const int digit = HexValue(c);
+        if (digit < 0) {
+            return Fail("invalid \\u escape");
+        }
+        unicode_ = unicode_ * 16 + static_cast<std::uint32_t>(digit);
+        if (escape_ < 5) {
+            ++escape_;
+            return true;
+        }
+        escape_ = 0;
+        if (highSurrogate_ != 0) {
+            if (unicode_ < 0xDC00 || unicode_ > 0xDFFF) {
+                return Fail("unpaired surrogate");
+            }
+            AppendCodePoint(0x10000 + ((highSurrogate_ - 0xD800) << 10) + (unicode_ - 0xDC00));
+            highSurrogate_ = 0;
+        } else if (unicode_ >= 0xD800 && unicode_ <= 0xDBFF) {
+            highSurrogate_ = unicode_;
+        } else if (unicode_ >= 0xDC00 && unicode_ <= 0xDFFF) {
+            return Fail("unpaired surrogate");
+        } else {
+            AppendCodePoint(unicode_);
+        }
+        return true;
+    }
+
+    // A high surrogate must be followed by the \u escape of a low one
+    if (highSurrogate_ != 0 && !(escape_ == 0 && c == '\\') && !(escape_ == 1 && c == 'u')) {
+        return Fail("unpaired surrogate");
+    }
+
+    if (escape_ == 1) {
+        escape_ = 0;
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            text_.push_back(c);
+            return true;
+        case 'b': text_.push_back('\b'); return true;
+        case 'f': text_.push_back('\f'); return true;
+        case 'n': text_.push_back('\n'); return true;
+        case 'r': text_.push_back('\r'); return true;
+        case 't': text_.push_back('\t'); return true;
+        case 'u':
+            escape_ = 2;
+            unicode_ = 0;
+            return true;
+        default:
+            return Fail("invalid escape");
+        }
+    }
+
+    if (c == '"') {
+        token_ = Token::None;
+        return FinishString();
+    }
+    if (c == '\\') {
+        escape_ = 1;
+        return true;
+    }
+    if (static_cast<unsigned char>(c) < 0x20) {
+        return Fail("control character in string");
+    }
+    text_.push_back(c);
+    return true;
+}
+
+bool JsonStreamParser::FinishString() {
+    if (tokenIsKey_) {
+        if (!handler_.key(text_)) {
+            return Fail("stopped by the handler");
+        }
+        expect_ = Expect::Colon;
+        return true;
+    }
+    if (!handler_.string(text_)) {
+        return Fail("stopped by the handler");
+    }
+    return ValueDone();
+}
+
+bool JsonStreamParser::FinishNumber() {
+    token_ = Token::None;
+    bool integer = false;
+    if (!IsValidNumber(text_, integer)) {
+        return Fail("invalid number");
+    }
+
+    const char* first = text_.data();
+    const char* last = first + text_.size();
+    bool accepted = false;
+    bool parsed = false;
+    if (integer) {
+        // Out of range integers are reported as floats, as nlohmann does
+        if (text_[0] == '-') {
+            nlohmann::json::number_integer_t value = 0;
+            if (std::from_chars(first, last, value).ec == std::errc()) {
+                parsed = true;
+                accepted = handler_.number_integer(value);
+            }
+        } else {
+            nlohmann::json::number_unsigned_t value = 0;
+            if (std::from_chars(first, last, value).ec == std::errc()) {
+                parsed = true;
+                accepted = handler_.number_unsigned(value);
+            }
+        }
+    }
+    if (!parsed) {
+        nlohmann::json::number_float_t value = 0.0;
+        if (std::from_chars(first, last, value).ec != std::errc()) {
+            return Fail("number out of range");
+        }
+        accepted = handler_.number_float(value, text_);
+    }
+    if (!accepted) {
+        return Fail("stopped by the handler");
+    }
+    return ValueDone();
+}
+
+bool JsonStreamParser::FinishLiteral() {
+    token_ = Token::None;
+    bool accepted = false;
+    switch (literal_[0]) {
+    case 't': accepted = handler_.boolean(true); break;
+    case 'f': accepted = handler_.boolean(false); break;
+    default: accepted = handler_.null(); break;
+    }
+    if (!accepted) {
+        return Fail("stopped by the handler");
+    }
+    return ValueDone();
+}
+
+bool JsonStreamParser::ValueDone() {
+    expect_ = containers_.empty() ? Expect::Done : Expect::CommaOrEnd;
+    return true;
+}
+
+void JsonStreamParser::AppendCodePoint(std::uint32_t codePoint) {
+    if (codePoint < 0x80) {
+        text_.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        text_.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        text_.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        text_.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        text_.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        text_.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        text_.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        text_.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        text_.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        text_.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+bool JsonStreamParser::Fail(const std::string& message) {
+    failed_ = true;
+    error_ = message + " at byte " + std::to_string(position_);
+    return false;
+}
+
+JsonRecordReader::JsonRecordReader(RecordCallback onRecord)
+    : onRecord_(std::move(onRecord)) {
+}
+
+nlohmann::json* JsonRecordReader::Put(nlohmann::json value) {
+    if (open_.empty()) {
+        nlohmann::json& target = streaming_ ? record_ : root_;
+        target = std::move(value);
+        return &target;
+    }
+    nlohmann::json* parent = open_.back();
+    if (parent->is_object()) {
+        return &((*parent)[key_] = std::move(value));
+    }
+    parent->push_back(std::move(value));
+    return &parent->back();
+}
+
+bool JsonRecordReader::Completed() {
+    if (!streaming_ || !open_.empty()) {
+        return true;
+    }
+    ++records_;
+    const bool accepted = onRecord_(record_);
+    record_ = nullptr;
+    if (!accepted) {
+        stopped_ = true;
+    }
+    return accepted;
+}
+
+bool JsonRecordReader::null() {
+    Put(nullptr);
+    return Completed();
+}
+
+bool JsonRecordReader::boolean(bool val) {
+    Put(val);
+    return Completed();
+}
+
+bool JsonRecordReader::number_integer(number_integer_t val) {
+    Put(val);
+    return Completed();
+}
+
+bool JsonRecordReader::number_unsigned(number_unsigned_t val) {
+    Put(val);
+    return Completed();
+}
+
+bool JsonRecordReader::number_float(number_float_t val, const string_t& /*s*/) {
+    Put(val);
+    return Completed();
+}
+
+bool JsonRecordReader::string(string_t& val) {
+    Put(std::move(val));
+    return Completed();
+}
+
+bool JsonRecordReader::binary(binary_t& /*val*/) {
+    // JSON text has no binary values
+    return false;
+}
+
+bool JsonRecordReader::start_object(std::size_t /*elements*/) {
+    open_.push_back(Put(nlohmann::json::object()));
+    return true;
+}
+
+bool JsonRecordReader::key(string_t& val) {
+    key_ = std::move(val);
+    return true;
+}
+
+bool JsonRecordReader::end_object() {
+    open_.pop_back();
+    return Completed();
+}
+
+bool JsonRecordReader::start_array(std::size_t /*elements*/) {
+    if (open_.empty() && !streaming_) {
+        // The top-level array: hand out its items instead of collecting them
+        streaming_ = true;
+        root_ = nlohmann::json::array();
+        return true;
+    }
+    open_.push_back(Put(nlohmann::json::array()));
+    return true;
+}
+
+bool JsonRecordReader::end_array() {
+    if (open_.empty()) {
+        streaming_ = false;
+        return true;
+    }
+    open_.pop_back();
+    return Completed();
+}
+
+bool JsonRecordReader::parse_error(std::size_t /*position*/, const std::string& /*last_token*/,
+                                   const nlohmann::detail::exception& /*ex*/) {
+    return false;
+}
+
+} // namespace fuelflux
@@ -0,0 +1,63 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace fuelflux {
+
+std::chrono::microseconds LatencyHistogram::BucketUpperBound(std::size_t bucket) {
+    return std::chrono::microseconds(std::int64_t{1} << std::min(bucket, kBucketCount - 1));
+}
+
+void LatencyHistogram::Record(std::chrono::microseconds latency) {
+    const std::int64_t micros = std::max<std::int64_t>(0, latency.count());
+    std::size_t bucket = 0;
+    while (bucket + 1 < kBucketCount && micros >= BucketUpperBound(bucket).count()) {
+        ++bucket;
+    }
+
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    totalMicros_.fetch_add(micros, std::memory_order_relaxed);
+    std::int64_t currentMax = maxMicros_.load(std::memory_order_relaxed);
+    while (micros > currentMax &&
+           !maxMicros_.compare_exchange_weak(currentMax, micros, std::memory_order_relaxed)) {
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+    Snapshot snapshot;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.total = std::chrono::microseconds(totalMicros_.load(std::memory_order_relaxed));
+    snapshot.max = std::chrono::microseconds(maxMicros_.load(std::memory_order_relaxed));
+    return snapshot;
+}
+
+std::chrono::microseconds LatencyHistogram::Snapshot::Percentile(double q) const {
+    if (count == 0) {
+        return std::chrono::microseconds(0);
+    }
+    const auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= std::max<std::uint64_t>(rank, 1)) {
+            // The slowest sample is a tighter bound for the top bucket(s)
+            return (i + 1 == kBucketCount) ? max : std::min(BucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+std::chrono::microseconds LatencyHistogram::Snapshot::Mean() const {
+    return count == 0 ? std::chrono::microseconds(0) : total / static_cast<std::int64_t>(count);
+}
+
+} // namespace fuelflux
@@ -0,0 +1,325 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "link_monitor.h"
+
+#include "logger.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace fuelflux {
+
+namespace {
+
+const char* StateName(LinkMonitor::State state) {
+    switch (state) {
+    case LinkMonitor::State::Up:
+        return "up";
+    case LinkMonitor::State::Down:
+        return "down";
+    case LinkMonitor::State::Absent:
+        break;
+    }
+    return "absent";
+}
+
+#ifdef __linux__
+// Attribute payload as a string (IFLA_IFNAME, IFA_LABEL); the kernel NUL-terminates it
+std::string AttributeString(const struct rtattr* rta) {
+    const char* text = static_cast<const char*>(RTA_DATA(rta));
+    return std::string(text, strnlen(text, RTA_PAYLOAD(rta)));
+}
+#endif
+
+} // namespace
+
+LinkMonitor::LinkMonitor(std::string interface)
+    : interface_(std::move(interface)) {
+}
+
+LinkMonitor::~LinkMonitor() {
+    Stop();
+}
+
+LinkMonitor& LinkMonitor::Instance() {
+    static LinkMonitor monitor(kPppInterface);
+    return monitor;
+}
+
+bool LinkMonitor::Start() {
+    if (IsRunning()) {
+        return true;
+    }
+    // Reap a watcher that gave up after a socket error
+    Stop();
+#ifdef __linux__
+    const int fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        LOG_BCK_WARN("rtnetlink is not available ({}); {} is checked on every request", std::strerror(errno),
+                     interface_);
+        return false;
+    }
+    struct sockaddr_nl local {};
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) != 0 ||
+        ::pipe2(wakePipe_, O_CLOEXEC) != 0) {
+        LOG_BCK_WARN("Failed to subscribe to rtnetlink ({}); {} is checked on every request", std::strerror(errno),
+                     interface_);
+        ::close(fd);
+        return false;
+    }
+    socket_ = fd;
+
+    // Subscribed first, so no event between the two is lost
+    Resync();
+    running_ = true;
+    thread_ = std::thread(&LinkMonitor::WatchLoop, this);
+    LOG_BCK_INFO("Watching {} through rtnetlink ({})", interface_, StateName(GetState()));
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LinkMonitor::Stop() {
+    running_ = false;
+#ifdef __linux__
+    if (wakePipe_[1] >= 0) {
+        const char wake = 0;
+        [[maybe_unused]] const ssize_t written = ::write(wakePipe_[1], &wake, 1);
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    for (int* fd : {&socket_, &wakePipe_[0], &wakePipe_[1]}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+#endif
+}
+
+std::string LinkMonitor::Address() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return publishedAddress_;
+}
+
+int LinkMonitor::Subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    const int id = nextId_++;
+    listeners_.emplace(id, std::move(listener));
+    return id;
+}
+
+void LinkMonitor::Unsubscribe(int id) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    listeners_.erase(id);
+}
+
+void LinkMonitor::WatchLoop() {
+#ifdef __linux__
+    alignas(struct nlmsghdr) char buffer[8192];
+    while (running_.load(std::memory_order_acquire)) {
+        struct pollfd fds[2] = {{socket_, POLLIN, 0}, {wakePipe_[0], POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_BCK_ERROR("rtnetlink poll failed: {}", std::strerror(errno));
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+
+        struct sockaddr_nl sender {};
+        socklen_t senderSize = sizeof(sender);
+        const ssize_t size = ::recvfrom(socket_, buffer, sizeof(buffer), 0,
+                                        reinterpret_cast<struct sockaddr*>(&sender), &senderSize);
+        if (size < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            if (errno == ENOBUFS) {
+                // Events were dropped; the state may be stale
+                LOG_BCK_WARN("rtnetlink overrun, re-reading {}", interface_);
+                Resync();
+                continue;
+            }
+            LOG_BCK_ERROR("rtnetlink receive failed: {}", std::strerror(errno));
+            break;
+        }
+        if (sender.nl_pid != 0) {
+            continue;  // Only the kernel reports link changes
+        }
+        ProcessMessages(buffer, static_cast<std::size_t>(size));
+    }
+    if (running_.exchange(false)) {
+        LOG_BCK_WARN("Stopped watching {}; it is checked on every request again", interface_);
+    }
+#endif
+}
+
+void LinkMonitor::ProcessMessages(const void* data, std::size_t size) {
+#ifdef __linux__
+    std::unique_lock<std::mutex> lock(mutex_);
+    int remaining = static_cast<int>(size);
+    for (auto* message = static_cast<const struct nlmsghdr*>(data); NLMSG_OK(message, remaining);
+         message = NLMSG_NEXT(message, remaining)) {
+        switch (message->nlmsg_type) {
+        case RTM_NEWLINK:
+        case RTM_DELLINK: {
+            if (message->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifinfomsg))) {
+                break;
+            }
+            const auto* info = static_cast<const struct ifinfomsg*>(NLMSG_DATA(message));
+            std::string name;
+            int length = IFLA_PAYLOAD(message);
+            for (auto* rta = IFLA_RTA(info); RTA_OK(rta, length); rta = RTA_NEXT(rta, length)) {
+                if (rta->rta_type == IFLA_IFNAME) {
+                    name = AttributeString(rta);
+                }
+            }
+            if (name != interface_ && !(index_ != 0 && info->ifi_index == index_)) {
+                break;
+            }
+            if (message->nlmsg_type == RTM_DELLINK) {
+                present_ = false;
+                index_ = 0;
+                adminUp_ = false;
+                address_.clear();
+            } else {
+                present_ = true;
+                seen_ = true;
+                index_ = info->ifi_index;
+                adminUp_ = (info->ifi_flags & IFF_UP) != 0;
+            }
+            break;
+        }
+        case RTM_NEWADDR:
+        case RTM_DELADDR: {
+            if (message->nlmsg_len < NLMSG_LENGTH(sizeof(struct ifaddrmsg))) {
+                break;
+            }
+            const auto* info = static_cast<const struct ifaddrmsg*>(NLMSG_DATA(message));
+            if (info->ifa_family != AF_INET) {
+                break;
+            }
+            std::string label;
+            const void* local = nullptr;
+            const void* address = nullptr;
+            int length = IFA_PAYLOAD(message);
+            for (auto* rta = IFA_RTA(info); RTA_OK(rta, length); rta = RTA_NEXT(rta, length)) {
+                if (rta->rta_type == IFA_LABEL) {
+                    label = AttributeString(rta);
+                } else if (rta->rta_type == IFA_LOCAL && RTA_PAYLOAD(rta) >= sizeof(struct in_addr)) {
+                    local = RTA_DATA(rta);
+                } else if (rta->rta_type == IFA_ADDRESS && RTA_PAYLOAD(rta) >= sizeof(struct in_addr)) {
+                    address = RTA_DATA(rta);
+                }
+            }
+            if (label != interface_ && !(index_ != 0 && static_cast<int>(info->ifa_index) == index_)) {
+                break;
+            }
+            // On point-to-point links IFA_ADDRESS is the peer; IFA_LOCAL is ours
+            char text[INET_ADDRSTRLEN] = {};
+            const void* ours = local ? local : address;
+            if (!ours || !inet_ntop(AF_INET, ours, text, sizeof(text))) {
+                break;
+            }
+            if (message->nlmsg_type == RTM_NEWADDR) {
+                present_ = true;
+                seen_ = true;
+                index_ = static_cast<int>(info->ifa_index);
+                address_ = text;
+            } else if (address_ == text) {
+                address_.clear();
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    Publish(lock);
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+void LinkMonitor::Resync() {
+#ifdef __linux__
+    struct ifaddrs* list = nullptr;
+    if (getifaddrs(&list) != 0) {
+        LOG_BCK_ERROR("Failed to get network interfaces (errno: {}): {}", errno, std::strerror(errno));
+        return;
+    }
+    bool present = false;
+    bool adminUp = false;
+    std::string address;
+    for (struct ifaddrs* entry = list; entry != nullptr; entry = entry->ifa_next) {
+        if (!entry->ifa_name || interface_ != entry->ifa_name) {
+            continue;
+        }
+        present = true;
+        adminUp = adminUp || (entry->ifa_flags & IFF_UP) != 0;
+        if (entry->ifa_addr && entry->ifa_addr->sa_family == AF_INET) {
+            char text[INET_ADDRSTRLEN] = {};
+            const auto* in = reinterpret_cast<const struct sockaddr_in*>(entry->ifa_addr);
+            if (inet_ntop(AF_INET, &in->sin_addr, text, sizeof(text))) {
+                address = text;
+            }
+        }
+    }
+    freeifaddrs(list);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    present_ = present;
+    seen_ = seen_ || present;
+    index_ = present ? static_cast<int>(if_nametoindex(interface_.c_str())) : 0;
+    adminUp_ = adminUp;
+    address_ = address;
+    Publish(lock);
+#endif
+}
+
+void LinkMonitor::Publish(std::unique_lock<std::mutex>& lock) {
+    State state = State::Absent;
+    if (seen_) {
+        state = (present_ && adminUp_ && !address_.empty()) ? State::Up : State::Down;
+    }
+    const std::string address = state == State::Up ? address_ : std::string();
+    if (state == state_.load(std::memory_order_acquire) && address == publishedAddress_) {
+        return;
+    }
+    publishedAddress_ = address;
+    state_.store(state, std::memory_order_release);
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+    lock.unlock();
+
+    LOG_BCK_INFO("Link {} is {}{}", interface_, StateName(state), address.empty() ? "" : " (" + address + ")");
+    std::lock_guard<std::mutex> listenersLock(listenersMutex_);
+    for (const auto& [id, listener] : listeners_) {
+        listener(state, address);
+    }
+}
+
+} // namespace fuelflux
@@ -13,6 +13,9 @@
 #ifdef USE_CARES
 #include "cares_resolver.h"
 #endif
+#ifdef TARGET_SIM800C
+#include "link_monitor.h"
+#endif
 #include "version.h"
 #include "peripherals/peripheral_interface.h"
 #include "peripherals/display.h"
@@ -28,6 +31,7 @@
 #ifdef TARGET_REAL_KEYBOARD
 #include "peripherals/keyboard.h"
 #endif
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <thread>
@@ -114,7 +118,35 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
     if (const char* envId = std::getenv("FUELFLUX_CONTROLLER_ID")) {
         controllerId = envId;
     }
+
+    // Parallel backlog sessions (each with its own backend); keep 1 on GPRS links
+    int backlogSessions = timing::kBacklogParallelSessions;
+    if (const char* envSessions = std::getenv("FUELFLUX_BACKLOG_SESSIONS")) {
+        backlogSessions = std::clamp(std::atoi(envSessions), 1, timing::kBacklogMaxParallelSessions);
+    }
+
+    // Hedged authorization delay in milliseconds; 0 waits for the backend as before
+    std::chrono::milliseconds authHedgeDelay = timing::kAuthHedgeDelay;
+    if (const char* envHedge = std::getenv("FUELFLUX_AUTH_HEDGE_MS")) {
+        authHedgeDelay = std::chrono::milliseconds(std::max(std::atoi(envHedge), 0));
+    }
+
+    // Backlog storage engine: SQLite table (default) or append-only segment log
+    BacklogEngine backlogEngine = BacklogEngine::Sqlite;
+    if (const char* envEngine = std::getenv("FUELFLUX_BACKLOG_ENGINE")) {
+        if (std::string(envEngine) == "segment") {
+            backlogEngine = BacklogEngine::SegmentLog;
+        }
+    }
     
+    // User cache engine: SQLite flip/flop tables (default) or memory-mapped snapshot
+    UserCacheEngine cacheEngine = UserCacheEngine::Sqlite;
+    if (const char* envCache = std::getenv("FUELFLUX_CACHE_ENGINE")) {
+        if (std::string(envCache) == "snapshot") {
+            cacheEngine = UserCacheEngine::Snapshot;
+        }
+    }
+
     // Retry limit to prevent infinite restart on persistent errors
     const int MAX_RETRIES = timing::kMaxRetries;
     int retryCount = 0;
@@ -122,6 +154,11 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
 #ifdef USE_CARES
     bool caresInitialized = false;
 #endif
+#ifdef TARGET_SIM800C
+    // Backends, the resolver and the backlog worker follow ppp0 from rtnetlink events;
+    // if this fails they check the interface on every request instead
+    LinkMonitor::Instance().Start();
+#endif
     
     while (g_running) {
         // Display pointer for failure message - created once per iteration, reused on failure
@@ -175,10 +212,13 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
             msg.line3 = "Очередь";
             display->showMessage(msg);
 
-            auto storage = std::make_shared<MessageStorage>(STORAGE_DB_PATH);
+            auto storage = std::make_shared<MessageStorage>(STORAGE_DB_PATH, MessageStorage::kDefaultDurability, backlogEngine);
             auto backend = Controller::CreateDefaultBackend(storage);
-            auto backlogBackend = Controller::CreateDefaultBackendShared(controllerId, nullptr);
-            BacklogWorker backlogWorker(storage, backlogBackend, timing::kBacklogWorkerInterval);
+            std::vector<std::shared_ptr<IBackend>> backlogBackends;
+            for (int i = 0; i < backlogSessions; ++i) {
+                backlogBackends.push_back(Controller::CreateDefaultBackendShared(controllerId, nullptr));
+            }
+            BacklogWorker backlogWorker(storage, std::move(backlogBackends), timing::kBacklogWorkerInterval);
             backlogWorker.Start();
 
 
@@ -186,7 +226,8 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
             msg.line3 = "Контроллер";
             display->showMessage(msg);
 
-            Controller controller(controllerId, backend);
+            Controller controller(controllerId, backend, timing::kNoFlowCancelTimeout, authHedgeDelay, cacheEngine);
+            controller.setBackendFactory([storage]() { return Controller::CreateDefaultBackend(storage); });
             controller.setDisplay(std::move(display));
 
 
@@ -358,6 +399,9 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
         }
     }
     
+#ifdef TARGET_SIM800C
+    LinkMonitor::Instance().Stop();
+#endif
 #ifdef USE_CARES
     if (caresInitialized) {
         CleanupCaresLibrary();
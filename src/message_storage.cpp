@@ -4,15 +4,45 @@
 
 #include "message_storage.h"
 
+#include "logger.h"
+#include "segment_backlog.h"
+#include "sqlite_statement_cache.h"
+
 #include <sqlite3.h>
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
 #include <stdexcept>
 
 namespace fuelflux {
 
-MessageStorage::MessageStorage(const std::string& dbPath)
+namespace {
+
+SegmentLogOptions SegmentLogOptionsFor(const SqliteDurability& durability) {
+    SegmentLogOptions options;
+    switch (durability.synchronous) {
+        case SqliteSynchronous::Full:
+            options.fsync = SegmentFsync::EveryCommit;
+            break;
+        case SqliteSynchronous::Normal:
+            options.fsync = SegmentFsync::Periodic;
+            break;
+        case SqliteSynchronous::Off:
+            options.fsync = SegmentFsync::Never;
+            break;
+    }
+    return options;
+}
+
+} // namespace
+
+MessageStorage::MessageStorage(const std::string& dbPath, const SqliteDurability& durability, BacklogEngine engine)
 : db_(nullptr)
 , dbPath_(dbPath) {
+if (engine == BacklogEngine::SegmentLog && dbPath == ":memory:") {
+    throw std::runtime_error("Segment log backlog needs an on-disk database path");
+}
+
 // Ensure the directory exists (skip for in-memory databases)
 if (dbPath != ":memory:") {
     std::filesystem::path dbfile(dbPath);
@@ -27,14 +57,41 @@ if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
 }
 
     db_ = db;
+    statements_.Attach(db_);
     sqlite3_busy_timeout(db, 5000);
 
+    // In-memory databases cannot use WAL and silently keep their journal mode
+    if (!ApplySqliteDurability(db_, durability) && dbPath != ":memory:") {
+        LOG_WARN("Message storage {} did not accept journal_mode={} synchronous={}", dbPath,
+                 ToString(durability.journalMode), ToString(durability.synchronous));
+    }
+
     Execute("CREATE TABLE IF NOT EXISTS backlog (uid TEXT NOT NULL, method TEXT NOT NULL, data TEXT NOT NULL);");
+    // Retry scheduling columns; the ALTERs fail harmlessly on databases that already have them
+    Execute("ALTER TABLE backlog ADD COLUMN attempts INTEGER NOT NULL DEFAULT 0;");
+    Execute("ALTER TABLE backlog ADD COLUMN next_attempt_at INTEGER NOT NULL DEFAULT 0;");
+    Execute("CREATE INDEX IF NOT EXISTS idx_backlog_uid ON backlog(uid);");
+    Execute("CREATE INDEX IF NOT EXISTS idx_backlog_next_attempt ON backlog(next_attempt_at);");
     Execute("CREATE TABLE IF NOT EXISTS dead_messages (uid TEXT NOT NULL, method TEXT NOT NULL, data TEXT NOT NULL);");
+
+    if (engine == BacklogEngine::SegmentLog) {
+        try {
+            segmentBacklog_ = std::make_unique<SegmentBacklog>(dbPath + ".backlog", SegmentLogOptionsFor(durability));
+        } catch (...) {
+            statements_.Clear();
+            sqlite3_close(db_);
+            db_ = nullptr;
+            throw;
+        }
+        MoveSqliteBacklogToSegments();
+    } else if (dbPath != ":memory:" && std::filesystem::exists(dbPath + ".backlog")) {
+        MoveSegmentBacklogToSqlite();
+    }
 }
 
 MessageStorage::~MessageStorage() {
     std::lock_guard<std::mutex> lock(dbMutex_);
+    statements_.Clear();
     if (db_) {
         sqlite3_close(db_);
         db_ = nullptr;
@@ -46,8 +103,114 @@ bool MessageStorage::IsOpen() const {
     return db_ != nullptr;
 }
 
+void MessageStorage::MoveSqliteBacklogToSegments() {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    std::size_t moved = 0;
+    for (;;) {
+        std::vector<StoredMessage> batch;
+        long long lastRowid = 0;
+        {
+            sqlite3_stmt* stmt = statements_.Get("SELECT rowid, uid, method, data FROM backlog ORDER BY rowid ASC LIMIT ?;");
+            if (!stmt) {
+                break;
+            }
+            ScopedStatementReset reset(stmt);
+            sqlite3_bind_int(stmt, 1, static_cast<int>(kMaxGroupCommitBatch));
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                lastRowid = sqlite3_column_int64(stmt, 0);
+                if (auto message = ReadMessage(stmt)) {
+                    batch.push_back(std::move(*message));
+                } else {
+                    LOG_WARN("Dropping unreadable backlog row {} while moving it to the segment log", lastRowid);
+                }
+            }
+        }
+        if (lastRowid == 0) {
+            break;
+        }
+
+        // Appended before the rows are deleted: a crash in between sends the batch twice, never zero times
+        if (!batch.empty() && !segmentBacklog_->Append(batch)) {
+            LOG_ERROR("Failed to move the SQLite backlog of {} to the segment log", dbPath_);
+            break;
+        }
+        sqlite3_stmt* stmt = statements_.Get("DELETE FROM backlog WHERE rowid <= ?;");
+        if (!stmt) {
+            break;
+        }
+        ScopedStatementReset reset(stmt);
+        sqlite3_bind_int64(stmt, 1, lastRowid);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            break;
+        }
+        moved += batch.size();
+    }
+    if (moved > 0) {
+        LOG_INFO("Moved {} backlog messages from SQLite to the segment log", moved);
+    }
+}
+
+void MessageStorage::MoveSegmentBacklogToSqlite() {
+    const std::string directory = dbPath_ + ".backlog";
+    std::vector<StoredMessage> messages;
+    try {
+        SegmentBacklog segments(directory);
+        for (const auto& uid : segments.GetUids(std::numeric_limits<int>::max(), kAllMessages)) {
+            auto forUid = segments.GetForUid(uid, std::numeric_limits<int>::max(), kAllMessages);
+            messages.insert(messages.end(), std::make_move_iterator(forUid.begin()),
+                            std::make_move_iterator(forUid.end()));
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to open the segment log backlog {}: {}", directory, e.what());
+        return;
+    }
+    // Message ids follow the append order across users
+    std::sort(messages.begin(), messages.end(),
+              [](const StoredMessage& a, const StoredMessage& b) { return a.id < b.id; });
+
+    {
+        std::lock_guard<std::mutex> lock(dbMutex_);
+        if (!ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+            return;
+        }
+        sqlite3_stmt* stmt = statements_.Get("INSERT INTO backlog (uid, method, data) VALUES (?, ?, ?);");
+        bool ok = (stmt != nullptr);
+        for (const auto& message : messages) {
+            if (!ok) {
+                break;
+            }
+            ScopedStatementReset reset(stmt);
+            sqlite3_bind_text(stmt, 1, message.uid.c_str(), -1, SQLITE_TRANSIENT);
+            const std::string methodValue = MethodToString(message.method);
+            sqlite3_bind_text(stmt, 2, methodValue.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_blob(stmt, 3, message.data.data(), static_cast<int>(message.data.size()), SQLITE_TRANSIENT);
+            ok = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+        if (!ok || !ExecuteUnlocked("COMMIT;")) {
+            ExecuteUnlocked("ROLLBACK;");
+            LOG_ERROR("Failed to move the segment log backlog {} to SQLite", directory);
+            return;
+        }
+    }
+
+    // Removed only once the rows are committed: a crash in between sends them twice, never zero times
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    if (!messages.empty()) {
+        LOG_INFO("Moved {} backlog messages from the segment log to SQLite", messages.size());
+    }
+}
+
+BacklogEngine MessageStorage::GetBacklogEngine() const {
+    return segmentBacklog_ ? BacklogEngine::SegmentLog : BacklogEngine::Sqlite;
+}
+
 bool MessageStorage::Execute(const std::string& sql) const {
     std::lock_guard<std::mutex> lock(dbMutex_);
+    return ExecuteUnlocked(sql);
+}
+
+bool MessageStorage::ExecuteUnlocked(const std::string& sql) const {
     if (!db_) {
         return false;
     }
@@ -81,25 +244,105 @@ std::optional<MessageMethod> MessageStorage::MethodFromString(const std::string&
 }
 
 bool MessageStorage::AddBacklog(const std::string& uid, MessageMethod method, const std::string& data) {
+    const auto start = std::chrono::steady_clock::now();
+    auto request = std::make_shared<PendingBacklog>();
+    request->uid = uid;
+    request->method = method;
+    request->data = data;
+
+    std::unique_lock<std::mutex> queueLock(queueMutex_);
+    pendingBacklog_.push_back(request);
+    while (!request->done) {
+        if (commitInProgress_) {
+            // Another caller is committing; our entry goes into the next batch
+            queueCv_.wait(queueLock);
+            continue;
+        }
+
+        // Become the committer for everything queued so far (including our own entry)
+        commitInProgress_ = true;
+        std::vector<std::shared_ptr<PendingBacklog>> batch;
+        while (!pendingBacklog_.empty() && batch.size() < kMaxGroupCommitBatch) {
+            batch.push_back(std::move(pendingBacklog_.front()));
+            pendingBacklog_.pop_front();
+        }
+        queueLock.unlock();
+
+        // Publishes the outcome and gives up the committer role on every exit path, so that a
+        // throwing commit fails its batch instead of leaving the other callers waiting forever
+        struct BatchCompletion {
+            MessageStorage& storage;
+            std::unique_lock<std::mutex>& lock;
+            std::vector<std::shared_ptr<PendingBacklog>>& batch;
+            bool ok = false;
+
+            ~BatchCompletion() {
+                if (!lock.owns_lock()) {
+                    lock.lock();
+                }
+                for (auto& pending : batch) {
+                    pending->ok = ok;
+                    pending->done = true;
+                }
+                storage.commitInProgress_ = false;
+                storage.queueCv_.notify_all();
+            }
+        } completion{*this, queueLock, batch};
+
+        completion.ok = CommitBacklogBatch(batch);
+    }
+    const bool ok = request->ok;
+    queueLock.unlock();
+
+    backlogLatency_.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
+    return ok;
+}
+
+bool MessageStorage::CommitBacklogBatch(const std::vector<std::shared_ptr<PendingBacklog>>& batch) {
+    if (segmentBacklog_) {
+        std::vector<StoredMessage> messages;
+        messages.reserve(batch.size());
+        for (const auto& pending : batch) {
+            messages.push_back(StoredMessage{0, pending->uid, pending->method, pending->data});
+        }
+        if (!segmentBacklog_->Append(messages)) {
+            return false;
+        }
+        ++backlogCommits_;
+        return true;
+    }
+
     std::lock_guard<std::mutex> lock(dbMutex_);
-    if (!db_) {
+    if (!db_ || !ExecuteUnlocked("BEGIN IMMEDIATE;")) {
         return false;
     }
 
-    sqlite3_stmt* stmt = nullptr;
+    bool ok = true;
     const char* sql = "INSERT INTO backlog (uid, method, data) VALUES (?, ?, ?);";
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        return false;
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        ok = false;
+    }
+    for (const auto& pending : batch) {
+        if (!ok) {
+            break;
+        }
+        ScopedStatementReset reset(stmt);
+        sqlite3_bind_text(stmt, 1, pending->uid.c_str(), -1, SQLITE_TRANSIENT);
+        const std::string methodValue = MethodToString(pending->method);
+        sqlite3_bind_text(stmt, 2, methodValue.c_str(), -1, SQLITE_TRANSIENT);
+        // Payloads are binary (see backlog_payload.h); blobs keep them intact in the TEXT column
+        sqlite3_bind_blob(stmt, 3, pending->data.data(), static_cast<int>(pending->data.size()), SQLITE_TRANSIENT);
+        ok = (sqlite3_step(stmt) == SQLITE_DONE);
     }
 
-    sqlite3_bind_text(stmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
-    const std::string methodValue = MethodToString(method);
-    sqlite3_bind_text(stmt, 2, methodValue.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, data.c_str(), -1, SQLITE_TRANSIENT);
-
-    const bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-    return ok;
+    if (!ok || !ExecuteUnlocked("COMMIT;")) {
+        ExecuteUnlocked("ROLLBACK;");
+        return false;
+    }
+    ++backlogCommits_;
+    return true;
 }
 
 bool MessageStorage::AddDeadMessage(const std::string& uid, MessageMethod method, const std::string& data) {
@@ -108,121 +351,277 @@ bool MessageStorage::AddDeadMessage(const std::string& uid, MessageMethod method
         return false;
     }
 
-    sqlite3_stmt* stmt = nullptr;
     const char* sql = "INSERT INTO dead_messages (uid, method, data) VALUES (?, ?, ?);";
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return false;
     }
+    ScopedStatementReset reset(stmt);
 
     sqlite3_bind_text(stmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
     const std::string methodValue = MethodToString(method);
     sqlite3_bind_text(stmt, 2, methodValue.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, data.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_blob(stmt, 3, data.data(), static_cast<int>(data.size()), SQLITE_TRANSIENT);
 
     const bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
     return ok;
 }
 
 std::optional<StoredMessage> MessageStorage::GetNextBacklog() {
+    if (segmentBacklog_) {
+        return segmentBacklog_->GetNext();
+    }
     std::lock_guard<std::mutex> lock(dbMutex_);
     if (!db_) {
         return std::nullopt;
     }
 
-    sqlite3_stmt* stmt = nullptr;
     const char* sql = "SELECT rowid, uid, method, data FROM backlog ORDER BY rowid ASC LIMIT 1;";
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return std::nullopt;
     }
+    ScopedStatementReset reset(stmt);
 
-    StoredMessage message;
-    const int stepResult = sqlite3_step(stmt);
-    if (stepResult == SQLITE_ROW) {
-        message.id = sqlite3_column_int64(stmt, 0);
-        const char* uid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        const char* methodValue = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-        const char* data = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
-        if (uid) {
-            message.uid = uid;
-        }
-        // Treat missing or unrecognized method as a hard read error
-        if (!methodValue) {
-            sqlite3_finalize(stmt);
-            return std::nullopt;
-        }
-        auto method = MethodFromString(methodValue);
-        if (!method) {
-            sqlite3_finalize(stmt);
-            return std::nullopt;
-        }
-        message.method = *method;
-        if (data) {
-            message.data = data;
-        }
-        sqlite3_finalize(stmt);
-        return message;
-    }
-
-    sqlite3_finalize(stmt);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        return ReadMessage(stmt);
+    }
+    return std::nullopt;
+}
+
+std::vector<std::string> MessageStorage::GetBacklogUids(int limit, std::int64_t dueAt) {
+    if (segmentBacklog_) {
+        return segmentBacklog_->GetUids(limit, dueAt);
+    }
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    std::vector<std::string> uids;
+    if (!db_) {
+        return uids;
+    }
+
+    // A user whose oldest message is not due yet is skipped entirely to keep their order
+    const char* sql = "SELECT b.uid FROM backlog b "
+                      "WHERE b.rowid = (SELECT MIN(rowid) FROM backlog WHERE uid = b.uid) AND b.next_attempt_at <= ? "
+                      "ORDER BY b.rowid ASC LIMIT ?;";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return uids;
+    }
+    ScopedStatementReset reset(stmt);
+
+    sqlite3_bind_int64(stmt, 1, dueAt);
+    sqlite3_bind_int(stmt, 2, limit);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* uid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        uids.emplace_back(uid ? uid : "");
+    }
+    return uids;
+}
+
+std::vector<StoredMessage> MessageStorage::GetBacklogForUid(const std::string& uid, int limit, std::int64_t dueAt) {
+    if (segmentBacklog_) {
+        return segmentBacklog_->GetForUid(uid, limit, dueAt);
+    }
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    std::vector<StoredMessage> messages;
+    if (!db_) {
+        return messages;
+    }
+
+    const char* sql = "SELECT rowid, uid, method, data, next_attempt_at FROM backlog WHERE uid = ? ORDER BY rowid ASC LIMIT ?;";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return messages;
+    }
+    ScopedStatementReset reset(stmt);
+
+    sqlite3_bind_text(stmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, limit);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        if (sqlite3_column_int64(stmt, 4) > dueAt) {
+            break;
+        }
+        auto message = ReadMessage(stmt);
+        if (!message) {
+            // Stop at an unreadable row so that later messages never overtake it
+            break;
+        }
+        messages.push_back(std::move(*message));
+    }
+    return messages;
+}
+
+bool MessageStorage::DeferBacklog(std::int64_t now,
+                                  const std::function<std::chrono::milliseconds(int attempts)>& delay) {
+    if (segmentBacklog_) {
+        return segmentBacklog_->Defer(now, delay);
+    }
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    if (!db_ || !ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    std::vector<std::pair<long long, int>> due;
+    bool ok = false;
+    {
+        const char* sql = "SELECT rowid, attempts FROM backlog WHERE next_attempt_at <= ?;";
+        sqlite3_stmt* stmt = statements_.Get(sql);
+        if (stmt) {
+            ScopedStatementReset reset(stmt);
+            sqlite3_bind_int64(stmt, 1, now);
+            int stepResult = SQLITE_ROW;
+            while ((stepResult = sqlite3_step(stmt)) == SQLITE_ROW) {
+                due.emplace_back(sqlite3_column_int64(stmt, 0), sqlite3_column_int(stmt, 1));
+            }
+            ok = (stepResult == SQLITE_DONE);
+        }
+    }
+
+    const char* sql = "UPDATE backlog SET attempts = ?, next_attempt_at = ? WHERE rowid = ?;";
+    sqlite3_stmt* stmt = ok ? statements_.Get(sql) : nullptr;
+    ok = ok && stmt;
+    for (const auto& [id, attempts] : due) {
+        if (!ok) {
+            break;
+        }
+        ScopedStatementReset reset(stmt);
+        sqlite3_bind_int(stmt, 1, attempts + 1);
+        sqlite3_bind_int64(stmt, 2, now + delay(attempts + 1).count());
+        sqlite3_bind_int64(stmt, 3, id);
+        ok = (sqlite3_step(stmt) == SQLITE_DONE);
+    }
+
+    if (!ok || !ExecuteUnlocked("COMMIT;")) {
+        ExecuteUnlocked("ROLLBACK;");
+        return false;
+    }
+    return true;
+}
+
+bool MessageStorage::ResetBacklogBackoff() {
+    if (segmentBacklog_) {
+        return segmentBacklog_->ResetBackoff();
+    }
+    return Execute("UPDATE backlog SET attempts = 0, next_attempt_at = 0 WHERE attempts > 0 OR next_attempt_at > 0;");
+}
+
+std::optional<std::int64_t> MessageStorage::GetNextBacklogAttemptAt() const {
+    if (segmentBacklog_) {
+        return segmentBacklog_->GetNextAttemptAt();
+    }
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    if (!db_) {
+        return std::nullopt;
+    }
+
+    const char* sql = "SELECT MIN(next_attempt_at) FROM backlog;";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return std::nullopt;
+    }
+    ScopedStatementReset reset(stmt);
+
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        return sqlite3_column_int64(stmt, 0);
+    }
     return std::nullopt;
 }
 
+std::optional<StoredMessage> MessageStorage::ReadMessage(sqlite3_stmt* stmt) const {
+    StoredMessage message;
+    message.id = sqlite3_column_int64(stmt, 0);
+    const char* uid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    const char* methodValue = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    // Blob access returns legacy text payloads unchanged
+    const void* data = sqlite3_column_blob(stmt, 3);
+    const int dataSize = sqlite3_column_bytes(stmt, 3);
+    if (uid) {
+        message.uid = uid;
+    }
+    // Treat missing or unrecognized method as a hard read error
+    if (!methodValue) {
+        return std::nullopt;
+    }
+    auto method = MethodFromString(methodValue);
+    if (!method) {
+        return std::nullopt;
+    }
+    message.method = *method;
+    if (data) {
+        message.data.assign(static_cast<const char*>(data), static_cast<std::size_t>(dataSize));
+    }
+    return message;
+}
+
 bool MessageStorage::RemoveBacklog(long long id) {
+    if (segmentBacklog_) {
+        return segmentBacklog_->Remove(id);
+    }
     std::lock_guard<std::mutex> lock(dbMutex_);
     if (!db_) {
         return false;
     }
 
-    sqlite3_stmt* stmt = nullptr;
     const char* sql = "DELETE FROM backlog WHERE rowid = ?;";
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return false;
     }
+    ScopedStatementReset reset(stmt);
 
     sqlite3_bind_int64(stmt, 1, id);
     const bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
     return ok;
 }
 
 int MessageStorage::BacklogCount() const {
+    if (segmentBacklog_) {
+        return segmentBacklog_->Count();
+    }
     std::lock_guard<std::mutex> lock(dbMutex_);
     if (!db_) {
         return 0;
     }
 
-    sqlite3_stmt* stmt = nullptr;
     const char* sql = "SELECT COUNT(*) FROM backlog;";
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return 0;
     }
+    ScopedStatementReset reset(stmt);
 
     int count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
     return count;
 }
 
+LatencyHistogram::Snapshot MessageStorage::GetBacklogEnqueueLatency() const {
+    return backlogLatency_.GetSnapshot();
+}
+
+std::uint64_t MessageStorage::GetBacklogCommitCount() const {
+    return backlogCommits_.load();
+}
+
 int MessageStorage::DeadMessageCount() const {
     std::lock_guard<std::mutex> lock(dbMutex_);
     if (!db_) {
         return 0;
     }
 
-    sqlite3_stmt* stmt = nullptr;
     const char* sql = "SELECT COUNT(*) FROM dead_messages;";
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return 0;
     }
+    ScopedStatementReset reset(stmt);
 
     int count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
     return count;
 }
 
@@ -6,6 +6,7 @@
 #include "logger.h"
 
 #ifdef TARGET_REAL_CARD_READER
+#include "card_uid.h"
 #include "hardware/hardware_config.h"
 #include <nfc/nfc.h>
 
@@ -33,7 +34,12 @@ std::string toString(const uint8_t* data, size_t len) {
     return oss.str();
 }
 
-std::optional<std::string> pollForUid(nfc_device* device) {
+struct PolledCard {
+    std::string userId;
+    std::optional<CardUid> cardUid;
+};
+
+std::optional<PolledCard> pollForUid(nfc_device* device) {
     nfc_modulation nm{};
     nm.nmt = NMT_ISO14443A;
     nm.nbr = NBR_106;
@@ -46,12 +52,15 @@ std::optional<std::string> pollForUid(nfc_device* device) {
 
     if (target.nm.nmt == NMT_ISO14443A) {
         const auto& nai = target.nti.nai;
+        if (const auto uid = CardUid::FromBytes(nai.abtUid, nai.szUidLen)) {
+            return PolledCard{uid->ToString(), uid};
+        }
         if (nai.szUidLen > 0) {
-            return toString(nai.abtUid, nai.szUidLen);
+            return PolledCard{toString(nai.abtUid, nai.szUidLen), std::nullopt};
         }
     }
 
-    return std::string("<unknown target>");
+    return PolledCard{"<unknown target>", std::nullopt};
 }
 } // namespace
 #endif
@@ -163,16 +172,16 @@ void HardwareCardReader::pollingLoop() {
             continue;
         }
 
-        auto uid = pollForUid(device_);
-        if (uid.has_value() && readingEnabled_) {
-			LOG_INFO("Card presented with UID: {}", *uid);
+        auto card = pollForUid(device_);
+        if (card.has_value() && readingEnabled_) {
+			LOG_INFO("Card presented with UID: {}", card->userId);
             CardPresentedCallback callback;
             {
                 std::lock_guard<std::mutex> lock(callbackMutex_);
                 callback = cardPresentedCallback_;
             }
             if (callback) {
-                callback(*uid);
+                callback(card->userId, card->cardUid);
             }
             std::this_thread::sleep_for(kReadCooldown);
         } else {
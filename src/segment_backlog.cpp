@@ -0,0 +1,282 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "segment_backlog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+#include "logger.h"
+
+namespace fuelflux {
+
+namespace {
+
+enum class RecordType : std::uint8_t {
+    Message = 1,
+    Ack = 2
+};
+
+// Message: type, id (8), method (1), uid length (4), uid, data
+// Ack:     type, id (8)
+constexpr std::size_t kAckRecordSize = 1 + sizeof(std::int64_t);
+constexpr std::size_t kMessageHeaderSize = kAckRecordSize + 1 + sizeof(std::uint32_t);
+
+template <typename T>
+void AppendValue(std::string& record, T value) {
+    record.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T ReadValue(const std::string& record, std::size_t offset) {
+    T value{};
+    std::memcpy(&value, record.data() + offset, sizeof(value));
+    return value;
+}
+
+std::string EncodeMessage(long long id, const StoredMessage& message) {
+    std::string record;
+    record.reserve(kMessageHeaderSize + message.uid.size() + message.data.size());
+    AppendValue(record, static_cast<std::uint8_t>(RecordType::Message));
+    AppendValue(record, static_cast<std::int64_t>(id));
+    AppendValue(record, static_cast<std::uint8_t>(message.method));
+    AppendValue(record, static_cast<std::uint32_t>(message.uid.size()));
+    record.append(message.uid);
+    record.append(message.data);
+    return record;
+}
+
+std::string EncodeAck(long long id) {
+    std::string record;
+    AppendValue(record, static_cast<std::uint8_t>(RecordType::Ack));
+    AppendValue(record, static_cast<std::int64_t>(id));
+    return record;
+}
+
+std::optional<StoredMessage> DecodeMessage(const std::string& record) {
+    if (record.size() < kMessageHeaderSize ||
+        ReadValue<std::uint8_t>(record, 0) != static_cast<std::uint8_t>(RecordType::Message)) {
+        return std::nullopt;
+    }
+    const auto method = ReadValue<std::uint8_t>(record, kAckRecordSize);
+    const auto uidSize = ReadValue<std::uint32_t>(record, kAckRecordSize + 1);
+    if (method > static_cast<std::uint8_t>(MessageMethod::Intake) || record.size() - kMessageHeaderSize < uidSize) {
+        return std::nullopt;
+    }
+
+    StoredMessage message;
+    message.id = ReadValue<std::int64_t>(record, 1);
+    message.method = static_cast<MessageMethod>(method);
+    message.uid = record.substr(kMessageHeaderSize, uidSize);
+    message.data = record.substr(kMessageHeaderSize + uidSize);
+    return message;
+}
+
+} // namespace
+
+SegmentBacklog::SegmentBacklog(const std::string& directory, SegmentLogOptions options)
+    : log_(directory, options) {
+    Replay();
+    if (options.fsync == SegmentFsync::Periodic) {
+        flusher_ = std::thread([this, interval = options.fsyncInterval]() { FlushLoop(interval); });
+    }
+}
+
+SegmentBacklog::~SegmentBacklog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    flushCv_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+}
+
+void SegmentBacklog::FlushLoop(std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!flushCv_.wait_for(lock, interval, [this]() { return stopping_; })) {
+        if (!log_.Flush()) {
+            LOG_WARN("Failed to sync the backlog segment log");
+        }
+    }
+}
+
+void SegmentBacklog::Replay() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    log_.ForEach([this](const SegmentLog::Position& position, const std::string& record) {
+        if (record.empty()) {
+            return;
+        }
+        const auto type = static_cast<RecordType>(record[0]);
+        if (type == RecordType::Ack && record.size() == kAckRecordSize) {
+            const long long id = ReadValue<std::int64_t>(record, 1);
+            nextId_ = std::max(nextId_, id + 1);
+            const auto it = index_.find(id);
+            if (it != index_.end()) {
+                if (--liveMessages_[it->second.position.segment] == 0) {
+                    liveMessages_.erase(it->second.position.segment);
+                }
+                index_.erase(it);
+            }
+            return;
+        }
+        auto message = DecodeMessage(record);
+        if (!message) {
+            LOG_WARN("Skipping unknown backlog record in segment {} at offset {}", position.segment, position.offset);
+            return;
+        }
+        nextId_ = std::max(nextId_, static_cast<long long>(message->id) + 1);
+        index_[message->id] = IndexEntry{message->uid, position, 0, 0};
+        ++liveMessages_[position.segment];
+    });
+    if (log_.TruncatedBytes() > 0 || !index_.empty()) {
+        LOG_INFO("Recovered {} backlog messages from {} segments", index_.size(), log_.SegmentCount());
+    }
+    Recycle();
+}
+
+void SegmentBacklog::Recycle() {
+    const std::uint64_t oldestLive = liveMessages_.empty() ? log_.ActiveSegment() : liveMessages_.begin()->first;
+    log_.ReleaseBefore(oldestLive);
+}
+
+bool SegmentBacklog::Append(const std::vector<StoredMessage>& messages) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> records;
+    records.reserve(messages.size());
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        records.push_back(EncodeMessage(nextId_ + static_cast<long long>(i), messages[i]));
+    }
+
+    const auto positions = log_.Append(records);
+    if (!positions) {
+        return false;
+    }
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        index_[nextId_++] = IndexEntry{messages[i].uid, (*positions)[i], 0, 0};
+        ++liveMessages_[(*positions)[i].segment];
+    }
+    return true;
+}
+
+std::optional<StoredMessage> SegmentBacklog::ReadUnlocked(long long id, const IndexEntry& entry) const {
+    const auto record = log_.Read(entry.position);
+    auto message = record ? DecodeMessage(*record) : std::nullopt;
+    if (!message || message->id != id) {
+        LOG_ERROR("Backlog message {} cannot be read from segment {}", id, entry.position.segment);
+        return std::nullopt;
+    }
+    return message;
+}
+
+std::optional<StoredMessage> SegmentBacklog::GetNext() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.empty()) {
+        return std::nullopt;
+    }
+    return ReadUnlocked(index_.begin()->first, index_.begin()->second);
+}
+
+std::vector<std::string> SegmentBacklog::GetUids(int limit, std::int64_t dueAt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> uids;
+    std::unordered_set<std::string> seen;
+    for (const auto& [id, entry] : index_) {
+        if (static_cast<int>(uids.size()) >= limit) {
+            break;
+        }
+        // Only the oldest message of each user decides whether the user is due
+        if (seen.insert(entry.uid).second && entry.nextAttemptAt <= dueAt) {
+            uids.push_back(entry.uid);
+        }
+    }
+    return uids;
+}
+
+std::vector<StoredMessage> SegmentBacklog::GetForUid(const std::string& uid, int limit, std::int64_t dueAt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<StoredMessage> messages;
+    for (const auto& [id, entry] : index_) {
+        if (static_cast<int>(messages.size()) >= limit) {
+            break;
+        }
+        if (entry.uid != uid) {
+            continue;
+        }
+        if (entry.nextAttemptAt > dueAt) {
+            break;
+        }
+        auto message = ReadUnlocked(id, entry);
+        if (!message) {
+            // Stop at an unreadable message so that later messages never overtake it
+            break;
+        }
+        messages.push_back(std::move(*message));
+    }
+    return messages;
+}
+
+bool SegmentBacklog::Defer(std::int64_t now, const std::function<std::chrono::milliseconds(int attempts)>& delay) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [id, entry] : index_) {
+        if (entry.nextAttemptAt <= now) {
+            ++entry.attempts;
+            entry.nextAttemptAt = now + delay(entry.attempts).count();
+        }
+    }
+    return true;
+}
+
+bool SegmentBacklog::ResetBackoff() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [id, entry] : index_) {
+        entry.attempts = 0;
+        entry.nextAttemptAt = 0;
+    }
+    return true;
+}
+
+std::optional<std::int64_t> SegmentBacklog::GetNextAttemptAt() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::optional<std::int64_t> next;
+    for (const auto& [id, entry] : index_) {
+        if (!next || entry.nextAttemptAt < *next) {
+            next = entry.nextAttemptAt;
+        }
+    }
+    return next;
+}
+
+bool SegmentBacklog::Remove(long long id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = index_.find(id);
+    if (it == index_.end()) {
+        return true;
+    }
+    if (!log_.Append({EncodeAck(id)})) {
+        return false;
+    }
+
+    const std::uint64_t segment = it->second.position.segment;
+    index_.erase(it);
+    if (--liveMessages_[segment] == 0) {
+        liveMessages_.erase(segment);
+        Recycle();
+    }
+    return true;
+}
+
+int SegmentBacklog::Count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(index_.size());
+}
+
+std::size_t SegmentBacklog::SegmentCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return log_.SegmentCount();
+}
+
+} // namespace fuelflux
@@ -0,0 +1,354 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "segment_log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "crc32.h"
+#include "logger.h"
+
+namespace fuelflux {
+
+namespace {
+
+constexpr char kSegmentMagic[4] = {'F', 'F', 'S', 'L'};
+constexpr std::uint32_t kSegmentVersion = 1;
+constexpr char kSegmentExtension[] = ".seg";
+constexpr std::size_t kSegmentNameDigits = 20;
+// Larger frame lengths can only come from a damaged header
+constexpr std::uint32_t kMaxRecordBytes = 16 * 1024 * 1024;
+
+struct SegmentHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t segment;
+};
+static_assert(sizeof(SegmentHeader) == 16, "Segment header must stay 16 bytes");
+
+struct FrameHeader {
+    std::uint32_t length;
+    std::uint32_t checksum;  // CRC-32 of length and payload
+};
+static_assert(sizeof(FrameHeader) == 8, "Frame header must stay 8 bytes");
+
+std::uint32_t FrameChecksum(std::uint32_t length, const void* payload) {
+    return Crc32(payload, length, Crc32(&length, sizeof(length)));
+}
+
+bool WriteAllAt(int fd, const void* data, std::size_t size, std::uint64_t offset) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+        offset += static_cast<std::uint64_t>(written);
+    }
+    return true;
+}
+
+bool ReadAllAt(int fd, void* data, std::size_t size, std::uint64_t offset) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t read = ::pread(fd, bytes, size, static_cast<off_t>(offset));
+        if (read <= 0) {
+            return false;
+        }
+        bytes += read;
+        size -= static_cast<std::size_t>(read);
+        offset += static_cast<std::uint64_t>(read);
+    }
+    return true;
+}
+
+// Make file creation and removal in the directory durable
+void SyncDirectory(const std::string& directory) {
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+std::optional<std::uint64_t> ParseSegmentName(const std::string& name) {
+    const std::size_t extensionSize = sizeof(kSegmentExtension) - 1;
+    if (name.size() != kSegmentNameDigits + extensionSize ||
+        name.compare(kSegmentNameDigits, extensionSize, kSegmentExtension) != 0) {
+        return std::nullopt;
+    }
+    std::uint64_t segment = 0;
+    for (std::size_t i = 0; i < kSegmentNameDigits; ++i) {
+        if (name[i] < '0' || name[i] > '9') {
+            return std::nullopt;
+        }
+        segment = segment * 10 + static_cast<std::uint64_t>(name[i] - '0');
+    }
+    return segment;
+}
+
+} // namespace
+
+SegmentLog::SegmentLog(std::string directory, SegmentLogOptions options)
+    : directory_(std::move(directory))
+    , options_(options)
+    , lastSync_(std::chrono::steady_clock::now()) {
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        throw std::runtime_error("Failed to create segment log directory " + directory_ + ": " + error.message());
+    }
+    Recover();
+    if (segments_.empty()) {
+        throw std::runtime_error("Failed to create segment log in " + directory_);
+    }
+}
+
+SegmentLog::~SegmentLog() {
+    SyncActive(true);
+    for (auto& [segment, file] : segments_) {
+        ::close(file.fd);
+    }
+}
+
+std::string SegmentLog::SegmentPath(std::uint64_t segment) const {
+    char name[kSegmentNameDigits + sizeof(kSegmentExtension)];
+    std::snprintf(name, sizeof(name), "%020llu%s", static_cast<unsigned long long>(segment), kSegmentExtension);
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+bool SegmentLog::CreateSegment(std::uint64_t segment) {
+    const std::string path = SegmentPath(segment);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create backlog segment: {}", path);
+        return false;
+    }
+
+    SegmentHeader header{};
+    std::memcpy(header.magic, kSegmentMagic, sizeof(header.magic));
+    header.version = kSegmentVersion;
+    header.segment = segment;
+    if (!WriteAllAt(fd, &header, sizeof(header), 0) ||
+        (options_.fsync != SegmentFsync::Never && ::fdatasync(fd) != 0)) {
+        LOG_ERROR("Failed to write backlog segment header: {}", path);
+        ::close(fd);
+        ::unlink(path.c_str());
+        return false;
+    }
+    if (options_.fsync != SegmentFsync::Never) {
+        SyncDirectory(directory_);
+    }
+
+    segments_[segment] = Segment{fd, sizeof(SegmentHeader)};
+    activeSegment_ = segment;
+    unsynced_ = false;
+    return true;
+}
+
+void SegmentLog::Recover() {
+    std::vector<std::uint64_t> found;
+    std::error_code error;
+    for (const auto& item : std::filesystem::directory_iterator(directory_, error)) {
+        if (auto segment = ParseSegmentName(item.path().filename().string())) {
+            found.push_back(*segment);
+        }
+    }
+    std::sort(found.begin(), found.end());
+
+    std::uint64_t lastSegment = 0;
+    for (std::size_t i = 0; i < found.size(); ++i) {
+        const std::uint64_t segment = found[i];
+        const bool isLast = (i + 1 == found.size());
+        const std::string path = SegmentPath(segment);
+        lastSegment = segment;
+
+        const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+        struct stat info {};
+        SegmentHeader header{};
+        if (fd < 0 || ::fstat(fd, &info) != 0 ||
+            static_cast<std::uint64_t>(info.st_size) < sizeof(header) ||
+            !ReadAllAt(fd, &header, sizeof(header), 0) ||
+            std::memcmp(header.magic, kSegmentMagic, sizeof(header.magic)) != 0 ||
+            header.version != kSegmentVersion || header.segment != segment) {
+            // A segment whose header never made it to disk holds no records
+            LOG_WARN("Removing backlog segment with invalid header: {}", path);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            ::unlink(path.c_str());
+            continue;
+        }
+
+        Segment file{fd, 0};
+        const auto fileSize = static_cast<std::uint64_t>(info.st_size);
+        file.size = ScanSegment(segment, file, fileSize, nullptr);
+        if (file.size < fileSize) {
+            if (isLast) {
+                // Torn write: the tail after the last intact frame was never acknowledged
+                if (::ftruncate(fd, static_cast<off_t>(file.size)) != 0 || ::fdatasync(fd) != 0) {
+                    LOG_ERROR("Failed to truncate torn backlog segment: {}", path);
+                }
+                truncatedBytes_ += fileSize - file.size;
+                LOG_WARN("Backlog segment {}: discarded {} bytes of a torn write", path, fileSize - file.size);
+            } else {
+                LOG_ERROR("Backlog segment {} is damaged after offset {}; {} bytes skipped",
+                          path, file.size, fileSize - file.size);
+            }
+        }
+        segments_[segment] = file;
+    }
+
+    if (segments_.empty()) {
+        CreateSegment(lastSegment + 1);
+    } else {
+        activeSegment_ = segments_.rbegin()->first;
+    }
+}
+
+std::uint64_t SegmentLog::ScanSegment(std::uint64_t segment, const Segment& file, std::uint64_t fileSize,
+                                      const RecordVisitor& visitor) const {
+    std::uint64_t offset = sizeof(SegmentHeader);
+    if (fileSize <= offset) {
+        return offset;
+    }
+
+    std::string data(fileSize - offset, '\0');
+    if (!ReadAllAt(file.fd, data.data(), data.size(), offset)) {
+        return offset;
+    }
+
+    std::size_t position = 0;
+    while (data.size() - position >= sizeof(FrameHeader)) {
+        FrameHeader frame{};
+        std::memcpy(&frame, data.data() + position, sizeof(frame));
+        const std::size_t payloadStart = position + sizeof(frame);
+        if (frame.length > kMaxRecordBytes || data.size() - payloadStart < frame.length ||
+            FrameChecksum(frame.length, data.data() + payloadStart) != frame.checksum) {
+            break;
+        }
+        if (visitor) {
+            visitor(Position{segment, offset + position}, data.substr(payloadStart, frame.length));
+        }
+        position = payloadStart + frame.length;
+    }
+    return offset + position;
+}
+
+void SegmentLog::ForEach(const RecordVisitor& visitor) const {
+    for (const auto& [segment, file] : segments_) {
+        ScanSegment(segment, file, file.size, visitor);
+    }
+}
+
+std::optional<std::vector<SegmentLog::Position>> SegmentLog::Append(const std::vector<std::string>& records) {
+    std::string buffer;
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(records.size());
+    for (const auto& record : records) {
+        if (record.size() > kMaxRecordBytes) {
+            return std::nullopt;
+        }
+        offsets.push_back(buffer.size());
+        FrameHeader frame{};
+        frame.length = static_cast<std::uint32_t>(record.size());
+        frame.checksum = FrameChecksum(frame.length, record.data());
+        buffer.append(reinterpret_cast<const char*>(&frame), sizeof(frame));
+        buffer.append(record);
+    }
+
+    Segment* active = &segments_[activeSegment_];
+    if (active->size > sizeof(SegmentHeader) && active->size + buffer.size() > options_.maxSegmentBytes) {
+        // Seal the full segment before records start going to the next one
+        if (!SyncActive(true) || !CreateSegment(activeSegment_ + 1)) {
+            return std::nullopt;
+        }
+        active = &segments_[activeSegment_];
+    }
+
+    const std::uint64_t start = active->size;
+    if (!WriteAllAt(active->fd, buffer.data(), buffer.size(), start)) {
+        ::ftruncate(active->fd, static_cast<off_t>(start));
+        return std::nullopt;
+    }
+    active->size += buffer.size();
+    unsynced_ = true;
+    if (!SyncActive(false)) {
+        // Not durable, so not appended: the caller will retry
+        ::ftruncate(active->fd, static_cast<off_t>(start));
+        active->size = start;
+        return std::nullopt;
+    }
+
+    std::vector<Position> positions;
+    positions.reserve(offsets.size());
+    for (const auto offset : offsets) {
+        positions.push_back(Position{activeSegment_, start + offset});
+    }
+    return positions;
+}
+
+std::optional<std::string> SegmentLog::Read(const Position& position) const {
+    const auto it = segments_.find(position.segment);
+    if (it == segments_.end() || position.offset < sizeof(SegmentHeader) ||
+        position.offset + sizeof(FrameHeader) > it->second.size) {
+        return std::nullopt;
+    }
+
+    FrameHeader frame{};
+    if (!ReadAllAt(it->second.fd, &frame, sizeof(frame), position.offset) || frame.length > kMaxRecordBytes ||
+        position.offset + sizeof(frame) + frame.length > it->second.size) {
+        return std::nullopt;
+    }
+    std::string record(frame.length, '\0');
+    if (!ReadAllAt(it->second.fd, record.data(), record.size(), position.offset + sizeof(frame)) ||
+        FrameChecksum(frame.length, record.data()) != frame.checksum) {
+        return std::nullopt;
+    }
+    return record;
+}
+
+std::size_t SegmentLog::ReleaseBefore(std::uint64_t segment) {
+    const std::uint64_t limit = std::min(segment, activeSegment_);
+    std::size_t released = 0;
+    while (!segments_.empty() && segments_.begin()->first < limit) {
+        ::close(segments_.begin()->second.fd);
+        ::unlink(SegmentPath(segments_.begin()->first).c_str());
+        segments_.erase(segments_.begin());
+        ++released;
+    }
+    if (released > 0 && options_.fsync != SegmentFsync::Never) {
+        SyncDirectory(directory_);
+    }
+    return released;
+}
+
+bool SegmentLog::SyncActive(bool force) {
+    if (!unsynced_ || options_.fsync == SegmentFsync::Never) {
+        return true;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (!force && options_.fsync == SegmentFsync::Periodic && now - lastSync_ < options_.fsyncInterval) {
+        return true;
+    }
+    const auto it = segments_.find(activeSegment_);
+    if (it == segments_.end() || ::fdatasync(it->second.fd) != 0) {
+        return false;
+    }
+    lastSync_ = now;
+    unsynced_ = false;
+    return true;
+}
+
+} // namespace fuelflux
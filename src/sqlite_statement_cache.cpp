@@ -0,0 +1,56 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "sqlite_statement_cache.h"
+
+#include <sqlite3.h>
+
+namespace fuelflux {
+
+SqliteStatementCache::~SqliteStatementCache() {
+    Clear();
+}
+
+void SqliteStatementCache::Attach(sqlite3* db) {
+    if (db_ != db) {
+        Clear();
+        db_ = db;
+    }
+}
+
+sqlite3_stmt* SqliteStatementCache::Get(const std::string& sql) {
+    const auto it = statements_.find(sql);
+    if (it != statements_.end()) {
+        return it->second;
+    }
+
+    if (!db_) {
+        return nullptr;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+
+    statements_.emplace(sql, stmt);
+    return stmt;
+}
+
+void SqliteStatementCache::Clear() {
+    for (auto& [sql, stmt] : statements_) {
+        sqlite3_finalize(stmt);
+    }
+    statements_.clear();
+}
+
+ScopedStatementReset::~ScopedStatementReset() {
+    if (stmt_) {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+}
+
+} // namespace fuelflux
@@ -0,0 +1,70 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "sqlite_utils.h"
+
+#include <sqlite3.h>
+#include <algorithm>
+#include <cctype>
+
+namespace fuelflux {
+
+std::string ToString(SqliteJournalMode mode) {
+    switch (mode) {
+        case SqliteJournalMode::Delete:
+            return "DELETE";
+        case SqliteJournalMode::Truncate:
+            return "TRUNCATE";
+        case SqliteJournalMode::Persist:
+            return "PERSIST";
+        case SqliteJournalMode::Memory:
+            return "MEMORY";
+        case SqliteJournalMode::Wal:
+            return "WAL";
+    }
+    return "DELETE";
+}
+
+std::string ToString(SqliteSynchronous level) {
+    switch (level) {
+        case SqliteSynchronous::Off:
+            return "OFF";
+        case SqliteSynchronous::Normal:
+            return "NORMAL";
+        case SqliteSynchronous::Full:
+            return "FULL";
+    }
+    return "FULL";
+}
+
+bool ApplySqliteDurability(sqlite3* db, const SqliteDurability& durability) {
+    if (!db) {
+        return false;
+    }
+
+    // journal_mode reports the mode actually in effect, which may differ from the request
+    bool journalOk = false;
+    const std::string requested = ToString(durability.journalMode);
+    const std::string journalSql = "PRAGMA journal_mode=" + requested + ";";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, journalSql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const auto* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            std::string actual = value ? value : "";
+            std::transform(actual.begin(), actual.end(), actual.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            journalOk = (actual == requested);
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    const std::string syncSql = "PRAGMA synchronous=" + ToString(durability.synchronous) + ";";
+    char* errorMessage = nullptr;
+    const bool syncOk = (sqlite3_exec(db, syncSql.c_str(), nullptr, nullptr, &errorMessage) == SQLITE_OK);
+    sqlite3_free(errorMessage);
+
+    return journalOk && syncOk;
+}
+
+} // namespace fuelflux
@@ -305,7 +305,7 @@ void StateMachine::setupTransitions() {
     transitions_[{SystemState::VolumeEntry, Event::PinEntered}]          = {SystemState::VolumeEntry,       noOp};
     transitions_[{SystemState::VolumeEntry, Event::InputUpdated}]        = {SystemState::VolumeEntry,       noOp};
     transitions_[{SystemState::VolumeEntry, Event::AuthorizationSuccess}]= {SystemState::VolumeEntry,       noOp};
-    transitions_[{SystemState::VolumeEntry, Event::AuthorizationDenied}] = {SystemState::VolumeEntry,       noOp};
+    transitions_[{SystemState::VolumeEntry, Event::AuthorizationDenied}] = {SystemState::NotAuthorized,     noOp};
     transitions_[{SystemState::VolumeEntry, Event::AuthorizationFailed}] = {SystemState::VolumeEntry,       noOp};
     transitions_[{SystemState::VolumeEntry, Event::TankSelected}]        = {SystemState::VolumeEntry,       noOp};
     transitions_[{SystemState::VolumeEntry, Event::VolumeEntered}]       = {SystemState::Refueling,         [this]() { onVolumeEntered();        }};
@@ -652,7 +652,8 @@ DisplayMessage StateMachine::getDisplayMessage() const {
 
 void StateMachine::doAuthorization() {
     std::string inputCopy = controller_->getCurrentInput();
-    controller_->requestAuthorization(inputCopy);
+    const auto cardCopy = controller_->getPresentedCard();
+    controller_->requestAuthorization(inputCopy, cardCopy);
     // Clear sensitive input (PIN/card UID) silently 
     controller_->clearInputSilent();
     // requestAuthorization will post AuthorizationSuccess or AuthorizationFailed event
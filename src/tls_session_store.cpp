@@ -0,0 +1,287 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "tls_session_store.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "crc32.h"
+#include "logger.h"
+
+namespace fuelflux {
+
+namespace {
+
+constexpr char kStoreMagic[4] = {'F', 'F', 'T', 'S'};
+constexpr std::uint32_t kStoreVersion = 1;
+
+struct StoreHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t count;
+    std::uint32_t checksum;
+};
+static_assert(sizeof(StoreHeader) == 16, "TLS session store header must stay 16 bytes");
+
+struct EntryHeader {
+    std::int64_t savedAt;
+    std::uint32_t peerSize;
+    std::uint32_t sessionSize;
+};
+static_assert(sizeof(EntryHeader) == 16, "TLS session entry header must stay 16 bytes");
+
+template <typename T>
+void AppendValue(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool WriteAll(int fd, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+} // namespace
+
+TlsSessionStore::TlsSessionStore(std::string path, std::chrono::seconds maxAge, std::chrono::milliseconds flushDelay)
+    : path_(std::move(path))
+    , maxAge_(maxAge.count())
+    , flushDelay_(flushDelay) {
+    ReadFile();
+}
+
+TlsSessionStore::~TlsSessionStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    writerCv_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    Flush();
+}
+
+std::int64_t TlsSessionStore::Now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void TlsSessionStore::ReadFile() {
+    std::ifstream file(path_, std::ios::binary);
+    if (!file) {
+        return;
+    }
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    StoreHeader header{};
+    if (content.size() < sizeof(header)) {
+        LOG_WARN("Ignoring truncated TLS session store: {}", path_);
+        return;
+    }
+    std::memcpy(&header, content.data(), sizeof(header));
+    if (std::memcmp(header.magic, kStoreMagic, sizeof(header.magic)) != 0 || header.version != kStoreVersion) {
+        LOG_WARN("Ignoring TLS session store with unknown format: {}", path_);
+        return;
+    }
+    const char* payload = content.data() + sizeof(header);
+    const std::size_t payloadSize = content.size() - sizeof(header);
+    if (Crc32(payload, payloadSize) != header.checksum) {
+        LOG_WARN("Ignoring corrupt TLS session store: {}", path_);
+        return;
+    }
+
+    std::map<std::string, Entry> entries;
+    std::size_t offset = 0;
+    for (std::uint32_t i = 0; i < header.count; ++i) {
+        EntryHeader entry{};
+        if (payloadSize - offset < sizeof(entry)) {
+            LOG_WARN("Ignoring corrupt TLS session store: {}", path_);
+            return;
+        }
+        std::memcpy(&entry, payload + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (entry.sessionSize > kMaxSessionBytes ||
+            payloadSize - offset < static_cast<std::size_t>(entry.peerSize) + entry.sessionSize) {
+            LOG_WARN("Ignoring corrupt TLS session store: {}", path_);
+            return;
+        }
+        std::string peer(payload + offset, entry.peerSize);
+        offset += entry.peerSize;
+        entries[std::move(peer)] = Entry{entry.savedAt, std::string(payload + offset, entry.sessionSize)};
+        offset += entry.sessionSize;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_ = std::move(entries);
+}
+
+std::string TlsSessionStore::SerializeUnlocked(std::int64_t now) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        it = (now - it->second.savedAt > maxAge_) ? entries_.erase(it) : std::next(it);
+    }
+
+    std::string payload;
+    for (const auto& [peer, entry] : entries_) {
+        AppendValue(payload, EntryHeader{entry.savedAt,
+                                         static_cast<std::uint32_t>(peer.size()),
+                                         static_cast<std::uint32_t>(entry.session.size())});
+        payload += peer;
+        payload += entry.session;
+    }
+
+    StoreHeader header{};
+    std::memcpy(header.magic, kStoreMagic, sizeof(header.magic));
+    header.version = kStoreVersion;
+    header.count = static_cast<std::uint32_t>(entries_.size());
+    header.checksum = Crc32(payload.data(), payload.size());
+
+    std::string image;
+    image.reserve(sizeof(header) + payload.size());
+    AppendValue(image, header);
+    image += payload;
+    return image;
+}
+
+bool TlsSessionStore::WriteFile(const std::string& image) const {
+    std::error_code error;
+    const auto directory = std::filesystem::path(path_).parent_path();
+    if (!directory.empty()) {
+        std::filesystem::create_directories(directory, error);
+    }
+
+    const std::string tempPath = path_ + ".tmp";
+    const int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create TLS session store: {}", tempPath);
+        return false;
+    }
+    const bool written = WriteAll(fd, image.data(), image.size()) && ::fsync(fd) == 0;
+    ::close(fd);
+
+    if (!written || std::rename(tempPath.c_str(), path_.c_str()) != 0) {
+        LOG_ERROR("Failed to write TLS session store: {}", path_);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::string> TlsSessionStore::Load(const std::string& peer, std::int64_t now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = entries_.find(peer);
+    if (it == entries_.end() || now - it->second.savedAt > maxAge_) {
+        return std::nullopt;
+    }
+    return it->second.session;
+}
+
+void TlsSessionStore::PutUnlocked(const std::string& peer, const std::string& session, std::int64_t now) {
+    entries_[peer] = Entry{now, session};
+    while (entries_.size() > kMaxPeers) {
+        // Evict the peer saved longest ago, never the one just saved
+        auto oldest = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->first != peer && (oldest == entries_.end() || it->second.savedAt < oldest->second.savedAt)) {
+                oldest = it;
+            }
+        }
+        entries_.erase(oldest);
+    }
+}
+
+bool TlsSessionStore::Save(const std::string& peer, const std::string& session, std::int64_t now) {
+    if (session.empty() || session.size() > kMaxSessionBytes) {
+        return false;
+    }
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    std::string image;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PutUnlocked(peer, session, now);
+        image = SerializeUnlocked(now);
+        dirty_ = false;
+    }
+    return WriteFile(image);
+}
+
+bool TlsSessionStore::Stage(const std::string& peer, const std::string& session, std::int64_t now) {
+    if (session.empty() || session.size() > kMaxSessionBytes) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    PutUnlocked(peer, session, now);
+    stagedAt_ = now;
+    dirty_ = true;
+    if (!writer_.joinable() && !stopping_) {
+        writer_ = std::thread([this]() { WriterLoop(); });
+    }
+    writerCv_.notify_all();
+    return true;
+}
+
+bool TlsSessionStore::Flush() {
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    std::string image;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_) {
+            return true;
+        }
+        image = SerializeUnlocked(stagedAt_);
+        dirty_ = false;
+    }
+    return WriteFile(image);
+}
+
+void TlsSessionStore::WriterLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        writerCv_.wait(lock, [this]() { return dirty_ || stopping_; });
+        // Let the rest of the handshake's tickets arrive before writing; the destructor
+        // flushes anything still staged when it stops the thread early
+        if (writerCv_.wait_for(lock, flushDelay_, [this]() { return stopping_; })) {
+            break;
+        }
+        lock.unlock();
+        Flush();
+        lock.lock();
+    }
+}
+
+bool TlsSessionStore::Forget(const std::string& peer) {
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    std::string image;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.erase(peer) == 0) {
+            return true;
+        }
+        image = SerializeUnlocked(Now());
+        dirty_ = false;
+    }
+    return WriteFile(image);
+}
+
+std::size_t TlsSessionStore::Count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+} // namespace fuelflux
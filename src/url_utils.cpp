@@ -45,4 +45,13 @@ std::string ExtractHostFromUrl(const std::string& url) {
     return std::string(authority);
 }
 
+std::string EndpointPath(const std::string& endpoint) {
+    return endpoint.substr(0, endpoint.find('?'));
+}
+
+std::string EndpointQuery(const std::string& endpoint) {
+    const auto queryPos = endpoint.find('?');
+    return queryPos == std::string::npos ? std::string() : endpoint.substr(queryPos);
+}
+
 } // namespace fuelflux
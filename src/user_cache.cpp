@@ -5,13 +5,71 @@
 #include "user_cache.h"
 
 #include <algorithm>
+#include "card_records.h"
+#include "logger.h"
+#include "sqlite_statement_cache.h"
+
 #include <sqlite3.h>
+#include <cstdio>
+#include <ctime>
 #include <filesystem>
 #include <stdexcept>
 
 namespace fuelflux {
 
-UserCache::UserCache(const std::string& dbPath)
+namespace {
+
+// Pending (not yet folded) ledger deductions per UID
+const std::string kPendingLedgerSql =
+    "SELECT uid, SUM(amount) AS pending FROM allowance_ledger WHERE folded_at IS NULL GROUP BY uid";
+const std::string kPendingUidsSql =
+    "SELECT uid FROM allowance_ledger WHERE folded_at IS NULL";
+
+// Card UIDs are stored as BLOBs holding the raw UID bytes, other identifiers as TEXT.
+// SQLite never considers a BLOB equal to a TEXT value, so the two forms cannot collide.
+void BindUid(sqlite3_stmt* stmt, int index, const std::string& uid) {
+    if (const auto card = CardUid::Parse(uid)) {
+        sqlite3_bind_blob(stmt, index, card->data(), static_cast<int>(card->size()), SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_text(stmt, index, uid.c_str(), -1, SQLITE_TRANSIENT);
+    }
+}
+
+std::optional<CardUid> ColumnCardUid(sqlite3_stmt* stmt, int column) {
+    if (sqlite3_column_type(stmt, column) != SQLITE_BLOB) {
+        return std::nullopt;
+    }
+    const auto* data = static_cast<const std::uint8_t*>(sqlite3_column_blob(stmt, column));
+    return CardUid::FromBytes(data, static_cast<std::size_t>(sqlite3_column_bytes(stmt, column)));
+}
+
+std::string ColumnUid(sqlite3_stmt* stmt, int column) {
+    if (const auto card = ColumnCardUid(stmt, column)) {
+        return card->ToString();
+    }
+    const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return text ? text : "";
+}
+
+// Bloom filter keys follow the storage form: UID bytes for cards, the string otherwise
+bool BloomMightContain(const BloomFilter& filter, const std::string& uid) {
+    if (const auto card = CardUid::Parse(uid)) {
+        return filter.MightContain(card->data(), card->size());
+    }
+    return filter.MightContain(uid);
+}
+
+void BloomAdd(BloomFilter& filter, const std::string& uid) {
+    if (const auto card = CardUid::Parse(uid)) {
+        filter.Add(card->data(), card->size());
+    } else {
+        filter.Add(uid);
+    }
+}
+
+} // namespace
+
+UserCache::UserCache(const std::string& dbPath, const SqliteDurability& durability)
 : db_(nullptr)
 , dbPath_(dbPath)
 , activeTableIsA_(true)
@@ -30,16 +88,25 @@ UserCache::UserCache(const std::string& dbPath)
     }
 
     db_ = db;
+    statements_.Attach(db_);
     sqlite3_busy_timeout(db, 5000);
 
+    // Best effort: in-memory databases cannot use WAL and silently keep their journal mode
+    ApplySqliteDurability(db_, durability);
+
     // Create both tables for flip/flop mechanism
-    Execute("CREATE TABLE IF NOT EXISTS user_cache_a (uid TEXT PRIMARY KEY, allowance REAL NOT NULL, role_id INTEGER NOT NULL);");
-    Execute("CREATE TABLE IF NOT EXISTS user_cache_b (uid TEXT PRIMARY KEY, allowance REAL NOT NULL, role_id INTEGER NOT NULL);");
+    // uid holds a BLOB for card UIDs and TEXT for other identifiers (see BindUid)
+    Execute("CREATE TABLE IF NOT EXISTS user_cache_a (uid BLOB PRIMARY KEY, allowance REAL NOT NULL, role_id INTEGER NOT NULL);");
+    Execute("CREATE TABLE IF NOT EXISTS user_cache_b (uid BLOB PRIMARY KEY, allowance REAL NOT NULL, role_id INTEGER NOT NULL);");
     Execute("CREATE TABLE IF NOT EXISTS tank_cache_a (id_tank INTEGER NOT NULL, visual_number_tank INTEGER PRIMARY KEY, name_tank TEXT NOT NULL, volume REAL NOT NULL);");
     Execute("CREATE TABLE IF NOT EXISTS tank_cache_b (id_tank INTEGER NOT NULL, visual_number_tank INTEGER PRIMARY KEY, name_tank TEXT NOT NULL, volume REAL NOT NULL);");
     
     // Create metadata table to track which table is active
     Execute("CREATE TABLE IF NOT EXISTS user_cache_meta (key TEXT PRIMARY KEY, value TEXT NOT NULL);");
+
+    // Append-only allowance ledger: offline deductions stay pending until folded into a table
+    Execute("CREATE TABLE IF NOT EXISTS allowance_ledger (id INTEGER PRIMARY KEY AUTOINCREMENT, uid BLOB NOT NULL, amount REAL NOT NULL, created_at INTEGER NOT NULL, folded_at INTEGER);");
+    Execute("CREATE INDEX IF NOT EXISTS idx_allowance_ledger_pending ON allowance_ledger(uid) WHERE folded_at IS NULL;");
     
     // Initialize metadata if it doesn't exist
     std::lock_guard<std::mutex> lock(dbMutex_);
@@ -60,10 +127,21 @@ UserCache::UserCache(const std::string& dbPath)
         }
         sqlite3_finalize(stmt);
     }
+
+    if (!MigrateUidKeysUnlocked()) {
+        LOG_WARN("Failed to convert cached card UIDs to binary keys: {}", dbPath_);
+    }
+
+    generation_ = LoadGenerationUnlocked();
+
+    // Load the active table into the in-memory lookup index; the filter from the last
+    // commit is reused when it was written for the same generation of the tables
+    RebuildIndex(true, (dbPath_ == ":memory:") ? nullptr : BloomFilter::Load(GetBloomFilterPath(), generation_));
 }
 
 UserCache::~UserCache() {
     std::lock_guard<std::mutex> lock(dbMutex_);
+    statements_.Clear();
     if (db_) {
         sqlite3_close(db_);
         db_ = nullptr;
@@ -77,6 +155,10 @@ bool UserCache::IsOpen() const {
 
 bool UserCache::Execute(const std::string& sql) const {
     std::lock_guard<std::mutex> lock(dbMutex_);
+    return ExecuteUnlocked(sql);
+}
+
+bool UserCache::ExecuteUnlocked(const std::string& sql) const {
     if (!db_) {
         return false;
     }
@@ -97,29 +179,355 @@ std::string UserCache::GetStandbyTableName() const {
     return activeTableIsA_ ? "user_cache_b" : "user_cache_a";
 }
 
+bool UserCache::MigrateUidKeysUnlocked() {
+    sqlite3_stmt* stmt = nullptr;
+    bool migrated = false;
+    if (sqlite3_prepare_v2(db_, "SELECT value FROM user_cache_meta WHERE key = 'uid_format';", -1, &stmt, nullptr) == SQLITE_OK) {
+        migrated = (sqlite3_step(stmt) == SQLITE_ROW);
+    }
+    sqlite3_finalize(stmt);
+    if (migrated) {
+        return true;
+    }
+
+    // Databases written before card UIDs were stored as BLOBs hold them as reader strings
+    if (!ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+    bool ok = true;
+    for (const char* table : {"user_cache_a", "user_cache_b", "allowance_ledger"}) {
+        std::vector<std::pair<sqlite3_int64, CardUid>> rows;
+        const std::string selectSql = std::string("SELECT rowid, uid FROM ") + table + " WHERE typeof(uid) = 'text';";
+        stmt = nullptr;
+        if (sqlite3_prepare_v2(db_, selectSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            sqlite3_finalize(stmt);
+            ok = false;
+            break;
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            if (const auto card = CardUid::Parse(text ? text : "")) {
+                rows.emplace_back(sqlite3_column_int64(stmt, 0), *card);
+            }
+        }
+        sqlite3_finalize(stmt);
+
+        const std::string updateSql = std::string("UPDATE ") + table + " SET uid = ? WHERE rowid = ?;";
+        stmt = nullptr;
+        if (sqlite3_prepare_v2(db_, updateSql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            sqlite3_finalize(stmt);
+            ok = false;
+            break;
+        }
+        for (const auto& [rowid, card] : rows) {
+            sqlite3_bind_blob(stmt, 1, card.data(), static_cast<int>(card.size()), SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmt, 2, rowid);
+            ok = (sqlite3_step(stmt) == SQLITE_DONE);
+            sqlite3_reset(stmt);
+            if (!ok) {
+                break;
+            }
+        }
+        sqlite3_finalize(stmt);
+        if (!ok) {
+            break;
+        }
+    }
+
+    ok = ok && ExecuteUnlocked("INSERT OR REPLACE INTO user_cache_meta (key, value) VALUES ('uid_format', 'binary');");
+    if (!ok || !ExecuteUnlocked("COMMIT;")) {
+        ExecuteUnlocked("ROLLBACK;");
+        return false;
+    }
+    return true;
+}
+
+std::optional<UserCacheEntry> UserCache::UserIndexMap::Find(const std::string& uid) const {
+    const Value* value = nullptr;
+    if (const auto card = CardUid::Parse(uid)) {
+        const auto it = cards_.find(*card);
+        value = (it != cards_.end()) ? &it->second : nullptr;
+    } else {
+        const auto it = others_.find(uid);
+        value = (it != others_.end()) ? &it->second : nullptr;
+    }
+    if (!value) {
+        return std::nullopt;
+    }
+    UserCacheEntry entry;
+    entry.uid = uid;
+    entry.allowance = value->allowance;
+    entry.roleId = value->roleId;
+    return entry;
+}
+
+std::optional<UserCacheEntry> UserCache::UserIndexMap::Find(const CardUid& uid) const {
+    const auto it = cards_.find(uid);
+    if (it == cards_.end()) {
+        return std::nullopt;
+    }
+    UserCacheEntry entry;
+    entry.uid = uid.ToString();
+    entry.allowance = it->second.allowance;
+    entry.roleId = it->second.roleId;
+    return entry;
+}
+
+void UserCache::UserIndexMap::Put(const std::string& uid, double allowance, int roleId) {
+    if (const auto card = CardUid::Parse(uid)) {
+        Put(*card, allowance, roleId);
+    } else {
+        others_[uid] = Value{allowance, roleId};
+    }
+}
+
+void UserCache::UserIndexMap::Put(const CardUid& uid, double allowance, int roleId) {
+    cards_[uid] = Value{allowance, roleId};
+}
+
+void UserCache::UserIndexMap::Merge(const UserIndexMap& other) {
+    for (const auto& [uid, value] : other.cards_) {
+        cards_[uid] = value;
+    }
+    for (const auto& [uid, value] : other.others_) {
+        others_[uid] = value;
+    }
+}
+
+void UserCache::UserIndexMap::AddKeysTo(BloomFilter& filter) const {
+    for (const auto& [uid, value] : cards_) {
+        filter.Add(uid.data(), uid.size());
+    }
+    for (const auto& [uid, value] : others_) {
+        filter.Add(uid);
+    }
+}
+
+std::shared_ptr<const UserCache::UserIndexMap> UserCache::LoadActiveTable() const {
+    if (!db_) {
+        return nullptr;
+    }
+
+    std::string sql = "SELECT t.uid, MAX(0.0, t.allowance - IFNULL(l.pending, 0.0)), t.role_id FROM " +
+                      GetActiveTableName() + " t LEFT JOIN (" + kPendingLedgerSql + ") l ON l.uid = t.uid;";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return nullptr;
+    }
+    ScopedStatementReset reset(stmt);
+
+    auto map = std::make_shared<UserIndexMap>();
+    int stepResult = SQLITE_ROW;
+    while ((stepResult = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const double allowance = sqlite3_column_double(stmt, 1);
+        const int roleId = sqlite3_column_int(stmt, 2);
+        if (const auto card = ColumnCardUid(stmt, 0)) {
+            map->Put(*card, allowance, roleId);
+        } else {
+            map->Put(ColumnUid(stmt, 0), allowance, roleId);
+        }
+    }
+
+    if (stepResult != SQLITE_DONE) {
+        return nullptr;
+    }
+    return map;
+}
+
+void UserCache::RebuildIndex(bool persistBloom, std::shared_ptr<BloomFilter> filter) {
+    auto base = LoadActiveTable();
+    if (!base) {
+        // Readers fall back to SQLite lookups until the next successful rebuild; without an
+        // index there is nothing reliable to build a filter from, so never reject either
+        std::atomic_store(&bloom_, std::shared_ptr<BloomFilter>());
+        std::atomic_store(&index_, std::shared_ptr<const IndexSnapshot>());
+        if (dbPath_ != ":memory:") {
+            std::remove(GetBloomFilterPath().c_str());
+        }
+        return;
+    }
+
+    auto snapshot = std::make_shared<IndexSnapshot>();
+    snapshot->base = std::move(base);
+    snapshot->delta = std::make_shared<UserIndexMap>();
+
+    if (!filter) {
+        filter = BuildBloomFilter(*snapshot);
+        if (persistBloom && dbPath_ != ":memory:" && !filter->Save(GetBloomFilterPath(), generation_)) {
+            LOG_WARN("Failed to persist user cache Bloom filter: {}", GetBloomFilterPath());
+        }
+    }
+
+    // The filter goes first, so that no reader pairs the new index with a filter that
+    // has never seen its keys
+    std::atomic_store(&bloom_, std::move(filter));
+    std::atomic_store(&index_, std::shared_ptr<const IndexSnapshot>(std::move(snapshot)));
+}
+
+void UserCache::ApplyIndexDelta(const UserCacheEntry& entry) {
+    const auto current = std::atomic_load(&index_);
+    if (!current) {
+        RebuildIndex(false);
+        return;
+    }
+
+    auto snapshot = std::make_shared<IndexSnapshot>();
+    if (current->delta->Size() >= kMaxIndexDeltaSize) {
+        // Fold the accumulated delta into a new base so that copies stay small
+        auto base = std::make_shared<UserIndexMap>(*current->base);
+        base->Merge(*current->delta);
+        base->Put(entry.uid, entry.allowance, entry.roleId);
+        snapshot->base = std::move(base);
+        snapshot->delta = std::make_shared<UserIndexMap>();
+    } else {
+        auto delta = std::make_shared<UserIndexMap>(*current->delta);
+        delta->Put(entry.uid, entry.allowance, entry.roleId);
+        snapshot->base = current->base;
+        snapshot->delta = std::move(delta);
+    }
+    std::atomic_store(&index_, std::shared_ptr<const IndexSnapshot>(std::move(snapshot)));
+}
+
+std::string UserCache::GetBloomFilterPath() const {
+    return dbPath_ + ".bloom";
+}
+
+std::shared_ptr<BloomFilter> UserCache::BuildBloomFilter(const IndexSnapshot& snapshot) {
+    const std::size_t count = snapshot.base->Size() + snapshot.delta->Size();
+    auto filter = std::make_shared<BloomFilter>(std::max(kBloomMinCapacity, count + count / 4),
+                                                kBloomFalsePositiveRate);
+    snapshot.base->AddKeysTo(*filter);
+    snapshot.delta->AddKeysTo(*filter);
+    return filter;
+}
+
+std::uint64_t UserCache::LoadGenerationUnlocked() const {
+    sqlite3_stmt* stmt = statements_.Get("SELECT value FROM user_cache_meta WHERE key = 'generation';");
+    if (!stmt) {
+        return 0;
+    }
+    ScopedStatementReset reset(stmt);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(sqlite3_column_int64(stmt, 0));
+}
+
+bool UserCache::StoreGenerationUnlocked(std::uint64_t generation) {
+    std::string sql = "INSERT OR REPLACE INTO user_cache_meta (key, value) VALUES ('generation', ?);";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return false;
+    }
+    ScopedStatementReset reset(stmt);
+    sqlite3_bind_text(stmt, 1, std::to_string(generation).c_str(), -1, SQLITE_TRANSIENT);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+void UserCache::AddToBloomFilter(const std::string& uid) {
+    const auto filter = std::atomic_load(&bloom_);
+    if (!filter || BloomMightContain(*filter, uid)) {
+        return;
+    }
+    // Drop the persisted copy before the UID reaches the database, so that a crash in
+    // between can never leave a filter on disk that rejects a cached card
+    if (dbPath_ != ":memory:") {
+        std::remove(GetBloomFilterPath().c_str());
+    }
+    BloomAdd(*filter, uid);
+}
+
+BloomFilterStats UserCache::GetBloomFilterStats() const {
+    BloomFilterStats stats;
+    stats.lookups = bloomLookups_.load();
+    stats.rejected = bloomRejected_.load();
+    stats.falsePositives = bloomFalsePositives_.load();
+    if (const auto filter = std::atomic_load(&bloom_)) {
+        stats.estimatedFalsePositiveRate = filter->EstimatedFalsePositiveRate();
+    }
+    return stats;
+}
+
 std::optional<UserCacheEntry> UserCache::GetEntry(const std::string& uid) const {
+    // Definite misses (foreign cards) are rejected by the filter in constant time
+    const auto filter = std::atomic_load(&bloom_);
+    if (filter) {
+        ++bloomLookups_;
+        if (!BloomMightContain(*filter, uid)) {
+            ++bloomRejected_;
+            return std::nullopt;
+        }
+    }
+
+    auto result = LookupEntry(uid);
+    if (filter && !result) {
+        ++bloomFalsePositives_;
+    }
+    return result;
+}
+
+std::optional<UserCacheEntry> UserCache::GetEntry(const CardUid& uid) const {
+    const auto filter = std::atomic_load(&bloom_);
+    if (filter) {
+        ++bloomLookups_;
+        if (!filter->MightContain(uid.data(), uid.size())) {
+            ++bloomRejected_;
+            return std::nullopt;
+        }
+    }
+
+    std::optional<UserCacheEntry> result;
+    if (const auto snapshot = std::atomic_load(&index_)) {
+        result = snapshot->delta->Find(uid);
+        if (!result) {
+            result = snapshot->base->Find(uid);
+        }
+    } else {
+        result = LookupEntry(uid.ToString());
+    }
+    if (filter && !result) {
+        ++bloomFalsePositives_;
+    }
+    return result;
+}
+
+std::optional<UserCacheEntry> UserCache::LookupEntry(const std::string& uid) const {
+    // Fast path: lock-free lookup in the published snapshot
+    if (const auto snapshot = std::atomic_load(&index_)) {
+        if (auto entry = snapshot->delta->Find(uid)) {
+            return entry;
+        }
+        return snapshot->base->Find(uid);
+    }
+
     std::lock_guard<std::mutex> lock(dbMutex_);
+    return SelectEntryUnlocked(uid);
+}
+
+std::optional<UserCacheEntry> UserCache::SelectEntryUnlocked(const std::string& uid) const {
     if (!db_) {
         return std::nullopt;
     }
 
-    std::string sql = "SELECT uid, allowance, role_id FROM " + GetActiveTableName() + " WHERE uid = ?;";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    std::string sql = "SELECT t.uid, MAX(0.0, t.allowance - IFNULL((SELECT SUM(amount) FROM allowance_ledger "
+                      "WHERE uid = t.uid AND folded_at IS NULL), 0.0)), t.role_id FROM " +
+                      GetActiveTableName() + " t WHERE t.uid = ?;";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return std::nullopt;
     }
+    ScopedStatementReset reset(stmt);
 
-    sqlite3_bind_text(stmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
+    BindUid(stmt, 1, uid);
 
     std::optional<UserCacheEntry> result;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         UserCacheEntry entry;
-        entry.uid = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        entry.uid = ColumnUid(stmt, 0);
         entry.allowance = sqlite3_column_double(stmt, 1);
         entry.roleId = sqlite3_column_int(stmt, 2);
         result = entry;
     }
-    sqlite3_finalize(stmt);
     return result;
 }
 
@@ -141,26 +549,49 @@ bool UserCache::UpdateEntry(const std::string& uid, double allowance, int roleId
         tablesToUpdate.push_back(GetActiveTableName());
     }
 
+    AddToBloomFilter(uid);
+
+    bool success = true;
+    bool activeUpdated = false;
     for (const auto& tableName : tablesToUpdate) {
         std::string sql = "INSERT OR REPLACE INTO " + tableName + " (uid, allowance, role_id) VALUES (?, ?, ?);";
-        sqlite3_stmt* stmt = nullptr;
-        if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-            return false;
+        sqlite3_stmt* stmt = statements_.Get(sql);
+        if (!stmt) {
+            success = false;
+            break;
         }
+        ScopedStatementReset reset(stmt);
 
-        sqlite3_bind_text(stmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
+        BindUid(stmt, 1, uid);
         sqlite3_bind_double(stmt, 2, allowance);
         sqlite3_bind_int(stmt, 3, roleId);
 
         const bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-        sqlite3_finalize(stmt);
         
         if (!ok) {
-            return false;
+            success = false;
+            break;
+        }
+        if (tableName == GetActiveTableName()) {
+            activeUpdated = true;
         }
     }
 
-    return true;
+    // The fresh value from the backend supersedes offline deductions recorded so far
+    if (activeUpdated && !SupersedeLedgerUnlocked(uid)) {
+        success = false;
+    }
+
+    // Keep the index in line with the active table even if the standby write failed
+    if (activeUpdated) {
+        UserCacheEntry entry;
+        entry.uid = uid;
+        entry.allowance = allowance;
+        entry.roleId = roleId;
+        ApplyIndexDelta(entry);
+    }
+
+    return success;
 }
 
 bool UserCache::DeductAllowance(const std::string& uid, double amount) {
@@ -169,79 +600,97 @@ bool UserCache::DeductAllowance(const std::string& uid, double amount) {
         return false;
     }
 
-    // First, get the current entry from active table
-    std::string selectSql = "SELECT allowance, role_id FROM " + GetActiveTableName() + " WHERE uid = ?;";
-    sqlite3_stmt* selectStmt = nullptr;
-    if (sqlite3_prepare_v2(db_, selectSql.c_str(), -1, &selectStmt, nullptr) != SQLITE_OK) {
-        return false;
+    // Effective allowance = active table value minus pending ledger entries
+    auto entry = SelectEntryUnlocked(uid);
+    if (!entry) {
+        return false; // Entry not found
     }
 
-    sqlite3_bind_text(selectStmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
-
-    if (sqlite3_step(selectStmt) != SQLITE_ROW) {
-        sqlite3_finalize(selectStmt);
-        return false; // Entry not found
+    // A single append, whether or not a population is in progress: pending entries are
+    // folded into whichever table becomes active (see BeginPopulation/CommitPopulation)
+    std::string sql = "INSERT INTO allowance_ledger (uid, amount, created_at) VALUES (?, ?, ?);";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return false;
     }
+    ScopedStatementReset reset(stmt);
 
-    double currentAllowance = sqlite3_column_double(selectStmt, 0);
-    int roleId = sqlite3_column_int(selectStmt, 1);
-    sqlite3_finalize(selectStmt);
+    BindUid(stmt, 1, uid);
+    sqlite3_bind_double(stmt, 2, amount);
+    sqlite3_bind_int64(stmt, 3, static_cast<sqlite3_int64>(std::time(nullptr)));
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        return false;
+    }
 
     // Calculate new allowance (clamp to 0)
-    double newAllowance = std::max(0.0, currentAllowance - amount);
+    entry->allowance = std::max(0.0, entry->allowance - amount);
+    ApplyIndexDelta(*entry);
+    return true;
+}
 
-    // Update the entry (or both entries if population is in progress)
-    // Use INSERT OR REPLACE to handle standby table not having the entry yet
-    std::vector<std::string> tablesToUpdate;
-    if (populationInProgress_) {
-        tablesToUpdate.push_back(GetActiveTableName());
-        tablesToUpdate.push_back(GetStandbyTableName());
-    } else {
-        tablesToUpdate.push_back(GetActiveTableName());
+std::vector<AllowanceLedgerEntry> UserCache::GetLedger(const std::string& uid) const {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    std::vector<AllowanceLedgerEntry> result;
+    if (!db_) {
+        return result;
     }
 
-    // Use transaction to ensure both tables are updated atomically during population
-    if (populationInProgress_) {
-        char* errorMessage = nullptr;
-        if (sqlite3_exec(db_, "BEGIN TRANSACTION;", nullptr, nullptr, &errorMessage) != SQLITE_OK) {
-            sqlite3_free(errorMessage);
-            return false;
-        }
+    std::string sql = "SELECT id, uid, amount, created_at, folded_at FROM allowance_ledger";
+    if (!uid.empty()) {
+        sql += " WHERE uid = ?";
+    }
+    sql += " ORDER BY id;";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return result;
+    }
+    ScopedStatementReset reset(stmt);
+    if (!uid.empty()) {
+        BindUid(stmt, 1, uid);
     }
 
-    bool success = true;
-    for (const auto& tableName : tablesToUpdate) {
-        std::string updateSql = "INSERT OR REPLACE INTO " + tableName + " (uid, allowance, role_id) VALUES (?, ?, ?);";
-        sqlite3_stmt* updateStmt = nullptr;
-        if (sqlite3_prepare_v2(db_, updateSql.c_str(), -1, &updateStmt, nullptr) != SQLITE_OK) {
-            success = false;
-            break;
-        }
-
-        sqlite3_bind_text(updateStmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_double(updateStmt, 2, newAllowance);
-        sqlite3_bind_int(updateStmt, 3, roleId);
-
-        const bool ok = (sqlite3_step(updateStmt) == SQLITE_DONE);
-        sqlite3_finalize(updateStmt);
-        
-        if (!ok) {
-            success = false;
-            break;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        AllowanceLedgerEntry entry;
+        entry.id = sqlite3_column_int64(stmt, 0);
+        entry.uid = ColumnUid(stmt, 1);
+        entry.amount = sqlite3_column_double(stmt, 2);
+        entry.createdAt = sqlite3_column_int64(stmt, 3);
+        if (sqlite3_column_type(stmt, 4) != SQLITE_NULL) {
+            entry.foldedAt = sqlite3_column_int64(stmt, 4);
         }
+        result.push_back(std::move(entry));
     }
+    return result;
+}
 
-    // Commit or rollback transaction during population
-    if (populationInProgress_) {
-        char* errorMessage = nullptr;
-        const char* sql = success ? "COMMIT;" : "ROLLBACK;";
-        if (sqlite3_exec(db_, sql, nullptr, nullptr, &errorMessage) != SQLITE_OK) {
-            sqlite3_free(errorMessage);
-            return false;
-        }
+bool UserCache::FoldLedgerUnlocked(const std::string& tableName) {
+    const std::string foldSql = "UPDATE " + tableName + " SET allowance = MAX(0.0, allowance - "
+                                "(SELECT SUM(amount) FROM allowance_ledger l WHERE l.uid = " + tableName +
+                                ".uid AND l.folded_at IS NULL)) WHERE uid IN (" + kPendingUidsSql + ");";
+    const std::string markSql = "UPDATE allowance_ledger SET folded_at = " +
+                                std::to_string(static_cast<long long>(std::time(nullptr))) +
+                                " WHERE folded_at IS NULL;";
+    if (!ExecuteUnlocked(foldSql) || !ExecuteUnlocked(markSql)) {
+        return false;
     }
 
-    return success;
+    // Folded history is kept for auditing, but not forever
+    const auto cutoff = static_cast<long long>(std::time(nullptr)) -
+                        static_cast<long long>(kLedgerRetention.count());
+    return ExecuteUnlocked("DELETE FROM allowance_ledger WHERE folded_at IS NOT NULL AND folded_at < " +
+                           std::to_string(cutoff) + ";");
+}
+
+bool UserCache::SupersedeLedgerUnlocked(const std::string& uid) {
+    std::string sql = "UPDATE allowance_ledger SET folded_at = ? WHERE uid = ? AND folded_at IS NULL;";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return false;
+    }
+    ScopedStatementReset reset(stmt);
+    sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(std::time(nullptr)));
+    BindUid(stmt, 2, uid);
+    return sqlite3_step(stmt) == SQLITE_DONE;
 }
 
 int UserCache::GetCount() const {
@@ -251,16 +700,16 @@ int UserCache::GetCount() const {
     }
 
     std::string sql = "SELECT COUNT(*) FROM " + GetActiveTableName() + ";";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return 0;
     }
+    ScopedStatementReset reset(stmt);
 
     int count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
     return count;
 }
 
@@ -274,10 +723,11 @@ std::vector<TankCacheEntry> UserCache::GetTanks() const {
     std::string activeSuffix = activeTableIsA_ ? "a" : "b";
     const std::string sql = "SELECT id_tank, visual_number_tank, name_tank, volume FROM tank_cache_" +
                             activeSuffix + " ORDER BY visual_number_tank ASC;";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return result;
     }
+    ScopedStatementReset reset(stmt);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         TankCacheEntry entry;
@@ -288,7 +738,6 @@ std::vector<TankCacheEntry> UserCache::GetTanks() const {
         entry.volume = sqlite3_column_double(stmt, 3);
         result.push_back(entry);
     }
-    sqlite3_finalize(stmt);
     return result;
 }
 
@@ -300,16 +749,16 @@ int UserCache::GetTankCount() const {
 
     std::string activeSuffix = activeTableIsA_ ? "a" : "b";
     const std::string sql = "SELECT COUNT(*) FROM tank_cache_" + activeSuffix + ";";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return 0;
     }
+    ScopedStatementReset reset(stmt);
 
     int count = 0;
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         count = sqlite3_column_int(stmt, 0);
     }
-    sqlite3_finalize(stmt);
     return count;
 }
 
@@ -319,6 +768,16 @@ bool UserCache::BeginPopulation() {
         return false;
     }
 
+    // Deductions recorded so far belong to the current table generation; the backend
+    // data being downloaded supersedes them, just like it supersedes the table itself
+    if (!ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+    if (!FoldLedgerUnlocked(GetActiveTableName()) || !ExecuteUnlocked("COMMIT;")) {
+        ExecuteUnlocked("ROLLBACK;");
+        return false;
+    }
+
     // Clear the standby table
     std::string sql = "DELETE FROM " + GetStandbyTableName() + ";";
     char* errorMessage = nullptr;
@@ -347,17 +806,17 @@ bool UserCache::AddPopulationEntry(const std::string& uid, double allowance, int
     }
 
     std::string sql = "INSERT OR REPLACE INTO " + GetStandbyTableName() + " (uid, allowance, role_id) VALUES (?, ?, ?);";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return false;
     }
+    ScopedStatementReset reset(stmt);
 
-    sqlite3_bind_text(stmt, 1, uid.c_str(), -1, SQLITE_TRANSIENT);
+    BindUid(stmt, 1, uid);
     sqlite3_bind_double(stmt, 2, allowance);
     sqlite3_bind_int(stmt, 3, roleId);
 
     const bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
     return ok;
 }
 
@@ -370,10 +829,11 @@ bool UserCache::AddPopulationTank(int idTank, int visualNumberTank, const std::s
     std::string standbySuffix = activeTableIsA_ ? "b" : "a";
     std::string sql = "INSERT OR REPLACE INTO tank_cache_" + standbySuffix +
                       " (id_tank, visual_number_tank, name_tank, volume) VALUES (?, ?, ?, ?);";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
         return false;
     }
+    ScopedStatementReset reset(stmt);
 
     sqlite3_bind_int(stmt, 1, idTank);
     sqlite3_bind_int(stmt, 2, visualNumberTank);
@@ -381,40 +841,145 @@ bool UserCache::AddPopulationTank(int idTank, int visualNumberTank, const std::s
     sqlite3_bind_double(stmt, 4, volume);
 
     const bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
     return ok;
 }
 
-bool UserCache::CommitPopulation() {
+bool UserCache::AddPopulationEntries(const std::vector<UserCard>& cards) {
     std::lock_guard<std::mutex> lock(dbMutex_);
     if (!db_ || !populationInProgress_) {
         return false;
     }
+    if (cards.empty()) {
+        return true;
+    }
+
+    // One transaction (and one fsync) per page instead of one per card
+    if (!ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    bool success = true;
+    {
+        std::string sql = "INSERT OR REPLACE INTO " + GetStandbyTableName() + " (uid, allowance, role_id) VALUES (?, ?, ?);";
+        sqlite3_stmt* stmt = statements_.Get(sql);
+        success = (stmt != nullptr);
+        for (const auto& card : cards) {
+            if (!success) {
+                break;
+            }
+            ScopedStatementReset reset(stmt);
+            BindUid(stmt, 1, card.uid);
+            sqlite3_bind_double(stmt, 2, card.allowance);
+            sqlite3_bind_int(stmt, 3, card.roleId);
+            success = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+    }
+
+    if (!ExecuteUnlocked(success ? "COMMIT;" : "ROLLBACK;")) {
+        ExecuteUnlocked("ROLLBACK;");
+        return false;
+    }
+    return success;
+}
+
+bool UserCache::AddPopulationTanks(const std::vector<FuelTank>& tanks) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    if (!db_ || !populationInProgress_) {
+        return false;
+    }
+    if (tanks.empty()) {
+        return true;
+    }
+
+    if (!ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    bool success = true;
+    {
+        std::string standbySuffix = activeTableIsA_ ? "b" : "a";
+        std::string sql = "INSERT OR REPLACE INTO tank_cache_" + standbySuffix +
+                          " (id_tank, visual_number_tank, name_tank, volume) VALUES (?, ?, ?, ?);";
+        sqlite3_stmt* stmt = statements_.Get(sql);
+        success = (stmt != nullptr);
+        for (const auto& tank : tanks) {
+            if (!success) {
+                break;
+            }
+            ScopedStatementReset reset(stmt);
+            sqlite3_bind_int(stmt, 1, tank.idTank);
+            sqlite3_bind_int(stmt, 2, tank.visualNumberTank);
+            sqlite3_bind_text(stmt, 3, tank.nameTank.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_double(stmt, 4, tank.volume);
+            success = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+    }
+
+    if (!ExecuteUnlocked(success ? "COMMIT;" : "ROLLBACK;")) {
+        ExecuteUnlocked("ROLLBACK;");
+        return false;
+    }
+    return success;
+}
+
+bool UserCache::CommitPopulation(const std::string& syncWatermark) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    if (!db_ || !populationInProgress_) {
+        return false;
+    }
+
+    // Flip inside a write transaction so the metadata switch is atomic with respect
+    // to other connections and is made durable with a single commit
+    if (!ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+        return false;
+    }
 
     // Swap the active table
     activeTableIsA_ = !activeTableIsA_;
     
     // Update metadata
     std::string newActiveValue = activeTableIsA_ ? "A" : "B";
-    std::string sql = "UPDATE user_cache_meta SET value = ? WHERE key = 'active_table';";
-    sqlite3_stmt* stmt = nullptr;
-    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        // Rollback the swap
-        activeTableIsA_ = !activeTableIsA_;
-        return false;
+    bool ok = false;
+    {
+        std::string sql = "UPDATE user_cache_meta SET value = ? WHERE key = 'active_table';";
+        sqlite3_stmt* stmt = statements_.Get(sql);
+        if (stmt) {
+            ScopedStatementReset reset(stmt);
+            sqlite3_bind_text(stmt, 1, newActiveValue.c_str(), -1, SQLITE_TRANSIENT);
+            ok = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+    }
+    if (ok && !syncWatermark.empty()) {
+        ok = StoreSyncWatermark(syncWatermark);
+    }
+    // A persisted filter from the previous generation no longer matches once this commits
+    if (ok) {
+        ok = StoreGenerationUnlocked(generation_ + 1);
+    }
+    // Deductions made while the population was running carry over into the new table;
+    // cards they touched are kept even if the download did not include them, as before
+    if (ok) {
+        ok = ExecuteUnlocked("INSERT OR IGNORE INTO " + GetActiveTableName() +
+                             " (uid, allowance, role_id) SELECT uid, allowance, role_id FROM " +
+                             GetStandbyTableName() + " WHERE uid IN (" + kPendingUidsSql + ");") &&
+             FoldLedgerUnlocked(GetActiveTableName());
     }
 
-    sqlite3_bind_text(stmt, 1, newActiveValue.c_str(), -1, SQLITE_TRANSIENT);
-    const bool ok = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
-
-    if (!ok) {
+    if (!ok || !ExecuteUnlocked("COMMIT;")) {
+        ExecuteUnlocked("ROLLBACK;");
         // Rollback the swap
         activeTableIsA_ = !activeTableIsA_;
         return false;
     }
 
     populationInProgress_ = false;
+    ++generation_;
+
+    // Statements prepared for the previous table generation are stale now
+    statements_.Clear();
+
+    // Publish a fresh snapshot of the new active table
+    RebuildIndex(true);
     return true;
 }
 
@@ -423,4 +988,138 @@ void UserCache::AbortPopulation() {
     populationInProgress_ = false;
 }
 
+bool UserCache::StoreSyncWatermark(const std::string& syncWatermark) {
+    std::string sql = "INSERT OR REPLACE INTO user_cache_meta (key, value) VALUES ('sync_watermark', ?);";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return false;
+    }
+    ScopedStatementReset reset(stmt);
+    sqlite3_bind_text(stmt, 1, syncWatermark.c_str(), -1, SQLITE_TRANSIENT);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+std::optional<std::string> UserCache::GetSyncWatermark() const {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    if (!db_) {
+        return std::nullopt;
+    }
+
+    std::string sql = "SELECT value FROM user_cache_meta WHERE key = 'sync_watermark';";
+    sqlite3_stmt* stmt = statements_.Get(sql);
+    if (!stmt) {
+        return std::nullopt;
+    }
+    ScopedStatementReset reset(stmt);
+
+    std::optional<std::string> result;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const auto* value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        if (value && *value) {
+            result = value;
+        }
+    }
+    return result;
+}
+
+bool UserCache::ApplyDelta(const std::vector<UserCard>& upserts,
+                           const std::vector<std::string>& deletedUids,
+                           const std::vector<FuelTank>& tanks,
+                           const std::string& syncWatermark) {
+    std::lock_guard<std::mutex> lock(dbMutex_);
+    if (!db_ || populationInProgress_) {
+        return false;
+    }
+
+    if (!ExecuteUnlocked("BEGIN IMMEDIATE;")) {
+        return false;
+    }
+
+    bool success = true;
+    {
+        std::string sql = "INSERT OR REPLACE INTO " + GetActiveTableName() + " (uid, allowance, role_id) VALUES (?, ?, ?);";
+        sqlite3_stmt* stmt = statements_.Get(sql);
+        success = (stmt != nullptr);
+        for (const auto& card : upserts) {
+            if (!success) {
+                break;
+            }
+            ScopedStatementReset reset(stmt);
+            BindUid(stmt, 1, card.uid);
+            sqlite3_bind_double(stmt, 2, card.allowance);
+            sqlite3_bind_int(stmt, 3, card.roleId);
+            success = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+    }
+
+    // Backend values supersede offline deductions for the changed and removed cards
+    for (const auto& card : upserts) {
+        if (!success) {
+            break;
+        }
+        success = SupersedeLedgerUnlocked(card.uid);
+    }
+    for (const auto& uid : deletedUids) {
+        if (!success) {
+            break;
+        }
+        success = SupersedeLedgerUnlocked(uid);
+    }
+
+    if (success && !deletedUids.empty()) {
+        std::string sql = "DELETE FROM " + GetActiveTableName() + " WHERE uid = ?;";
+        sqlite3_stmt* stmt = statements_.Get(sql);
+        success = (stmt != nullptr);
+        for (const auto& uid : deletedUids) {
+            if (!success) {
+                break;
+            }
+            ScopedStatementReset reset(stmt);
+            BindUid(stmt, 1, uid);
+            success = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+    }
+
+    // Tanks are few, so the active tank table is simply replaced
+    if (success) {
+        std::string activeSuffix = activeTableIsA_ ? "a" : "b";
+        success = ExecuteUnlocked("DELETE FROM tank_cache_" + activeSuffix + ";");
+        std::string sql = "INSERT OR REPLACE INTO tank_cache_" + activeSuffix +
+                          " (id_tank, visual_number_tank, name_tank, volume) VALUES (?, ?, ?, ?);";
+        sqlite3_stmt* stmt = success ? statements_.Get(sql) : nullptr;
+        success = success && (stmt != nullptr);
+        for (const auto& tank : tanks) {
+            if (!success) {
+                break;
+            }
+            ScopedStatementReset reset(stmt);
+            sqlite3_bind_int(stmt, 1, tank.idTank);
+            sqlite3_bind_int(stmt, 2, tank.visualNumberTank);
+            sqlite3_bind_text(stmt, 3, tank.nameTank.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_double(stmt, 4, tank.volume);
+            success = (sqlite3_step(stmt) == SQLITE_DONE);
+        }
+    }
+
+    if (success && !syncWatermark.empty()) {
+        success = StoreSyncWatermark(syncWatermark);
+    }
+    if (success) {
+        success = StoreGenerationUnlocked(generation_ + 1);
+    }
+
+    if (!ExecuteUnlocked(success ? "COMMIT;" : "ROLLBACK;")) {
+        ExecuteUnlocked("ROLLBACK;");
+        return false;
+    }
+    if (!success) {
+        return false;
+    }
+    ++generation_;
+
+    // Deletes cannot be expressed as an index delta, so reload the active table
+    RebuildIndex(true);
+    return true;
+}
+
 } // namespace fuelflux
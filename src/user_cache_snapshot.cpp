@@ -0,0 +1,744 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "user_cache_snapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "card_records.h"
+#include "crc32.h"
+#include "logger.h"
+
+namespace fuelflux {
+
+namespace {
+
+constexpr char kSnapshotMagic[4] = {'F', 'F', 'U', 'S'};
+constexpr std::uint32_t kSnapshotVersion = 1;
+
+struct SnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t generation;
+    std::uint32_t count;
+    std::uint32_t keyWidth;
+    std::uint32_t checksum;
+    std::uint32_t reserved;
+};
+static_assert(sizeof(SnapshotHeader) == 32, "Snapshot header must stay 32 bytes");
+
+std::size_t AlignTo8(std::size_t value) {
+    return (value + 7) & ~static_cast<std::size_t>(7);
+}
+
+bool CheckedMultiply(std::size_t a, std::size_t b, std::size_t& result) {
+    if (b != 0 && a > std::numeric_limits<std::size_t>::max() / b) {
+        return false;
+    }
+    result = a * b;
+    return true;
+}
+
+bool CheckedAdd(std::size_t a, std::size_t b, std::size_t& result) {
+    if (a > std::numeric_limits<std::size_t>::max() - b) {
+        return false;
+    }
+    result = a + b;
+    return true;
+}
+
+// Sizes of the key column (padded) and of the whole payload for a header; false if they
+// do not fit in size_t (a corrupt header on a 32-bit target)
+bool PayloadLayout(std::size_t count, std::size_t keyWidth, std::size_t& keysSize, std::size_t& payloadSize) {
+    std::size_t keys = 0;
+    std::size_t allowances = 0;
+    std::size_t roles = 0;
+    std::size_t columns = 0;
+    if (!CheckedMultiply(count, keyWidth, keys) || !CheckedAdd(keys, 7, keys) ||
+        !CheckedMultiply(count, sizeof(double), allowances) ||
+        !CheckedMultiply(count, sizeof(std::int32_t), roles) ||
+        !CheckedAdd(allowances, roles, columns)) {
+        return false;
+    }
+    keysSize = keys & ~static_cast<std::size_t>(7);
+    return CheckedAdd(keysSize, columns, payloadSize);
+}
+
+// Overlay journal records: "G\t<generation>" first, then the "W\t<watermark>" and
+// "T\t<idTank>\t<visualNumber>\t<volume>\t<name>" records of that generation, then
+// "S\t<uid>\t<allowance>\t<role>" for backend values, "D\t<uid>\t<amount>" for offline
+// deductions and "P\t<uid>\t<amount>" for pending deductions already in an S value
+std::string FormatDouble(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+    return buffer;
+}
+
+// Record separators in a free-text field would split or end the record
+std::string JournalField(std::string value) {
+    std::replace_if(value.begin(), value.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+    return value;
+}
+
+std::vector<std::string> SplitRecord(const std::string& line) {
+    std::vector<std::string> fields;
+    std::size_t start = 0;
+    while (true) {
+        const std::size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) {
+            return fields;
+        }
+        start = tab + 1;
+    }
+}
+
+bool WriteAll(int fd, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool WriteJournalFile(int fd, const std::string& data) {
+    return WriteAll(fd, data.data(), data.size()) && ::fdatasync(fd) == 0;
+}
+
+} // namespace
+
+UserCacheSnapshot::~UserCacheSnapshot() {
+    if (mapping_) {
+        ::munmap(mapping_, size_);
+    }
+}
+
+bool UserCacheSnapshot::Write(const std::string& path, std::vector<UserCacheEntry> entries, std::uint64_t generation) {
+    // Stable sort keeps the input order of duplicates, so the last one survives the unique pass below
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const UserCacheEntry& a, const UserCacheEntry& b) { return a.uid < b.uid; });
+    std::vector<UserCacheEntry> unique;
+    unique.reserve(entries.size());
+    for (auto& entry : entries) {
+        if (!unique.empty() && unique.back().uid == entry.uid) {
+            unique.back() = std::move(entry);
+        } else {
+            unique.push_back(std::move(entry));
+        }
+    }
+
+    std::size_t keyWidth = 1;
+    for (const auto& entry : unique) {
+        keyWidth = std::max(keyWidth, entry.uid.size());
+    }
+
+    const std::size_t count = unique.size();
+    const std::size_t keysSize = AlignTo8(count * keyWidth);
+    std::vector<unsigned char> payload(keysSize + count * sizeof(double) + count * sizeof(std::int32_t), 0);
+
+    unsigned char* keys = payload.data();
+    unsigned char* allowances = keys + keysSize;
+    unsigned char* roles = allowances + count * sizeof(double);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::memcpy(keys + i * keyWidth, unique[i].uid.data(), unique[i].uid.size());
+        const double allowance = unique[i].allowance;
+        const std::int32_t role = unique[i].roleId;
+        std::memcpy(allowances + i * sizeof(double), &allowance, sizeof(double));
+        std::memcpy(roles + i * sizeof(std::int32_t), &role, sizeof(std::int32_t));
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+    header.version = kSnapshotVersion;
+    header.generation = generation;
+    header.count = static_cast<std::uint32_t>(count);
+    header.keyWidth = static_cast<std::uint32_t>(keyWidth);
+    header.checksum = Crc32(payload.data(), payload.size());
+
+    const std::string tempPath = path + ".tmp";
+    const int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create user cache snapshot: {}", tempPath);
+        return false;
+    }
+    const bool written = WriteAll(fd, &header, sizeof(header)) &&
+                         WriteAll(fd, payload.data(), payload.size()) &&
+                         ::fsync(fd) == 0;
+    ::close(fd);
+
+    if (!written || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Failed to write user cache snapshot: {}", path);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const UserCacheSnapshot> UserCacheSnapshot::Open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::shared_ptr<UserCacheSnapshot> snapshot(new UserCacheSnapshot());
+    snapshot->mapping_ = mapping;
+    snapshot->size_ = size;
+
+    SnapshotHeader header{};
+    std::memcpy(&header, mapping, sizeof(header));
+    if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 ||
+        header.version != kSnapshotVersion || header.keyWidth == 0) {
+        LOG_WARN("Ignoring user cache snapshot with unknown format: {}", path);
+        return nullptr;
+    }
+
+    const std::size_t count = header.count;
+    std::size_t keysSize = 0;
+    std::size_t payloadSize = 0;
+    const auto* payload = static_cast<const unsigned char*>(mapping) + sizeof(SnapshotHeader);
+    if (!PayloadLayout(count, header.keyWidth, keysSize, payloadSize) ||
+        size - sizeof(SnapshotHeader) != payloadSize || Crc32(payload, payloadSize) != header.checksum) {
+        LOG_WARN("Ignoring corrupt user cache snapshot: {}", path);
+        return nullptr;
+    }
+
+    snapshot->generation_ = header.generation;
+    snapshot->count_ = count;
+    snapshot->keyWidth_ = header.keyWidth;
+    snapshot->keys_ = payload;
+    // The header is 32 bytes and the key column is padded to 8, so the columns are naturally aligned
+    snapshot->allowances_ = reinterpret_cast<const double*>(payload + keysSize);
+    snapshot->roles_ = reinterpret_cast<const std::int32_t*>(payload + keysSize + count * sizeof(double));
+    return snapshot;
+}
+
+std::optional<UserCacheEntry> UserCacheSnapshot::Find(const std::string& uid) const {
+    if (uid.empty() || uid.size() > keyWidth_) {
+        return std::nullopt;
+    }
+
+    // Zero padding sorts before any UID character, so padded keys keep std::string order
+    unsigned char key[256];
+    std::vector<unsigned char> longKey;
+    unsigned char* probe = key;
+    if (keyWidth_ > sizeof(key)) {
+        longKey.resize(keyWidth_);
+        probe = longKey.data();
+    }
+    std::memset(probe, 0, keyWidth_);
+    std::memcpy(probe, uid.data(), uid.size());
+
+    std::size_t low = 0;
+    std::size_t high = count_;
+    while (low < high) {
+        const std::size_t middle = low + (high - low) / 2;
+        const int order = std::memcmp(KeyAt(middle), probe, keyWidth_);
+        if (order == 0) {
+            UserCacheEntry entry;
+            entry.uid = uid;
+            entry.allowance = allowances_[middle];
+            entry.roleId = roles_[middle];
+            return entry;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<UserCacheEntry> UserCacheSnapshot::Entries() const {
+    std::vector<UserCacheEntry> entries;
+    entries.reserve(count_);
+    for (std::size_t i = 0; i < count_; ++i) {
+        const auto* key = reinterpret_cast<const char*>(KeyAt(i));
+        UserCacheEntry entry;
+        entry.uid.assign(key, std::find(key, key + keyWidth_, '\0'));
+        entry.allowance = allowances_[i];
+        entry.roleId = roles_[i];
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+MappedUserCache::MappedUserCache(std::string snapshotPath)
+    : snapshotPath_(std::move(snapshotPath)) {
+    const std::filesystem::path parent = std::filesystem::path(snapshotPath_).parent_path();
+    if (!parent.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(parent, error);
+    }
+    std::atomic_store(&state_, LoadJournal(UserCacheSnapshot::Open(snapshotPath_)));
+}
+
+std::shared_ptr<const MappedUserCache::State> MappedUserCache::LoadJournal(
+    const std::shared_ptr<const UserCacheSnapshot>& snapshot) {
+    const std::uint64_t generation = snapshot ? snapshot->Generation() : 0;
+    auto overlay = std::make_shared<OverlayMap>();
+    auto metadata = std::make_shared<Metadata>();
+    auto makeState = [&snapshot, &metadata](std::shared_ptr<const OverlayMap> stateOverlay) {
+        auto state = std::make_shared<State>();
+        state->snapshot = snapshot;
+        state->overlay = std::move(stateOverlay);
+        state->metadata = metadata;
+        return std::shared_ptr<const State>(std::move(state));
+    };
+
+    std::ifstream journal(JournalPath());
+    std::string line;
+    std::uint64_t journalGeneration = 0;
+    bool valid = false;
+    if (journal && std::getline(journal, line)) {
+        const auto fields = SplitRecord(line);
+        if (fields.size() == 2 && fields[0] == "G") {
+            try {
+                journalGeneration = std::stoull(fields[1]);
+                valid = journalGeneration <= generation;
+            } catch (const std::exception&) {
+            }
+        }
+    }
+    if (!valid) {
+        if (journal.is_open()) {
+            LOG_WARN("Ignoring user cache overlay journal that does not match the snapshot: {}", JournalPath());
+        }
+        RewriteJournal(generation, *overlay, *metadata);
+        return makeState(overlay);
+    }
+
+    // A torn last record (crash during an append) ends the replay
+    while (std::getline(journal, line)) {
+        const auto fields = SplitRecord(line);
+        try {
+            if (fields.size() == 2 && fields[0] == "W") {
+                metadata->syncWatermark = fields[1];
+            } else if (fields.size() == 5 && fields[0] == "T") {
+                TankCacheEntry tank;
+                tank.idTank = std::stoi(fields[1]);
+                tank.visualNumberTank = std::stoi(fields[2]);
+                tank.volume = std::stod(fields[3]);
+                tank.nameTank = fields[4];
+                metadata->tanks.push_back(std::move(tank));
+            } else if (fields.size() == 4 && fields[0] == "S") {
+                UserCacheEntry entry;
+                entry.uid = fields[1];
+                entry.allowance = std::stod(fields[2]);
+                entry.roleId = std::stoi(fields[3]);
+                (*overlay)[entry.uid] = entry;
+                pendingDeductions_.erase(entry.uid);
+            } else if (fields.size() == 3 && fields[0] == "D") {
+                const double amount = std::stod(fields[2]);
+                std::optional<UserCacheEntry> entry;
+                const auto it = overlay->find(fields[1]);
+                if (it != overlay->end()) {
+                    entry = it->second;
+                } else if (snapshot) {
+                    entry = snapshot->Find(fields[1]);
+                }
+                if (entry) {
+                    entry->allowance = std::max(0.0, entry->allowance - amount);
+                    (*overlay)[entry->uid] = *entry;
+                    pendingDeductions_[entry->uid] += amount;
+                }
+            } else if (fields.size() == 3 && fields[0] == "P") {
+                pendingDeductions_[fields[1]] += std::stod(fields[2]);
+            } else {
+                break;
+            }
+        } catch (const std::exception&) {
+            break;
+        }
+    }
+
+    if (journalGeneration == generation) {
+        return makeState(overlay);
+    }
+
+    // The process stopped between publishing a snapshot and rewriting the journal:
+    // carry the deductions over to the new snapshot as Publish would have done. The
+    // watermark belongs to the previous generation, so the next sync is a full one.
+    metadata->syncWatermark.reset();
+    auto carried = CarryOver(snapshot, *overlay);
+    RewriteJournal(generation, *carried, *metadata);
+    return makeState(carried);
+}
+
+std::shared_ptr<const MappedUserCache::OverlayMap> MappedUserCache::CarryOver(
+    const std::shared_ptr<const UserCacheSnapshot>& snapshot, const OverlayMap& previous) {
+    auto carried = std::make_shared<OverlayMap>();
+    for (const auto& [uid, amount] : pendingDeductions_) {
+        std::optional<UserCacheEntry> entry = snapshot ? snapshot->Find(uid) : std::nullopt;
+        if (entry) {
+            entry->allowance = std::max(0.0, entry->allowance - amount);
+            (*carried)[uid] = *entry;
+        } else if (const auto it = previous.find(uid); it != previous.end()) {
+            // Kept even if the new population does not include the card; already deducted
+            (*carried)[uid] = it->second;
+        }
+    }
+    pendingDeductions_.clear();
+    return carried;
+}
+
+bool MappedUserCache::AppendJournal(const std::string& record) {
+    const int fd = ::open(JournalPath().c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open user cache overlay journal: {}", JournalPath());
+        return false;
+    }
+    const bool written = WriteJournalFile(fd, record + "\n");
+    ::close(fd);
+    if (!written) {
+        LOG_ERROR("Failed to append to user cache overlay journal: {}", JournalPath());
+    }
+    return written;
+}
+
+bool MappedUserCache::RewriteJournal(std::uint64_t generation, const OverlayMap& overlay, const Metadata& metadata) {
+    std::string data = "G\t" + std::to_string(generation) + "\n";
+    if (metadata.syncWatermark) {
+        data += "W\t" + JournalField(*metadata.syncWatermark) + "\n";
+    }
+    for (const auto& tank : metadata.tanks) {
+        data += "T\t" + std::to_string(tank.idTank) + "\t" + std::to_string(tank.visualNumberTank) + "\t" +
+                FormatDouble(tank.volume) + "\t" + JournalField(tank.nameTank) + "\n";
+    }
+    for (const auto& [uid, entry] : overlay) {
+        data += "S\t" + uid + "\t" + FormatDouble(entry.allowance) + "\t" + std::to_string(entry.roleId) + "\n";
+    }
+    for (const auto& [uid, amount] : pendingDeductions_) {
+        data += "P\t" + uid + "\t" + FormatDouble(amount) + "\n";
+    }
+
+    const std::string tempPath = JournalPath() + ".tmp";
+    const int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create user cache overlay journal: {}", tempPath);
+        return false;
+    }
+    const bool written = WriteJournalFile(fd, data);
+    ::close(fd);
+    if (!written || std::rename(tempPath.c_str(), JournalPath().c_str()) != 0) {
+        LOG_ERROR("Failed to write user cache overlay journal: {}", JournalPath());
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool MappedUserCache::IsLoaded() const {
+    const auto state = std::atomic_load(&state_);
+    return state->snapshot != nullptr;
+}
+
+std::uint64_t MappedUserCache::GetGeneration() const {
+    const auto state = std::atomic_load(&state_);
+    return state->snapshot ? state->snapshot->Generation() : 0;
+}
+
+std::optional<UserCacheEntry> MappedUserCache::GetEntry(const std::string& uid) const {
+    const auto state = std::atomic_load(&state_);
+    const auto it = state->overlay->find(uid);
+    if (it != state->overlay->end()) {
+        return it->second;
+    }
+    if (state->snapshot) {
+        return state->snapshot->Find(uid);
+    }
+    return std::nullopt;
+}
+
+std::optional<UserCacheEntry> MappedUserCache::GetEntry(const CardUid& uid) const {
+    // Snapshot keys are the UID strings; card UIDs are at most 30 characters
+    return GetEntry(uid.ToString());
+}
+
+void MappedUserCache::StoreOverlayEntry(const std::shared_ptr<const State>& current, const UserCacheEntry& entry) {
+    auto overlay = std::make_shared<OverlayMap>(*current->overlay);
+    (*overlay)[entry.uid] = entry;
+
+    auto state = std::make_shared<State>(*current);
+    state->overlay = std::move(overlay);
+    std::atomic_store(&state_, std::shared_ptr<const State>(std::move(state)));
+}
+
+bool MappedUserCache::UpdateEntry(const std::string& uid, double allowance, int roleId) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!AppendJournal("S\t" + uid + "\t" + FormatDouble(allowance) + "\t" + std::to_string(roleId))) {
+        return false;
+    }
+    UserCacheEntry entry;
+    entry.uid = uid;
+    entry.allowance = allowance;
+    entry.roleId = roleId;
+    // The fresh value from the backend supersedes offline deductions recorded so far
+    pendingDeductions_.erase(uid);
+    StoreOverlayEntry(std::atomic_load(&state_), entry);
+    return true;
+}
+
+bool MappedUserCache::DeductAllowance(const std::string& uid, double amount) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    const auto current = std::atomic_load(&state_);
+
+    std::optional<UserCacheEntry> entry;
+    const auto it = current->overlay->find(uid);
+    if (it != current->overlay->end()) {
+        entry = it->second;
+    } else if (current->snapshot) {
+        entry = current->snapshot->Find(uid);
+    }
+    if (!entry || !AppendJournal("D\t" + uid + "\t" + FormatDouble(amount))) {
+        return false;
+    }
+
+    entry->allowance = std::max(0.0, entry->allowance - amount);
+    pendingDeductions_[uid] += amount;
+    StoreOverlayEntry(current, *entry);
+    return true;
+}
+
+int MappedUserCache::GetCount() const {
+    const auto state = std::atomic_load(&state_);
+    std::size_t count = state->snapshot ? state->snapshot->Count() : 0;
+    for (const auto& [uid, entry] : *state->overlay) {
+        if (!state->snapshot || !state->snapshot->Find(uid)) {
+            ++count;
+        }
+    }
+    return static_cast<int>(count);
+}
+
+std::vector<TankCacheEntry> MappedUserCache::GetTanks() const {
+    const auto state = std::atomic_load(&state_);
+    return state->metadata->tanks;
+}
+
+int MappedUserCache::GetTankCount() const {
+    const auto state = std::atomic_load(&state_);
+    return static_cast<int>(state->metadata->tanks.size());
+}
+
+std::optional<std::string> MappedUserCache::GetSyncWatermark() const {
+    const auto state = std::atomic_load(&state_);
+    return state->metadata->syncWatermark;
+}
+
+bool MappedUserCache::BeginPopulation() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (populationInProgress_) {
+        return false;
+    }
+    populationInProgress_ = true;
+    populationEntries_.clear();
+    populationTanks_.clear();
+    return true;
+}
+
+bool MappedUserCache::AddPopulationEntry(const std::string& uid, double allowance, int roleId) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!populationInProgress_) {
+        return false;
+    }
+    UserCacheEntry entry;
+    entry.uid = uid;
+    entry.allowance = allowance;
+    entry.roleId = roleId;
+    populationEntries_.push_back(std::move(entry));
+    return true;
+}
+
+bool MappedUserCache::AddPopulationTank(int idTank, int visualNumberTank, const std::string& nameTank, double volume) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!populationInProgress_) {
+        return false;
+    }
+    TankCacheEntry tank;
+    tank.idTank = idTank;
+    tank.visualNumberTank = visualNumberTank;
+    tank.nameTank = nameTank;
+    tank.volume = volume;
+    populationTanks_.push_back(std::move(tank));
+    return true;
+}
+
+bool MappedUserCache::AddPopulationEntries(const std::vector<UserCard>& cards) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!populationInProgress_) {
+        return false;
+    }
+    for (const auto& card : cards) {
+        UserCacheEntry entry;
+        entry.uid = card.uid;
+        entry.allowance = card.allowance;
+        entry.roleId = card.roleId;
+        populationEntries_.push_back(std::move(entry));
+    }
+    return true;
+}
+
+bool MappedUserCache::AddPopulationTanks(const std::vector<FuelTank>& tanks) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!populationInProgress_) {
+        return false;
+    }
+    for (const auto& fuelTank : tanks) {
+        TankCacheEntry tank;
+        tank.idTank = fuelTank.idTank;
+        tank.visualNumberTank = fuelTank.visualNumberTank;
+        tank.nameTank = fuelTank.nameTank;
+        tank.volume = fuelTank.volume;
+        populationTanks_.push_back(std::move(tank));
+    }
+    return true;
+}
+
+bool MappedUserCache::CommitPopulation(const std::string& syncWatermark) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!populationInProgress_) {
+        return false;
+    }
+    auto metadata = std::make_shared<Metadata>();
+    metadata->tanks = std::move(populationTanks_);
+    if (!syncWatermark.empty()) {
+        metadata->syncWatermark = syncWatermark;
+    }
+    std::vector<UserCacheEntry> entries = std::move(populationEntries_);
+    populationInProgress_ = false;
+    populationEntries_.clear();
+    populationTanks_.clear();
+    return PublishUnlocked(std::move(entries), std::move(metadata), nullptr);
+}
+
+void MappedUserCache::AbortPopulation() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    populationInProgress_ = false;
+    populationEntries_.clear();
+    populationTanks_.clear();
+}
+
+bool MappedUserCache::ApplyDelta(const std::vector<UserCard>& upserts,
+                                 const std::vector<std::string>& deletedUids,
+                                 const std::vector<FuelTank>& tanks,
+                                 const std::string& syncWatermark) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (populationInProgress_) {
+        return false;
+    }
+    const auto current = std::atomic_load(&state_);
+
+    std::unordered_set<std::string> changed(deletedUids.begin(), deletedUids.end());
+    for (const auto& card : upserts) {
+        changed.insert(card.uid);
+    }
+
+    std::vector<UserCacheEntry> entries = current->snapshot ? current->snapshot->Entries()
+                                                            : std::vector<UserCacheEntry>{};
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [&changed](const UserCacheEntry& entry) { return changed.count(entry.uid) != 0; }),
+                  entries.end());
+    for (const auto& card : upserts) {
+        UserCacheEntry entry;
+        entry.uid = card.uid;
+        entry.allowance = card.allowance;
+        entry.roleId = card.roleId;
+        entries.push_back(std::move(entry));
+    }
+
+    // Unchanged UIDs keep their overlay values and pending deductions: their snapshot values are the same
+    auto overlay = std::make_shared<OverlayMap>(*current->overlay);
+    const auto previousDeductions = pendingDeductions_;
+    for (const auto& uid : changed) {
+        overlay->erase(uid);
+        pendingDeductions_.erase(uid);
+    }
+
+    auto metadata = std::make_shared<Metadata>();
+    for (const auto& fuelTank : tanks) {
+        TankCacheEntry tank;
+        tank.idTank = fuelTank.idTank;
+        tank.visualNumberTank = fuelTank.visualNumberTank;
+        tank.nameTank = fuelTank.nameTank;
+        tank.volume = fuelTank.volume;
+        metadata->tanks.push_back(std::move(tank));
+    }
+    if (!syncWatermark.empty()) {
+        metadata->syncWatermark = syncWatermark;
+    }
+
+    if (!PublishUnlocked(std::move(entries), std::move(metadata), std::move(overlay))) {
+        pendingDeductions_ = previousDeductions;
+        return false;
+    }
+    return true;
+}
+
+bool MappedUserCache::Publish(const std::vector<UserCacheEntry>& entries) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    auto metadata = std::make_shared<Metadata>();
+    metadata->tanks = std::atomic_load(&state_)->metadata->tanks;
+    return PublishUnlocked(entries, std::move(metadata), nullptr);
+}
+
+bool MappedUserCache::PublishUnlocked(std::vector<UserCacheEntry> entries, std::shared_ptr<const Metadata> metadata,
+                                      std::shared_ptr<const OverlayMap> overlay) {
+    const auto current = std::atomic_load(&state_);
+    const std::uint64_t generation = (current->snapshot ? current->snapshot->Generation() : 0) + 1;
+
+    if (!UserCacheSnapshot::Write(snapshotPath_, std::move(entries), generation)) {
+        return false;
+    }
+    auto snapshot = UserCacheSnapshot::Open(snapshotPath_);
+    if (!snapshot) {
+        return false;
+    }
+
+    if (!overlay) {
+        overlay = CarryOver(snapshot, *current->overlay);
+    }
+    // A failed rewrite leaves the previous generation in the journal, which the next
+    // start carries over the same way
+    RewriteJournal(generation, *overlay, *metadata);
+
+    // Readers holding the previous state keep its mapping alive until they finish
+    auto state = std::make_shared<State>();
+    state->snapshot = std::move(snapshot);
+    state->overlay = std::move(overlay);
+    state->metadata = std::move(metadata);
+    std::atomic_store(&state_, std::shared_ptr<const State>(std::move(state)));
+    return true;
+}
+
+} // namespace fuelflux
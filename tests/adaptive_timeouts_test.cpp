@@ -0,0 +1,103 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include <gtest/gtest.h>
+#include "adaptive_timeouts.h"
+
+using namespace fuelflux;
+using std::chrono::milliseconds;
+
+namespace {
+
+const AdaptiveTimeouts::Limits kConnectLimits{milliseconds(1000), milliseconds(30000)};
+const AdaptiveTimeouts::Limits kTotalLimits{milliseconds(3000), milliseconds(90000)};
+
+void RecordMany(AdaptiveTimeouts& timeouts, const std::string& endpoint, std::size_t count,
+                milliseconds connect, milliseconds total) {
+    for (std::size_t i = 0; i < count; ++i) {
+        timeouts.Record(endpoint, connect, total);
+    }
+}
+
+} // namespace
+
+TEST(AdaptiveTimeoutsTest, CeilingsUntilEnoughSamples) {
+    AdaptiveTimeouts timeouts(kConnectLimits, kTotalLimits);
+    auto current = timeouts.For("/api/pump/authorize");
+    EXPECT_EQ(current.connect, milliseconds(30000));
+    EXPECT_EQ(current.total, milliseconds(90000));
+
+    RecordMany(timeouts, "/api/pump/authorize", timing::kHttpTimeoutMinSamples - 1, milliseconds(400),
+               milliseconds(2000));
+    current = timeouts.For("/api/pump/authorize");
+    EXPECT_EQ(current.connect, milliseconds(30000));
+    EXPECT_EQ(current.total, milliseconds(90000));
+}
+
+TEST(AdaptiveTimeoutsTest, DerivedFromPercentileWithinBounds) {
+    AdaptiveTimeouts timeouts(kConnectLimits, kTotalLimits);
+    RecordMany(timeouts, "/api/pump/authorize", timing::kHttpTimeoutWindow, milliseconds(1500), milliseconds(4000));
+    auto current = timeouts.For("/api/pump/authorize");
+    EXPECT_EQ(current.connect, milliseconds(1500) * timing::kHttpTimeoutMultiplier);
+    EXPECT_EQ(current.total, milliseconds(4000) * timing::kHttpTimeoutMultiplier);
+
+    // A fast LAN link is held at the floors
+    AdaptiveTimeouts fast(kConnectLimits, kTotalLimits);
+    RecordMany(fast, "/api/pump/refuel", timing::kHttpTimeoutWindow, milliseconds(2), milliseconds(20));
+    current = fast.For("/api/pump/refuel");
+    EXPECT_EQ(current.connect, milliseconds(1000));
+    EXPECT_EQ(current.total, milliseconds(3000));
+
+    // A very slow one at the ceilings
+    AdaptiveTimeouts slow(kConnectLimits, kTotalLimits);
+    RecordMany(slow, "/api/pump/refuel", timing::kHttpTimeoutWindow, milliseconds(20000), milliseconds(60000));
+    current = slow.For("/api/pump/refuel");
+    EXPECT_EQ(current.connect, milliseconds(30000));
+    EXPECT_EQ(current.total, milliseconds(90000));
+}
+
+TEST(AdaptiveTimeoutsTest, PercentileIgnoresRareOutliers) {
+    AdaptiveTimeouts timeouts(kConnectLimits, kTotalLimits);
+    RecordMany(timeouts, "/api/pump/refuel", timing::kHttpTimeoutWindow - 1, milliseconds(0), milliseconds(2000));
+    timeouts.Record("/api/pump/refuel", milliseconds(0), milliseconds(25000));
+    EXPECT_EQ(timeouts.For("/api/pump/refuel").total, milliseconds(6000));
+}
+
+TEST(AdaptiveTimeoutsTest, TotalTimesArePerEndpoint) {
+    AdaptiveTimeouts timeouts(kConnectLimits, kTotalLimits);
+    RecordMany(timeouts, "/api/pump/authorize", timing::kHttpTimeoutWindow, milliseconds(1500), milliseconds(2000));
+    RecordMany(timeouts, "/api/pump/cards", timing::kHttpTimeoutWindow, milliseconds(0), milliseconds(12000));
+
+    EXPECT_EQ(timeouts.For("/api/pump/authorize").total, milliseconds(6000));
+    EXPECT_EQ(timeouts.For("/api/pump/cards").total, milliseconds(36000));
+    // Connect times describe the link and apply to every endpoint
+    EXPECT_EQ(timeouts.For("/api/pump/cards").connect, milliseconds(4500));
+    EXPECT_EQ(timeouts.For("/api/pump/fuel-intake").connect, milliseconds(4500));
+    EXPECT_EQ(timeouts.For("/api/pump/fuel-intake").total, milliseconds(90000));
+}
+
+TEST(AdaptiveTimeoutsTest, PagesOfAListingShareTheirEndpoint) {
+    AdaptiveTimeouts timeouts(kConnectLimits, kTotalLimits);
+    for (int page = 0; page < static_cast<int>(timing::kHttpTimeoutWindow); ++page) {
+        timeouts.Record("/api/pump/cards?first=" + std::to_string(page * 50) + "&number=50", milliseconds(0),
+                        milliseconds(12000));
+    }
+    EXPECT_EQ(timeouts.For("/api/pump/cards?first=5000&number=50").total, milliseconds(36000));
+    EXPECT_EQ(timeouts.For("/api/pump/cards").total, milliseconds(36000));
+}
+
+TEST(AdaptiveTimeoutsTest, TimeoutsWidenAgainWhenTheLinkDegrades) {
+    AdaptiveTimeouts timeouts(kConnectLimits, kTotalLimits);
+    RecordMany(timeouts, "/api/pump/refuel", timing::kHttpTimeoutWindow, milliseconds(500), milliseconds(1500));
+    auto current = timeouts.For("/api/pump/refuel");
+    ASSERT_EQ(current.total, milliseconds(4500));
+
+    // Each timed out request is recorded with the timeout it hit
+    for (int i = 0; i < 6; ++i) {
+        timeouts.Record("/api/pump/refuel", current.connect, current.total);
+        current = timeouts.For("/api/pump/refuel");
+    }
+    EXPECT_EQ(current.connect, milliseconds(30000));
+    EXPECT_EQ(current.total, milliseconds(90000));
+}
@@ -4,11 +4,18 @@
 
 #include "backend.h"
 #include "backend_utils.h"
+#include "json_stream.h"
+#include "timing_config.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
+#include <future>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 using namespace fuelflux;
 
@@ -54,6 +61,81 @@ protected:
     }
 };
 
+// Listings arrive as a byte stream in small chunks, as they do from curl in Backend
+class StreamingTestBackend : public TestBackendBase {
+public:
+    using TestBackendBase::TestBackendBase;
+
+    std::string body;
+    std::size_t chunk = 5;
+    std::size_t fedBytes = 0;
+
+protected:
+    nlohmann::json HttpRequestRecords(const std::string& /*endpoint*/,
+                                      const std::string& /*method*/,
+                                      const nlohmann::json& /*requestBody*/,
+                                      bool /*useBearerToken*/,
+                                      const RecordCallback& onRecord) override {
+        JsonRecordReader reader(onRecord);
+        JsonStreamParser parser(reader);
+        for (fedBytes = 0; fedBytes < body.size(); fedBytes += chunk) {
+            if (!parser.Feed(body.data() + fedBytes, std::min(chunk, body.size() - fedBytes))) {
+                break;
+            }
+        }
+        if (reader.Stopped()) {
+            return nlohmann::json::array();
+        }
+        if (parser.Failed() || !parser.Finish()) {
+            return BuildWrapperErrorResponse();
+        }
+        return reader.Result();
+    }
+};
+
+// Network errors on demand, with a fake clock for the circuit breaker
+class FlakyTestBackend : public TestBackendBase {
+public:
+    explicit FlakyTestBackend(std::string controllerUid)
+        : TestBackendBase(std::move(controllerUid)) {
+        breaker_ = std::make_shared<CircuitBreaker>(timing::kBackendCircuitFailureThreshold,
+                                                    timing::kBackendCircuitProbeInterval,
+                                                    [this]() { return now; });
+    }
+
+    bool down = false;
+    bool probeReachable = false;
+    int requests = 0;
+    int probes = 0;
+    CircuitBreaker::Clock::time_point now{};
+
+    CircuitBreaker::State BreakerState() const { return breaker_->GetState(); }
+
+protected:
+    nlohmann::json HttpRequestWrapper(const std::string& endpoint,
+                                      const std::string& /*method*/,
+                                      const nlohmann::json& /*requestBody*/,
+                                      bool /*useBearerToken*/) override {
+        ++requests;
+        networkError_ = down;
+        if (down) {
+            return BuildWrapperErrorResponse();
+        }
+        if (endpoint == "/api/pump/authorize") {
+            return nlohmann::json{{"Token", "token-1"},
+                                  {"RoleId", static_cast<int>(UserRole::Customer)},
+                                  {"Allowance", 50.0},
+                                  {"fuelTanks", nlohmann::json::array()}};
+        }
+        return nlohmann::json(nullptr);
+    }
+
+    void ProbeBackend(std::function<void(bool reachable)> done) override {
+        ++probes;
+        done(probeReachable);
+    }
+};
+
 } // namespace
 
 TEST(BackendBaseFetchUserCardsTest, SendsExpectedRequestAndParsesValidCards) {
@@ -206,3 +288,205 @@ TEST(BackendBaseFetchFuelTanksTest, BadVolumeTypeIsHandledAsFailure) {
     EXPECT_TRUE(tanks.empty());
     EXPECT_EQ(backend.GetLastError(), StdBackendError);
 }
+
+TEST(BackendBaseStreamedListingTest, CardsAndTanksAreParsedFromChunks) {
+    StreamingTestBackend backend("controller-uid-42");
+
+    backend.body = R"([{"Uid":"100"},{"Uid":"200","RoleId":2,"Allowance":19.75},42,{"RoleId":1}])";
+    const auto cards = backend.FetchUserCards(0, 4);
+    ASSERT_EQ(cards.size(), 2u);
+    EXPECT_EQ(cards[0].uid, "100");
+    EXPECT_EQ(cards[1].uid, "200");
+    EXPECT_EQ(cards[1].roleId, 2);
+    EXPECT_DOUBLE_EQ(cards[1].allowance, 19.75);
+    EXPECT_TRUE(backend.GetLastError().empty());
+
+    backend.body = R"([{"VisualNumberTank":1,"IdTank":11,"NameTank":"Diesel","Volume":1000.5},{"IdTank":99}])";
+    const auto tanks = backend.FetchFuelTanks(0, 2);
+    ASSERT_EQ(tanks.size(), 1u);
+    EXPECT_EQ(tanks[0].idTank, 11);
+    EXPECT_EQ(tanks[0].nameTank, "Diesel");
+    EXPECT_DOUBLE_EQ(tanks[0].volume, 1000.5);
+}
+
+TEST(BackendBaseStreamedListingTest, MalformedCardStopsTheStream) {
+    StreamingTestBackend backend("controller-uid-42");
+    backend.chunk = 1;
+    backend.body = R"([{"Uid":"100"},{"Uid":"200","Allowance":"bad"},{"Uid":"300"},{"Uid":"400"}])";
+
+    const auto cards = backend.FetchUserCards(0, 4);
+
+    EXPECT_TRUE(cards.empty());
+    EXPECT_EQ(backend.GetLastError(), StdBackendError);
+    EXPECT_LT(backend.fedBytes, backend.body.find("300"));
+}
+
+TEST(BackendBaseStreamedListingTest, ErrorObjectAndBrokenBodyAreReported) {
+    StreamingTestBackend backend("controller-uid-42");
+
+    backend.body = R"({"CodeError":7,"TextError":"cards api unavailable"})";
+    EXPECT_TRUE(backend.FetchUserCards(0, 100).empty());
+    EXPECT_EQ(backend.GetLastError(), "cards api unavailable");
+
+    backend.body = R"([{"VisualNumberTank":1},{"VisualNumb)";
+    EXPECT_TRUE(backend.FetchFuelTanks(0, 100).empty());
+    EXPECT_FALSE(backend.GetLastError().empty());
+}
+
+TEST(BackendBaseAsyncTest, AuthorizeRefuelAndDeauthorizeThroughAsyncRequests) {
+    auto backend = std::make_shared<TestBackendBase>("controller-uid-42");
+    std::vector<std::string> requests;
+
+    backend->explicitTokenHandler = [&requests](const std::string& endpoint,
+                                                const std::string& method,
+                                                const nlohmann::json& body,
+                                                const std::string& bearerToken) -> nlohmann::json {
+        EXPECT_EQ(method, "POST");
+        requests.push_back(endpoint + " " + bearerToken);
+        if (endpoint == "/api/pump/authorize") {
+            EXPECT_EQ(body.value("CardUid", ""), "card-1");
+            return nlohmann::json{{"Token", "token-1"},
+                                  {"RoleId", static_cast<int>(UserRole::Customer)},
+                                  {"Allowance", 50.0},
+                                  {"fuelTanks", nlohmann::json::array({{{"idTank", 7}, {"visualNumberTank", 1}}})}};
+        }
+        if (endpoint == "/api/pump/refuel") {
+            EXPECT_EQ(body.value("TankNumber", 0), 7);
+            EXPECT_DOUBLE_EQ(body.value("FuelVolume", 0.0), 20.0);
+        }
+        return nlohmann::json(nullptr);
+    };
+
+    ASSERT_TRUE(backend->AuthorizeAsync("card-1").get());
+    EXPECT_TRUE(backend->IsAuthorized());
+    EXPECT_EQ(backend->GetToken(), "token-1");
+
+    ASSERT_TRUE(backend->RefuelAsync(1, 20.0).get());
+    EXPECT_DOUBLE_EQ(backend->GetAllowance(), 30.0);
+
+    ASSERT_TRUE(backend->DeauthorizeAsync().get());
+    EXPECT_FALSE(backend->IsAuthorized());
+
+    const std::vector<std::string> expected = {
+        "/api/pump/authorize ",
+        "/api/pump/refuel token-1",
+        "/api/pump/deauthorize token-1",
+    };
+    EXPECT_EQ(requests, expected);
+}
+
+TEST(BackendBaseAsyncTest, ValidationFailuresResolveWithoutRequest) {
+    auto backend = std::make_shared<TestBackendBase>("controller-uid-42");
+    backend->explicitTokenHandler = [](const std::string&, const std::string&, const nlohmann::json&,
+                                       const std::string&) -> nlohmann::json {
+        ADD_FAILURE() << "No request expected";
+        return nlohmann::json(nullptr);
+    };
+
+    EXPECT_FALSE(backend->RefuelAsync(1, 1.0).get());
+    EXPECT_FALSE(backend->IntakeAsync(1, 1.0, IntakeDirection::In).get());
+    EXPECT_FALSE(backend->DeauthorizeAsync().get());
+    EXPECT_EQ(backend->GetLastError(), StdControllerError);
+}
+
+TEST(BackendBaseAsyncTest, FetchUserCardsAsyncParsesCardsAndErrors) {
+    auto backend = std::make_shared<TestBackendBase>("controller-uid-42");
+    backend->explicitTokenHandler = [](const std::string& endpoint, const std::string&, const nlohmann::json&,
+                                       const std::string&) -> nlohmann::json {
+        if (endpoint == "/api/pump/cards?first=0&number=2") {
+            return nlohmann::json::array({{{"Uid", "100"}, {"RoleId", 1}}, {{"Uid", "200"}}});
+        }
+        return nlohmann::json{{"CodeError", 7}, {"TextError", "cards api unavailable"}};
+    };
+
+    auto first = backend->FetchUserCardsAsync(0, 2);
+    auto second = backend->FetchUserCardsAsync(2, 2);
+
+    const auto cards = first.get();
+    ASSERT_EQ(cards.size(), 2u);
+    EXPECT_EQ(cards[0].uid, "100");
+    EXPECT_EQ(cards[1].uid, "200");
+    EXPECT_TRUE(second.get().empty());
+    EXPECT_EQ(backend->GetLastError(), "cards api unavailable");
+}
+
+TEST(BackendBaseAsyncTest, BackendNotManagedBySharedPtrRunsSynchronously) {
+    TestBackendBase backend("controller-uid-42");
+    backend.boolTokenHandler = [](const std::string& endpoint, const std::string&, const nlohmann::json&,
+                                  bool) -> nlohmann::json {
+        EXPECT_EQ(endpoint, "/api/pump/cards?first=0&number=1");
+        return nlohmann::json::array({{{"Uid", "100"}}});
+    };
+
+    auto cards = backend.FetchUserCardsAsync(0, 1);
+    ASSERT_EQ(cards.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(cards.get().size(), 1u);
+}
+
+TEST(BackendBaseCircuitBreakerTest, OpenCircuitFailsWithoutRequest) {
+    FlakyTestBackend backend("controller-uid-42");
+    backend.down = true;
+
+    for (int i = 0; i < timing::kBackendCircuitFailureThreshold; ++i) {
+        EXPECT_FALSE(backend.Authorize("card-1"));
+        EXPECT_TRUE(backend.IsNetworkError());
+    }
+    EXPECT_EQ(backend.requests, timing::kBackendCircuitFailureThreshold);
+    ASSERT_EQ(backend.BreakerState(), CircuitBreaker::State::Open);
+
+    // Authorization fails at once as a network error, so the controller uses its cache
+    EXPECT_FALSE(backend.Authorize("card-1"));
+    EXPECT_TRUE(backend.IsNetworkError());
+    EXPECT_FALSE(backend.GetLastError().empty());
+    EXPECT_TRUE(backend.FetchUserCards(0, 10).empty());
+    EXPECT_EQ(backend.requests, timing::kBackendCircuitFailureThreshold);
+    EXPECT_EQ(backend.probes, 0);
+}
+
+TEST(BackendBaseCircuitBreakerTest, ProbeAndTrialRequestCloseTheCircuit) {
+    FlakyTestBackend backend("controller-uid-42");
+    backend.down = true;
+    for (int i = 0; i < timing::kBackendCircuitFailureThreshold; ++i) {
+        backend.Authorize("card-1");
+    }
+    ASSERT_EQ(backend.BreakerState(), CircuitBreaker::State::Open);
+    const int requests = backend.requests;
+
+    // The backend is still unreachable when the probe is due
+    backend.now += timing::kBackendCircuitProbeInterval;
+    EXPECT_FALSE(backend.Authorize("card-1"));
+    EXPECT_EQ(backend.probes, 1);
+    EXPECT_EQ(backend.requests, requests);
+
+    // Back: the probe lets the request through as the trial, which closes the circuit
+    backend.down = false;
+    backend.probeReachable = true;
+    backend.now += timing::kBackendCircuitProbeInterval;
+    EXPECT_TRUE(backend.Authorize("card-1"));
+    EXPECT_FALSE(backend.IsNetworkError());
+    EXPECT_EQ(backend.probes, 2);
+    EXPECT_EQ(backend.requests, requests + 1);
+    EXPECT_EQ(backend.BreakerState(), CircuitBreaker::State::Closed);
+}
+
+TEST(BackendBaseCircuitBreakerTest, AsyncRequestsFailWithoutRequestWhileOpen) {
+    auto backend = std::make_shared<FlakyTestBackend>("controller-uid-42");
+    backend->down = true;
+    backend->explicitTokenHandler = [backend](const std::string&, const std::string&, const nlohmann::json&,
+                                              const std::string&) {
+        ++backend->requests;
+        return BuildWrapperErrorResponse();
+    };
+    for (int i = 0; i < timing::kBackendCircuitFailureThreshold; ++i) {
+        backend->Authorize("card-1");
+    }
+    ASSERT_EQ(backend->BreakerState(), CircuitBreaker::State::Open);
+    const int requests = backend->requests;
+
+    auto authorized = backend->AuthorizeAsync("card-1");
+    ASSERT_EQ(authorized.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_FALSE(authorized.get());
+    EXPECT_TRUE(backend->IsNetworkError());
+    EXPECT_EQ(backend->requests, requests);
+    backend->explicitTokenHandler = nullptr;  // Breaks the reference cycle
+}
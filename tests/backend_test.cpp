@@ -5,6 +5,8 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "backend.h"
+#include "backlog_payload.h"
+#include "message_storage.h"
 #include <httplib.h>
 
 using namespace fuelflux;
@@ -38,6 +40,10 @@ public:
         server.Post("/api/pump/fuel-intake", [this](const httplib::Request& req, httplib::Response& res) {
             handleFuelIntake(req, res);
         });
+
+        server.Post("/api/pump/cards/changes", [this](const httplib::Request& req, httplib::Response& res) {
+            handleCardChanges(req, res);
+        });
     }
 
     void start() {
@@ -81,6 +87,7 @@ public:
     std::function<void(const httplib::Request&, httplib::Response&)> handleDeauthorize;
     std::function<void(const httplib::Request&, httplib::Response&)> handleRefuel;
     std::function<void(const httplib::Request&, httplib::Response&)> handleFuelIntake;
+    std::function<void(const httplib::Request&, httplib::Response&)> handleCardChanges;
 };
 
 class BackendTest : public ::testing::Test {
@@ -631,6 +638,74 @@ TEST_F(BackendTest, IntakeJsonParseError) {
     EXPECT_FALSE(backend.GetLastError().empty());
 }
 
+// Test that consecutive requests reuse one keep-alive connection
+TEST_F(BackendTest, ReusesConnectionAcrossRequests) {
+    std::vector<int> clientPorts;
+    std::mutex portsMutex;
+    auto recordPort = [&clientPorts, &portsMutex](const httplib::Request& req) {
+        std::lock_guard<std::mutex> lock(portsMutex);
+        clientPorts.push_back(req.remote_port);
+    };
+
+    setupSuccessfulAuthorizeResponse();
+    auto authorize = mockServer->handleAuthorize;
+    mockServer->handleAuthorize = [authorize, recordPort](const httplib::Request& req, httplib::Response& res) {
+        recordPort(req);
+        authorize(req, res);
+    };
+    mockServer->handleRefuel = [recordPort](const httplib::Request& req, httplib::Response& res) {
+        recordPort(req);
+        res.status = 200;
+        res.set_content("null", "application/json");
+    };
+
+    Backend backend(baseAPI, controllerUid);
+    ASSERT_TRUE(backend.Authorize("card-uid-12345"));
+    ASSERT_TRUE(backend.Refuel(1, 10.0));
+    ASSERT_TRUE(backend.Refuel(2, 5.0));
+
+    std::lock_guard<std::mutex> lock(portsMutex);
+    ASSERT_EQ(clientPorts.size(), 3u);
+    EXPECT_EQ(clientPorts[0], clientPorts[1]);
+    EXPECT_EQ(clientPorts[1], clientPorts[2]);
+}
+
+// Test that the static headers go with every request and the bearer token only with authorized ones
+TEST_F(BackendTest, BearerTokenIsSentOnlyWhenAuthorized) {
+    std::vector<std::pair<std::string, std::string>> headers;  // Authorization, Content-Type
+    std::mutex headersMutex;
+    auto recordHeaders = [&headers, &headersMutex](const httplib::Request& req) {
+        std::lock_guard<std::mutex> lock(headersMutex);
+        headers.emplace_back(req.get_header_value("Authorization"), req.get_header_value("Content-Type"));
+    };
+
+    setupSuccessfulAuthorizeResponse();
+    auto authorize = mockServer->handleAuthorize;
+    mockServer->handleAuthorize = [authorize, recordHeaders](const httplib::Request& req, httplib::Response& res) {
+        recordHeaders(req);
+        authorize(req, res);
+    };
+    mockServer->handleRefuel = [recordHeaders](const httplib::Request& req, httplib::Response& res) {
+        recordHeaders(req);
+        res.status = 200;
+        res.set_content("null", "application/json");
+    };
+
+    Backend backend(baseAPI, controllerUid);
+    ASSERT_TRUE(backend.Authorize("card-uid-12345"));
+    ASSERT_TRUE(backend.Refuel(1, 10.0));
+    ASSERT_TRUE(backend.Refuel(2, 5.0));
+
+    std::lock_guard<std::mutex> lock(headersMutex);
+    ASSERT_EQ(headers.size(), 3u);
+    EXPECT_EQ(headers[0].first, "");
+    EXPECT_EQ(headers[1].first, "Bearer test-token-12345");
+    EXPECT_EQ(headers[2].first, "Bearer test-token-12345");
+    for (const auto& [authorization, contentType] : headers) {
+        EXPECT_EQ(contentType, "application/json");
+    }
+}
+
 // Test that RefuelPayload maps visualNumberTank -> idTank in stored payload
 TEST_F(BackendTest, RefuelPayloadMapsVisualNumberToId) {
     mockServer->handleAuthorize = [](const httplib::Request& req [[maybe_unused]], httplib::Response& res) {
@@ -670,6 +745,58 @@ TEST_F(BackendTest, RefuelPayloadMapsVisualNumberToId) {
     EXPECT_TRUE(backend.RefuelPayload(storedPayload.dump()));
 }
 
+// Test that a refueling report kept in the backlog is stored binary and replayed as JSON
+TEST_F(BackendTest, BackloggedRefuelIsStoredBinaryAndReplayed) {
+    mockServer->handleAuthorize = [](const httplib::Request& req [[maybe_unused]], httplib::Response& res) {
+        nlohmann::json response;
+        response["Token"] = "test-token-12345";
+        response["RoleId"] = 1;
+        response["Allowance"] = 200.0;
+        response["Price"] = 45.5;
+        response["fuelTanks"] = nlohmann::json::array();
+        response["fuelTanks"].push_back(
+            {{"idTank", 44},
+             {"visualNumberTank", 7},
+             {"nameTank", "АИ-95"},
+             {"isCheckEnoughFuel", 1},
+             {"allowanceTank", "150.0"}});
+
+        res.status = 200;
+        res.set_content(response.dump(), "application/json");
+    };
+
+    bool serverDown = true;
+    nlohmann::json received;
+    mockServer->handleRefuel = [&serverDown, &received](const httplib::Request& req, httplib::Response& res) {
+        if (serverDown) {
+            res.status = 503;
+            return;
+        }
+        received = nlohmann::json::parse(req.body);
+        res.status = 200;
+        res.set_content("null", "application/json");
+    };
+
+    auto storage = std::make_shared<MessageStorage>(":memory:");
+    Backend backend(baseAPI, controllerUid, storage);
+    ASSERT_TRUE(backend.Authorize("card-uid-12345"));
+    EXPECT_FALSE(backend.Refuel(7, 25.5));
+
+    const auto stored = storage->GetNextBacklog();
+    ASSERT_TRUE(stored.has_value());
+    ASSERT_FALSE(stored->data.empty());
+    EXPECT_EQ(static_cast<std::uint8_t>(stored->data[0]), kBacklogPayloadMsgpackV1);
+    const auto decoded = DecodeBacklogPayload(stored->data);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->value("TankNumber", -1), 44);
+    EXPECT_LT(stored->data.size(), decoded->dump().size());
+
+    serverDown = false;
+    EXPECT_TRUE(backend.RefuelPayload(stored->data));
+    EXPECT_EQ(received.value("FuelVolume", 0.0), 25.5);
+    EXPECT_EQ(received.value("TimeAt", 0LL), decoded->value("TimeAt", -1LL));
+}
+
 // Test that IntakePayload maps visualNumberTank -> idTank in stored payload
 TEST_F(BackendTest, IntakePayloadMapsVisualNumberToId) {
     mockServer->handleAuthorize = [](const httplib::Request& req [[maybe_unused]], httplib::Response& res) {
@@ -709,3 +836,46 @@ TEST_F(BackendTest, IntakePayloadMapsVisualNumberToId) {
     storedPayload["TimeAt"] = 1234567890000LL;
     EXPECT_TRUE(backend.IntakePayload(storedPayload.dump()));
 }
+
+// Test that card changes are requested with the watermark and parsed into a delta
+TEST_F(BackendTest, FetchUserCardChangesParsesDelta) {
+    mockServer->handleCardChanges = [](const httplib::Request& req, httplib::Response& res) {
+        const auto body = nlohmann::json::parse(req.body);
+        EXPECT_EQ(body.value("Since", ""), "2026-01-01T00:00:00Z");
+        EXPECT_EQ(req.get_param_value("number"), "50");
+
+        nlohmann::json response;
+        response["Cards"] = nlohmann::json::array();
+        response["Cards"].push_back({{"Uid", "card-1"}, {"RoleId", 1}, {"Allowance", 12.5}});
+        response["Cards"].push_back({{"RoleId", 1}});
+        response["Deleted"] = {"card-2", "card-3"};
+        response["Watermark"] = "wm-2";
+        response["Truncated"] = false;
+
+        res.status = 200;
+        res.set_content(response.dump(), "application/json");
+    };
+
+    Backend backend(baseAPI, controllerUid);
+    auto delta = backend.FetchUserCardChanges("2026-01-01T00:00:00Z", 50);
+
+    ASSERT_TRUE(delta.has_value());
+    ASSERT_EQ(delta->upserts.size(), 1u);
+    EXPECT_EQ(delta->upserts[0].uid, "card-1");
+    EXPECT_DOUBLE_EQ(delta->upserts[0].allowance, 12.5);
+    EXPECT_EQ(delta->deletedUids, (std::vector<std::string>{"card-2", "card-3"}));
+    EXPECT_EQ(delta->watermark, "wm-2");
+    EXPECT_FALSE(delta->truncated);
+}
+
+// Test that a server without delta support makes the caller fall back to a full sync
+TEST_F(BackendTest, FetchUserCardChangesUnavailable) {
+    mockServer->handleCardChanges = [](const httplib::Request& req [[maybe_unused]], httplib::Response& res) {
+        res.status = 404;
+        res.set_content("Not Found", "text/plain");
+    };
+
+    Backend backend(baseAPI, controllerUid);
+    EXPECT_FALSE(backend.FetchUserCardChanges("2026-01-01T00:00:00Z", 50).has_value());
+    EXPECT_FALSE(backend.GetLastError().empty());
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "backlog_payload.h"
+#include <gtest/gtest.h>
+
+using namespace fuelflux;
+
+namespace {
+
+nlohmann::json MakeRefuelBody() {
+    nlohmann::json body;
+    body["TankNumber"] = 7;
+    body["FuelVolume"] = 25.5;
+    body["TimeAt"] = 1767225600123LL;
+    return body;
+}
+
+} // namespace
+
+TEST(BacklogPayloadTest, EncodesCompactBinaryAndReplaysWireBody) {
+    const auto body = MakeRefuelBody();
+    const std::string payload = EncodeBacklogPayload(body);
+
+    ASSERT_FALSE(payload.empty());
+    EXPECT_EQ(static_cast<std::uint8_t>(payload[0]), kBacklogPayloadMsgpackV1);
+    EXPECT_LT(payload.size(), body.dump().size());
+
+    EXPECT_EQ(DecodeBacklogPayload(payload), std::optional<nlohmann::json>(body));
+    EXPECT_EQ(BacklogPayloadToWireBody(payload), std::optional<std::string>(body.dump()));
+}
+
+TEST(BacklogPayloadTest, LegacyTextPayloadsStillLoad) {
+    const std::string legacy = " {\"TankNumber\": 3, \"IntakeVolume\": 100.0, \"Direction\": 1, \"Name\": \"ДТ \\\"x\\\"\"}";
+    const auto expected = nlohmann::json::parse(legacy);
+
+    EXPECT_EQ(DecodeBacklogPayload(legacy), std::optional<nlohmann::json>(expected));
+    // Streaming keeps the stored key order and drops the whitespace
+    const auto wire = BacklogPayloadToWireBody(legacy);
+    ASSERT_TRUE(wire.has_value());
+    EXPECT_EQ(wire->find(' '), wire->find("ДТ") + 4);
+    EXPECT_EQ(nlohmann::json::parse(*wire), expected);
+}
+
+TEST(BacklogPayloadTest, MapsTopLevelTankNumberOnly) {
+    nlohmann::json body = MakeRefuelBody();
+    body["Nested"] = {{"TankNumber", 7}, {"List", {1, 2, nullptr, true, "s"}}};
+    const auto mapper = [](std::int64_t tankNumber) -> std::optional<std::int64_t> {
+        if (tankNumber == 7) {
+            return 44;
+        }
+        return std::nullopt;
+    };
+
+    nlohmann::json expected = body;
+    expected["TankNumber"] = 44;
+    EXPECT_EQ(BacklogPayloadToWireBody(EncodeBacklogPayload(body), mapper), std::optional<std::string>(expected.dump()));
+
+    // Unknown tank numbers are kept
+    body["TankNumber"] = 8;
+    EXPECT_EQ(BacklogPayloadToWireBody(body.dump(), mapper), std::optional<std::string>(body.dump()));
+}
+
+TEST(BacklogPayloadTest, RejectsCorruptAndUnknownPayloads) {
+    const std::string payload = EncodeBacklogPayload(MakeRefuelBody());
+
+    EXPECT_FALSE(BacklogPayloadToWireBody(payload.substr(0, payload.size() - 3)).has_value());
+    EXPECT_FALSE(DecodeBacklogPayload(payload.substr(0, payload.size() - 3)).has_value());
+
+    std::string future = payload;
+    future[0] = 0x02;
+    EXPECT_FALSE(BacklogPayloadToWireBody(future).has_value());
+    EXPECT_FALSE(DecodeBacklogPayload(future).has_value());
+
+    EXPECT_FALSE(BacklogPayloadToWireBody("").has_value());
+    EXPECT_FALSE(BacklogPayloadToWireBody("{\"TankNumber\":").has_value());
+}
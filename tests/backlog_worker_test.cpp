@@ -6,8 +6,13 @@
 #include <gmock/gmock.h>
 
 #include "backlog_worker.h"
+#include "connectivity_signal.h"
 #include "message_storage.h"
 
+#include <map>
+#include <mutex>
+#include <thread>
+
 using namespace fuelflux;
 using ::testing::Return;
 using ::testing::StrictMock;
@@ -77,3 +82,181 @@ TEST(BacklogWorkerTest, MovesToDeadOnNonNetworkError) {
     EXPECT_EQ(storage->BacklogCount(), 0);
     EXPECT_EQ(storage->DeadMessageCount(), 1);
 }
+
+TEST(BacklogWorkerTest, SendsAllMessagesOfUserInOneSession) {
+    auto storage = std::make_shared<MessageStorage>(":memory:");
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Refuel, "{\"TankNumber\":1}"));
+    ASSERT_TRUE(storage->AddBacklog("uid-2", MessageMethod::Refuel, "{\"TankNumber\":2}"));
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Intake, "{\"TankNumber\":3}"));
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Refuel, "{\"TankNumber\":4}"));
+
+    auto backend = std::make_shared<StrictMock<MockBackendForBacklog>>();
+    {
+        ::testing::InSequence sequence;
+        EXPECT_CALL(*backend, Authorize("uid-1")).WillOnce(Return(true));
+        EXPECT_CALL(*backend, RefuelPayload("{\"TankNumber\":1}")).WillOnce(Return(true));
+        EXPECT_CALL(*backend, IntakePayload("{\"TankNumber\":3}")).WillOnce(Return(true));
+        EXPECT_CALL(*backend, RefuelPayload("{\"TankNumber\":4}")).WillOnce(Return(true));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+        EXPECT_CALL(*backend, Authorize("uid-2")).WillOnce(Return(true));
+        EXPECT_CALL(*backend, RefuelPayload("{\"TankNumber\":2}")).WillOnce(Return(true));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+    }
+
+    BacklogWorker worker(storage, backend, std::chrono::milliseconds(1));
+    EXPECT_TRUE(worker.ProcessOnce());
+    EXPECT_EQ(storage->BacklogCount(), 1);
+    EXPECT_TRUE(worker.ProcessOnce());
+    EXPECT_EQ(storage->BacklogCount(), 0);
+    EXPECT_FALSE(worker.ProcessOnce());
+
+    const auto stats = worker.GetDrainStats();
+    EXPECT_EQ(stats.sessions, 2u);
+    EXPECT_EQ(stats.delivered, 4u);
+    EXPECT_EQ(stats.deadLettered, 0u);
+    EXPECT_GE(stats.MessagesPerMinute(), 0.0);
+}
+
+TEST(BacklogWorkerTest, NetworkErrorMidSessionKeepsRemainingMessages) {
+    auto storage = std::make_shared<MessageStorage>(":memory:");
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Refuel, "{\"TankNumber\":1}"));
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Refuel, "{\"TankNumber\":2}"));
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Refuel, "{\"TankNumber\":3}"));
+
+    auto backend = std::make_shared<StrictMock<MockBackendForBacklog>>();
+    EXPECT_CALL(*backend, Authorize("uid-1")).WillOnce(Return(true));
+    EXPECT_CALL(*backend, RefuelPayload("{\"TankNumber\":1}")).WillOnce(Return(true));
+    EXPECT_CALL(*backend, RefuelPayload("{\"TankNumber\":2}")).WillOnce(Return(false));
+    EXPECT_CALL(*backend, IsNetworkError()).WillOnce(Return(true));
+    EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+
+    BacklogWorker worker(storage, backend, std::chrono::milliseconds(1));
+    EXPECT_FALSE(worker.ProcessOnce());
+    EXPECT_EQ(storage->BacklogCount(), 2);
+    EXPECT_EQ(storage->DeadMessageCount(), 0);
+
+    auto next = storage->GetNextBacklog();
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->data, "{\"TankNumber\":2}");
+    EXPECT_EQ(worker.GetDrainStats().delivered, 1u);
+}
+
+TEST(BacklogWorkerTest, ParallelSessionsKeepPerUserOrder) {
+    auto storage = std::make_shared<MessageStorage>(":memory:");
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(storage->AddBacklog("uid-a", MessageMethod::Refuel, "a" + std::to_string(i)));
+        ASSERT_TRUE(storage->AddBacklog("uid-b", MessageMethod::Refuel, "b" + std::to_string(i)));
+    }
+    ASSERT_TRUE(storage->AddBacklog("uid-c", MessageMethod::Intake, "c0"));
+
+    std::vector<std::shared_ptr<IBackend>> backends;
+    std::mutex sentMutex;
+    std::map<std::string, std::vector<std::string>> sent;
+    for (int i = 0; i < 3; ++i) {
+        auto backend = std::make_shared<::testing::NiceMock<MockBackendForBacklog>>();
+        auto currentUid = std::make_shared<std::string>();
+        ON_CALL(*backend, Authorize(::testing::_)).WillByDefault([currentUid](const std::string& uid) {
+            *currentUid = uid;
+            return true;
+        });
+        auto record = [currentUid, &sentMutex, &sent](const std::string& payload) {
+            std::lock_guard<std::mutex> lock(sentMutex);
+            sent[*currentUid].push_back(payload);
+            return true;
+        };
+        ON_CALL(*backend, RefuelPayload(::testing::_)).WillByDefault(record);
+        ON_CALL(*backend, IntakePayload(::testing::_)).WillByDefault(record);
+        ON_CALL(*backend, Deauthorize()).WillByDefault(Return(true));
+        backends.push_back(backend);
+    }
+
+    BacklogWorker worker(storage, backends, std::chrono::milliseconds(1));
+    EXPECT_TRUE(worker.ProcessOnce());
+    EXPECT_EQ(storage->BacklogCount(), 0);
+
+    EXPECT_EQ(sent["uid-a"], (std::vector<std::string>{"a0", "a1", "a2", "a3"}));
+    EXPECT_EQ(sent["uid-b"], (std::vector<std::string>{"b0", "b1", "b2", "b3"}));
+    EXPECT_EQ(sent["uid-c"], (std::vector<std::string>{"c0"}));
+    EXPECT_EQ(worker.GetDrainStats().sessions, 3u);
+    EXPECT_EQ(worker.GetDrainStats().delivered, 9u);
+}
+
+TEST(BacklogWorkerTest, NetworkErrorStopsAllParallelSessions) {
+    auto storage = std::make_shared<MessageStorage>(":memory:");
+    ASSERT_TRUE(storage->AddBacklog("uid-a", MessageMethod::Refuel, "a0"));
+    ASSERT_TRUE(storage->AddBacklog("uid-b", MessageMethod::Refuel, "b0"));
+
+    auto first = std::make_shared<::testing::NiceMock<MockBackendForBacklog>>();
+    auto second = std::make_shared<::testing::NiceMock<MockBackendForBacklog>>();
+    for (const auto& backend : {first, second}) {
+        ON_CALL(*backend, Authorize(::testing::_)).WillByDefault(Return(false));
+        ON_CALL(*backend, IsNetworkError()).WillByDefault(Return(true));
+    }
+
+    BacklogWorker worker(storage, std::vector<std::shared_ptr<IBackend>>{first, second}, std::chrono::milliseconds(1));
+    EXPECT_FALSE(worker.ProcessOnce());
+    EXPECT_EQ(storage->BacklogCount(), 2);
+    EXPECT_EQ(storage->DeadMessageCount(), 0);
+}
+
+TEST(BacklogWorkerTest, BackoffDelayGrowsExponentiallyWithJitter) {
+    using std::chrono::milliseconds;
+    const milliseconds base = timing::kBacklogBackoffBase;
+    const milliseconds cap = timing::kBacklogBackoffMax;
+
+    EXPECT_EQ(BacklogWorker::BackoffDelay(1, 1.0), base);
+    EXPECT_EQ(BacklogWorker::BackoffDelay(1, 0.0), base / 2);
+    EXPECT_EQ(BacklogWorker::BackoffDelay(3, 1.0), base * 4);
+    EXPECT_EQ(BacklogWorker::BackoffDelay(100, 1.0), cap);
+    EXPECT_EQ(BacklogWorker::BackoffDelay(100, 0.0), cap / 2);
+    const auto jittered = BacklogWorker::BackoffDelay(2, 0.5);
+    EXPECT_GT(jittered, base);
+    EXPECT_LT(jittered, base * 2);
+}
+
+TEST(BacklogWorkerTest, NetworkErrorDefersBacklog) {
+    auto storage = std::make_shared<MessageStorage>(":memory:");
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Refuel, "a"));
+
+    auto backend = std::make_shared<StrictMock<MockBackendForBacklog>>();
+    EXPECT_CALL(*backend, Authorize("uid-1")).WillOnce(Return(false));
+    EXPECT_CALL(*backend, IsNetworkError()).WillOnce(Return(true));
+
+    BacklogWorker worker(storage, backend, std::chrono::milliseconds(1));
+    EXPECT_FALSE(worker.ProcessOnce());
+    auto nextAttempt = storage->GetNextBacklogAttemptAt();
+    ASSERT_TRUE(nextAttempt.has_value());
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    EXPECT_GT(*nextAttempt, now);
+
+    // Not due yet: the backend is not contacted again
+    EXPECT_FALSE(worker.ProcessOnce());
+    EXPECT_EQ(storage->BacklogCount(), 1);
+}
+
+TEST(BacklogWorkerTest, ConnectivityRestoredWakesWorker) {
+    auto storage = std::make_shared<MessageStorage>(":memory:");
+    auto backend = std::make_shared<::testing::NiceMock<MockBackendForBacklog>>();
+    ON_CALL(*backend, Authorize(::testing::_)).WillByDefault(Return(true));
+    ON_CALL(*backend, RefuelPayload(::testing::_)).WillByDefault(Return(true));
+
+    BacklogWorker worker(storage, backend, std::chrono::hours(1));
+    worker.Start();
+    // Let the worker go idle on the empty backlog, then queue a message as if it was backed off
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_TRUE(storage->AddBacklog("uid-1", MessageMethod::Refuel, "a"));
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    ASSERT_TRUE(storage->DeferBacklog(now, [](int) { return std::chrono::hours(1); }));
+
+    ConnectivitySignal::Instance().ReportNetworkError();
+    ConnectivitySignal::Instance().ReportSuccess();
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (storage->BacklogCount() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    worker.Stop();
+    EXPECT_EQ(storage->BacklogCount(), 0);
+}
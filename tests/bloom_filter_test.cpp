@@ -0,0 +1,74 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "bloom_filter.h"
+
+using namespace fuelflux;
+
+namespace {
+
+std::string MakeTempPath() {
+    return (std::filesystem::temp_directory_path() /
+            ("fuelflux_bloom_test-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+             "-" + ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".bloom")).string();
+}
+
+} // namespace
+
+TEST(BloomFilterTest, NoFalseNegatives) {
+    BloomFilter filter(1000, 0.01);
+    for (int i = 0; i < 1000; ++i) {
+        filter.Add("card-" + std::to_string(i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(filter.MightContain("card-" + std::to_string(i)));
+    }
+}
+
+TEST(BloomFilterTest, FalsePositiveRateNearTarget) {
+    BloomFilter filter(1000, 0.01);
+    for (int i = 0; i < 1000; ++i) {
+        filter.Add("card-" + std::to_string(i));
+    }
+
+    int falsePositives = 0;
+    constexpr int kProbes = 20000;
+    for (int i = 0; i < kProbes; ++i) {
+        falsePositives += filter.MightContain("foreign-" + std::to_string(i)) ? 1 : 0;
+    }
+    const double observed = static_cast<double>(falsePositives) / kProbes;
+    EXPECT_LT(observed, 0.03);
+    EXPECT_GT(filter.EstimatedFalsePositiveRate(), 0.0);
+    EXPECT_LT(filter.EstimatedFalsePositiveRate(), 0.03);
+}
+
+TEST(BloomFilterTest, SaveAndLoad) {
+    const std::string path = MakeTempPath();
+    BloomFilter filter(100, 0.01);
+    filter.Add("04A1B2C3");
+    ASSERT_TRUE(filter.Save(path, 7));
+
+    // A filter written for another generation of the data is stale
+    EXPECT_EQ(BloomFilter::Load(path, 6), nullptr);
+    auto loaded = BloomFilter::Load(path, 7);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->BitCount(), filter.BitCount());
+    EXPECT_EQ(loaded->HashCount(), filter.HashCount());
+    EXPECT_TRUE(loaded->MightContain("04A1B2C3"));
+
+    // Corrupt one filter word
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(40);
+        file.put('\x5A');
+    }
+    EXPECT_EQ(BloomFilter::Load(path, 7), nullptr);
+    EXPECT_EQ(BloomFilter::Load(path + ".missing", 7), nullptr);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "bounded_queue.h"
+
+using namespace fuelflux;
+
+TEST(BoundedQueueTest, DeliversItemsInOrder) {
+    BoundedQueue<int> queue(4);
+    std::vector<int> received;
+
+    std::thread consumer([&queue, &received]() {
+        while (auto item = queue.Pop()) {
+            received.push_back(*item);
+        }
+    });
+
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_TRUE(queue.Push(i));
+    }
+    queue.Close();
+    consumer.join();
+
+    ASSERT_EQ(received.size(), 20u);
+    for (int i = 0; i < 20; ++i) {
+        EXPECT_EQ(received[i], i);
+    }
+}
+
+TEST(BoundedQueueTest, PushBlocksWhileFull) {
+    BoundedQueue<int> queue(1);
+    ASSERT_TRUE(queue.Push(1));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&queue, &pushed]() {
+        EXPECT_TRUE(queue.Push(2));
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed.load());
+    EXPECT_EQ(queue.Size(), 1u);
+
+    EXPECT_EQ(queue.Pop().value_or(-1), 1);
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+    EXPECT_EQ(queue.Pop().value_or(-1), 2);
+}
+
+TEST(BoundedQueueTest, CloseDrainsAndRejects) {
+    BoundedQueue<int> queue(2);
+    ASSERT_TRUE(queue.Push(1));
+    queue.Close();
+
+    EXPECT_TRUE(queue.IsClosed());
+    EXPECT_FALSE(queue.Push(2));
+    EXPECT_EQ(queue.Pop().value_or(-1), 1);
+    EXPECT_FALSE(queue.Pop().has_value());
+}
+
+TEST(BoundedQueueTest, CloseWakesBlockedProducer) {
+    BoundedQueue<int> queue(1);
+    ASSERT_TRUE(queue.Push(1));
+
+    std::atomic<bool> result{true};
+    std::thread producer([&queue, &result]() {
+        result = queue.Push(2);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Close();
+    producer.join();
+    EXPECT_FALSE(result.load());
+}
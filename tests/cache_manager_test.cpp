@@ -3,12 +3,14 @@
 // This file is a part of fuelflux application
 
 #include "cache_manager.h"
+#include "user_cache_snapshot.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include <chrono>
 #include <filesystem>
+#include <optional>
 #include <random>
 #include <sstream>
 #include <thread>
@@ -16,6 +18,8 @@
 using namespace fuelflux;
 using ::testing::_;
 using ::testing::InSequence;
+using ::testing::Not;
+using ::testing::IsEmpty;
 using ::testing::Invoke;
 using ::testing::Return;
 
@@ -40,6 +44,7 @@ public:
     MOCK_METHOD(std::vector<UserCard>, FetchUserCards, (int first, int number), (override));
     MOCK_METHOD(std::vector<FuelTank>, FetchFuelTanks, (int first, int number), (override));
     MOCK_METHOD((const std::string&), GetControllerUid, (), (const, override));
+    MOCK_METHOD(std::optional<UserCardDelta>, FetchUserCardChanges, (const std::string& since, int number), (override));
 };
 
 std::string MakeTempDbPath() {
@@ -78,8 +83,11 @@ protected:
     }
 
     void TearDown() override {
-        if (std::filesystem::exists(dbPath_)) {
-            std::filesystem::remove(dbPath_);
+        for (const auto& suffix : {"", "-wal", "-shm", ".bloom", ".snap", ".snap.overlay"}) {
+            const std::string path = dbPath_ + suffix;
+            if (std::filesystem::exists(path)) {
+                std::filesystem::remove(path);
+            }
         }
     }
 
@@ -312,3 +320,170 @@ TEST_F(CacheManagerTest, NullDependenciesCauseFailedPopulation) {
     EXPECT_FALSE(noCache.GetLastPopulationSuccess());
     noCache.Stop();
 }
+
+TEST_F(CacheManagerTest, DeltaSyncAppliesChangesInPlace) {
+    auto cache = std::make_shared<UserCache>(dbPath_);
+    auto backend = std::make_shared<MockBackend>();
+
+    std::vector<UserCard> initial = {{"uid-keep", 1, 100.0}, {"uid-change", 1, 50.0}, {"uid-remove", 2, 0.0}};
+    std::vector<FuelTank> tanks = {{21, 1, "Tank-A", 1000.0}};
+    std::vector<FuelTank> refreshedTanks = {{21, 1, "Tank-A", 1000.0}, {22, 2, "Tank-B", 2000.0}};
+
+    UserCardDelta delta;
+    delta.upserts = {{"uid-change", 1, 75.0}, {"uid-new", 2, 10.0}};
+    delta.deletedUids = {"uid-remove"};
+    delta.watermark = "server-watermark-1";
+
+    std::string controllerUid = "test-controller-uid";
+
+    {
+        InSequence seq;
+        // First population has no watermark and rebuilds the whole cache
+        EXPECT_CALL(*backend, GetControllerUid()).WillOnce(testing::ReturnRef(controllerUid));
+        EXPECT_CALL(*backend, Authorize(controllerUid)).WillOnce(Return(true));
+        EXPECT_CALL(*backend, GetRoleId()).WillOnce(Return(3));
+        EXPECT_CALL(*backend, FetchUserCards(0, 100)).WillOnce(Return(initial));
+        EXPECT_CALL(*backend, FetchFuelTanks(0, 100)).WillOnce(Return(tanks));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+
+        // Second population only downloads the changes
+        EXPECT_CALL(*backend, GetControllerUid()).WillOnce(testing::ReturnRef(controllerUid));
+        EXPECT_CALL(*backend, Authorize(controllerUid)).WillOnce(Return(true));
+        EXPECT_CALL(*backend, GetRoleId()).WillOnce(Return(3));
+        EXPECT_CALL(*backend, FetchUserCardChanges(Not(IsEmpty()), 1000)).WillOnce(Return(delta));
+        EXPECT_CALL(*backend, FetchFuelTanks(0, 100)).WillOnce(Return(refreshedTanks));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+    }
+
+    CacheManager manager(cache, backend);
+
+    EXPECT_TRUE(manager.Start());
+    ASSERT_TRUE(WaitForPopulation(manager, std::chrono::system_clock::time_point::min()));
+    ASSERT_TRUE(cache->GetSyncWatermark().has_value());
+
+    auto firstDone = manager.GetLastPopulationTime();
+    manager.TriggerPopulation();
+    ASSERT_TRUE(WaitForPopulation(manager, firstDone));
+
+    EXPECT_TRUE(manager.GetLastPopulationSuccess());
+    EXPECT_EQ(cache->GetCount(), 3);
+    EXPECT_EQ(cache->GetTankCount(), 2);
+    EXPECT_FALSE(cache->GetEntry("uid-remove").has_value());
+    ASSERT_TRUE(cache->GetEntry("uid-keep").has_value());
+    EXPECT_DOUBLE_EQ(cache->GetEntry("uid-change")->allowance, 75.0);
+    EXPECT_EQ(cache->GetEntry("uid-new")->roleId, 2);
+    EXPECT_EQ(cache->GetSyncWatermark().value_or(""), "server-watermark-1");
+
+    manager.Stop();
+}
+
+TEST_F(CacheManagerTest, SnapshotCacheTakesPopulationAndDelta) {
+    auto cache = std::make_shared<MappedUserCache>(dbPath_ + ".snap");
+    auto backend = std::make_shared<MockBackend>();
+
+    std::vector<UserCard> initial = {{"uid-keep", 1, 100.0}, {"uid-change", 1, 50.0}, {"uid-remove", 2, 0.0}};
+    std::vector<FuelTank> tanks = {{21, 1, "Tank-A", 1000.0}};
+    std::vector<FuelTank> refreshedTanks = {{21, 1, "Tank-A", 1000.0}, {22, 2, "Tank-B", 2000.0}};
+
+    UserCardDelta delta;
+    delta.upserts = {{"uid-change", 1, 75.0}, {"uid-new", 2, 10.0}};
+    delta.deletedUids = {"uid-remove"};
+    delta.watermark = "server-watermark-1";
+
+    std::string controllerUid = "test-controller-uid";
+
+    {
+        InSequence seq;
+        // First population has no watermark and rebuilds the whole cache
+        EXPECT_CALL(*backend, GetControllerUid()).WillOnce(testing::ReturnRef(controllerUid));
+        EXPECT_CALL(*backend, Authorize(controllerUid)).WillOnce(Return(true));
+        EXPECT_CALL(*backend, GetRoleId()).WillOnce(Return(3));
+        EXPECT_CALL(*backend, FetchUserCards(0, 100)).WillOnce(Return(initial));
+        EXPECT_CALL(*backend, FetchFuelTanks(0, 100)).WillOnce(Return(tanks));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+
+        // Second population only downloads the changes
+        EXPECT_CALL(*backend, GetControllerUid()).WillOnce(testing::ReturnRef(controllerUid));
+        EXPECT_CALL(*backend, Authorize(controllerUid)).WillOnce(Return(true));
+        EXPECT_CALL(*backend, GetRoleId()).WillOnce(Return(3));
+        EXPECT_CALL(*backend, FetchUserCardChanges(Not(IsEmpty()), 1000)).WillOnce(Return(delta));
+        EXPECT_CALL(*backend, FetchFuelTanks(0, 100)).WillOnce(Return(refreshedTanks));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+    }
+
+    CacheManager manager(cache, backend);
+
+    EXPECT_TRUE(manager.Start());
+    ASSERT_TRUE(WaitForPopulation(manager, std::chrono::system_clock::time_point::min()));
+    ASSERT_TRUE(cache->GetSyncWatermark().has_value());
+
+    auto firstDone = manager.GetLastPopulationTime();
+    manager.TriggerPopulation();
+    ASSERT_TRUE(WaitForPopulation(manager, firstDone));
+
+    EXPECT_TRUE(manager.GetLastPopulationSuccess());
+    EXPECT_EQ(cache->GetCount(), 3);
+    EXPECT_EQ(cache->GetTankCount(), 2);
+    EXPECT_FALSE(cache->GetEntry("uid-remove").has_value());
+    ASSERT_TRUE(cache->GetEntry("uid-keep").has_value());
+    EXPECT_DOUBLE_EQ(cache->GetEntry("uid-change")->allowance, 75.0);
+    EXPECT_EQ(cache->GetEntry("uid-new")->roleId, 2);
+    EXPECT_EQ(cache->GetSyncWatermark().value_or(""), "server-watermark-1");
+
+    manager.Stop();
+
+    // Tanks and watermark come back with the snapshot
+    MappedUserCache reopened(dbPath_ + ".snap");
+    EXPECT_EQ(reopened.GetCount(), 3);
+    EXPECT_EQ(reopened.GetTankCount(), 2);
+    EXPECT_EQ(reopened.GetSyncWatermark().value_or(""), "server-watermark-1");
+}
+
+TEST_F(CacheManagerTest, TruncatedDeltaFallsBackToFullRebuild) {
+    auto cache = std::make_shared<UserCache>(dbPath_);
+    auto backend = std::make_shared<MockBackend>();
+
+    std::vector<UserCard> initial = {{"uid-initial", 1, 100.0}};
+    std::vector<UserCard> refreshed = {{"uid-refreshed", 2, 42.5}};
+    std::vector<FuelTank> tanks = {{21, 1, "Tank-A", 1000.0}};
+
+    UserCardDelta delta;
+    delta.upserts = {{"uid-partial", 1, 1.0}};
+    delta.truncated = true;
+
+    std::string controllerUid = "test-controller-uid";
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*backend, GetControllerUid()).WillOnce(testing::ReturnRef(controllerUid));
+        EXPECT_CALL(*backend, Authorize(controllerUid)).WillOnce(Return(true));
+        EXPECT_CALL(*backend, GetRoleId()).WillOnce(Return(3));
+        EXPECT_CALL(*backend, FetchUserCards(0, 100)).WillOnce(Return(initial));
+        EXPECT_CALL(*backend, FetchFuelTanks(0, 100)).WillOnce(Return(tanks));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+
+        EXPECT_CALL(*backend, GetControllerUid()).WillOnce(testing::ReturnRef(controllerUid));
+        EXPECT_CALL(*backend, Authorize(controllerUid)).WillOnce(Return(true));
+        EXPECT_CALL(*backend, GetRoleId()).WillOnce(Return(3));
+        EXPECT_CALL(*backend, FetchUserCardChanges(_, 1000)).WillOnce(Return(delta));
+        EXPECT_CALL(*backend, FetchUserCards(0, 100)).WillOnce(Return(refreshed));
+        EXPECT_CALL(*backend, FetchFuelTanks(0, 100)).WillOnce(Return(tanks));
+        EXPECT_CALL(*backend, Deauthorize()).WillOnce(Return(true));
+    }
+
+    CacheManager manager(cache, backend);
+
+    EXPECT_TRUE(manager.Start());
+    ASSERT_TRUE(WaitForPopulation(manager, std::chrono::system_clock::time_point::min()));
+
+    auto firstDone = manager.GetLastPopulationTime();
+    manager.TriggerPopulation();
+    ASSERT_TRUE(WaitForPopulation(manager, firstDone));
+
+    EXPECT_TRUE(manager.GetLastPopulationSuccess());
+    EXPECT_EQ(cache->GetCount(), 1);
+    EXPECT_FALSE(cache->GetEntry("uid-partial").has_value());
+    EXPECT_TRUE(cache->GetEntry("uid-refreshed").has_value());
+
+    manager.Stop();
+}
@@ -0,0 +1,64 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include <gtest/gtest.h>
+#include <unordered_set>
+#include "card_uid.h"
+
+using namespace fuelflux;
+
+TEST(CardUidTest, FromBytesAcceptsIso14443Sizes) {
+    const std::uint8_t bytes[] = {0x04, 0xA1, 0xB2, 0x5A, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+    for (std::size_t size : {4u, 7u, 10u}) {
+        const auto uid = CardUid::FromBytes(bytes, size);
+        ASSERT_TRUE(uid.has_value());
+        EXPECT_EQ(uid->size(), size);
+    }
+    EXPECT_FALSE(CardUid::FromBytes(bytes, 0).has_value());
+    EXPECT_FALSE(CardUid::FromBytes(bytes, 5).has_value());
+    EXPECT_FALSE(CardUid::FromBytes(nullptr, 4).has_value());
+}
+
+TEST(CardUidTest, ReaderStringRoundTrip) {
+    const std::uint8_t bytes[] = {0x04, 0xA1, 0xB2, 0x5A};
+    const auto uid = CardUid::FromBytes(bytes, sizeof(bytes));
+    ASSERT_TRUE(uid.has_value());
+    EXPECT_EQ(uid->ToString(), "004161178090");
+    EXPECT_EQ(uid->ToHex(), "04A1B25A");
+
+    const auto parsed = CardUid::Parse("004161178090");
+    ASSERT_TRUE(parsed.has_value());
+    EXPECT_EQ(*parsed, *uid);
+
+    const auto seven = CardUid::Parse("004001002003004005255");
+    ASSERT_TRUE(seven.has_value());
+    EXPECT_EQ(seven->size(), 7u);
+    EXPECT_EQ(seven->ToString(), "004001002003004005255");
+}
+
+TEST(CardUidTest, ParseRejectsOtherIdentifiers) {
+    EXPECT_FALSE(CardUid::Parse("").has_value());
+    EXPECT_FALSE(CardUid::Parse("uid-1").has_value());
+    EXPECT_FALSE(CardUid::Parse("1234").has_value());
+    EXPECT_FALSE(CardUid::Parse("00416117809").has_value());
+    EXPECT_FALSE(CardUid::Parse("004161178256").has_value());
+    EXPECT_FALSE(CardUid::Parse("00416117809a").has_value());
+    EXPECT_FALSE(CardUid::Parse("004161178090004").has_value());
+}
+
+TEST(CardUidTest, EqualityOrderingAndHash) {
+    const auto a = *CardUid::Parse("004161178090");
+    const auto b = *CardUid::Parse("004161178091");
+    const auto longer = *CardUid::Parse("004161178090000000000");
+
+    EXPECT_NE(a, b);
+    EXPECT_NE(a, longer);
+    EXPECT_TRUE(a < b);
+    EXPECT_TRUE(a < longer);
+    EXPECT_FALSE(b < a);
+
+    std::unordered_set<CardUid> set = {a, b, longer, a};
+    EXPECT_EQ(set.size(), 3u);
+    EXPECT_EQ(std::hash<CardUid>()(a), std::hash<CardUid>()(*CardUid::Parse("004161178090")));
+}
@@ -5,6 +5,10 @@
 #include <gtest/gtest.h>
 #include "cares_resolver.h"
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
 
 #ifdef USE_CARES
 
@@ -122,19 +126,120 @@ TEST_F(CaresResolverTest, UsesCacheFor24HoursAndExpiresAfterTtl) {
     ASSERT_EQ(firstIp, "127.0.0.1");
     ASSERT_TRUE(targetedResolver.HasValidTargetedCacheForTesting());
 
-    now += std::chrono::hours(23);
+    now += std::chrono::hours(21);
     const std::string cachedIp = targetedResolver.Resolve("localhost", "definitely_nonexistent_interface0");
     EXPECT_EQ(cachedIp, firstIp);
     EXPECT_TRUE(targetedResolver.HasValidTargetedCacheForTesting());
 
-    now += std::chrono::hours(2);
+    now += std::chrono::hours(4);
     EXPECT_FALSE(targetedResolver.HasValidTargetedCacheForTesting());
 
-    const std::string refreshedIp = targetedResolver.Resolve("localhost");
-    EXPECT_EQ(refreshedIp, firstIp);
+    // The expired address is served at once and refreshed in the background
+    const std::string staleIp = targetedResolver.Resolve("localhost");
+    EXPECT_EQ(staleIp, firstIp);
+    targetedResolver.WaitForRefreshForTesting();
     EXPECT_TRUE(targetedResolver.HasValidTargetedCacheForTesting());
 }
 
+TEST_F(CaresResolverTest, RefreshesAheadOfExpiry) {
+    CaresResolver::TimePoint now = CaresResolver::Clock::now();
+    CaresResolver targetedResolver("localhost", [&now]() { return now; });
+    ASSERT_EQ(targetedResolver.Resolve("localhost"), "127.0.0.1");
+
+    // Inside the refresh window: the cached entry is returned and renewed for another TTL
+    now += timing::kBackendApiDnsCacheTtl - timing::kBackendApiDnsRefreshAhead / 2;
+    EXPECT_EQ(targetedResolver.Resolve("localhost"), "127.0.0.1");
+    targetedResolver.WaitForRefreshForTesting();
+
+    now += timing::kBackendApiDnsRefreshAhead;
+    EXPECT_TRUE(targetedResolver.HasValidTargetedCacheForTesting());
+}
+
+TEST_F(CaresResolverTest, ResolveCachedNeverLooksUpOnTheCallingThread) {
+    CaresResolver::TimePoint now = CaresResolver::Clock::now();
+    CaresResolver targetedResolver("localhost", [&now]() { return now; });
+    EXPECT_EQ(targetedResolver.ResolveCached("10.0.0.1"), std::optional<std::string>("10.0.0.1"));
+    EXPECT_FALSE(targetedResolver.ResolveCached("127.0.0.1.example").has_value());
+
+    // A miss starts a background lookup that fills the cache for the next call
+    EXPECT_FALSE(targetedResolver.ResolveCached("localhost").has_value());
+    targetedResolver.WaitForRefreshForTesting();
+    EXPECT_EQ(targetedResolver.ResolveCached("localhost"), std::optional<std::string>("127.0.0.1"));
+
+    // A stale entry is still served while it is refreshed
+    now += timing::kBackendApiDnsCacheTtl + timing::kBackendApiDnsMaxStale / 2;
+    EXPECT_EQ(targetedResolver.ResolveCached("localhost"), std::optional<std::string>("127.0.0.1"));
+    targetedResolver.WaitForRefreshForTesting();
+    EXPECT_TRUE(targetedResolver.HasValidTargetedCacheForTesting());
+}
+
+class CaresResolverCacheFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = std::filesystem::temp_directory_path() /
+                     ("fuelflux_dns_cache_test-" + std::to_string(::getpid()));
+        std::filesystem::create_directories(directory_);
+        path_ = (directory_ / "dns_cache.txt").string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    void WriteCacheFile(const std::string& hostname, const std::string& ip, std::chrono::seconds age) {
+        const auto resolvedAt = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()) - age;
+        std::ofstream(path_) << hostname << ' ' << ip << ' ' << resolvedAt.count() << '\n';
+    }
+
+    std::filesystem::path directory_;
+    std::string path_;
+};
+
+TEST_F(CaresResolverCacheFileTest, ResolvedAddressIsPersisted) {
+    {
+        CaresResolver resolver("localhost", CaresResolver::Clock::now, path_);
+        ASSERT_EQ(resolver.Resolve("localhost"), "127.0.0.1");
+    }
+
+    std::ifstream file(path_);
+    std::string hostname;
+    std::string ip;
+    ASSERT_TRUE(file >> hostname >> ip);
+    EXPECT_EQ(hostname, "localhost");
+    EXPECT_EQ(ip, "127.0.0.1");
+}
+
+TEST_F(CaresResolverCacheFileTest, ColdStartServesPersistedAddressWithoutLookup) {
+    // ".invalid" never resolves: an answer proves no lookup was made
+    WriteCacheFile("backend.invalid", "10.1.2.3", std::chrono::hours(1));
+    CaresResolver resolver("backend.invalid", CaresResolver::Clock::now, path_);
+
+    EXPECT_TRUE(resolver.HasValidTargetedCacheForTesting());
+    EXPECT_EQ(resolver.Resolve("backend.invalid"), "10.1.2.3");
+}
+
+TEST_F(CaresResolverCacheFileTest, ExpiredPersistedAddressIsServedWhileRefreshing) {
+    WriteCacheFile("backend.invalid", "10.1.2.3", timing::kBackendApiDnsCacheTtl + std::chrono::hours(1));
+    CaresResolver resolver("backend.invalid", CaresResolver::Clock::now, path_);
+
+    EXPECT_FALSE(resolver.HasValidTargetedCacheForTesting());
+    // Returned at once; the failing background refresh is cancelled by the destructor
+    EXPECT_EQ(resolver.Resolve("backend.invalid"), "10.1.2.3");
+}
+
+TEST_F(CaresResolverCacheFileTest, IgnoresFileOfAnotherHostOrMalformed) {
+    WriteCacheFile("other.invalid", "10.1.2.3", std::chrono::hours(1));
+    {
+        CaresResolver resolver("backend.invalid", CaresResolver::Clock::now, path_);
+        EXPECT_EQ(resolver.GetTargetedCachedIpForTesting(), "");
+    }
+
+    std::ofstream(path_) << "backend.invalid not-an-ip 0\n";
+    CaresResolver resolver("backend.invalid", CaresResolver::Clock::now, path_);
+    EXPECT_EQ(resolver.GetTargetedCachedIpForTesting(), "");
+}
+
 } // namespace
 } // namespace fuelflux
 
@@ -0,0 +1,101 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include <gtest/gtest.h>
+#include "circuit_breaker.h"
+
+using namespace fuelflux;
+using std::chrono::seconds;
+
+namespace {
+
+struct FakeClock {
+    CircuitBreaker::Clock::time_point now{};
+    CircuitBreaker::TimeProvider Provider() {
+        return [this]() { return now; };
+    }
+};
+
+} // namespace
+
+TEST(CircuitBreakerTest, OpensAfterConsecutiveFailures) {
+    FakeClock clock;
+    CircuitBreaker breaker(3, seconds(15), clock.Provider());
+
+    breaker.RecordResult(false);
+    breaker.RecordResult(false);
+    breaker.RecordResult(true);   // Resets the count
+    breaker.RecordResult(false);
+    breaker.RecordResult(false);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::Closed);
+    EXPECT_TRUE(breaker.Allow());
+
+    breaker.RecordResult(false);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::Open);
+    EXPECT_FALSE(breaker.Allow());
+}
+
+TEST(CircuitBreakerTest, ProbeIsDueAfterTheInterval) {
+    FakeClock clock;
+    CircuitBreaker breaker(1, seconds(15), clock.Provider());
+    breaker.RecordResult(false);
+    ASSERT_EQ(breaker.GetState(), CircuitBreaker::State::Open);
+
+    EXPECT_FALSE(breaker.TryStartProbe());
+    clock.now += seconds(15);
+    EXPECT_TRUE(breaker.TryStartProbe());
+    EXPECT_FALSE(breaker.TryStartProbe());  // One probe at a time
+
+    // An unreachable backend restarts the interval
+    breaker.ProbeFinished(false);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::Open);
+    EXPECT_FALSE(breaker.TryStartProbe());
+    clock.now += seconds(15);
+    EXPECT_TRUE(breaker.TryStartProbe());
+}
+
+TEST(CircuitBreakerTest, TrialRequestDecidesAfterASuccessfulProbe) {
+    FakeClock clock;
+    CircuitBreaker breaker(2, seconds(15), clock.Provider());
+    breaker.RecordResult(false);
+    breaker.RecordResult(false);
+    clock.now += seconds(15);
+    ASSERT_TRUE(breaker.TryStartProbe());
+    breaker.ProbeFinished(true);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::HalfOpen);
+    EXPECT_TRUE(breaker.Allow());
+    // Only one trial request at a time
+    EXPECT_FALSE(breaker.Allow());
+    breaker.Cancel();
+    EXPECT_TRUE(breaker.Allow());
+    EXPECT_FALSE(breaker.Allow());
+
+    // A single failure opens it again
+    breaker.RecordResult(false);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::Open);
+
+    clock.now += seconds(15);
+    ASSERT_TRUE(breaker.TryStartProbe());
+    breaker.ProbeFinished(true);
+    ASSERT_TRUE(breaker.Allow());
+    breaker.RecordResult(true);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::Closed);
+    EXPECT_TRUE(breaker.Allow());
+    EXPECT_TRUE(breaker.Allow());
+
+    // Closed again: the full threshold applies
+    breaker.RecordResult(false);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::Closed);
+}
+
+TEST(CircuitBreakerTest, LateSuccessClosesAnOpenBreaker) {
+    FakeClock clock;
+    CircuitBreaker breaker(1, seconds(15), clock.Provider());
+    breaker.RecordResult(false);
+    ASSERT_EQ(breaker.GetState(), CircuitBreaker::State::Open);
+
+    // An async request that was in flight when it opened got through
+    breaker.RecordResult(true);
+    EXPECT_EQ(breaker.GetState(), CircuitBreaker::State::Closed);
+}
@@ -262,7 +262,7 @@ TEST_F(ConsoleCardReaderTest, CallbackFiresOnlyWhenReadingEnabled) {
     int callbackCount = 0;
     UserId lastUser;
 
-    cardReader->setCardPresentedCallback([&](const UserId& userId) {
+    cardReader->setCardPresentedCallback([&](const UserId& userId, const std::optional<CardUid>&) {
         std::lock_guard<std::mutex> lock(callbackMutex);
         ++callbackCount;
         lastUser = userId;
@@ -465,7 +465,7 @@ TEST_F(ConsoleEmulatorTest, ProcessCommandCardDispatchesToCardReaderWhenEnabled)
     UserId receivedUserId;
     bool callbackFired = false;
 
-    cardReader->setCardPresentedCallback([&](const UserId& userId) {
+    cardReader->setCardPresentedCallback([&](const UserId& userId, const std::optional<CardUid>&) {
         std::lock_guard<std::mutex> lock(callbackMutex);
         receivedUserId = userId;
         callbackFired = true;
@@ -6,10 +6,13 @@
 #include <gmock/gmock.h>
 #include <array>
 #include <filesystem>
+#include <future>
 #include "backend.h"
+#include "backlog_payload.h"
 #include "config.h"
 #include "controller.h"
 #include "user_cache.h"
+#include "user_cache_snapshot.h"
 #include "message_storage.h"
 #include "peripherals/display.h"
 #include "peripherals/keyboard.h"
@@ -46,6 +49,32 @@ public:
     MOCK_METHOD(std::vector<FuelTank>, FetchFuelTanks, (int first, int number), (override));
     MOCK_METHOD(const std::string&, GetControllerUid, (), (const, override));
 
+    // When set, AuthorizeAsync is answered through this promise instead of Authorize
+    std::shared_ptr<std::promise<bool>> pendingAuthorize_;
+    std::future<bool> AuthorizeAsync(const std::string& uid) override {
+        if (pendingAuthorize_) {
+            return pendingAuthorize_->get_future();
+        }
+        return IBackend::AuthorizeAsync(uid);
+    }
+
+    // When set, DeauthorizeAsync runs Deauthorize on its own thread like the real backend
+    bool asyncDeauthorize_ = false;
+    std::thread deauthorizeThread_;
+    std::future<bool> DeauthorizeAsync() override {
+        if (!asyncDeauthorize_) {
+            return IBackend::DeauthorizeAsync();
+        }
+        auto done = std::make_shared<std::promise<bool>>();
+        deauthorizeThread_ = std::thread([this, done]() { done->set_value(Deauthorize()); });
+        return done->get_future();
+    }
+    ~MockBackend() override {
+        if (deauthorizeThread_.joinable()) {
+            deauthorizeThread_.join();
+        }
+    }
+
     std::string tokenStorage_;
     std::vector<BackendTankInfo> tanksStorage_;
     std::string lastErrorStorage_;
@@ -105,7 +134,7 @@ public:
     
     void simulateCardPresented(const UserId& userId) {
         if (storedCallback) {
-            storedCallback(userId);
+            storedCallback(userId, CardUid::Parse(userId));
         }
     }
 };
@@ -195,11 +224,14 @@ protected:
     MockPump* mockPump;
     MockFlowMeter* mockFlowMeter;
 
-    void createController(std::chrono::seconds noFlowCancelTimeout = std::chrono::seconds(30)) {
+    void createController(std::chrono::seconds noFlowCancelTimeout = std::chrono::seconds(30),
+                          std::chrono::milliseconds authHedgeDelay = timing::kAuthHedgeDelay,
+                          UserCacheEngine cacheEngine = UserCacheEngine::Sqlite) {
         auto backend = std::make_shared<NiceMock<MockBackend>>();
         mockBackend = backend.get();
         ON_CALL(*mockBackend, GetControllerUid()).WillByDefault(ReturnRef(CONTROLLER_UID));
-        controller = std::make_unique<Controller>(CONTROLLER_UID, backend, noFlowCancelTimeout);
+        controller = std::make_unique<Controller>(CONTROLLER_UID, backend, noFlowCancelTimeout, authHedgeDelay,
+                                                  cacheEngine);
 
         // Create mocks (use raw pointers as Controller takes ownership)
         auto display = std::make_unique<NiceMock<MockDisplay>>();
@@ -267,6 +299,8 @@ protected:
     void SetUp() override {
         std::filesystem::remove(STORAGE_DB_PATH);
         std::filesystem::remove(CACHE_DB_PATH);
+        std::filesystem::remove(CACHE_SNAPSHOT_PATH);
+        std::filesystem::remove(std::string(CACHE_SNAPSHOT_PATH) + ".overlay");
         createController();
     }
 
@@ -320,6 +354,29 @@ TEST_F(ControllerTest, AuthorizationFallsBackToCacheOnNetworkError) {
     EXPECT_EQ(controller->getAvailableTanks()[0].number, 7);
 }
 
+TEST_F(ControllerTest, SnapshotCacheEngineServesOfflineAuthorization) {
+    controller.reset();
+    createController(std::chrono::seconds(30), timing::kAuthHedgeDelay, UserCacheEngine::Snapshot);
+    ASSERT_NE(std::dynamic_pointer_cast<MappedUserCache>(controller->getUserCache()), nullptr);
+    ASSERT_TRUE(controller->getUserCache()->BeginPopulation());
+    ASSERT_TRUE(controller->getUserCache()->AddPopulationEntry("offline-user", 123.0, static_cast<int>(UserRole::Customer)));
+    ASSERT_TRUE(controller->getUserCache()->AddPopulationTank(10, 7, "Tank-7", 700.0));
+    ASSERT_TRUE(controller->getUserCache()->CommitPopulation());
+
+    EXPECT_CALL(*mockBackend, Authorize("offline-user")).WillOnce(Return(false));
+    ON_CALL(*mockBackend, IsNetworkError()).WillByDefault(Return(true));
+    ON_CALL(*mockBackend, FetchUserCards(_, _)).WillByDefault(Return(std::vector<UserCard>{{"offline-user", static_cast<int>(UserRole::Customer), 123.0}}));
+    ON_CALL(*mockBackend, FetchFuelTanks(_, _)).WillByDefault(Return(std::vector<FuelTank>{{10, 7, "Tank-7", 700.0}}));
+
+    controller->initialize();
+    controller->requestAuthorization("offline-user");
+
+    EXPECT_TRUE(controller->isSessionAuthorizedFromCache());
+    EXPECT_DOUBLE_EQ(controller->getCurrentUser().allowance, 123.0);
+    ASSERT_EQ(controller->getAvailableTanks().size(), 1);
+    EXPECT_EQ(controller->getAvailableTanks()[0].number, 7);
+}
+
 TEST_F(ControllerTest, CachedAuthorizationAllowsOnlyCachedTankSelection) {
     ASSERT_NE(controller->getUserCache(), nullptr);
     ASSERT_TRUE(controller->getUserCache()->BeginPopulation());
@@ -383,6 +440,13 @@ TEST_F(ControllerTest, CachedAuthorizationRefuelGoesToBacklogAndSkipsDeauthorize
     ASSERT_TRUE(message.has_value());
     EXPECT_EQ(message->uid, "offline-user");
     EXPECT_EQ(message->method, MessageMethod::Refuel);
+    ASSERT_FALSE(message->data.empty());
+    EXPECT_EQ(static_cast<std::uint8_t>(message->data[0]), kBacklogPayloadMsgpackV1);
+    const auto wire = BacklogPayloadToWireBody(message->data);
+    ASSERT_TRUE(wire.has_value());
+    const auto body = nlohmann::json::parse(*wire);
+    EXPECT_EQ(body["TankNumber"], 7);
+    EXPECT_DOUBLE_EQ(body["FuelVolume"].get<double>(), 8.0);
 }
 
 TEST_F(ControllerTest, CachedAuthorizationIntakeGoesToBacklog) {
@@ -412,6 +476,287 @@ TEST_F(ControllerTest, CachedAuthorizationIntakeGoesToBacklog) {
     ASSERT_TRUE(message.has_value());
     EXPECT_EQ(message->uid, "offline-operator");
     EXPECT_EQ(message->method, MessageMethod::Intake);
+    ASSERT_FALSE(message->data.empty());
+    EXPECT_EQ(static_cast<std::uint8_t>(message->data[0]), kBacklogPayloadMsgpackV1);
+    const auto wire = BacklogPayloadToWireBody(message->data);
+    ASSERT_TRUE(wire.has_value());
+    const auto body = nlohmann::json::parse(*wire);
+    EXPECT_EQ(body["TankNumber"], 11);
+    EXPECT_DOUBLE_EQ(body["IntakeVolume"].get<double>(), 12.5);
+}
+
+class HedgedAuthorizationTest : public ControllerTest {
+protected:
+    void SetUp() override {
+        ControllerTest::SetUp();
+        createController(std::chrono::seconds(30), std::chrono::milliseconds(50));
+        mockBackend->pendingAuthorize_ = std::make_shared<std::promise<bool>>();
+        ON_CALL(*mockBackend, FetchUserCards(_, _)).WillByDefault(Return(std::vector<UserCard>{}));
+        ON_CALL(*mockBackend, FetchFuelTanks(_, _)).WillByDefault(Return(std::vector<FuelTank>{}));
+    }
+
+    void PopulateCache(const std::string& uid, double allowance, UserRole role) {
+        ASSERT_NE(controller->getUserCache(), nullptr);
+        ASSERT_TRUE(controller->getUserCache()->BeginPopulation());
+        ASSERT_TRUE(controller->getUserCache()->AddPopulationEntry(uid, allowance, static_cast<int>(role)));
+        ASSERT_TRUE(controller->getUserCache()->AddPopulationTank(10, 7, "Tank-7", 700.0));
+        ASSERT_TRUE(controller->getUserCache()->AddPopulationTank(11, 8, "Tank-8", 800.0));
+        ASSERT_TRUE(controller->getUserCache()->CommitPopulation());
+    }
+
+    // The backend answers a pending authorization with what Authorize would have set
+    void Answer(bool authorized, double allowance = 40.0) {
+        if (authorized) {
+            mockBackend->roleId_ = static_cast<int>(UserRole::Customer);
+            mockBackend->allowance_ = allowance;
+            mockBackend->price_ = 2.0;
+            mockBackend->tanksStorage_ = {BackendTankInfo{10, 7, "Tank-7", 700.0}};
+            mockBackend->authorized_ = true;
+        }
+        mockBackend->pendingAuthorize_->set_value(authorized);
+    }
+
+    template <typename Pred>
+    bool waitFor(Pred pred, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!pred() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return pred();
+    }
+};
+
+TEST_F(HedgedAuthorizationTest, CacheDecidesWhenBackendIsSlowAndBackendConfirmsLater) {
+    PopulateCache("hedged-user", 150.0, UserRole::Customer);
+    EXPECT_CALL(*mockBackend, Deauthorize()).Times(1);
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    controller->handleCardPresented("hedged-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+    EXPECT_TRUE(controller->isSessionAuthorizedFromCache());
+    EXPECT_TRUE(controller->isAuthorizationPending());
+    EXPECT_DOUBLE_EQ(controller->getCurrentUser().allowance, timing::kAuthHedgeMaxAllowance);
+    EXPECT_EQ(controller->getAvailableTanks().size(), 2U);
+
+    Answer(true);
+    ASSERT_TRUE(waitFor([this]() { return !controller->isAuthorizationPending(); }));
+    EXPECT_FALSE(controller->isSessionAuthorizedFromCache());
+    EXPECT_DOUBLE_EQ(controller->getCurrentUser().allowance, 40.0);
+    EXPECT_DOUBLE_EQ(controller->getCurrentUser().price, 2.0);
+    EXPECT_EQ(controller->getAvailableTanks().size(), 1U);
+    EXPECT_EQ(controller->getStateMachine().getCurrentState(), SystemState::TankSelection);
+
+    // Confirmed sessions are closed on the backend
+    controller->handleKeyPress(KeyCode::KeyStop);
+    ASSERT_TRUE(waitForState(SystemState::Waiting));
+
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, BackendDenialCancelsTheSession) {
+    PopulateCache("revoked-user", 80.0, UserRole::Customer);
+    ON_CALL(*mockBackend, IsNetworkError()).WillByDefault(Return(false));
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    controller->handleCardPresented("revoked-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+    controller->handleKeyPress(KeyCode::Key7);
+    controller->handleKeyPress(KeyCode::KeyStart);
+    ASSERT_TRUE(waitForState(SystemState::VolumeEntry));
+
+    Answer(false);
+    ASSERT_TRUE(waitForState(SystemState::NotAuthorized));
+    EXPECT_FALSE(controller->isAuthorizationPending());
+    EXPECT_TRUE(controller->getCurrentUser().uid.empty());
+    EXPECT_FALSE(mockPump->isRunning());
+
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, NetworkErrorKeepsTheCachedSession) {
+    PopulateCache("offline-user", 80.0, UserRole::Customer);
+    ON_CALL(*mockBackend, IsNetworkError()).WillByDefault(Return(true));
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    controller->handleCardPresented("offline-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+
+    Answer(false);
+    ASSERT_TRUE(waitFor([this]() { return !controller->isAuthorizationPending(); }));
+    EXPECT_TRUE(controller->isSessionAuthorizedFromCache());
+    EXPECT_EQ(controller->getStateMachine().getCurrentState(), SystemState::TankSelection);
+    EXPECT_DOUBLE_EQ(controller->getCurrentUser().allowance, 80.0);
+
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, LateConfirmationClosesTheEndedSession) {
+    PopulateCache("quick-user", 80.0, UserRole::Customer);
+    // The request in flight owns the backend session state
+    EXPECT_CALL(*mockBackend, IsAuthorized()).Times(0);
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    controller->handleCardPresented("quick-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+    controller->handleKeyPress(KeyCode::KeyStop);
+    ASSERT_TRUE(waitForState(SystemState::Waiting));
+    EXPECT_FALSE(controller->isAuthorizationPending());
+
+    EXPECT_CALL(*mockBackend, Deauthorize()).Times(1);
+    Answer(true);
+    ASSERT_TRUE(waitFor([this]() { return !mockBackend->authorized_; }));
+    EXPECT_EQ(controller->getStateMachine().getCurrentState(), SystemState::Waiting);
+
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, LateConfirmationDoesNotHoldUpTheNextUser) {
+    PopulateCache("late-user", 80.0, UserRole::Customer);
+    // Closing the stale session takes as long as the backend wants
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> closing{false};
+    mockBackend->asyncDeauthorize_ = true;
+    EXPECT_CALL(*mockBackend, Deauthorize()).WillOnce([released, &closing]() {
+        closing = true;
+        released.wait();
+        return true;
+    });
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    controller->handleCardPresented("late-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+    controller->handleKeyPress(KeyCode::KeyStop);
+    ASSERT_TRUE(waitForState(SystemState::Waiting));
+
+    Answer(true);
+    ASSERT_TRUE(waitFor([&closing]() { return closing.load(); }));
+
+    // The next user is not in the cache: an online authorization answered right away
+    mockBackend->pendingAuthorize_ = std::make_shared<std::promise<bool>>();
+    mockBackend->tanksStorage_ = {BackendTankInfo{10, 7, "Tank-7", 700.0}, BackendTankInfo{11, 8, "Tank-8", 800.0}};
+    mockBackend->pendingAuthorize_->set_value(true);
+    controller->handleCardPresented("next-user");
+    EXPECT_TRUE(waitForState(SystemState::TankSelection));
+    EXPECT_EQ(controller->getCurrentUser().uid, "next-user");
+    EXPECT_FALSE(controller->isSessionAuthorizedFromCache());
+
+    release.set_value();
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, RoleMismatchClosesTheBackendSessionOnce) {
+    PopulateCache("promoted-user", 80.0, UserRole::Customer);
+    // Deauthorize leaves IsAuthorized true, so a second close would show up here
+    EXPECT_CALL(*mockBackend, Deauthorize()).WillOnce(Return(true));
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    controller->handleCardPresented("promoted-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+
+    mockBackend->roleId_ = static_cast<int>(UserRole::Operator);
+    mockBackend->tanksStorage_ = {BackendTankInfo{10, 7, "Tank-7", 700.0}};
+    mockBackend->authorized_ = true;
+    mockBackend->pendingAuthorize_->set_value(true);
+    ASSERT_TRUE(waitForState(SystemState::NotAuthorized));
+    EXPECT_TRUE(controller->getCurrentUser().uid.empty());
+
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, NextUserDoesNotWaitForAnAbandonedRequest) {
+    ASSERT_TRUE(controller->getUserCache()->BeginPopulation());
+    ASSERT_TRUE(controller->getUserCache()->AddPopulationEntry("first-user", 80.0,
+                                                               static_cast<int>(UserRole::Customer)));
+    ASSERT_TRUE(controller->getUserCache()->AddPopulationEntry("second-user", 60.0,
+                                                               static_cast<int>(UserRole::Customer)));
+    ASSERT_TRUE(controller->getUserCache()->AddPopulationTank(10, 7, "Tank-7", 700.0));
+    ASSERT_TRUE(controller->getUserCache()->AddPopulationTank(11, 8, "Tank-8", 800.0));
+    ASSERT_TRUE(controller->getUserCache()->CommitPopulation());
+
+    auto next = std::make_shared<NiceMock<MockBackend>>();
+    next->pendingAuthorize_ = std::make_shared<std::promise<bool>>();
+    ON_CALL(*next, GetControllerUid()).WillByDefault(ReturnRef(CONTROLLER_UID));
+    ON_CALL(*next, IsAuthorized()).WillByDefault(ReturnPointee(&next->authorized_));
+    EXPECT_CALL(*next, Deauthorize()).Times(0);
+    controller->setBackendFactory([next]() { return next; });
+
+    // The abandoned request takes its backend along; it is closed there when it lands
+    std::atomic<bool> closed{false};
+    EXPECT_CALL(*mockBackend, Deauthorize()).WillOnce([&closed]() {
+        closed = true;
+        return true;
+    });
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    controller->handleCardPresented("first-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+    controller->handleKeyPress(KeyCode::KeyStop);
+    ASSERT_TRUE(waitForState(SystemState::Waiting));
+
+    controller->handleCardPresented("second-user");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+    EXPECT_EQ(controller->getCurrentUser().uid, "second-user");
+    EXPECT_TRUE(controller->isAuthorizationPending());
+
+    mockBackend->authorized_ = true;
+    mockBackend->pendingAuthorize_->set_value(true);
+    // mockBackend is released by the controller once closed
+    ASSERT_TRUE(waitFor([&closed]() { return closed.load(); }));
+    EXPECT_EQ(controller->getCurrentUser().uid, "second-user");
+    EXPECT_TRUE(controller->isAuthorizationPending());
+    EXPECT_EQ(controller->getStateMachine().getCurrentState(), SystemState::TankSelection);
+
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, PresentedCardIsLookedUpByItsUidBytes) {
+    PopulateCache("004161178090", 80.0, UserRole::Customer);
+
+    controller->initialize();
+    std::thread controllerThread([this]() { controller->run(); });
+
+    mockCardReader->simulateCardPresented("004161178090");
+    ASSERT_TRUE(waitForState(SystemState::TankSelection));
+    EXPECT_TRUE(controller->isSessionAuthorizedFromCache());
+    EXPECT_EQ(controller->getCurrentUser().uid, "004161178090");
+    EXPECT_FALSE(controller->getPresentedCard().has_value());
+
+    Answer(false);
+    shutdownControllerAndJoinThread(controllerThread);
+}
+
+TEST_F(HedgedAuthorizationTest, OperatorsWaitForTheBackend) {
+    PopulateCache("operator", 0.0, UserRole::Operator);
+    controller->initialize();
+
+    std::thread backendThread([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        mockBackend->roleId_ = static_cast<int>(UserRole::Operator);
+        mockBackend->tanksStorage_ = {BackendTankInfo{10, 7, "Tank-7", 700.0}};
+        mockBackend->authorized_ = true;
+        mockBackend->pendingAuthorize_->set_value(true);
+    });
+    controller->requestAuthorization("operator");
+    backendThread.join();
+
+    EXPECT_FALSE(controller->isSessionAuthorizedFromCache());
+    EXPECT_FALSE(controller->isAuthorizationPending());
+    EXPECT_EQ(controller->getCurrentUser().role, UserRole::Operator);
 }
 
 // Test Controller initialization
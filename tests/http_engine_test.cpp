@@ -0,0 +1,162 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "http_engine.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <random>
+#include <sstream>
+
+using namespace fuelflux;
+
+namespace {
+
+std::string MakeTempDir() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 0xFFFF);
+
+    std::ostringstream oss;
+    oss << "fuelflux_http_engine_test-" << std::hex << dis(gen) << '-' << dis(gen);
+    return (std::filesystem::temp_directory_path() / oss.str()).string();
+}
+
+size_t AppendToString(void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), size * nmemb);
+    return size * nmemb;
+}
+
+// Easy handle reading a local file; the transfers need no network
+struct FileTransfer {
+    explicit FileTransfer(const std::string& path)
+        : url("file://" + path)
+        , curl(curl_easy_init()) {
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, AppendToString);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+    }
+    ~FileTransfer() {
+        curl_easy_cleanup(curl);
+    }
+
+    std::string url;
+    std::string body;
+    CURL* curl;
+};
+
+} // namespace
+
+class HttpEngineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = MakeTempDir();
+        std::filesystem::create_directories(directory_);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    std::string WriteFile(const std::string& name, const std::string& content) {
+        const std::string path = directory_ + "/" + name;
+        std::ofstream(path, std::ios::binary) << content;
+        return path;
+    }
+
+    std::string directory_;
+};
+
+TEST_F(HttpEngineTest, PerformWaitsForTransfer) {
+    HttpEngine engine;
+    FileTransfer transfer(WriteFile("body.json", "{\"Token\":\"abc\"}"));
+
+    EXPECT_EQ(engine.Perform(transfer.curl), CURLE_OK);
+    EXPECT_EQ(transfer.body, "{\"Token\":\"abc\"}");
+    EXPECT_EQ(engine.ActiveTransfers(), 0u);
+}
+
+TEST_F(HttpEngineTest, SubmitCompletesOnIoThread) {
+    HttpEngine engine;
+    FileTransfer transfer(WriteFile("body.json", "payload"));
+
+    std::promise<bool> onIoThread;
+    ASSERT_TRUE(engine.Submit(transfer.curl, [&engine, &onIoThread](CURLcode result) {
+        EXPECT_EQ(result, CURLE_OK);
+        onIoThread.set_value(engine.IsIoThread());
+    }));
+
+    EXPECT_TRUE(onIoThread.get_future().get());
+    EXPECT_FALSE(engine.IsIoThread());
+    EXPECT_EQ(transfer.body, "payload");
+}
+
+TEST_F(HttpEngineTest, OverlappingTransfersAllComplete) {
+    HttpEngine engine;
+    constexpr int kTransfers = 16;
+    std::vector<std::unique_ptr<FileTransfer>> transfers;
+    std::vector<std::future<CURLcode>> results;
+    for (int i = 0; i < kTransfers; ++i) {
+        transfers.push_back(std::make_unique<FileTransfer>(
+            WriteFile("page" + std::to_string(i), "page " + std::to_string(i))));
+        auto done = std::make_shared<std::promise<CURLcode>>();
+        results.push_back(done->get_future());
+        ASSERT_TRUE(engine.Submit(transfers.back()->curl, [done](CURLcode result) { done->set_value(result); }));
+    }
+
+    for (int i = 0; i < kTransfers; ++i) {
+        EXPECT_EQ(results[i].get(), CURLE_OK);
+        EXPECT_EQ(transfers[i]->body, "page " + std::to_string(i));
+    }
+}
+
+TEST_F(HttpEngineTest, ReportsTransferErrors) {
+    HttpEngine engine;
+    FileTransfer transfer(directory_ + "/missing");
+
+    EXPECT_EQ(engine.Perform(transfer.curl), CURLE_FILE_COULDNT_READ_FILE);
+}
+
+TEST_F(HttpEngineTest, PerformFromCompletionRunsInline) {
+    HttpEngine engine;
+    FileTransfer first(WriteFile("first", "one"));
+    FileTransfer second(WriteFile("second", "two"));
+
+    std::promise<CURLcode> nested;
+    ASSERT_TRUE(engine.Submit(first.curl, [&engine, &second, &nested](CURLcode /*result*/) {
+        // Waiting for the I/O thread from the I/O thread would never return
+        nested.set_value(engine.Perform(second.curl));
+    }));
+
+    EXPECT_EQ(nested.get_future().get(), CURLE_OK);
+    EXPECT_EQ(second.body, "two");
+}
+
+TEST_F(HttpEngineTest, ResetConnectionsKeepsEngineUsable) {
+    HttpEngine engine;
+    FileTransfer before(WriteFile("before", "1"));
+    ASSERT_EQ(engine.Perform(before.curl), CURLE_OK);
+
+    engine.ResetConnections();
+
+    FileTransfer after(WriteFile("after", "2"));
+    EXPECT_EQ(engine.Perform(after.curl), CURLE_OK);
+    EXPECT_EQ(after.body, "2");
+}
+
+TEST_F(HttpEngineTest, AfterShutdownSubmitFailsAndPerformRunsInline) {
+    HttpEngine engine;
+    engine.Shutdown();
+
+    FileTransfer transfer(WriteFile("body", "late"));
+    std::atomic<bool> called{false};
+    EXPECT_FALSE(engine.Submit(transfer.curl, [&called](CURLcode) { called = true; }));
+    EXPECT_FALSE(called);
+
+    EXPECT_EQ(engine.Perform(transfer.curl), CURLE_OK);
+    EXPECT_EQ(transfer.body, "late");
+}
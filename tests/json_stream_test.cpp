@@ -0,0 +1,157 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "json_stream.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace fuelflux;
+
+namespace {
+
+// Feed 'text' in chunks of 'chunk' bytes, collecting the records
+struct Streamed {
+    bool ok = false;
+    nlohmann::json result;
+    std::vector<nlohmann::json> records;
+    std::string error;
+};
+
+Streamed Stream(const std::string& text, std::size_t chunk) {
+    Streamed out;
+    JsonRecordReader reader([&out](const nlohmann::json& record) {
+        out.records.push_back(record);
+        return true;
+    });
+    JsonStreamParser parser(reader);
+    for (std::size_t offset = 0; offset < text.size(); offset += chunk) {
+        if (!parser.Feed(text.data() + offset, std::min(chunk, text.size() - offset))) {
+            out.error = parser.Error();
+            return out;
+        }
+    }
+    out.ok = parser.Finish();
+    out.error = parser.Error();
+    out.result = reader.Result();
+    return out;
+}
+
+} // namespace
+
+TEST(JsonStreamTest, ArrayItemsAreDeliveredOneByOne) {
+    const std::string page =
+        R"([{"Uid":"100"},{"Uid":"200","RoleId":2,"Allowance":19.75},42,)"
+        R"({"RoleId":1,"Allowance":5.5,"Tags":["a",{"b":null}]}])";
+
+    for (std::size_t chunk : {std::size_t{1}, std::size_t{3}, std::size_t{7}, page.size()}) {
+        const Streamed out = Stream(page, chunk);
+        ASSERT_TRUE(out.ok) << "chunk " << chunk << ": " << out.error;
+        EXPECT_EQ(out.result, nlohmann::json::array());
+
+        const nlohmann::json expected = nlohmann::json::parse(page);
+        ASSERT_EQ(out.records.size(), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(out.records[i], expected[i]) << "chunk " << chunk << ", record " << i;
+        }
+    }
+}
+
+TEST(JsonStreamTest, NonArrayResponseIsKeptWhole) {
+    const Streamed error = Stream(R"({"CodeError": 7, "TextError": "cards api unavailable"})", 2);
+    ASSERT_TRUE(error.ok) << error.error;
+    EXPECT_TRUE(error.records.empty());
+    EXPECT_EQ(error.result["CodeError"], 7);
+    EXPECT_EQ(error.result["TextError"], "cards api unavailable");
+
+    const Streamed null = Stream("null", 1);
+    ASSERT_TRUE(null.ok);
+    EXPECT_TRUE(null.result.is_null());
+
+    const Streamed number = Stream(" 12 ", 1);
+    ASSERT_TRUE(number.ok);
+    EXPECT_EQ(number.result, 12);
+}
+
+TEST(JsonStreamTest, StringsAndNumbersMatchNlohmann) {
+    const std::string page =
+        R"([{"s":"a\"b\\c\/d\n\t\u0041\u00e9\u20ac\ud83d\ude00","k\u00fc":"Привет"},)"
+        R"({"i":-42,"u":18446744073709551615,"big":18446744073709551616,"f":-1.5e3,"z":0,"t":true,"n":false}])";
+
+    const Streamed out = Stream(page, 1);
+    ASSERT_TRUE(out.ok) << out.error;
+    const nlohmann::json expected = nlohmann::json::parse(page);
+    ASSERT_EQ(out.records.size(), 2u);
+    EXPECT_EQ(out.records[0], expected[0]);
+    EXPECT_EQ(out.records[1], expected[1]);
+    EXPECT_TRUE(out.records[1]["i"].is_number_integer());
+    EXPECT_TRUE(out.records[1]["u"].is_number_unsigned());
+    EXPECT_TRUE(out.records[1]["big"].is_number_float());
+    EXPECT_TRUE(out.records[1]["f"].is_number_float());
+}
+
+TEST(JsonStreamTest, SyntaxErrorsAreReported) {
+    const std::vector<std::string> invalid = {
+        "",
+        "[",
+        "[1,]",
+        "[1 2]",
+        "{\"a\" 1}",
+        "{\"a\":1,}",
+        "{1:2}",
+        "[01]",
+        "[1.]",
+        "[-]",
+        "[1e+]",
+        "[tru]",
+        "[nul1]",
+        "[\"unterminated]",
+        "[\"bad \\x escape\"]",
+        "[\"\\ud83d alone\"]",
+        "[\"\\ude00\"]",
+        "[\"tab\tinside\"]",
+        "[] []",
+        "{\"a\":1}}",
+        "[1}",
+    };
+    for (const auto& text : invalid) {
+        const Streamed out = Stream(text, 1);
+        EXPECT_FALSE(out.ok) << "accepted: " << text;
+        EXPECT_FALSE(out.error.empty()) << text;
+    }
+}
+
+TEST(JsonStreamTest, NestingDepthIsBounded) {
+    const std::string deep(JsonStreamParser::kMaxDepth + 1, '[');
+    const Streamed out = Stream(deep, 16);
+    EXPECT_FALSE(out.ok);
+    EXPECT_NE(out.error.find("nesting"), std::string::npos);
+}
+
+TEST(JsonStreamTest, CallbackCanStopParsing) {
+    JsonRecordReader reader([](const nlohmann::json& record) {
+        return record != 2;
+    });
+    JsonStreamParser parser(reader);
+
+    EXPECT_FALSE(parser.Feed("[1,2,3]", 7));
+    EXPECT_TRUE(reader.Stopped());
+    EXPECT_EQ(reader.RecordCount(), 2u);
+    EXPECT_TRUE(parser.Failed());
+    EXPECT_FALSE(parser.Feed("]", 1));
+    EXPECT_FALSE(parser.Finish());
+}
+
+TEST(JsonStreamTest, ReaderWorksWithNlohmannSaxParse) {
+    std::vector<nlohmann::json> records;
+    JsonRecordReader reader([&records](const nlohmann::json& record) {
+        records.push_back(record);
+        return true;
+    });
+
+    ASSERT_TRUE(nlohmann::json::sax_parse(R"([{"VisualNumberTank":1},{"VisualNumberTank":2}])", &reader));
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[1]["VisualNumberTank"], 2);
+}
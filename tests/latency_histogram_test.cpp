@@ -0,0 +1,48 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include <gtest/gtest.h>
+#include "latency_histogram.h"
+
+using namespace fuelflux;
+using std::chrono::microseconds;
+
+TEST(LatencyHistogramTest, EmptySnapshot) {
+    LatencyHistogram histogram;
+    const auto snapshot = histogram.GetSnapshot();
+    EXPECT_EQ(snapshot.count, 0u);
+    EXPECT_EQ(snapshot.Percentile(0.99), microseconds(0));
+    EXPECT_EQ(snapshot.Mean(), microseconds(0));
+}
+
+TEST(LatencyHistogramTest, BucketsAndPercentiles) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 90; ++i) {
+        histogram.Record(microseconds(100));     // [64, 128)
+    }
+    for (int i = 0; i < 10; ++i) {
+        histogram.Record(microseconds(5000));    // [4096, 8192)
+    }
+
+    const auto snapshot = histogram.GetSnapshot();
+    EXPECT_EQ(snapshot.count, 100u);
+    EXPECT_EQ(snapshot.buckets[7], 90u);
+    EXPECT_EQ(snapshot.buckets[13], 10u);
+    EXPECT_EQ(snapshot.max, microseconds(5000));
+    EXPECT_EQ(snapshot.Mean(), microseconds(590));
+    EXPECT_EQ(snapshot.Percentile(0.5), microseconds(128));
+    EXPECT_EQ(snapshot.Percentile(0.9), microseconds(128));
+    EXPECT_EQ(snapshot.Percentile(0.95), microseconds(5000));
+}
+
+TEST(LatencyHistogramTest, OutliersLandInLastBucket) {
+    LatencyHistogram histogram;
+    histogram.Record(microseconds(-5));
+    histogram.Record(std::chrono::duration_cast<microseconds>(std::chrono::minutes(2)));
+
+    const auto snapshot = histogram.GetSnapshot();
+    EXPECT_EQ(snapshot.buckets[0], 1u);
+    EXPECT_EQ(snapshot.buckets[LatencyHistogram::kBucketCount - 1], 1u);
+    EXPECT_EQ(snapshot.Percentile(1.0), std::chrono::duration_cast<microseconds>(std::chrono::minutes(2)));
+}
@@ -0,0 +1,195 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "link_monitor.h"
+#include <gtest/gtest.h>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace fuelflux;
+
+namespace {
+
+// Builds a buffer of rtnetlink messages as the kernel sends them
+class NetlinkBuffer {
+public:
+    void Link(int type, int index, const std::string& name, bool up) {
+        struct ifinfomsg info {};
+        info.ifi_family = AF_UNSPEC;
+        info.ifi_index = index;
+        info.ifi_flags = up ? (IFF_UP | IFF_RUNNING) : 0;
+        const std::size_t start = Begin(type, &info, sizeof(info));
+        Attribute(IFLA_IFNAME, name.c_str(), name.size() + 1);
+        End(start);
+    }
+
+    void Address(int type, int index, const std::string& label, const char* local, const char* peer) {
+        struct ifaddrmsg info {};
+        info.ifa_family = AF_INET;
+        info.ifa_prefixlen = 32;
+        info.ifa_index = static_cast<unsigned>(index);
+        const std::size_t start = Begin(type, &info, sizeof(info));
+        struct in_addr addr {};
+        if (peer) {
+            inet_pton(AF_INET, peer, &addr);
+            Attribute(IFA_ADDRESS, &addr, sizeof(addr));
+        }
+        if (local) {
+            inet_pton(AF_INET, local, &addr);
+            Attribute(IFA_LOCAL, &addr, sizeof(addr));
+        }
+        if (!label.empty()) {
+            Attribute(IFA_LABEL, label.c_str(), label.size() + 1);
+        }
+        End(start);
+    }
+
+    const void* data() const { return bytes_.data(); }
+    std::size_t size() const { return bytes_.size(); }
+
+private:
+    std::size_t Begin(int type, const void* payload, std::size_t size) {
+        const std::size_t start = bytes_.size();
+        bytes_.resize(start + NLMSG_SPACE(size));
+        auto* header = reinterpret_cast<struct nlmsghdr*>(bytes_.data() + start);
+        header->nlmsg_type = static_cast<unsigned short>(type);
+        std::memcpy(NLMSG_DATA(header), payload, size);
+        return start;
+    }
+
+    void Attribute(int type, const void* payload, std::size_t size) {
+        const std::size_t start = bytes_.size();
+        bytes_.resize(start + RTA_SPACE(size));
+        auto* rta = reinterpret_cast<struct rtattr*>(bytes_.data() + start);
+        rta->rta_type = static_cast<unsigned short>(type);
+        rta->rta_len = static_cast<unsigned short>(RTA_LENGTH(size));
+        std::memcpy(RTA_DATA(rta), payload, size);
+    }
+
+    void End(std::size_t start) {
+        auto* header = reinterpret_cast<struct nlmsghdr*>(bytes_.data() + start);
+        header->nlmsg_len = static_cast<std::uint32_t>(bytes_.size() - start);
+    }
+
+    std::vector<char> bytes_;  // heap storage is suitably aligned for nlmsghdr
+};
+
+} // namespace
+
+TEST(LinkMonitorTest, FollowsLinkAndAddressEvents) {
+    LinkMonitor monitor("ppp0");
+    std::vector<std::pair<LinkMonitor::State, std::string>> events;
+    monitor.Subscribe([&events](LinkMonitor::State state, const std::string& address) {
+        events.emplace_back(state, address);
+    });
+    EXPECT_EQ(monitor.GetState(), LinkMonitor::State::Absent);
+
+    // pppd creates the interface, then assigns the negotiated address
+    NetlinkBuffer created;
+    created.Link(RTM_NEWLINK, 7, "ppp0", true);
+    monitor.ProcessMessages(created.data(), created.size());
+    EXPECT_EQ(monitor.GetState(), LinkMonitor::State::Down);
+
+    NetlinkBuffer addressed;
+    addressed.Address(RTM_NEWADDR, 7, "ppp0", "10.64.12.5", "10.64.64.64");
+    monitor.ProcessMessages(addressed.data(), addressed.size());
+    EXPECT_TRUE(monitor.IsUp());
+    EXPECT_EQ(monitor.Address(), "10.64.12.5");
+
+    // The modem drops the call
+    NetlinkBuffer gone;
+    gone.Address(RTM_DELADDR, 7, "ppp0", "10.64.12.5", "10.64.64.64");
+    gone.Link(RTM_DELLINK, 7, "ppp0", false);
+    monitor.ProcessMessages(gone.data(), gone.size());
+    EXPECT_EQ(monitor.GetState(), LinkMonitor::State::Down);
+    EXPECT_EQ(monitor.Address(), "");
+
+    ASSERT_EQ(events.size(), 3u);
+    EXPECT_EQ(events[0].first, LinkMonitor::State::Down);
+    EXPECT_EQ(events[1].first, LinkMonitor::State::Up);
+    EXPECT_EQ(events[1].second, "10.64.12.5");
+    EXPECT_EQ(events[2].first, LinkMonitor::State::Down);
+    EXPECT_EQ(monitor.Generation(), 3u);
+}
+
+TEST(LinkMonitorTest, NewAddressAfterReconnectIsATransition) {
+    LinkMonitor monitor("ppp0");
+    NetlinkBuffer up;
+    up.Link(RTM_NEWLINK, 7, "ppp0", true);
+    up.Address(RTM_NEWADDR, 7, "ppp0", "10.64.12.5", "10.64.64.64");
+    monitor.ProcessMessages(up.data(), up.size());
+    ASSERT_TRUE(monitor.IsUp());
+    const auto generation = monitor.Generation();
+
+    // The same event again changes nothing
+    monitor.ProcessMessages(up.data(), up.size());
+    EXPECT_EQ(monitor.Generation(), generation);
+
+    // pppd re-dialled in the same interface and got another address
+    NetlinkBuffer renewed;
+    renewed.Address(RTM_DELADDR, 7, "ppp0", "10.64.12.5", "10.64.64.64");
+    renewed.Address(RTM_NEWADDR, 7, "ppp0", "10.64.30.17", "10.64.64.64");
+    monitor.ProcessMessages(renewed.data(), renewed.size());
+    EXPECT_TRUE(monitor.IsUp());
+    EXPECT_EQ(monitor.Address(), "10.64.30.17");
+    EXPECT_GT(monitor.Generation(), generation);
+}
+
+TEST(LinkMonitorTest, AdministrativelyDownLinkIsDown) {
+    LinkMonitor monitor("ppp0");
+    NetlinkBuffer up;
+    up.Link(RTM_NEWLINK, 7, "ppp0", true);
+    up.Address(RTM_NEWADDR, 7, "ppp0", "10.64.12.5", nullptr);
+    monitor.ProcessMessages(up.data(), up.size());
+    ASSERT_TRUE(monitor.IsUp());
+
+    NetlinkBuffer down;
+    down.Link(RTM_NEWLINK, 7, "ppp0", false);
+    monitor.ProcessMessages(down.data(), down.size());
+    EXPECT_EQ(monitor.GetState(), LinkMonitor::State::Down);
+}
+
+TEST(LinkMonitorTest, OtherInterfacesAreIgnored) {
+    LinkMonitor monitor("ppp0");
+    int calls = 0;
+    const int id = monitor.Subscribe([&calls](LinkMonitor::State, const std::string&) { ++calls; });
+
+    NetlinkBuffer other;
+    other.Link(RTM_NEWLINK, 2, "eth0", true);
+    other.Address(RTM_NEWADDR, 2, "eth0", "192.168.1.10", nullptr);
+    other.Link(RTM_NEWLINK, 8, "ppp1", true);
+    monitor.ProcessMessages(other.data(), other.size());
+    EXPECT_EQ(monitor.GetState(), LinkMonitor::State::Absent);
+    EXPECT_EQ(calls, 0);
+
+    // Unsubscribed listeners are not called any more
+    monitor.Unsubscribe(id);
+    NetlinkBuffer up;
+    up.Link(RTM_NEWLINK, 7, "ppp0", true);
+    monitor.ProcessMessages(up.data(), up.size());
+    EXPECT_EQ(monitor.GetState(), LinkMonitor::State::Down);
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(LinkMonitorTest, WatchesLoopbackThroughRtnetlink) {
+    LinkMonitor monitor("lo");
+    if (!monitor.Start()) {
+        GTEST_SKIP() << "rtnetlink is not available";
+    }
+    EXPECT_TRUE(monitor.IsRunning());
+    EXPECT_TRUE(monitor.IsUp());
+    EXPECT_EQ(monitor.Address(), "127.0.0.1");
+    monitor.Stop();
+    EXPECT_FALSE(monitor.IsRunning());
+}
+
+#endif // __linux__
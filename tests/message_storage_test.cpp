@@ -6,10 +6,17 @@
 
 #include "message_storage.h"
 
+#include <sqlite3.h>
+
+#include <chrono>
 #include <filesystem>
 #include <random>
 #include <sstream>
 #include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 using namespace fuelflux;
 
@@ -80,3 +87,240 @@ TEST(MessageStorageTest, FetchesAndRemovesBacklogInOrder) {
 
     std::filesystem::remove(dbPath);
 }
+
+TEST(MessageStorageTest, UsesWalJournalByDefault) {
+    const std::string dbPath = MakeTempDbPath();
+    std::filesystem::remove(dbPath);
+
+    {
+        MessageStorage storage(dbPath);
+        ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Refuel, "{}"));
+
+        sqlite3* db = nullptr;
+        ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+        sqlite3_stmt* stmt = nullptr;
+        ASSERT_EQ(sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &stmt, nullptr), SQLITE_OK);
+        ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+        EXPECT_STREQ(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), "wal");
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+    }
+
+    {
+        MessageStorage storage(dbPath, SqliteDurability{SqliteJournalMode::Delete, SqliteSynchronous::Full});
+        EXPECT_EQ(storage.BacklogCount(), 1);
+    }
+
+    std::filesystem::remove(dbPath);
+}
+
+TEST(MessageStorageTest, ConcurrentBacklogWritesAreGroupCommitted) {
+    const std::string dbPath = MakeTempDbPath();
+    std::filesystem::remove(dbPath);
+
+    constexpr int kThreads = 8;
+    constexpr int kWritesPerThread = 25;
+    {
+        MessageStorage storage(dbPath);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < kThreads; ++t) {
+            writers.emplace_back([&storage, t]() {
+                for (int i = 0; i < kWritesPerThread; ++i) {
+                    const std::string uid = "uid-" + std::to_string(t);
+                    EXPECT_TRUE(storage.AddBacklog(uid, MessageMethod::Refuel, std::to_string(i)));
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+
+        EXPECT_EQ(storage.BacklogCount(), kThreads * kWritesPerThread);
+        EXPECT_GE(storage.GetBacklogCommitCount(), 1u);
+        EXPECT_LE(storage.GetBacklogCommitCount(), static_cast<std::uint64_t>(kThreads * kWritesPerThread));
+
+        const auto latency = storage.GetBacklogEnqueueLatency();
+        EXPECT_EQ(latency.count, static_cast<std::uint64_t>(kThreads * kWritesPerThread));
+        EXPECT_LE(latency.Percentile(0.5), latency.Percentile(0.99));
+        EXPECT_LE(latency.Percentile(0.99), latency.max);
+
+        // Entries of one writer keep their order
+        std::vector<int> lastSeen(kThreads, -1);
+        while (auto message = storage.GetNextBacklog()) {
+            const int writer = std::stoi(message->uid.substr(4));
+            const int sequence = std::stoi(message->data);
+            EXPECT_GT(sequence, lastSeen[writer]);
+            lastSeen[writer] = sequence;
+            ASSERT_TRUE(storage.RemoveBacklog(message->id));
+        }
+    }
+
+    std::filesystem::remove(dbPath);
+}
+
+TEST(MessageStorageTest, FetchesBacklogOfOneUser) {
+    MessageStorage storage(":memory:");
+    ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Refuel, "a"));
+    ASSERT_TRUE(storage.AddBacklog("uid-2", MessageMethod::Intake, "b"));
+    ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Intake, "c"));
+    ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Refuel, "d"));
+
+    auto messages = storage.GetBacklogForUid("uid-1", 2);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0].data, "a");
+    EXPECT_EQ(messages[1].data, "c");
+    EXPECT_EQ(messages[1].method, MessageMethod::Intake);
+    EXPECT_LT(messages[0].id, messages[1].id);
+
+    EXPECT_EQ(storage.GetBacklogForUid("uid-1", 10).size(), 3u);
+    EXPECT_TRUE(storage.GetBacklogForUid("uid-3", 10).empty());
+}
+
+TEST(MessageStorageTest, DeferredBacklogIsNotDueUntilNextAttempt) {
+    MessageStorage storage(":memory:");
+    ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Refuel, "a"));
+    ASSERT_TRUE(storage.AddBacklog("uid-2", MessageMethod::Refuel, "b"));
+    EXPECT_EQ(storage.GetNextBacklogAttemptAt(), std::optional<std::int64_t>(0));
+
+    std::vector<int> attempts;
+    ASSERT_TRUE(storage.DeferBacklog(1000, [&attempts](int attempt) {
+        attempts.push_back(attempt);
+        return std::chrono::milliseconds(500);
+    }));
+    EXPECT_EQ(attempts, (std::vector<int>{1, 1}));
+    EXPECT_EQ(storage.GetNextBacklogAttemptAt(), std::optional<std::int64_t>(1500));
+
+    EXPECT_TRUE(storage.GetBacklogUids(10, 1499).empty());
+    EXPECT_TRUE(storage.GetBacklogForUid("uid-1", 10, 1499).empty());
+    EXPECT_EQ(storage.GetBacklogUids(10, 1500).size(), 2u);
+    // Without a due time everything is returned
+    EXPECT_EQ(storage.GetBacklogUids(10).size(), 2u);
+
+    // Attempts keep counting while the network stays down
+    attempts.clear();
+    ASSERT_TRUE(storage.DeferBacklog(1500, [&attempts](int attempt) {
+        attempts.push_back(attempt);
+        return std::chrono::milliseconds(1000);
+    }));
+    EXPECT_EQ(attempts, (std::vector<int>{2, 2}));
+
+    ASSERT_TRUE(storage.ResetBacklogBackoff());
+    EXPECT_EQ(storage.GetNextBacklogAttemptAt(), std::optional<std::int64_t>(0));
+    EXPECT_EQ(storage.GetBacklogUids(10, 0).size(), 2u);
+}
+
+TEST(MessageStorageTest, SegmentLogEngineServesBacklog) {
+    const std::string dbPath = MakeTempDbPath();
+    EXPECT_THROW(MessageStorage(":memory:", MessageStorage::kDefaultDurability, BacklogEngine::SegmentLog),
+                 std::runtime_error);
+
+    {
+        MessageStorage storage(dbPath, MessageStorage::kDefaultDurability, BacklogEngine::SegmentLog);
+        EXPECT_EQ(storage.GetBacklogEngine(), BacklogEngine::SegmentLog);
+        ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Refuel, "a"));
+        ASSERT_TRUE(storage.AddBacklog("uid-2", MessageMethod::Intake, "b"));
+        ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Intake, "c"));
+        ASSERT_TRUE(storage.AddDeadMessage("uid-3", MessageMethod::Refuel, "dead"));
+
+        auto first = storage.GetNextBacklog();
+        ASSERT_TRUE(first.has_value());
+        EXPECT_EQ(first->data, "a");
+        ASSERT_TRUE(storage.RemoveBacklog(first->id));
+        EXPECT_EQ(storage.GetBacklogUids(10), (std::vector<std::string>{"uid-2", "uid-1"}));
+
+        ASSERT_TRUE(storage.DeferBacklog(1000, [](int) { return std::chrono::milliseconds(500); }));
+        EXPECT_TRUE(storage.GetBacklogUids(10, 1499).empty());
+        EXPECT_EQ(storage.GetNextBacklogAttemptAt(), std::optional<std::int64_t>(1500));
+    }
+
+    // The backlog is recovered from the segments, with the retry schedule reset
+    MessageStorage storage(dbPath, MessageStorage::kDefaultDurability, BacklogEngine::SegmentLog);
+    EXPECT_EQ(storage.BacklogCount(), 2);
+    EXPECT_EQ(storage.DeadMessageCount(), 1);
+    const auto messages = storage.GetBacklogForUid("uid-1", 10, 0);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].data, "c");
+    EXPECT_EQ(messages[0].method, MessageMethod::Intake);
+
+    std::filesystem::remove(dbPath);
+    std::filesystem::remove_all(dbPath + ".backlog");
+}
+
+TEST(MessageStorageTest, SwitchingBacklogEnginesKeepsUndeliveredMessages) {
+    const std::string dbPath = MakeTempDbPath();
+    {
+        MessageStorage storage(dbPath);
+        ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Refuel, "a"));
+        ASSERT_TRUE(storage.AddBacklog("uid-2", MessageMethod::Intake, "b"));
+        ASSERT_TRUE(storage.AddBacklog("uid-1", MessageMethod::Intake, "c"));
+    }
+
+    {
+        MessageStorage storage(dbPath, MessageStorage::kDefaultDurability, BacklogEngine::SegmentLog);
+        EXPECT_EQ(storage.BacklogCount(), 3);
+        auto first = storage.GetNextBacklog();
+        ASSERT_TRUE(first.has_value());
+        EXPECT_EQ(first->data, "a");
+        ASSERT_TRUE(storage.RemoveBacklog(first->id));
+        ASSERT_TRUE(storage.AddBacklog("uid-3", MessageMethod::Refuel, "d"));
+    }
+
+    // Back on SQLite, the remaining messages come back in their original order
+    MessageStorage storage(dbPath);
+    EXPECT_FALSE(std::filesystem::exists(dbPath + ".backlog"));
+    std::vector<std::string> data;
+    while (auto message = storage.GetNextBacklog()) {
+        data.push_back(message->data);
+        ASSERT_TRUE(storage.RemoveBacklog(message->id));
+    }
+    EXPECT_EQ(data, (std::vector<std::string>{"b", "c", "d"}));
+
+    std::filesystem::remove(dbPath);
+}
+
+// Enqueue and drain throughput of both backlog engines through the MessageStorage interface
+// Run with --gtest_also_run_disabled_tests --gtest_filter='*BacklogEngineBenchmark*'
+TEST(MessageStorageTest, DISABLED_BacklogEngineBenchmark) {
+    constexpr int kMessages = 2000;
+    constexpr int kThreads = 4;
+    using Clock = std::chrono::steady_clock;
+    const std::string payload(200, 'x');
+
+    for (const auto engine : {BacklogEngine::Sqlite, BacklogEngine::SegmentLog}) {
+        const std::string dbPath = MakeTempDbPath();
+        {
+            MessageStorage storage(dbPath, MessageStorage::kDefaultDurability, engine);
+            auto start = Clock::now();
+            std::vector<std::thread> writers;
+            for (int t = 0; t < kThreads; ++t) {
+                writers.emplace_back([&storage, &payload, t]() {
+                    for (int i = 0; i < kMessages / kThreads; ++i) {
+                        storage.AddBacklog("uid-" + std::to_string(t), MessageMethod::Refuel, payload);
+                    }
+                });
+            }
+            for (auto& writer : writers) {
+                writer.join();
+            }
+            const auto enqueue = Clock::now() - start;
+
+            start = Clock::now();
+            int drained = 0;
+            while (auto message = storage.GetNextBacklog()) {
+                ASSERT_TRUE(storage.RemoveBacklog(message->id));
+                ++drained;
+            }
+            const auto drain = Clock::now() - start;
+            EXPECT_EQ(drained, kMessages);
+
+            const auto latency = storage.GetBacklogEnqueueLatency();
+            std::cout << (engine == BacklogEngine::Sqlite ? "sqlite:  " : "segment: ")
+                      << "enqueue " << std::chrono::duration_cast<std::chrono::milliseconds>(enqueue).count()
+                      << " ms (" << storage.GetBacklogCommitCount() << " commits, p99 "
+                      << latency.Percentile(0.99).count() << " us), drain "
+                      << std::chrono::duration_cast<std::chrono::milliseconds>(drain).count() << " ms\n";
+        }
+        std::filesystem::remove(dbPath);
+        std::filesystem::remove_all(dbPath + ".backlog");
+    }
+}
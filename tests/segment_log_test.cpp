@@ -0,0 +1,164 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "segment_log.h"
+#include "segment_backlog.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace fuelflux;
+
+namespace {
+
+std::string MakeTempDir() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 0xFFFF);
+
+    std::ostringstream oss;
+    oss << "fuelflux_segment_test-" << std::hex << dis(gen) << '-' << dis(gen);
+    return (std::filesystem::temp_directory_path() / oss.str()).string();
+}
+
+std::vector<std::string> ReadAll(const SegmentLog& log) {
+    std::vector<std::string> records;
+    log.ForEach([&records](const SegmentLog::Position&, const std::string& record) {
+        records.push_back(record);
+    });
+    return records;
+}
+
+std::filesystem::path LastSegmentFile(const std::string& directory) {
+    std::filesystem::path last;
+    for (const auto& item : std::filesystem::directory_iterator(directory)) {
+        if (last.empty() || item.path().filename() > last.filename()) {
+            last = item.path();
+        }
+    }
+    return last;
+}
+
+} // namespace
+
+class SegmentLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = MakeTempDir();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    std::string directory_;
+};
+
+TEST_F(SegmentLogTest, AppendReadAndReplay) {
+    std::vector<SegmentLog::Position> positions;
+    {
+        SegmentLog log(directory_);
+        auto appended = log.Append({"first", "second"});
+        ASSERT_TRUE(appended.has_value());
+        ASSERT_EQ(appended->size(), 2u);
+        positions = *appended;
+        ASSERT_TRUE(log.Append({std::string("third\0record", 12)}).has_value());
+
+        EXPECT_EQ(log.Read(positions[1]), std::optional<std::string>("second"));
+        EXPECT_FALSE(log.Read(SegmentLog::Position{positions[1].segment, positions[1].offset + 1}).has_value());
+    }
+
+    SegmentLog reopened(directory_);
+    EXPECT_EQ(ReadAll(reopened), (std::vector<std::string>{"first", "second", std::string("third\0record", 12)}));
+    EXPECT_EQ(reopened.Read(positions[0]), std::optional<std::string>("first"));
+    EXPECT_EQ(reopened.TruncatedBytes(), 0u);
+}
+
+TEST_F(SegmentLogTest, TornWriteIsTruncatedOnRecovery) {
+    {
+        SegmentLog log(directory_);
+        ASSERT_TRUE(log.Append({"kept-1", "kept-2"}).has_value());
+        ASSERT_TRUE(log.Append({"torn-record"}).has_value());
+    }
+
+    // Power loss in the middle of the last frame
+    const auto segment = LastSegmentFile(directory_);
+    std::filesystem::resize_file(segment, std::filesystem::file_size(segment) - 4);
+
+    {
+        SegmentLog log(directory_);
+        EXPECT_GT(log.TruncatedBytes(), 0u);
+        EXPECT_EQ(ReadAll(log), (std::vector<std::string>{"kept-1", "kept-2"}));
+        // Appends continue right after the last intact frame
+        ASSERT_TRUE(log.Append({"after"}).has_value());
+    }
+
+    // Garbage after the last frame (e.g. a sector of a never completed write)
+    {
+        std::ofstream file(segment, std::ios::binary | std::ios::app);
+        file << "garbage";
+    }
+    SegmentLog log(directory_);
+    EXPECT_EQ(ReadAll(log), (std::vector<std::string>{"kept-1", "kept-2", "after"}));
+}
+
+TEST_F(SegmentLogTest, RollsAndReleasesSegments) {
+    SegmentLogOptions options;
+    options.maxSegmentBytes = 64;
+    options.fsync = SegmentFsync::Never;
+    SegmentLog log(directory_, options);
+
+    const std::string record(30, 'x');
+    std::vector<SegmentLog::Position> positions;
+    for (int i = 0; i < 5; ++i) {
+        auto appended = log.Append({record});
+        ASSERT_TRUE(appended.has_value());
+        positions.push_back(appended->front());
+    }
+    EXPECT_GT(log.SegmentCount(), 2u);
+    EXPECT_EQ(log.ActiveSegment(), positions.back().segment);
+
+    // The active segment is never released
+    EXPECT_EQ(log.ReleaseBefore(log.ActiveSegment() + 10), log.SegmentCount() - 1);
+    EXPECT_EQ(log.SegmentCount(), 1u);
+    EXPECT_FALSE(log.Read(positions.front()).has_value());
+    EXPECT_EQ(log.Read(positions.back()), std::optional<std::string>(record));
+}
+
+TEST_F(SegmentLogTest, BacklogRecoversUnacknowledgedMessages) {
+    SegmentLogOptions options;
+    options.maxSegmentBytes = 128;
+    {
+        SegmentBacklog backlog(directory_, options);
+        ASSERT_TRUE(backlog.Append({StoredMessage{0, "uid-1", MessageMethod::Refuel, "a"},
+                                    StoredMessage{0, "uid-2", MessageMethod::Intake, "b"}}));
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_TRUE(backlog.Append({StoredMessage{0, "uid-3", MessageMethod::Refuel, "payload-" + std::to_string(i)}}));
+        }
+        const auto first = backlog.GetNext();
+        ASSERT_TRUE(first.has_value());
+        EXPECT_EQ(first->data, "a");
+        ASSERT_TRUE(backlog.Remove(first->id));
+        for (const auto& message : backlog.GetForUid("uid-3", 9, 0)) {
+            ASSERT_TRUE(backlog.Remove(message.id));
+        }
+        EXPECT_EQ(backlog.Count(), 2);
+    }
+
+    SegmentBacklog backlog(directory_, options);
+    EXPECT_EQ(backlog.Count(), 2);
+    const auto next = backlog.GetNext();
+    ASSERT_TRUE(next.has_value());
+    EXPECT_EQ(next->uid, "uid-2");
+    EXPECT_EQ(next->method, MessageMethod::Intake);
+    EXPECT_EQ(backlog.GetUids(10, 0), (std::vector<std::string>{"uid-2", "uid-3"}));
+
+    // Acknowledging everything leaves only the active segment
+    ASSERT_TRUE(backlog.Remove(next->id));
+    ASSERT_TRUE(backlog.Remove(backlog.GetNext()->id));
+    EXPECT_EQ(backlog.Count(), 0);
+    EXPECT_EQ(backlog.SegmentCount(), 1u);
+}
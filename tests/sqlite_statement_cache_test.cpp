@@ -0,0 +1,79 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include <gtest/gtest.h>
+
+#include "sqlite_statement_cache.h"
+
+#include <sqlite3.h>
+
+using namespace fuelflux;
+
+class SqliteStatementCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_EQ(sqlite3_open(":memory:", &db_), SQLITE_OK);
+        ASSERT_EQ(sqlite3_exec(db_, "CREATE TABLE t (k INTEGER PRIMARY KEY, v TEXT);", nullptr, nullptr, nullptr), SQLITE_OK);
+        cache_.Attach(db_);
+    }
+
+    void TearDown() override {
+        cache_.Clear();
+        sqlite3_close(db_);
+    }
+
+    sqlite3* db_ = nullptr;
+    SqliteStatementCache cache_;
+};
+
+TEST_F(SqliteStatementCacheTest, ReturnsSameStatementForSameSql) {
+    sqlite3_stmt* first = cache_.Get("SELECT v FROM t WHERE k = ?;");
+    ASSERT_NE(first, nullptr);
+    sqlite3_stmt* second = cache_.Get("SELECT v FROM t WHERE k = ?;");
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(cache_.Size(), 1u);
+
+    EXPECT_NE(cache_.Get("SELECT COUNT(*) FROM t;"), nullptr);
+    EXPECT_EQ(cache_.Size(), 2u);
+}
+
+TEST_F(SqliteStatementCacheTest, InvalidSqlReturnsNull) {
+    EXPECT_EQ(cache_.Get("SELECT FROM nowhere;"), nullptr);
+    EXPECT_EQ(cache_.Size(), 0u);
+}
+
+TEST_F(SqliteStatementCacheTest, ScopedResetAllowsReuseWithFreshBindings) {
+    const std::string insertSql = "INSERT INTO t (k, v) VALUES (?, ?);";
+    for (int i = 0; i < 3; ++i) {
+        sqlite3_stmt* stmt = cache_.Get(insertSql);
+        ASSERT_NE(stmt, nullptr);
+        ScopedStatementReset reset(stmt);
+        sqlite3_bind_int(stmt, 1, i);
+        sqlite3_bind_text(stmt, 2, "value", -1, SQLITE_TRANSIENT);
+        EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    }
+
+    // Bindings are cleared on reset, so an unbound insert stores NULL
+    {
+        sqlite3_stmt* stmt = cache_.Get(insertSql);
+        ScopedStatementReset reset(stmt);
+        sqlite3_bind_int(stmt, 1, 10);
+        EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    }
+
+    sqlite3_stmt* count = cache_.Get("SELECT COUNT(*) FROM t WHERE v IS NULL;");
+    ScopedStatementReset reset(count);
+    ASSERT_EQ(sqlite3_step(count), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(count, 0), 1);
+}
+
+TEST_F(SqliteStatementCacheTest, ClearFinalizesAndAllowsPreparingAgain) {
+    ASSERT_NE(cache_.Get("SELECT COUNT(*) FROM t;"), nullptr);
+    cache_.Clear();
+    EXPECT_EQ(cache_.Size(), 0u);
+    EXPECT_EQ(sqlite3_next_stmt(db_, nullptr), nullptr);
+
+    EXPECT_NE(cache_.Get("SELECT COUNT(*) FROM t;"), nullptr);
+    EXPECT_EQ(cache_.Size(), 1u);
+}
@@ -0,0 +1,162 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "tls_session_store.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using namespace fuelflux;
+
+namespace {
+
+std::string MakeTempDir() {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 0xFFFF);
+
+    std::ostringstream oss;
+    oss << "fuelflux_tls_session_test-" << std::hex << dis(gen) << '-' << dis(gen);
+    return (std::filesystem::temp_directory_path() / oss.str()).string();
+}
+
+constexpr std::int64_t kNow = 1760000000;
+const std::string kPeer = "https://backend.example";
+
+} // namespace
+
+class TlsSessionStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory_ = MakeTempDir();
+        // The store creates the missing directory on the first save
+        path_ = directory_ + "/db/tls_sessions.bin";
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory_);
+    }
+
+    std::string directory_;
+    std::string path_;
+};
+
+TEST_F(TlsSessionStoreTest, SessionSurvivesRestart) {
+    const std::string session("\x30\x82\x01\x00binary\0session", 20);
+    {
+        TlsSessionStore store(path_);
+        EXPECT_EQ(store.Count(), 0u);
+        EXPECT_FALSE(store.Load(kPeer, kNow).has_value());
+        ASSERT_TRUE(store.Save(kPeer, session, kNow));
+        ASSERT_TRUE(store.Save("https://other.example", "other", kNow));
+    }
+
+    TlsSessionStore reopened(path_);
+    EXPECT_EQ(reopened.Count(), 2u);
+    EXPECT_EQ(reopened.Load(kPeer, kNow + 60), session);
+    EXPECT_EQ(reopened.Load("https://other.example", kNow + 60), "other");
+    EXPECT_FALSE(reopened.Load("https://unknown.example", kNow).has_value());
+}
+
+TEST_F(TlsSessionStoreTest, SaveReplacesSessionOfPeer) {
+    TlsSessionStore store(path_);
+    ASSERT_TRUE(store.Save(kPeer, "first", kNow));
+    ASSERT_TRUE(store.Save(kPeer, "second", kNow + 1));
+    EXPECT_EQ(store.Count(), 1u);
+
+    TlsSessionStore reopened(path_);
+    EXPECT_EQ(reopened.Load(kPeer, kNow + 1), "second");
+}
+
+TEST_F(TlsSessionStoreTest, StagedSessionsAreWrittenInTheBackground) {
+    TlsSessionStore store(path_, timing::kTlsSessionMaxAge, std::chrono::milliseconds(20));
+    ASSERT_TRUE(store.Stage(kPeer, "first", kNow));
+    ASSERT_TRUE(store.Stage(kPeer, "second", kNow + 1));
+    EXPECT_EQ(store.Load(kPeer, kNow + 1), "second");
+    EXPECT_FALSE(store.Stage(kPeer, std::string(TlsSessionStore::kMaxSessionBytes + 1, 'x'), kNow));
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!std::filesystem::exists(path_) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    TlsSessionStore reopened(path_);
+    EXPECT_EQ(reopened.Load(kPeer, kNow + 1), "second");
+}
+
+TEST_F(TlsSessionStoreTest, StagedSessionsAreWrittenOnDestruction) {
+    {
+        TlsSessionStore store(path_, timing::kTlsSessionMaxAge, std::chrono::hours(1));
+        ASSERT_TRUE(store.Stage(kPeer, "staged", kNow));
+        EXPECT_FALSE(std::filesystem::exists(path_));
+    }
+
+    TlsSessionStore reopened(path_);
+    EXPECT_EQ(reopened.Load(kPeer, kNow), "staged");
+}
+
+TEST_F(TlsSessionStoreTest, ExpiredSessionsAreNotReturnedAndArePruned) {
+    TlsSessionStore store(path_, std::chrono::hours(1));
+    ASSERT_TRUE(store.Save(kPeer, "old", kNow));
+    EXPECT_EQ(store.Load(kPeer, kNow + 3600), "old");
+    EXPECT_FALSE(store.Load(kPeer, kNow + 3601).has_value());
+
+    // The next write drops it from the file
+    ASSERT_TRUE(store.Save("https://other.example", "fresh", kNow + 7200));
+    TlsSessionStore reopened(path_, std::chrono::hours(1));
+    EXPECT_EQ(reopened.Count(), 1u);
+    EXPECT_EQ(reopened.Load("https://other.example", kNow + 7200), "fresh");
+}
+
+TEST_F(TlsSessionStoreTest, ForgetRemovesSession) {
+    TlsSessionStore store(path_);
+    ASSERT_TRUE(store.Save(kPeer, "session", kNow));
+    ASSERT_TRUE(store.Forget(kPeer));
+    EXPECT_FALSE(store.Load(kPeer, kNow).has_value());
+
+    TlsSessionStore reopened(path_);
+    EXPECT_EQ(reopened.Count(), 0u);
+}
+
+TEST_F(TlsSessionStoreTest, RejectsOversizedSessions) {
+    TlsSessionStore store(path_);
+    EXPECT_FALSE(store.Save(kPeer, std::string(TlsSessionStore::kMaxSessionBytes + 1, 'x'), kNow));
+    EXPECT_FALSE(store.Save(kPeer, "", kNow));
+    EXPECT_EQ(store.Count(), 0u);
+}
+
+TEST_F(TlsSessionStoreTest, KeepsAtMostMaxPeers) {
+    TlsSessionStore store(path_);
+    for (std::size_t i = 0; i <= TlsSessionStore::kMaxPeers; ++i) {
+        ASSERT_TRUE(store.Save("https://peer" + std::to_string(i), "session", kNow + static_cast<std::int64_t>(i)));
+    }
+    EXPECT_EQ(store.Count(), TlsSessionStore::kMaxPeers);
+    EXPECT_FALSE(store.Load("https://peer0", kNow).has_value());
+    EXPECT_TRUE(store.Load("https://peer" + std::to_string(TlsSessionStore::kMaxPeers), kNow).has_value());
+}
+
+TEST_F(TlsSessionStoreTest, CorruptFileStartsEmpty) {
+    {
+        TlsSessionStore store(path_);
+        ASSERT_TRUE(store.Save(kPeer, "session", kNow));
+    }
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-1, std::ios::end);
+        file.put('!');
+    }
+    TlsSessionStore corrupt(path_);
+    EXPECT_EQ(corrupt.Count(), 0u);
+
+    std::filesystem::resize_file(path_, 10);
+    TlsSessionStore truncated(path_);
+    EXPECT_EQ(truncated.Count(), 0u);
+
+    // A corrupt file is simply replaced by the next save
+    ASSERT_TRUE(truncated.Save(kPeer, "again", kNow));
+    TlsSessionStore reopened(path_);
+    EXPECT_EQ(reopened.Load(kPeer, kNow), "again");
+}
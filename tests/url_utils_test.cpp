@@ -31,3 +31,10 @@ TEST(UrlUtilsTest, ExtractsHostWithUserInfo) {
 TEST(UrlUtilsTest, ReturnsHostForPlainHostname) {
     EXPECT_EQ(ExtractHostFromUrl("localhost"), "localhost");
 }
+
+TEST(UrlUtilsTest, SplitsEndpointAtItsQuery) {
+    EXPECT_EQ(EndpointPath("/api/pump/cards?first=0&number=50"), "/api/pump/cards");
+    EXPECT_EQ(EndpointQuery("/api/pump/cards?first=0&number=50"), "?first=0&number=50");
+    EXPECT_EQ(EndpointPath("/api/pump/authorize"), "/api/pump/authorize");
+    EXPECT_EQ(EndpointQuery("/api/pump/authorize"), "");
+}
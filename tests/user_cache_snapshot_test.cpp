@@ -0,0 +1,311 @@
+// Copyright (C) 2025, 2026 Maxim [maxirmx] Samsonov (www.sw.consulting)
+// All rights reserved.
+// This file is a part of fuelflux application
+
+#include "user_cache_snapshot.h"
+#include "card_records.h"
+#include "crc32.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <unistd.h>
+
+using namespace fuelflux;
+
+namespace {
+
+std::string MakeTempPath(const std::string& suffix) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 0xFFFF);
+
+    std::ostringstream oss;
+    oss << "fuelflux_snapshot_test-" << std::hex << dis(gen) << '-' << dis(gen) << suffix;
+    return (std::filesystem::temp_directory_path() / oss.str()).string();
+}
+
+UserCacheEntry MakeEntry(const std::string& uid, double allowance, int roleId) {
+    UserCacheEntry entry;
+    entry.uid = uid;
+    entry.allowance = allowance;
+    entry.roleId = roleId;
+    return entry;
+}
+
+// Resident set size of this process in kilobytes
+long CurrentRssKb() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0;
+    long resident = 0;
+    statm >> pages >> resident;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+} // namespace
+
+class UserCacheSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = MakeTempPath(".snap");
+    }
+
+    void TearDown() override {
+        for (const auto& suffix : {"", ".tmp", ".overlay", ".overlay.tmp", ".db", ".db-wal", ".db-shm", ".db.bloom"}) {
+            const std::string path = path_ + suffix;
+            if (std::filesystem::exists(path)) {
+                std::filesystem::remove(path);
+            }
+        }
+    }
+
+    std::string path_;
+};
+
+TEST(Crc32Test, KnownValue) {
+    const std::string data = "123456789";
+    EXPECT_EQ(Crc32(data.data(), data.size()), 0xCBF43926U);
+    EXPECT_EQ(Crc32(data.data() + 4, 5, Crc32(data.data(), 4)), 0xCBF43926U);
+}
+
+TEST_F(UserCacheSnapshotTest, WriteAndFind) {
+    std::vector<UserCacheEntry> entries = {
+        MakeEntry("04A1B2C3", 10.0, 1),
+        MakeEntry("04A1", 20.0, 2),
+        MakeEntry("FFEE0011223344", 30.0, 1),
+        MakeEntry("04A1", 25.0, 2),
+    };
+    ASSERT_TRUE(UserCacheSnapshot::Write(path_, entries, 7));
+
+    auto snapshot = UserCacheSnapshot::Open(path_);
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(snapshot->Generation(), 7u);
+    EXPECT_EQ(snapshot->Count(), 3u);
+
+    auto entry = snapshot->Find("04A1");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_DOUBLE_EQ(entry->allowance, 25.0);
+    EXPECT_EQ(entry->roleId, 2);
+
+    ASSERT_TRUE(snapshot->Find("FFEE0011223344").has_value());
+    EXPECT_DOUBLE_EQ(snapshot->Find("04A1B2C3")->allowance, 10.0);
+    EXPECT_FALSE(snapshot->Find("04A").has_value());
+    EXPECT_FALSE(snapshot->Find("FFEE00112233445566").has_value());
+    EXPECT_FALSE(snapshot->Find("").has_value());
+}
+
+TEST_F(UserCacheSnapshotTest, RejectsCorruptFile) {
+    ASSERT_TRUE(UserCacheSnapshot::Write(path_, {MakeEntry("uid-1", 1.0, 1), MakeEntry("uid-2", 2.0, 1)}, 1));
+    ASSERT_NE(UserCacheSnapshot::Open(path_), nullptr);
+
+    {
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(34);
+        file.put('X');
+    }
+    EXPECT_EQ(UserCacheSnapshot::Open(path_), nullptr);
+
+    std::filesystem::resize_file(path_, 16);
+    EXPECT_EQ(UserCacheSnapshot::Open(path_), nullptr);
+    EXPECT_EQ(UserCacheSnapshot::Open(path_ + ".missing"), nullptr);
+}
+
+TEST_F(UserCacheSnapshotTest, MappedCacheOverlayAndPublish) {
+    MappedUserCache cache(path_);
+    EXPECT_FALSE(cache.IsLoaded());
+    EXPECT_EQ(cache.GetCount(), 0);
+
+    ASSERT_TRUE(cache.Publish({MakeEntry("uid-1", 100.0, 1), MakeEntry("uid-2", 50.0, 2)}));
+    EXPECT_TRUE(cache.IsLoaded());
+    EXPECT_EQ(cache.GetGeneration(), 1u);
+
+    EXPECT_TRUE(cache.DeductAllowance("uid-1", 30.0));
+    EXPECT_FALSE(cache.DeductAllowance("uid-missing", 1.0));
+    EXPECT_TRUE(cache.UpdateEntry("uid-3", 5.0, 1));
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 70.0);
+    EXPECT_EQ(cache.GetCount(), 3);
+
+    // The overlay is journaled and replayed with the snapshot
+    {
+        MappedUserCache reopened(path_);
+        EXPECT_EQ(reopened.GetGeneration(), 1u);
+        EXPECT_DOUBLE_EQ(reopened.GetEntry("uid-1")->allowance, 70.0);
+        EXPECT_DOUBLE_EQ(reopened.GetEntry("uid-3")->allowance, 5.0);
+    }
+
+    // Deductions carry over to the next generation; backend values are superseded
+    ASSERT_TRUE(cache.Publish({MakeEntry("uid-1", 200.0, 1)}));
+    EXPECT_EQ(cache.GetGeneration(), 2u);
+    EXPECT_EQ(cache.GetCount(), 1);
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 170.0);
+    EXPECT_FALSE(cache.GetEntry("uid-3").has_value());
+
+    // ...but only once
+    ASSERT_TRUE(cache.Publish({MakeEntry("uid-1", 200.0, 1)}));
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 200.0);
+
+    MappedUserCache reopened(path_);
+    EXPECT_EQ(reopened.GetGeneration(), 3u);
+    EXPECT_DOUBLE_EQ(reopened.GetEntry("uid-1")->allowance, 200.0);
+}
+
+TEST_F(UserCacheSnapshotTest, DeductionsSurviveACrashDuringPublish) {
+    {
+        MappedUserCache cache(path_);
+        ASSERT_TRUE(cache.Publish({MakeEntry("uid-1", 100.0, 1)}));
+        ASSERT_TRUE(cache.DeductAllowance("uid-1", 30.0));
+        ASSERT_TRUE(cache.UpdateEntry("uid-2", 40.0, 1));
+    }
+    // The next generation was written, the journal was not rewritten
+    ASSERT_TRUE(UserCacheSnapshot::Write(path_, {MakeEntry("uid-1", 150.0, 1), MakeEntry("uid-2", 60.0, 1)}, 2));
+
+    MappedUserCache cache(path_);
+    EXPECT_EQ(cache.GetGeneration(), 2u);
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 120.0);
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-2")->allowance, 60.0);
+}
+
+TEST_F(UserCacheSnapshotTest, RejectsHeaderSizesBeyondTheFile) {
+    ASSERT_TRUE(UserCacheSnapshot::Write(path_, {MakeEntry("uid-1", 1.0, 1)}, 1));
+    {
+        // count and key width at offsets 16 and 20
+        std::fstream file(path_, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint32_t huge = 0xFFFFFFFFu;
+        file.seekp(16);
+        file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+        file.write(reinterpret_cast<const char*>(&huge), sizeof(huge));
+    }
+    EXPECT_EQ(UserCacheSnapshot::Open(path_), nullptr);
+}
+
+TEST_F(UserCacheSnapshotTest, PopulationKeepsTanksAndWatermark) {
+    {
+        MappedUserCache cache(path_);
+        EXPECT_FALSE(cache.GetSyncWatermark().has_value());
+        ASSERT_TRUE(cache.BeginPopulation());
+        EXPECT_FALSE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntries({{"004161178090", 1, 80.0}, {"uid-2", 2, 0.0}}));
+        ASSERT_TRUE(cache.AddPopulationTank(10, 7, "Tank\t7", 700.0));
+        EXPECT_FALSE(cache.ApplyDelta({}, {}, {}, "too-early"));
+        ASSERT_TRUE(cache.CommitPopulation("wm-1"));
+        EXPECT_FALSE(cache.AddPopulationEntry("uid-3", 1.0, 1));
+
+        // An aborted population publishes nothing
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-3", 1.0, 1));
+        cache.AbortPopulation();
+        EXPECT_EQ(cache.GetGeneration(), 1u);
+    }
+
+    MappedUserCache cache(path_);
+    EXPECT_EQ(cache.GetCount(), 2);
+    EXPECT_EQ(cache.GetSyncWatermark().value_or(""), "wm-1");
+    const auto tanks = cache.GetTanks();
+    ASSERT_EQ(tanks.size(), 1u);
+    EXPECT_EQ(tanks[0].idTank, 10);
+    EXPECT_EQ(tanks[0].visualNumberTank, 7);
+    EXPECT_EQ(tanks[0].nameTank, "Tank 7");
+    EXPECT_DOUBLE_EQ(tanks[0].volume, 700.0);
+
+    const auto card = CardUid::Parse("004161178090");
+    ASSERT_TRUE(card.has_value());
+    ASSERT_TRUE(cache.GetEntry(*card).has_value());
+    EXPECT_DOUBLE_EQ(cache.GetEntry(*card)->allowance, 80.0);
+}
+
+TEST_F(UserCacheSnapshotTest, DeltaKeepsDeductionsOfUnchangedCards) {
+    {
+        MappedUserCache cache(path_);
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntries({{"uid-a", 1, 100.0}, {"uid-b", 1, 100.0}, {"uid-c", 1, 5.0}}));
+        ASSERT_TRUE(cache.CommitPopulation("wm-1"));
+        ASSERT_TRUE(cache.DeductAllowance("uid-a", 10.0));
+        ASSERT_TRUE(cache.DeductAllowance("uid-b", 20.0));
+
+        ASSERT_TRUE(cache.ApplyDelta({{"uid-b", 1, 80.0}}, {"uid-c"}, {{10, 7, "Tank-7", 700.0}}, "wm-2"));
+        EXPECT_EQ(cache.GetGeneration(), 2u);
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-a")->allowance, 90.0);
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-b")->allowance, 80.0);
+        EXPECT_FALSE(cache.GetEntry("uid-c").has_value());
+        EXPECT_EQ(cache.GetTankCount(), 1);
+        EXPECT_EQ(cache.GetSyncWatermark().value_or(""), "wm-2");
+    }
+
+    // The pending deduction of uid-a survives a restart and is carried over once
+    MappedUserCache cache(path_);
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-a")->allowance, 90.0);
+    ASSERT_TRUE(cache.BeginPopulation());
+    ASSERT_TRUE(cache.AddPopulationEntries({{"uid-a", 1, 100.0}, {"uid-b", 1, 100.0}}));
+    ASSERT_TRUE(cache.CommitPopulation("wm-3"));
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-a")->allowance, 90.0);
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-b")->allowance, 100.0);
+}
+
+// Startup, lookup and RSS comparison with the SQLite flip/flop cache
+// Run with --gtest_also_run_disabled_tests --gtest_filter='*SnapshotBenchmark*'
+TEST_F(UserCacheSnapshotTest, DISABLED_SnapshotBenchmark) {
+    constexpr int kEntries = 20000;
+    constexpr int kLookups = 200000;
+    using Clock = std::chrono::steady_clock;
+    auto micros = [](Clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    };
+
+    std::vector<UserCacheEntry> entries;
+    std::vector<std::string> uids;
+    std::mt19937 gen(42);
+    for (int i = 0; i < kEntries; ++i) {
+        std::ostringstream uid;
+        uid << std::hex << std::uppercase << std::setw(14) << std::setfill('0')
+            << (static_cast<unsigned long long>(gen()) << 24 | gen());
+        uids.push_back(uid.str());
+        entries.push_back(MakeEntry(uid.str(), i, i % 3 + 1));
+    }
+
+    const std::string dbPath = path_ + ".db";
+    {
+        UserCache sqlite(dbPath);
+        ASSERT_TRUE(sqlite.BeginPopulation());
+        for (const auto& entry : entries) {
+            ASSERT_TRUE(sqlite.AddPopulationEntry(entry.uid, entry.allowance, entry.roleId));
+        }
+        ASSERT_TRUE(sqlite.CommitPopulation());
+    }
+    ASSERT_TRUE(UserCacheSnapshot::Write(path_, entries, 1));
+
+    auto runLookups = [&](const auto& cache) {
+        std::size_t found = 0;
+        const auto start = Clock::now();
+        for (int i = 0; i < kLookups; ++i) {
+            found += cache.GetEntry(uids[static_cast<std::size_t>(i) % uids.size()]).has_value();
+        }
+        EXPECT_EQ(found, static_cast<std::size_t>(kLookups));
+        return Clock::now() - start;
+    };
+
+    long rssBefore = CurrentRssKb();
+    auto start = Clock::now();
+    auto sqlite = std::make_unique<UserCache>(dbPath);
+    const auto sqliteOpen = Clock::now() - start;
+    const long sqliteRss = CurrentRssKb() - rssBefore;
+    const auto sqliteLookups = runLookups(*sqlite);
+    sqlite.reset();
+
+    rssBefore = CurrentRssKb();
+    start = Clock::now();
+    auto mapped = std::make_unique<MappedUserCache>(path_);
+    const auto mappedOpen = Clock::now() - start;
+    const auto mappedLookups = runLookups(*mapped);
+    const long mappedRss = CurrentRssKb() - rssBefore;
+
+    std::cout << "entries=" << kEntries << " lookups=" << kLookups << "\n"
+              << "sqlite: open " << micros(sqliteOpen) << " us, lookups " << micros(sqliteLookups)
+              << " us, rss +" << sqliteRss << " kB\n"
+              << "mmap:   open " << micros(mappedOpen) << " us, lookups " << micros(mappedLookups)
+              << " us, rss +" << mappedRss << " kB\n";
+}
@@ -3,11 +3,16 @@
 // This file is a part of fuelflux application
 
 #include "user_cache.h"
+#include "backend.h"
 #include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <atomic>
 #include <filesystem>
 #include <random>
 #include <sstream>
 #include <iomanip>
+#include <thread>
+#include <vector>
 
 using namespace fuelflux;
 
@@ -37,8 +42,11 @@ protected:
     }
 
     void TearDown() override {
-        if (std::filesystem::exists(dbPath_)) {
-            std::filesystem::remove(dbPath_);
+        for (const auto& suffix : {"", "-wal", "-shm", ".bloom"}) {
+            const std::string path = dbPath_ + suffix;
+            if (std::filesystem::exists(path)) {
+                std::filesystem::remove(path);
+            }
         }
     }
 
@@ -491,3 +499,396 @@ TEST_F(UserCacheTest, TankPopulationReplacesPreviousSnapshot) {
     EXPECT_EQ(tanks[0].visualNumberTank, 2);
     EXPECT_EQ(tanks[0].nameTank, "New");
 }
+
+// Test that the lookup index is loaded from the active table on open
+TEST_F(UserCacheTest, IndexLoadedFromPersistedActiveTable) {
+    {
+        UserCache cache(dbPath_);
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-1", 10.0, 1));
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-2", 20.0, 2));
+        ASSERT_TRUE(cache.CommitPopulation());
+        ASSERT_TRUE(cache.DeductAllowance("uid-1", 4.0));
+    }
+
+    UserCache cache(dbPath_);
+    auto entry1 = cache.GetEntry("uid-1");
+    ASSERT_TRUE(entry1.has_value());
+    EXPECT_DOUBLE_EQ(entry1->allowance, 6.0);
+    auto entry2 = cache.GetEntry("uid-2");
+    ASSERT_TRUE(entry2.has_value());
+    EXPECT_EQ(entry2->roleId, 2);
+    EXPECT_FALSE(cache.GetEntry("uid-3").has_value());
+}
+
+// Test that standby writes are not visible until the population is committed
+TEST_F(UserCacheTest, IndexSwitchesOnlyOnCommit) {
+    UserCache cache(dbPath_);
+    ASSERT_TRUE(cache.UpdateEntry("uid-old", 1.0, 1));
+
+    ASSERT_TRUE(cache.BeginPopulation());
+    ASSERT_TRUE(cache.AddPopulationEntry("uid-new", 2.0, 1));
+    EXPECT_TRUE(cache.GetEntry("uid-old").has_value());
+    EXPECT_FALSE(cache.GetEntry("uid-new").has_value());
+
+    ASSERT_TRUE(cache.CommitPopulation());
+    EXPECT_FALSE(cache.GetEntry("uid-old").has_value());
+    EXPECT_TRUE(cache.GetEntry("uid-new").has_value());
+}
+
+// Test that many updates (beyond the delta folding threshold) remain visible
+TEST_F(UserCacheTest, IndexKeepsAllUpdatesAcrossDeltaFolding) {
+    UserCache cache(dbPath_);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(cache.UpdateEntry("uid-" + std::to_string(i), static_cast<double>(i), 1));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        auto entry = cache.GetEntry("uid-" + std::to_string(i));
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_DOUBLE_EQ(entry->allowance, static_cast<double>(i));
+    }
+}
+
+// Test that readers observe consistent entries while writers update and flip the cache
+TEST_F(UserCacheTest, ConcurrentLookupsDuringUpdatesAndCommit) {
+    UserCache cache(dbPath_);
+    ASSERT_TRUE(cache.UpdateEntry("uid-stable", 100.0, 1));
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> misses{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                auto entry = cache.GetEntry("uid-stable");
+                if (!entry.has_value() || entry->roleId != 1) {
+                    ++misses;
+                }
+            }
+        });
+    }
+
+    // No ASSERT_* while the readers run: returning early would destroy joinable threads
+    int writeFailures = 0;
+    for (int i = 0; i < 50; ++i) {
+        const bool written = cache.DeductAllowance("uid-stable", 1.0) && cache.BeginPopulation() &&
+                             cache.AddPopulationEntry("uid-stable", 100.0, 1) && cache.CommitPopulation();
+        if (!written) {
+            ++writeFailures;
+            break;
+        }
+    }
+
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(writeFailures, 0);
+    EXPECT_EQ(misses.load(), 0);
+}
+
+// Test that cached statements follow the active table across several flips
+TEST_F(UserCacheTest, CachedStatementsFollowTableSwaps) {
+    UserCache cache(dbPath_);
+    for (int generation = 0; generation < 4; ++generation) {
+        const std::string uid = "uid-gen-" + std::to_string(generation);
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry(uid, 100.0, 1));
+        ASSERT_TRUE(cache.CommitPopulation());
+
+        ASSERT_TRUE(cache.DeductAllowance(uid, 10.0 * (generation + 1)));
+        EXPECT_EQ(cache.GetCount(), 1);
+        auto entry = cache.GetEntry(uid);
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_DOUBLE_EQ(entry->allowance, 100.0 - 10.0 * (generation + 1));
+    }
+}
+
+// Test batched population inserts a whole page and rejects calls outside population
+TEST_F(UserCacheTest, BatchedPopulation) {
+    UserCache cache(dbPath_);
+
+    std::vector<UserCard> cards;
+    for (int i = 0; i < 250; ++i) {
+        UserCard card;
+        card.uid = "uid-" + std::to_string(i);
+        card.allowance = 10.0 + i;
+        card.roleId = i % 3 + 1;
+        cards.push_back(card);
+    }
+    std::vector<FuelTank> tanks(2);
+    tanks[0].idTank = 11;
+    tanks[0].visualNumberTank = 1;
+    tanks[0].nameTank = "A-95";
+    tanks[0].volume = 5000.0;
+    tanks[1].idTank = 12;
+    tanks[1].visualNumberTank = 2;
+    tanks[1].nameTank = "DT";
+    tanks[1].volume = 8000.0;
+
+    EXPECT_FALSE(cache.AddPopulationEntries(cards));
+    EXPECT_FALSE(cache.AddPopulationTanks(tanks));
+
+    ASSERT_TRUE(cache.BeginPopulation());
+    EXPECT_TRUE(cache.AddPopulationEntries({}));
+    EXPECT_TRUE(cache.AddPopulationEntries(cards));
+    EXPECT_TRUE(cache.AddPopulationTanks(tanks));
+    EXPECT_EQ(cache.GetCount(), 0);
+    ASSERT_TRUE(cache.CommitPopulation());
+
+    EXPECT_EQ(cache.GetCount(), 250);
+    EXPECT_EQ(cache.GetTankCount(), 2);
+    auto entry = cache.GetEntry("uid-249");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_DOUBLE_EQ(entry->allowance, 259.0);
+    EXPECT_EQ(entry->roleId, 1);
+}
+
+// Test that the file-backed cache runs in WAL mode by default and honours overrides
+TEST_F(UserCacheTest, DurabilitySettings) {
+    auto journalMode = [this]() {
+        sqlite3* db = nullptr;
+        std::string mode;
+        if (sqlite3_open(dbPath_.c_str(), &db) == SQLITE_OK) {
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &stmt, nullptr) == SQLITE_OK &&
+                sqlite3_step(stmt) == SQLITE_ROW) {
+                mode = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            }
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close(db);
+        return mode;
+    };
+
+    {
+        UserCache cache(dbPath_);
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-1", 10.0, 1));
+        ASSERT_TRUE(cache.CommitPopulation());
+        EXPECT_EQ(journalMode(), "wal");
+    }
+
+    {
+        UserCache cache(dbPath_, SqliteDurability{SqliteJournalMode::Delete, SqliteSynchronous::Full});
+        EXPECT_EQ(journalMode(), "delete");
+        auto entry = cache.GetEntry("uid-1");
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_DOUBLE_EQ(entry->allowance, 10.0);
+    }
+
+    // In-memory databases cannot use WAL but must still work
+    UserCache memory(":memory:");
+    ASSERT_TRUE(memory.BeginPopulation());
+    ASSERT_TRUE(memory.AddPopulationEntry("uid-1", 10.0, 1));
+    EXPECT_TRUE(memory.CommitPopulation());
+    EXPECT_EQ(memory.GetCount(), 1);
+}
+
+// Test that a delta is applied in place to the active table together with the watermark
+TEST_F(UserCacheTest, ApplyDeltaUpdatesActiveTable) {
+    {
+        UserCache cache(dbPath_);
+        EXPECT_FALSE(cache.GetSyncWatermark().has_value());
+
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-keep", 10.0, 1));
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-remove", 20.0, 1));
+        ASSERT_TRUE(cache.AddPopulationTank(1, 1, "Old", 100.0));
+        EXPECT_FALSE(cache.ApplyDelta({}, {}, {}, "wm-0"));
+        ASSERT_TRUE(cache.CommitPopulation("wm-1"));
+        EXPECT_EQ(cache.GetSyncWatermark().value_or(""), "wm-1");
+
+        std::vector<UserCard> upserts(1);
+        upserts[0].uid = "uid-new";
+        upserts[0].allowance = 30.0;
+        upserts[0].roleId = 2;
+        std::vector<FuelTank> tanks(1);
+        tanks[0].idTank = 2;
+        tanks[0].visualNumberTank = 5;
+        tanks[0].nameTank = "New";
+        tanks[0].volume = 500.0;
+
+        ASSERT_TRUE(cache.ApplyDelta(upserts, {"uid-remove"}, tanks, "wm-2"));
+        EXPECT_EQ(cache.GetCount(), 2);
+        EXPECT_FALSE(cache.GetEntry("uid-remove").has_value());
+        EXPECT_TRUE(cache.GetEntry("uid-keep").has_value());
+        ASSERT_TRUE(cache.GetEntry("uid-new").has_value());
+        EXPECT_EQ(cache.GetEntry("uid-new")->roleId, 2);
+        ASSERT_EQ(cache.GetTanks().size(), 1u);
+        EXPECT_EQ(cache.GetTanks()[0].visualNumberTank, 5);
+    }
+
+    UserCache reopened(dbPath_);
+    EXPECT_EQ(reopened.GetSyncWatermark().value_or(""), "wm-2");
+    EXPECT_EQ(reopened.GetCount(), 2);
+    EXPECT_TRUE(reopened.GetEntry("uid-new").has_value());
+}
+
+// Test that unknown cards are rejected by the Bloom filter and counted
+TEST_F(UserCacheTest, BloomFilterRejectsUnknownCards) {
+    {
+        UserCache cache(dbPath_);
+        ASSERT_TRUE(cache.BeginPopulation());
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_TRUE(cache.AddPopulationEntry("uid-" + std::to_string(i), 10.0, 1));
+        }
+        ASSERT_TRUE(cache.CommitPopulation());
+        EXPECT_TRUE(std::filesystem::exists(dbPath_ + ".bloom"));
+
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_FALSE(cache.GetEntry("foreign-" + std::to_string(i)).has_value());
+        }
+        EXPECT_TRUE(cache.GetEntry("uid-42").has_value());
+
+        const auto stats = cache.GetBloomFilterStats();
+        EXPECT_EQ(stats.lookups, 1001u);
+        EXPECT_EQ(stats.rejected + stats.falsePositives, 1000u);
+        EXPECT_GT(stats.rejected, 950u);
+        EXPECT_LT(stats.ObservedFalsePositiveRate(), 0.05);
+
+        // A card added online must pass the filter and invalidate the persisted copy
+        ASSERT_TRUE(cache.UpdateEntry("online-card", 5.0, 1));
+        EXPECT_TRUE(cache.GetEntry("online-card").has_value());
+        EXPECT_FALSE(std::filesystem::exists(dbPath_ + ".bloom"));
+    }
+
+    // The filter is rebuilt on open and covers the online card
+    UserCache reopened(dbPath_);
+    EXPECT_TRUE(std::filesystem::exists(dbPath_ + ".bloom"));
+    EXPECT_TRUE(reopened.GetEntry("online-card").has_value());
+    EXPECT_TRUE(reopened.GetEntry("uid-0").has_value());
+}
+
+// Test that a filter left over from before a commit is not trusted after a crash
+TEST_F(UserCacheTest, StaleBloomFilterIsRebuiltOnOpen) {
+    const std::string stalePath = dbPath_ + ".bloom.stale";
+    {
+        UserCache cache(dbPath_);
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-old", 10.0, 1));
+        ASSERT_TRUE(cache.CommitPopulation("wm-1"));
+        std::filesystem::copy_file(dbPath_ + ".bloom", stalePath);
+
+        std::vector<UserCard> upserts(1);
+        upserts[0].uid = "uid-new";
+        upserts[0].allowance = 30.0;
+        upserts[0].roleId = 1;
+        ASSERT_TRUE(cache.ApplyDelta(upserts, {}, {}, "wm-2"));
+    }
+
+    // The delta reached the database but the process died before the new filter was saved
+    std::filesystem::rename(stalePath, dbPath_ + ".bloom");
+
+    UserCache reopened(dbPath_);
+    EXPECT_TRUE(reopened.GetEntry("uid-new").has_value());
+    EXPECT_TRUE(reopened.GetEntry("uid-old").has_value());
+}
+
+// Test that deductions are journaled and folded into the table on commit
+TEST_F(UserCacheTest, AllowanceLedgerJournalsDeductions) {
+    {
+        UserCache cache(dbPath_);
+        ASSERT_TRUE(cache.UpdateEntry("uid-1", 100.0, 1));
+        ASSERT_TRUE(cache.UpdateEntry("uid-2", 50.0, 2));
+
+        ASSERT_TRUE(cache.DeductAllowance("uid-1", 10.0));
+        ASSERT_TRUE(cache.DeductAllowance("uid-1", 15.0));
+        ASSERT_TRUE(cache.DeductAllowance("uid-2", 5.0));
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 75.0);
+
+        auto ledger = cache.GetLedger("uid-1");
+        ASSERT_EQ(ledger.size(), 2u);
+        EXPECT_DOUBLE_EQ(ledger[0].amount, 10.0);
+        EXPECT_DOUBLE_EQ(ledger[1].amount, 15.0);
+        EXPECT_LT(ledger[0].id, ledger[1].id);
+        EXPECT_GT(ledger[0].createdAt, 0);
+        EXPECT_FALSE(ledger[0].foldedAt.has_value());
+        EXPECT_EQ(cache.GetLedger().size(), 3u);
+
+        // A fresh backend value supersedes pending deductions
+        ASSERT_TRUE(cache.UpdateEntry("uid-2", 40.0, 2));
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-2")->allowance, 40.0);
+        EXPECT_TRUE(cache.GetLedger("uid-2")[0].foldedAt.has_value());
+    }
+
+    // Pending entries survive a restart
+    {
+        UserCache cache(dbPath_);
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 75.0);
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-2")->allowance, 40.0);
+
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-1", 200.0, 1));
+        ASSERT_TRUE(cache.DeductAllowance("uid-1", 20.0));
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 55.0);
+        ASSERT_TRUE(cache.CommitPopulation());
+
+        // Only the deduction made during population applies to the downloaded value
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-1")->allowance, 180.0);
+        const auto ledger = cache.GetLedger("uid-1");
+        ASSERT_EQ(ledger.size(), 3u);
+        for (const auto& entry : ledger) {
+            EXPECT_TRUE(entry.foldedAt.has_value());
+        }
+    }
+
+    UserCache reopened(dbPath_);
+    EXPECT_DOUBLE_EQ(reopened.GetEntry("uid-1")->allowance, 180.0);
+}
+
+// Test that card UIDs are stored as binary keys and found by either form
+TEST_F(UserCacheTest, CardUidsStoredAsBinaryKeys) {
+    const std::string cardUid = "004161178090";
+    {
+        UserCache cache(dbPath_);
+        ASSERT_TRUE(cache.BeginPopulation());
+        ASSERT_TRUE(cache.AddPopulationEntry(cardUid, 100.0, 1));
+        ASSERT_TRUE(cache.AddPopulationEntry("uid-text", 50.0, 2));
+        ASSERT_TRUE(cache.CommitPopulation());
+        ASSERT_TRUE(cache.DeductAllowance(cardUid, 10.0));
+
+        auto entry = cache.GetEntry(*CardUid::Parse(cardUid));
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_EQ(entry->uid, cardUid);
+        EXPECT_DOUBLE_EQ(entry->allowance, 90.0);
+        EXPECT_DOUBLE_EQ(cache.GetEntry(cardUid)->allowance, 90.0);
+        EXPECT_DOUBLE_EQ(cache.GetEntry("uid-text")->allowance, 50.0);
+        EXPECT_FALSE(cache.GetEntry(*CardUid::Parse("004161178091")).has_value());
+        EXPECT_EQ(cache.GetLedger(cardUid).size(), 1u);
+    }
+
+    // The first population made table B active
+    sqlite3* db = nullptr;
+    ASSERT_EQ(sqlite3_open(dbPath_.c_str(), &db), SQLITE_OK);
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_EQ(sqlite3_prepare_v2(db, "SELECT typeof(uid), length(uid) FROM user_cache_b ORDER BY uid;", -1, &stmt, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_STREQ(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), "text");
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_STREQ(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)), "blob");
+    EXPECT_EQ(sqlite3_column_int(stmt, 1), 4);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+// Test that reader strings in a database from an earlier version are converted on open
+TEST_F(UserCacheTest, LegacyTextUidsAreMigrated) {
+    sqlite3* db = nullptr;
+    ASSERT_EQ(sqlite3_open(dbPath_.c_str(), &db), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(db,
+        "CREATE TABLE user_cache_a (uid TEXT PRIMARY KEY, allowance REAL NOT NULL, role_id INTEGER NOT NULL);"
+        "CREATE TABLE user_cache_meta (key TEXT PRIMARY KEY, value TEXT NOT NULL);"
+        "INSERT INTO user_cache_meta VALUES ('active_table', 'A');"
+        "INSERT INTO user_cache_a VALUES ('004161178090', 70.0, 1);"
+        "INSERT INTO user_cache_a VALUES ('uid-text', 20.0, 2);",
+        nullptr, nullptr, nullptr), SQLITE_OK);
+    sqlite3_close(db);
+
+    UserCache cache(dbPath_);
+    EXPECT_DOUBLE_EQ(cache.GetEntry("004161178090")->allowance, 70.0);
+    EXPECT_DOUBLE_EQ(cache.GetEntry(*CardUid::Parse("004161178090"))->allowance, 70.0);
+    EXPECT_DOUBLE_EQ(cache.GetEntry("uid-text")->allowance, 20.0);
+    ASSERT_TRUE(cache.UpdateEntry("004161178090", 60.0, 1));
+    EXPECT_EQ(cache.GetCount(), 2);
+}